@@ -1980,6 +1980,14 @@ public final class GVRAssetLoader {
             throw new IOException(errmsg);
         }
         boolean startAnimations = settings.contains(GVRImportSettings.START_ANIMATIONS);
+        if (settings.contains(GVRImportSettings.PACK_VERTICES))
+        {
+            jassimpAdapter.setVertexFormat(GVRMesh.PACK_ALL);
+        }
+        if (settings.contains(GVRImportSettings.OPTIMIZE_VERTEX_ORDER))
+        {
+            jassimpAdapter.setOptimizeMeshes(true);
+        }
         jassimpAdapter.processScene(request, model, assimpScene, volume, startAnimations);
         request.onModelLoaded(mContext, model, filePath);
         return model;
@@ -87,7 +87,19 @@ public enum GVRImportSettings {
     /**
      * Causes the animations in the asset to start as soon as the asset is added to the scene.
      */
-    START_ANIMATIONS(0x100000);
+    START_ANIMATIONS(0x100000),
+
+    /**
+     * Upload the vertices of the imported meshes in packed formats where no precision is lost,
+     * see {@link GVRMesh#setVertexFormat(int)}.
+     */
+    PACK_VERTICES(0x8000000),
+
+    /**
+     * Reorder the triangles and vertices of the imported meshes for the vertex cache and for less
+     * overdraw, see {@link GVRMesh#optimize()}.
+     */
+    OPTIMIZE_VERTEX_ORDER(0x10000000);
     
     private int mValue;
     
@@ -116,6 +128,8 @@ public enum GVRImportSettings {
             flags |= s.getValue();
         }
         flags &= ~START_ANIMATIONS.getValue();
+        flags &= ~PACK_VERTICES.getValue();
+        flags &= ~OPTIMIZE_VERTEX_ORDER.getValue();
         return flags;
     }
     
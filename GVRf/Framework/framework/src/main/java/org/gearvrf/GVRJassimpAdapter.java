@@ -5,7 +5,6 @@ import android.graphics.BitmapFactory;
 
 import java.io.ByteArrayInputStream;
 import java.io.IOException;
-import java.nio.CharBuffer;
 import java.nio.FloatBuffer;
 import java.nio.IntBuffer;
 import java.util.ArrayList;
@@ -59,6 +58,8 @@ class GVRJassimpAdapter {
     private AiScene mScene;
     private GVRContext mContext;
     private String mFileName;
+    private int mVertexFormat = 0;
+    private boolean mOptimizeMeshes = false;
     private static final int MAX_TEX_COORDS = JassimpConfig.MAX_NUMBER_TEXCOORDS;
     private static final int MAX_VERTEX_COLORS = JassimpConfig.MAX_NUMBER_COLORSETS;
 
@@ -82,9 +83,29 @@ class GVRJassimpAdapter {
         mNodeFactories.remove(factory);
     }
 
+    /**
+     * Vertex format given to the meshes created from now on.
+     * @see GVRMesh#setVertexFormat(int)
+     */
+    public void setVertexFormat(int format) {
+        mVertexFormat = format;
+    }
+
+    /**
+     * Whether the meshes created from now on are optimized.
+     * @see GVRMesh#optimize()
+     */
+    public void setOptimizeMeshes(boolean optimize) {
+        mOptimizeMeshes = optimize;
+    }
+
     public GVRMesh createMesh(GVRContext ctx, AiMesh aiMesh) {
         GVRMesh mesh = new GVRMesh(ctx);
 
+        if (mVertexFormat != 0) {
+            mesh.setVertexFormat(mVertexFormat);
+        }
+
         // Vertices
         FloatBuffer verticesBuffer = aiMesh.getPositionBuffer();
         if (verticesBuffer != null) {
@@ -156,11 +177,9 @@ class GVRJassimpAdapter {
         // Triangles
         IntBuffer indexBuffer = aiMesh.getIndexBuffer();
         if (indexBuffer != null) {
-            CharBuffer triangles = CharBuffer.allocate(indexBuffer.capacity());
-            for (int i = 0; i < indexBuffer.capacity(); ++i) {
-                triangles.put((char)indexBuffer.get());
-            }
-            mesh.setIndices(triangles.array());
+            int[] triangles = new int[indexBuffer.capacity()];
+            indexBuffer.get(triangles);
+            mesh.setIndices(triangles);
         }
 
         // Bones
@@ -172,6 +191,11 @@ class GVRJassimpAdapter {
             mesh.setBones(bones);
         }
 
+        if (mOptimizeMeshes) {
+            float[] report = mesh.optimize();
+            Log.d(TAG, "optimized %s: ACMR %f -> %f, ATVR %f -> %f", aiMesh.getName(),
+                    report[0], report[2], report[1], report[3]);
+        }
         return mesh;
     }
 
@@ -314,6 +338,8 @@ class GVRJassimpAdapter {
             case FLIP_UV:
                 return AiPostProcessSteps.FLIP_UVS;
             case START_ANIMATIONS:
+            case PACK_VERTICES:
+            case OPTIMIZE_VERTEX_ORDER:
                 return null;
             default:
                 // Unsupported setting
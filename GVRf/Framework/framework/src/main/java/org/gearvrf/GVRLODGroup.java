@@ -15,13 +15,21 @@
 
 package org.gearvrf;
 
-import org.gearvrf.utility.Log;
-import org.joml.Vector4f;
-
 import java.util.LinkedList;
 
 
 /**
+ * Level of detail group. Each level is a scene object the group adds as a
+ * child of its owner; culling draws only one of them per frame and skips
+ * the others along with their children. The level is chosen in native
+ * code while culling, from either the distance between the camera and
+ * the owner's bounding sphere or the fraction of the screen height the
+ * sphere covers. A group uses one or the other, not both.
+ * <p>
+ * To keep levels from popping back and forth near a threshold the current
+ * level is kept until the distance or screen size leaves its range by more
+ * than the hysteresis, 10% by default.
+ * <p>
  * Example:
  * <pre>
  * root = new GVRSceneObject(..);
@@ -36,22 +44,24 @@ import java.util.LinkedList;
  * lodGroup.addRange(9, sphereLowDensity);
  * root.attachComponent(lodGroup);
  * </pre>
+ * or, by size on screen:
+ * <pre>
+ * lodGroup.addLevel(0.5f, sphereHighDensity);
+ * lodGroup.addLevel(0.1f, sphereMediumDensity);
+ * lodGroup.addLevel(0.01f, sphereLowDensity);
+ * </pre>
+ * @see GVRScene#setSmallFeatureCulling(float)
  */
 public final class GVRLODGroup extends GVRBehavior {
-    static private long TYPE_LODGROUP = newComponentType(GVRLODGroup.class);
-
     public GVRLODGroup(GVRContext gvrContext) {
-        super(gvrContext, 0);
-        mType = getComponentType();
+        super(gvrContext, NativeLODGroup.ctor());
     }
 
     static public long getComponentType() {
-        return TYPE_LODGROUP;
+        return NativeLODGroup.getComponentType();
     }
 
-    private final Vector4f mCenter = new Vector4f();
-    private final Vector4f mVector = new Vector4f();
-    private final LinkedList<Object[]> mRanges = new LinkedList<>();
+    private final LinkedList<GVRSceneObject> mLevels = new LinkedList<>();
 
     /**
      * Add a range to this LOD group. Specify the scene object that should be displayed in this
@@ -60,6 +70,7 @@ public final class GVRLODGroup extends GVRBehavior {
      * @param range show the scene object if the camera distance is greater than this value
      * @param sceneObject scene object that should be rendered when in this range
      * @throws IllegalArgumentException if range is negative or sceneObject null
+     * @throws IllegalStateException if the group has levels added with {@link #addLevel(float, GVRSceneObject)}
      */
     public synchronized void addRange(final float range, final GVRSceneObject sceneObject)
     {
@@ -69,68 +80,82 @@ public final class GVRLODGroup extends GVRBehavior {
         if (range < 0) {
             throw new IllegalArgumentException("range cannot be negative");
         }
-
-        final int size = mRanges.size();
-        final float rangePow2 = range*range;
-        final Object[] newElement = new Object[] {rangePow2, sceneObject};
-
-        for (int i = 0; i < size; ++i) {
-            final Object[] el = mRanges.get(i);
-            final Float r = (Float)el[0];
-            if (r > rangePow2) {
-                mRanges.add(i, newElement);
-                break;
-            }
+        if (!NativeLODGroup.addRange(getNative(), range, sceneObject.getNative())) {
+            throw new IllegalStateException("cannot mix distance ranges and screen sizes");
         }
+        addChild(sceneObject);
+    }
 
-        if (mRanges.size() == size) {
-            mRanges.add(newElement);
+    /**
+     * Add a level selected by size on screen. The first level, in order of
+     * decreasing size, whose minimum the bounding sphere of the owner reaches
+     * is rendered; nothing is when it falls short of every level. The
+     * scene object is added as a child of the owner.
+     * @param minScreenSize smallest fraction of the screen height the owner
+     *                      covers with this level rendered
+     * @param sceneObject scene object that should be rendered at this size
+     * @throws IllegalArgumentException if minScreenSize is negative or sceneObject null
+     * @throws IllegalStateException if the group has ranges added with {@link #addRange(float, GVRSceneObject)}
+     */
+    public synchronized void addLevel(final float minScreenSize, final GVRSceneObject sceneObject)
+    {
+        if (null == sceneObject) {
+            throw new IllegalArgumentException("sceneObject must be specified!");
         }
-
-        final GVRSceneObject owner = getOwnerObject();
-        if (null != owner) {
-            owner.addChildObject(sceneObject);
+        if (minScreenSize < 0) {
+            throw new IllegalArgumentException("minScreenSize cannot be negative");
+        }
+        if (!NativeLODGroup.addLevel(getNative(), minScreenSize, sceneObject.getNative())) {
+            throw new IllegalStateException("cannot mix distance ranges and screen sizes");
         }
+        addChild(sceneObject);
     }
 
     /**
-     * Do not call directly.
-     * @deprecated
+     * Remove a level added with either method. Its scene object is removed
+     * from the children of the owner.
+     * @param sceneObject scene object of the level
      */
-    public void onDrawFrame(float frameTime) {
-        final GVRSceneObject owner = getOwnerObject();
-        if (owner == null) {
-            return;
-        }
-
-        final int size = mRanges.size();
-        final GVRTransform t = getGVRContext().getMainScene().getMainCameraRig().getCenterCamera().getTransform();
-
-        for (final Object[] range : mRanges) {
-            ((GVRSceneObject)range[1]).setEnable(false);
-        }
+    public synchronized void removeLevel(final GVRSceneObject sceneObject)
+    {
+        if (mLevels.remove(sceneObject)) {
+            NativeLODGroup.removeLevel(getNative(), sceneObject.getNative());
 
-        for (int i = size - 1; i >= 0; --i) {
-            final Object[] range = mRanges.get(i);
-            final GVRSceneObject child = (GVRSceneObject) range[1];
-            if (child.getParent() != owner) {
-                Log.w(TAG, "the scene object for distance greater than " + range[0] + " is not a child of the owner; skipping it");
-                continue;
+            final GVRSceneObject owner = getOwnerObject();
+            if ((null != owner) && (sceneObject.getParent() == owner)) {
+                owner.removeChildObject(sceneObject);
             }
+        }
+    }
 
-            final float[] values = child.getBoundingVolumeRawValues();
-            mCenter.set(values[0], values[1], values[2], 1.0f);
-            mVector.set(t.getPositionX(), t.getPositionY(), t.getPositionZ(), 1.0f);
+    /**
+     * Set how far, as a fraction of the distance or screen size, the
+     * current level is kept past its range before switching.
+     * @param hysteresis fraction of the range, 0 to switch right at it
+     */
+    public void setHysteresis(float hysteresis)
+    {
+        NativeLODGroup.setHysteresis(getNative(), hysteresis);
+    }
 
-            mVector.sub(mCenter);
-            mVector.negate();
+    /**
+     * @return index of the level the last frame rendered, in order of
+     *         increasing range or decreasing screen size, or -1 if none
+     */
+    public int getSelectedLevel()
+    {
+        return NativeLODGroup.getSelectedLevel(getNative());
+    }
 
-            float distance = mVector.dot(mVector);
+    private void addChild(final GVRSceneObject sceneObject)
+    {
+        if (!mLevels.contains(sceneObject)) {
+            mLevels.add(sceneObject);
+        }
 
-            if (distance >= (Float) range[0]) {
-                child.setEnable(true);
-                break;
-            }
+        final GVRSceneObject owner = getOwnerObject();
+        if (null != owner) {
+            owner.addChildObject(sceneObject);
         }
     }
 
@@ -138,8 +163,8 @@ public final class GVRLODGroup extends GVRBehavior {
     public synchronized void onAttach(GVRSceneObject newOwner) {
         super.onAttach(newOwner);
 
-        for (final Object[] el : mRanges) {
-            newOwner.addChildObject((GVRSceneObject)el[1]);
+        for (final GVRSceneObject level : mLevels) {
+            newOwner.addChildObject(level);
         }
     }
 
@@ -147,10 +172,24 @@ public final class GVRLODGroup extends GVRBehavior {
     public synchronized void onDetach(GVRSceneObject oldOwner) {
         super.onDetach(oldOwner);
 
-        for (final Object[] el : mRanges) {
-            oldOwner.removeChildObject((GVRSceneObject)el[1]);
+        for (final GVRSceneObject level : mLevels) {
+            oldOwner.removeChildObject(level);
         }
     }
+}
+
+class NativeLODGroup {
+    static native long ctor();
+
+    static native long getComponentType();
+
+    static native boolean addRange(long lodGroup, float range, long sceneObject);
+
+    static native boolean addLevel(long lodGroup, float minSize, long sceneObject);
+
+    static native void removeLevel(long lodGroup, long sceneObject);
+
+    static native void setHysteresis(long lodGroup, float hysteresis);
 
-    private static final String TAG = "GVRLODGroup";
-}
\ No newline at end of file
+    static native int getSelectedLevel(long lodGroup);
+}
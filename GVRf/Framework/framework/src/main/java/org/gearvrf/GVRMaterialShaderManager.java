@@ -17,9 +17,12 @@ package org.gearvrf;
 
 import android.content.res.Resources;
 
+import java.io.File;
 import java.io.InputStream;
 import java.util.HashMap;
+import java.util.HashSet;
 import java.util.Map;
+import java.util.Set;
 import java.lang.reflect.*;
 
 import org.gearvrf.GVRShaderTemplate;
@@ -40,10 +43,126 @@ import org.gearvrf.utility.Log;
     public class GVRMaterialShaderManager extends
         GVRBaseShaderManager implements GVRShaderManagers {
 
+    private static final String PROGRAM_CACHE_NAME = "gvr_programs";
+
     private final Map<GVRShaderId, GVRMaterialMap> materialMaps = new HashMap<GVRShaderId, GVRMaterialMap>();
 
     GVRMaterialShaderManager(GVRContext gvrContext) {
         super(gvrContext, NativeShaderManager.ctor());
+        File cacheDir = gvrContext.getContext().getCacheDir();
+        if (cacheDir != null) {
+            setProgramCacheDirectory(new File(cacheDir, PROGRAM_CACHE_NAME).getAbsolutePath());
+        }
+    }
+
+    /**
+     * Compiles shaders on a background thread instead of during the first
+     * frame that draws them.
+     *
+     * Objects whose shader is still compiling are not drawn, the same as
+     * while a {@link GVRShaderTemplate} is generating their shader. Off by
+     * default.
+     *
+     * @param async
+     *            true to compile in the background.
+     * @see #prewarm(GVRShaderId...)
+     */
+    public void setAsyncCompile(boolean async)
+    {
+        NativeShaderManager.setAsyncCompile(getNative(), async);
+    }
+
+    /**
+     * Compiles the given shaders now rather than when they are first drawn,
+     * typically while a loading screen is shown.
+     *
+     * With {@link #setAsyncCompile(boolean)} on, the shaders are queued on the
+     * compile thread and {@link #getPendingPrograms()} tells when they are
+     * done. Otherwise they are compiled on the GL thread before the next frame.
+     *
+     * @param shaders
+     *            shaders to compile, stock or custom.
+     */
+    public void prewarm(GVRShaderId... shaders)
+    {
+        int[] shaderTypes = new int[shaders.length];
+        for (int i = 0; i < shaders.length; ++i)
+        {
+            shaderTypes[i] = shaders[i].ID;
+        }
+        prewarm(shaderTypes);
+    }
+
+    private void prewarm(final int[] shaderTypes)
+    {
+        getGVRContext().runOnGlThread(new Runnable()
+        {
+            public void run()
+            {
+                NativeShaderManager.prewarm(getNative(), shaderTypes);
+            }
+        });
+    }
+
+    /**
+     * Generates the shaders of every object in a scene and compiles them
+     * before they are first drawn.
+     *
+     * The variants of {@link GVRShaderTemplate} shaders depend on the meshes,
+     * materials and lights they are used with; this binds them for the
+     * scene as it is now, so call it once the scene and its lights are set up.
+     *
+     * @param scene
+     *            scene to compile the shaders of.
+     * @see #prewarm(GVRShaderId...)
+     */
+    public void prewarm(GVRScene scene)
+    {
+        Set<Integer> shaders = new HashSet<Integer>();
+
+        scene.bindShaders();
+        for (GVRSceneObject sceneObject : scene.getWholeSceneObjects())
+        {
+            GVRRenderData rdata = sceneObject.getRenderData();
+            GVRMaterial material = (rdata != null) ? rdata.getMaterial() : null;
+            if (material != null)
+            {
+                shaders.add(material.getShaderType().ID);
+            }
+        }
+        int[] shaderTypes = new int[shaders.size()];
+        int i = 0;
+        for (Integer shaderType : shaders)
+        {
+            shaderTypes[i++] = shaderType;
+        }
+        prewarm(shaderTypes);
+    }
+
+    /**
+     * @return how many shaders are still being compiled in the background.
+     */
+    public int getPendingPrograms()
+    {
+        return NativeShaderManager.getPendingPrograms(getNative());
+    }
+
+    /**
+     * Sets the directory where linked shader programs are kept between runs.
+     *
+     * The first time a program is built its binary is saved there, and later
+     * launches load it instead of compiling the shaders again. Binaries are
+     * keyed by the shader sources and the GL driver version, so they are
+     * rebuilt when either changes. By default the programs are kept in the
+     * application's cache directory.
+     *
+     * @param directory
+     *            path of the directory, which is created if needed,
+     *            or null to stop caching programs.
+     */
+    public static void setProgramCacheDirectory(String directory)
+    {
+        NativeShaderManager.setProgramCacheDirectory(directory);
     }
 
     /**
@@ -134,4 +253,20 @@ class NativeShaderManager {
             String fragmentShader);
 
     static native long getCustomShader(long shaderManager, int id);
+
+    static native void setAsyncCompile(long shaderManager, boolean async);
+
+    static native void prewarm(long shaderManager, int[] shaderTypes);
+
+    static native int getPendingPrograms(long shaderManager);
+
+    static native void setProgramCacheDirectory(String directory);
+
+    static native int getCompiledPrograms();
+
+    static native int getCachedPrograms();
+
+    static native long getProgramCompileTime();
+
+    static native long getProgramLoadTime();
 }
@@ -38,6 +38,29 @@ import org.gearvrf.utility.Log;
 public class GVRMesh extends GVRHybridObject implements PrettyPrint {
     private static final String TAG = GVRMesh.class.getSimpleName();
 
+    /**
+     * Upload positions as half floats, see {@link #setVertexFormat(int)}.
+     */
+    public static final int PACK_POSITIONS = 1;
+    /**
+     * Upload normals, tangents and bitangents as 10 bit signed normalized
+     * integers.
+     */
+    public static final int PACK_NORMALS = 2;
+    /**
+     * Upload texture coordinates as half floats.
+     */
+    public static final int PACK_TEXCOORDS = 4;
+    /**
+     * Upload bone indices and weights as bytes.
+     */
+    public static final int PACK_BONE_WEIGHTS = 8;
+    /**
+     * Pack every attribute which can be.
+     */
+    public static final int PACK_ALL = PACK_POSITIONS | PACK_NORMALS
+            | PACK_TEXCOORDS | PACK_BONE_WEIGHTS;
+
     public GVRMesh(GVRContext gvrContext) {
         this(gvrContext, NativeMesh.ctor());
         mAttributeKeys = new HashSet<String>();
@@ -196,6 +219,29 @@ public class GVRMesh extends GVRHybridObject implements PrettyPrint {
         NativeMesh.setIndices(getNative(), indices);
     }
 
+    /**
+     * Get the vertex indices of the mesh as {@code int} values. Use this
+     * instead of {@link #getIndices()} for meshes with more than 65536
+     * vertices.
+     *
+     * @return Array with the packed index data.
+     */
+    public int[] getIntIndices() {
+        return NativeMesh.getIntIndices(getNative());
+    }
+
+    /**
+     * Sets the vertex indices of the mesh from {@code int} values, so
+     * meshes can have more than 65536 vertices. The index buffer is still
+     * uploaded with 16 bit indices when the vertex count allows it.
+     *
+     * @param indices
+     *            Array containing the packed index data.
+     */
+    public void setIndices(int[] indices) {
+        NativeMesh.setIntIndices(getNative(), indices);
+    }
+
     /**
      * Get the array of {@code float} scalars bound to the shader attribute
      * {@code key}.
@@ -332,6 +378,57 @@ public class GVRMesh extends GVRHybridObject implements PrettyPrint {
         NativeMesh.getSphereBound(getNative(), sphere);
     }
 
+    /**
+     * Choose which vertex attributes are uploaded to the GPU in a smaller
+     * format than 32 bit floats, which can halve the size of the vertex
+     * buffer. The data kept in the mesh is not changed. An attribute is
+     * only packed if its values keep their precision: positions within
+     * 1/4096 of the size of the mesh, texture coordinates within 1/1024,
+     * normals and tangents if no component is outside [-1, 1], bone
+     * indices if they are below 256.
+     *
+     * @param format combination of {@link #PACK_POSITIONS},
+     *            {@link #PACK_NORMALS}, {@link #PACK_TEXCOORDS} and
+     *            {@link #PACK_BONE_WEIGHTS}, or 0 for floats only.
+     */
+    public void setVertexFormat(int format) {
+        NativeMesh.setVertexFormat(getNative(), format);
+    }
+
+    /**
+     * @return the packing chosen with {@link #setVertexFormat(int)}.
+     */
+    public int getVertexFormat() {
+        return NativeMesh.getVertexFormat(getNative());
+    }
+
+    /**
+     * Reorder the triangles of the mesh so the GPU transforms fewer
+     * vertices and draws less overdraw, then renumber the vertices in the
+     * order they are used. What is drawn does not change. Vertices of
+     * skinned meshes keep their numbers.
+     *
+     * @return average cache misses per triangle (ACMR) and vertices
+     *         transformed per vertex (ATVR) before, then after:
+     *         { acmrBefore, atvrBefore, acmrAfter, atvrAfter }
+     */
+    public float[] optimize() {
+        return optimize(1.05f);
+    }
+
+    /**
+     * Reorder the triangles and vertices of the mesh, see {@link #optimize()}.
+     *
+     * @param overdrawThreshold how many times worse the vertex cache may
+     *            get to reduce overdraw; 1 means not at all.
+     * @return { acmrBefore, atvrBefore, acmrAfter, atvrAfter }
+     */
+    public float[] optimize(float overdrawThreshold) {
+        float[] report = new float[4];
+        NativeMesh.optimize(getNative(), overdrawThreshold, report);
+        return report;
+    }
+
     /**
      * Determine if a named attribute exists in this mesh.
      * @param key Name of the shader attribute
@@ -595,6 +692,10 @@ class NativeMesh {
 
     static native void setIndices(long mesh, char[] indices);
 
+    static native int[] getIntIndices(long mesh);
+
+    static native void setIntIndices(long mesh, int[] indices);
+
     static native float[] getFloatVector(long mesh, String key);
 
     static native void setFloatVector(long mesh, String key, float[] floatVector);
@@ -618,4 +719,10 @@ class NativeMesh {
     static native void getSphereBound(long mesh, float[] sphere);
     
     static native boolean hasAttribute(long mesh, String key);
+
+    static native void setVertexFormat(long mesh, int format);
+
+    static native int getVertexFormat(long mesh);
+
+    static native void optimize(long mesh, float overdrawThreshold, float[] report);
 }
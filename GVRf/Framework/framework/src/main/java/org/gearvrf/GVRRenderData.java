@@ -913,6 +913,58 @@ public class GVRRenderData extends GVRComponent implements PrettyPrint {
         return this;
     }
 
+    /**
+     * Returns whether this object hides the objects behind it from the
+     * CPU occlusion culler.
+     * @return true if the object is an occluder
+     * @see #setOccluder(boolean)
+     */
+    public boolean isOccluder() {
+        return NativeRenderData.isOccluder(getNative());
+    }
+
+    /**
+     * Makes this object an occluder. While CPU occlusion culling is
+     * enabled the meshes of occluders are drawn into a small depth buffer
+     * on the CPU every frame and objects they completely hide are not
+     * rendered. Pick a few large, opaque objects
+     * with simple meshes, like walls and buildings.
+     * @param occluder true to make the object an occluder
+     * @see GVRScene#setCpuOcclusionCulling(boolean)
+     */
+    public GVRRenderData setOccluder(boolean occluder) {
+        NativeRenderData.setOccluder(getNative(), occluder);
+        return this;
+    }
+
+    /**
+     * Returns whether this object is drawn into the cached static layer
+     * of the shadow maps.
+     * @return true if the object is a static shadow caster
+     * @see #setStaticShadowCaster(boolean)
+     */
+    public boolean isStaticShadowCaster() {
+        return NativeRenderData.isStaticShadowCaster(getNative());
+    }
+
+    /**
+     * Marks this object as a static shadow caster. Shadow maps keep the
+     * static casters of their light in a cached layer and only draw them
+     * again when the light moves or the shadow maps are invalidated, so
+     * only objects that move every frame need to be drawn. Call
+     * {@link GVRScene#inValidateShadowMap()} after moving a static caster.
+     * @param staticCaster true if the object does not move
+     * @see GVRShadowMap#setUpdateRate(int)
+     */
+    public GVRRenderData setStaticShadowCaster(boolean staticCaster) {
+        NativeRenderData.setStaticShadowCaster(getNative(), staticCaster);
+        GVRScene scene = getGVRContext().getMainScene();
+        if (scene != null) {
+            scene.inValidateShadowMap();
+        }
+        return this;
+    }
+
     @Override
     public void prettyPrint(StringBuffer sb, int indent) {
         GVRMesh mesh = null;
@@ -1056,6 +1108,14 @@ class NativeRenderData {
 
     static native boolean getCastShadows(long renderData);
 
+    static native void setOccluder(long renderData, boolean occluder);
+
+    static native boolean isOccluder(long renderData);
+
+    static native void setStaticShadowCaster(long renderData, boolean staticCaster);
+
+    static native boolean isStaticShadowCaster(long renderData);
+
     static native void setStencilFunc(long renderData, int func, int ref, int mask);
 
     static native void setStencilOp(long renderData, int fail, int zfail, int zpass);
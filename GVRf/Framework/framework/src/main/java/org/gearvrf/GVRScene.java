@@ -293,12 +293,133 @@ public class GVRScene extends GVRHybridObject implements PrettyPrint, IScriptabl
     }
 
     /**
-     * Sets the occlusion query for the {@link GVRScene}.
+     * Sets the occlusion query for the {@link GVRScene}. Objects are
+     * tested with GPU queries against the depth buffer of the frame and
+     * keep their last result until a new one arrives, so an object that
+     * comes into view may show up a frame late.
      */
     public void setOcclusionQuery(boolean flag) {
         NativeScene.setOcclusionQuery(getNative(), flag);
     }
 
+    /**
+     * Selects how the {@link GVRScene} is traversed for frustum culling.
+     * When disabled (the default) culling recurses through the scene
+     * objects; when enabled it walks a flattened copy of the scene graph.
+     * The copy still reads the bounds of every node it visits each frame,
+     * so on one thread it is not reliably faster than the recursion.
+     * Culling on several threads and the vector frustum test need it.
+     */
+    public void setFlatCulling(boolean flag) {
+        NativeScene.setFlatCulling(getNative(), flag);
+    }
+
+    /**
+     * Enables the vector (NEON/SSE) frustum test for the flattened scene
+     * graph. It is on by default where the CPU supports it; disabling it
+     * falls back to the scalar reference test, which gives the same results.
+     */
+    public void setSimdCulling(boolean flag) {
+        NativeScene.setSimdCulling(getNative(), flag);
+    }
+
+    /**
+     * Sets the number of threads, the render thread included, used to
+     * frustum cull the {@link GVRScene}. Subtrees of the scene graph are
+     * spread across the threads and the results merged in scene order.
+     * The default of 1 culls on the render thread only. Only applies
+     * while flat culling is enabled.
+     */
+    public void setCullThreads(int count) {
+        NativeScene.setCullThreads(getNative(), count);
+    }
+
+    /**
+     * Enables culling against one frustum enclosing both eyes of the main
+     * camera rig (the default). The scene is culled, sorted and batched
+     * once per frame and the result is drawn for both eyes. When disabled
+     * the center camera's frustum is used, which can drop objects seen
+     * only near the outer edge of one eye.
+     */
+    public void setStereoCulling(boolean flag) {
+        NativeScene.setStereoCulling(getNative(), flag);
+    }
+
+    /**
+     * Enables CPU occlusion culling, off by default. After frustum
+     * culling the objects marked with
+     * {@link GVRRenderData#setOccluder(boolean)} are drawn into a small
+     * depth buffer on the CPU and objects they completely hide are not
+     * drawn in the same frame. Without occluders nothing is culled.
+     * Hidden objects can still be picked.
+     */
+    public void setCpuOcclusionCulling(boolean flag) {
+        NativeScene.setCpuOcclusionCulling(getNative(), flag);
+    }
+
+    /**
+     * Enables small feature culling. Objects whose bounding sphere covers
+     * fewer than {@code minPixels} rows of the eye buffer are culled along
+     * with their children, as they contribute next to nothing to the image.
+     * @param minPixels size on screen in pixels below which objects are
+     *                  dropped, 0 (the default) to disable
+     * @see GVRLODGroup
+     */
+    public void setSmallFeatureCulling(float minPixels) {
+        NativeScene.setSmallFeatureCulling(getNative(), minPixels);
+    }
+
+    /**
+     * Enables GPU instancing, off by default. Render data that share a
+     * mesh, materials and render state are drawn with one instanced draw
+     * call instead of being merged into batches on the CPU. The texture
+     * shader supports it; custom shaders opt in by reading their model
+     * matrix from a {@code mat4 a_instance_matrix} vertex attribute
+     * instead of {@code u_model}. Render data drawn with other shaders
+     * keep the CPU batching, as do transparent ones, which have to be
+     * drawn back to front.
+     */
+    public void setInstancing(boolean flag) {
+        NativeScene.setInstancing(getNative(), flag);
+    }
+
+    /**
+     * Replays the recorded render commands into a backend that makes no
+     * GL calls, so nothing is drawn. Meant for measuring the cost of
+     * recording them; see the "Render Commands" line of the stats.
+     */
+    public void setNullBackend(boolean flag) {
+        NativeScene.setNullBackend(getNative(), flag);
+    }
+
+    /**
+     * Culls and sorts the next frame on a thread of its own while the GL
+     * thread submits the current one. Disabled by default.
+     *
+     * The visible set drawn in a frame is the one prepared from the
+     * previous frame, so an object coming into view shows up one frame
+     * late; transforms are still the current ones. Frames that add or
+     * remove scene objects are prepared right away. CPU and GPU occlusion
+     * culling are skipped while this is enabled. The GL thread's share
+     * of the work is on the "Frame Prep" line of the stats.
+     */
+    public void setPipelinedFramePrep(boolean flag) {
+        NativeScene.setPipelinedFramePrep(getNative(), flag);
+    }
+
+    /**
+     * Sets how much geometry one batch may hold when meshes are merged on
+     * the CPU (500 vertices and 500 indices by default). Meshes that do
+     * not fit into an empty batch are drawn on their own. Larger budgets
+     * mean fewer draw calls but more data to upload when a batch changes.
+     *
+     * @param maxVertices vertices per batch
+     * @param maxIndices indices per batch
+     */
+    public void setBatchBudget(int maxVertices, int maxIndices) {
+        NativeScene.setBatchBudget(getNative(), maxVertices, maxIndices);
+    }
+
     private GVRConsole mStatsConsole = null;
     private boolean mStatsEnabled = false;
     private boolean pendingStats = false;
@@ -354,9 +475,52 @@ public class GVRScene extends GVRHybridObject implements PrettyPrint, IScriptabl
         if (mStatsEnabled) {
             int numberDrawCalls = NativeScene.getNumberDrawCalls(getNative());
             int numberTriangles = NativeScene.getNumberTriangles(getNative());
+            int numberRenderCommands = NativeScene.getNumberRenderCommands(getNative());
+            long commandRecordTime = NativeScene.getCommandRecordTime(getNative());
+            long commandReplayTime = NativeScene.getCommandReplayTime(getNative());
+            int shadowCasters = NativeScene.getShadowCasters(getNative());
+            int shadowMapsUpdated = NativeScene.getShadowMapsUpdated(getNative());
+            int shadowMapsSkipped = NativeScene.getShadowMapsSkipped(getNative());
+            long framePrepSnapshotTime = NativeScene.getFramePrepSnapshotTime(getNative());
+            long framePrepWaitTime = NativeScene.getFramePrepWaitTime(getNative());
+            long cullTime = NativeScene.getCullTime(getNative());
+            long sortTime = NativeScene.getSortTime(getNative());
+            int cullAllocations = NativeScene.getCullAllocations(getNative());
+            int occlusionQueries = NativeScene.getOcclusionQueries(getNative());
+            int occlusionStalls = NativeScene.getOcclusionStalls(getNative());
+            float occlusionLatency = NativeScene.getOcclusionLatency(getNative());
+            int cpuOccluded = NativeScene.getCpuOccluded(getNative());
+            long cpuOcclusionTime = NativeScene.getCpuOcclusionTime(getNative());
+            int glCallsAvoided = NativeScene.getNumberGLCallsAvoided(getNative());
+            int batchUploadBytes = NativeScene.getBatchUploadBytes(getNative());
+            int compiledPrograms = NativeShaderManager.getCompiledPrograms();
+            int cachedPrograms = NativeShaderManager.getCachedPrograms();
+            long programCompileTime = NativeShaderManager.getProgramCompileTime();
+            long programLoadTime = NativeShaderManager.getProgramLoadTime();
 
             mStatsConsole.writeLine("Draw Calls: %d", numberDrawCalls);
             mStatsConsole.writeLine("Triangles: %d", numberTriangles);
+            mStatsConsole.writeLine("Render Commands: %d, %.3f ms record, %.3f ms replay",
+                    numberRenderCommands, commandRecordTime / 1000000.0f,
+                    commandReplayTime / 1000000.0f);
+            mStatsConsole.writeLine("Shadows: %d casters, %d maps drawn, %d reused",
+                    shadowCasters, shadowMapsUpdated, shadowMapsSkipped);
+            mStatsConsole.writeLine("Programs: %d compiled in %.1f ms, %d cached in %.1f ms",
+                    compiledPrograms, programCompileTime / 1000000.0f,
+                    cachedPrograms, programLoadTime / 1000000.0f);
+            mStatsConsole.writeLine("Frame Prep: %.3f ms snapshot, %.3f ms wait",
+                    framePrepSnapshotTime / 1000000.0f, framePrepWaitTime / 1000000.0f);
+            mStatsConsole.writeLine("Cull Time: %.3f ms", cullTime / 1000000.0f);
+            mStatsConsole.writeLine("Sort Time: %.3f ms", sortTime / 1000000.0f);
+            if (cullAllocations >= 0) {
+                mStatsConsole.writeLine("Cull Allocations: %d", cullAllocations);
+            }
+            mStatsConsole.writeLine("Occlusion Queries: %d issued, %d stalled, %.1f frames",
+                    occlusionQueries, occlusionStalls, occlusionLatency);
+            mStatsConsole.writeLine("CPU Occlusion: %d culled, %.3f ms", cpuOccluded,
+                    cpuOcclusionTime / 1000000.0f);
+            mStatsConsole.writeLine("GL Calls Avoided: %d", glCallsAvoided);
+            mStatsConsole.writeLine("Batch Upload Bytes: %d", batchUploadBytes);
 
             if (mStatMessage.length() > 0) {
                 String lines[] = mStatMessage.toString().split(System.lineSeparator());
@@ -733,14 +897,70 @@ class NativeScene {
 
     public static native void setOcclusionQuery(long scene, boolean flag);
 
+    public static native void setFlatCulling(long scene, boolean flag);
+
+    public static native void setSimdCulling(long scene, boolean flag);
+
+    public static native void setCullThreads(long scene, int count);
+
+    public static native void setStereoCulling(long scene, boolean flag);
+
+    public static native void setCpuOcclusionCulling(long scene, boolean flag);
+
+    public static native void setSmallFeatureCulling(long scene, float minPixels);
+
+    public static native void setInstancing(long scene, boolean flag);
+
+    public static native void setNullBackend(long scene, boolean flag);
+
+    public static native void setPipelinedFramePrep(long scene, boolean flag);
+
+    public static native void setBatchBudget(long scene, int maxVertices, int maxIndices);
+
     static native void setMainCameraRig(long scene, long cameraRig);
 
     public static native void resetStats(long scene);
 
     public static native int getNumberDrawCalls(long scene);
 
+    public static native int getNumberRenderCommands(long scene);
+
+    public static native long getCommandRecordTime(long scene);
+
+    public static native long getCommandReplayTime(long scene);
+
+    public static native int getShadowCasters(long scene);
+
+    public static native int getShadowMapsUpdated(long scene);
+
+    public static native int getShadowMapsSkipped(long scene);
+
+    public static native long getFramePrepSnapshotTime(long scene);
+
+    public static native long getFramePrepWaitTime(long scene);
+
     public static native int getNumberTriangles(long scene);
 
+    public static native long getCullTime(long scene);
+
+    public static native long getSortTime(long scene);
+
+    public static native int getCullAllocations(long scene);
+
+    public static native int getOcclusionQueries(long scene);
+
+    public static native int getOcclusionStalls(long scene);
+
+    public static native float getOcclusionLatency(long scene);
+
+    public static native int getCpuOccluded(long scene);
+
+    public static native long getCpuOcclusionTime(long scene);
+
+    public static native int getNumberGLCallsAvoided(long scene);
+
+    public static native int getBatchUploadBytes(long scene);
+
     public static native void exportToFile(long scene, String file_path);
 
     static native boolean addLight(long scene, long light);
@@ -752,16 +752,24 @@ public class GVRShaderTemplate
                 lightFunction += "   c = vec4(enable, enable, enable, 1) * AddLight(s, r);\n";
                 lightFunction += "   color.xyz += c.xyz;\n";
                 lightFunction += "   color.w = c.w;\n";
-                lightSources += "\nuniform Uniform" + lightClassName + " " + uniformId + ";\n";
+                if (!useLightBlock())
+                    lightSources += "\nuniform Uniform" + lightClassName + " " + uniformId + ";\n";
             }
             ++index;
         }
+        if (useLightBlock())
+            lightSources += generateLightBlock(lightlist);
         for (Map.Entry<String, LightClass> entry : lightClasses.entrySet())
         {
             LightClass lclass = entry.getValue();
             
             if (lclass.FragmentShader == null)
+            {
+                // Lights_ubo declares the lights with only a vertex shader too
+                if (useLightBlock())
+                    lightDefs += "\n" + lclass.FragmentUniforms;
                 continue;
+            }
             lightDefs += "\n" + lclass.FragmentUniforms;            
             if (lclass.VertexOutputs != null)
                 lightDefs += "\n" + lclass.VertexOutputs;
@@ -786,6 +794,7 @@ public class GVRShaderTemplate
         String lightDefs = "";
         String lightFunction = "void LightVertex(Vertex vertex) {\n";
         Integer index = 0;
+        boolean hasVertexLights = false;
 
         for (GVRLightBase light : lightlist)
         {
@@ -802,7 +811,9 @@ public class GVRShaderTemplate
                 lightShader = lightShader.replace("@LIGHTIN", lightid);
                 lightFunction += lightShader;
                 lightDefs += makeVertexOutputs(light.getVertexDescriptor(), vertexId, "out ");
-                lightSources += "\nuniform Uniform" + light.getClass().getSimpleName() + " " + lightid + ";\n";
+                if (!useLightBlock())
+                    lightSources += "\nuniform Uniform" + light.getClass().getSimpleName() + " " + lightid + ";\n";
+                hasVertexLights = true;
             }
             ++index;
         }
@@ -810,13 +821,53 @@ public class GVRShaderTemplate
         for (Map.Entry<String, LightClass> entry : lightClasses.entrySet())
         {
             LightClass lclass = entry.getValue();
-            
-            if (lclass.VertexShader != null)
+
+            if (useLightBlock() ? hasVertexLights : (lclass.VertexShader != null))
                 lightDefs += lclass.FragmentUniforms;
         }
+        if (useLightBlock() && hasVertexLights)
+            lightSources += generateLightBlock(lightlist);
         return lightDefs + lightSources + lightFunction;
     }
 
+    /**
+     * Light uniforms are kept in a uniform block if the GLSL version
+     * supports them. The renderer then uploads all the lights into one
+     * buffer once per frame instead of setting each light's uniforms in
+     * every program that uses it.
+     */
+    private boolean useLightBlock()
+    {
+        return mGLSLVersion >= 300;
+    }
+
+    /**
+     * Generates the Lights_ubo block declaring the uniforms of every light
+     * which has a fragment or a vertex shader. The vertex and fragment
+     * shaders must declare it identically, so both use this function.
+     *
+     * @param lightlist
+     *            list of lights in the scene
+     * @return string with the block declaration, empty if there are no lights
+     */
+    private String generateLightBlock(GVRLightBase[] lightlist)
+    {
+        String members = "";
+
+        for (GVRLightBase light : lightlist)
+        {
+            String lightid = light.getLightID();
+
+            if (((light.getFragmentShaderSource() == null) && (light.getVertexShaderSource() == null))
+                || lightid.isEmpty())
+                continue;
+            members += "    Uniform" + light.getClass().getSimpleName() + " " + lightid + ";\n";
+        }
+        if (members.isEmpty())
+            return "";
+        return "\nlayout (std140) uniform Lights_ubo {\n" + members + "};\n";
+    }
+
     private Map<String, LightClass> scanLights(GVRLightBase[] lightlist)
     {
         Map<String, LightClass> lightClasses = new HashMap<String, LightClass>();
@@ -829,7 +880,7 @@ public class GVRShaderTemplate
             String lightid = light.getLightID();
             String lightShader = light.getFragmentShaderSource();
  
-            if ((lightShader == null) || lightid.isEmpty())
+            if (((lightShader == null) && (light.getVertexShaderSource() == null)) || lightid.isEmpty())
                 continue;
             LightClass lightClass = lightClasses.get(lightClassName);
             if (lightClass != null)
@@ -837,7 +888,10 @@ public class GVRShaderTemplate
             else
             {
                 lightClass = new LightClass();
-                lightClass.FragmentShader = lightShader.replace("@LightType", lightClassName);
+                if (lightShader != null)
+                {
+                    lightClass.FragmentShader = lightShader.replace("@LightType", lightClassName);
+                }
                 lightClass.FragmentUniforms = makeShaderStruct(light.getUniformDescriptor(), "Uniform" + lightClassName, null);
                 if (light.getVertexShaderSource() != null)
                 {
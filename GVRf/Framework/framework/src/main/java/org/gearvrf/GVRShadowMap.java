@@ -75,6 +75,21 @@ public class GVRShadowMap extends GVRRenderTarget
         setCamera(camera);
     }
 
+    /**
+     * Sets how often the shadow map is drawn. With a rate of 1, the
+     * default, it is drawn every frame; with a rate of N every Nth frame,
+     * reusing the shadows of the last update in between. Lights whose
+     * shadows change slowly can use a higher rate.
+     * Static casters are cached separately and are only drawn when the
+     * light moves or the shadow maps are invalidated.
+     * @param frames frames between two updates of the shadow map
+     * @see GVRRenderData#setStaticShadowCaster(boolean)
+     */
+    public void setUpdateRate(int frames)
+    {
+        NativeShadowMap.setUpdateRate(getNative(), frames);
+    }
+
     /**
      * Adds an orthographic camera constructed from the designated
      * perspective camera to describe the shadow projection.
@@ -222,4 +237,6 @@ public class GVRShadowMap extends GVRRenderTarget
 class NativeShadowMap
 {
     static native long ctor(long material);
+
+    static native void setUpdateRate(long shadowMap, int frames);
 }
\ No newline at end of file
@@ -495,10 +495,14 @@ abstract class GVRViewManager extends GVRContext {
         makeShadowMaps(mMainScene.getNative(), mRenderBundle.getMaterialShaderManager().getNative(),
                 mRenderBundle.getPostEffectRenderTextureA().getWidth(),
                 mRenderBundle.getPostEffectRenderTextureA().getHeight());
-        cull(mMainScene.getNative(), centerCamera.getNative(), mRenderBundle.getMaterialShaderManager().getNative());
+        cull(mMainScene.getNative(), centerCamera.getNative(), mRenderBundle.getMaterialShaderManager().getNative(),
+                mRenderBundle.getPostEffectRenderTextureA().getHeight());
     }
 
     protected void afterDrawEyes() {
+        // the next frame may still be culled in the background
+        finishFramePrep();
+
         // Execute post-rendering tasks (after drawing eyes, but
         // before afterDrawEyes handlers)
         synchronized (mRunnablesPostRender) {
@@ -821,7 +825,8 @@ abstract class GVRViewManager extends GVRContext {
 
     protected native void renderCamera(long scene, long camera, long shaderManager,
                                        long postEffectShaderManager, long postEffectRenderTextureA, long postEffectRenderTextureB, boolean isMultiviewSet);
-    protected native void cull(long scene, long camera, long shader_manager);
+    protected native void cull(long scene, long camera, long shader_manager, int viewportHeight);
+    protected native void finishFramePrep();
     protected native void makeShadowMaps(long scene, long shader_manager, int width, int height);
     protected native void cullAndRender(long render_target, long scene, long shader_manager,
                                         long postEffectShaderManager, long postEffectRenderTextureA, long postEffectRenderTextureB);
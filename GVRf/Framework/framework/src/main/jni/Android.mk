@@ -44,6 +44,8 @@ LOCAL_C_INCLUDES +=	$(LOCAL_PATH)/contrib/assimp/include/Compiler
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/contrib/jassimp
 # Uncomment for logs
 # LOCAL_CFLAGS += -DANDROID -DJNI_LOG
+# Uncomment to count heap allocations (shown as "Cull Allocations" in the stats)
+# LOCAL_CPPFLAGS += -DGVR_COUNT_ALLOCATIONS
 FILE_LIST := $(wildcard $(LOCAL_PATH)/contrib/jassimp/*.cpp)
 LOCAL_SRC_FILES += $(FILE_LIST:$(LOCAL_PATH)/%=%)
 
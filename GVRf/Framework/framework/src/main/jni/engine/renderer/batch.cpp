@@ -18,13 +18,11 @@
 #include "objects/components/render_data.h"
 #include "objects/light.h"
 
-#define BATCH_SIZE 60
-
 namespace gvr {
 Batch::Batch(int no_vertices, int no_indices) :
         draw_count_(0), vertex_count_(0), index_count_(0), vertex_limit_(no_vertices),
         indices_limit_(no_indices), renderdata_(nullptr),mesh_init_(false),
-        index_offset_(0), not_batched_(false), batch_dirty_(false) {
+        index_offset_(0), not_batched_(false), batch_dirty_(false), free_vertices_(0) {
 
     vertices_.reserve(no_vertices);
     indices_.reserve(no_indices);
@@ -39,8 +37,12 @@ Batch::~Batch() {
     renderdata_ = nullptr;
 }
 
-void Batch::updateMesh(Mesh* render_mesh){
-    const std::vector<unsigned short>& indices = render_mesh->indices();
+/*
+ * Append a mesh at the end of the merged mesh, its vertices use the model
+ * matrix in matrix_slot.
+ */
+void Batch::updateMesh(Mesh* render_mesh, int matrix_slot){
+    const std::vector<unsigned int>& indices = render_mesh->indices();
     const std::vector<glm::vec3>& vertices = render_mesh->vertices();
     const std::vector<glm::vec3>& normals = render_mesh->normals();
     const std::vector<glm::vec2>& tex_cords = render_mesh->getVec2Vector("a_texcoord");
@@ -50,7 +52,7 @@ void Batch::updateMesh(Mesh* render_mesh){
 
     for(int i=0;i<size;i++){
         vertices_.push_back(vertices[i]);
-        matrix_indices_.push_back(draw_count_);
+        matrix_indices_.push_back(matrix_slot);
         tex_coords_.push_back(tex_cords[i]);
     }
     // Check if models has normals
@@ -62,35 +64,156 @@ void Batch::updateMesh(Mesh* render_mesh){
     size = indices.size();
     index_count_+=size;
     for (int i = 0; i < size; i++) {
-        unsigned short index = indices[i];
+        unsigned int index = indices[i];
         index += index_offset_;
         indices_.push_back(index);
     }
     // update all VBO data
     vertex_count_ += vertices.size();
     index_offset_ += vertices.size();
-    draw_count_++;
     mesh_init_ = false;
 }
+
 /*
- * Add renderdata of scene object into mesh, add vertices, texcoords, normals, model matrices
+ * Overwrite the range of a member in place with render_mesh. Indices the
+ * mesh does not need are left degenerate.
  */
-bool Batch::add(RenderData *render_data) {
-    material_ = render_data->pass(0)->material();
-    Mesh *render_mesh = render_data->mesh();
-    const std::vector<unsigned short>& indices = render_mesh->indices();
+void Batch::writeMember(Mesh* render_mesh, const Member& member){
+    const Range& range = member.range;
+    const std::vector<unsigned int>& indices = render_mesh->indices();
+    const std::vector<glm::vec3>& vertices = render_mesh->vertices();
+    const std::vector<glm::vec3>& normals = render_mesh->normals();
+    const std::vector<glm::vec2>& tex_cords = render_mesh->getVec2Vector("a_texcoord");
+    int size = vertices.size();
+
+    for(int i=0;i<size;i++){
+        vertices_[range.first_vertex + i] = vertices[i];
+        matrix_indices_[range.first_vertex + i] = member.matrix_slot;
+        tex_coords_[range.first_vertex + i] = tex_cords[i];
+    }
+    if(normals.size() > 0 && normals_.size() >= static_cast<size_t>(range.first_vertex + size)){
+        for(int i=0;i<size;i++)
+            normals_[range.first_vertex + i] = normals[i];
+    }
+    size = indices.size();
+    for (int i = 0; i < range.index_count; i++) {
+        indices_[range.first_index + i] = range.first_vertex + ((i < size) ? indices[i] : 0);
+    }
+    if (mesh_init_) {
+        uploadRange(range);
+    }
+}
 
+/*
+ * Hand a range changed in place to the batch mesh, which uploads just
+ * that part on its next use.
+ */
+void Batch::uploadRange(const Range& range){
+    mesh_.updateVertices(range.first_vertex, &vertices_[range.first_vertex], range.vertex_count);
+    if (normals_.size() >= static_cast<size_t>(range.first_vertex + range.vertex_count)) {
+        mesh_.updateNormals(range.first_vertex, &normals_[range.first_vertex], range.vertex_count);
+    }
+    mesh_.updateVec2Vector("a_texcoord", range.first_vertex, &tex_coords_[range.first_vertex],
+            range.vertex_count);
+    mesh_.updateFloatVector("a_matrix_index", range.first_vertex,
+            &matrix_indices_[range.first_vertex], range.vertex_count);
+    mesh_.updateIndices(range.first_index, &indices_[range.first_index], range.index_count);
+}
+
+/*
+ * First free range with room for the given mesh size, or -1.
+ */
+int Batch::findFreeRange(int vertex_count, int index_count){
+    int count = free_ranges_.size();
+    for (int i = 0; i < count; ++i) {
+        const Range& range = free_ranges_[i];
+        if (range.vertex_count >= vertex_count && range.index_count >= index_count) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Batch::addMember(RenderData* render_data){
+    Mesh* render_mesh = render_data->mesh();
+    int vertex_count = render_mesh->vertices().size();
+    int index_count = render_mesh->indices().size();
     Transform* const t = render_data->owner_object()->transform();
     glm::mat4 model_matrix;
     if (t != NULL) {
         model_matrix = glm::mat4(t->getModelMatrix());
     }
+
+    Member member;
+    if (free_slots_.size() > 0) {
+        member.matrix_slot = free_slots_.back();
+        free_slots_.pop_back();
+        matrices_[member.matrix_slot] = model_matrix;
+    } else {
+        member.matrix_slot = matrices_.size();
+        matrices_.push_back(model_matrix);
+    }
+
+    int free = findFreeRange(vertex_count, index_count);
+    if (free >= 0) {
+        Range range = free_ranges_[free];
+        free_ranges_[free] = free_ranges_.back();
+        free_ranges_.pop_back();
+        free_vertices_ -= range.vertex_count;
+        // give back what is left if it can still hold a mesh
+        if (range.vertex_count > vertex_count && range.index_count > index_count) {
+            Range rest = { range.first_vertex + vertex_count, range.vertex_count - vertex_count,
+                    range.first_index + index_count, range.index_count - index_count };
+            free_ranges_.push_back(rest);
+            free_vertices_ += rest.vertex_count;
+            range.vertex_count = vertex_count;
+            range.index_count = index_count;
+        }
+        member.range = range;
+        writeMember(render_mesh, member);
+    } else {
+        Range range = { (int) vertex_count_, vertex_count, (int) index_count_, index_count };
+        member.range = range;
+        updateMesh(render_mesh, member.matrix_slot);
+    }
+    members_[render_data] = member;
+    draw_count_++;
+}
+
+/*
+ * Turn the range of a member into degenerate triangles and put it on the
+ * free list.
+ */
+void Batch::removeMember(RenderData* render_data){
+    auto it = members_.find(render_data);
+    if (it == members_.end()) {
+        return;
+    }
+    const Member& member = it->second;
+    const Range& range = member.range;
+    for (int i = 0; i < range.index_count; i++) {
+        indices_[range.first_index + i] = range.first_vertex;
+    }
+    if (mesh_init_) {
+        mesh_.updateIndices(range.first_index, &indices_[range.first_index], range.index_count);
+    }
+    free_ranges_.push_back(range);
+    free_vertices_ += range.vertex_count;
+    free_slots_.push_back(member.matrix_slot);
+    members_.erase(it);
+    draw_count_--;
+}
+
+/*
+ * Add renderdata of scene object into mesh, add vertices, texcoords, normals, model matrices
+ */
+bool Batch::add(RenderData *render_data) {
+    material_ = render_data->pass(0)->material();
+    Mesh *render_mesh = render_data->mesh();
+    const std::vector<unsigned int>& indices = render_mesh->indices();
+
     render_data->getHashCode();
     render_data->setDirty(false);
-
-    // Store the model matrix and its index into map for update
-    matrix_index_map_[render_data] = draw_count_;
-    matrices_.push_back(model_matrix);
     render_data->owner_object()->setTransformUnDirty();
 
     if(!render_data->batching()){
@@ -108,8 +231,12 @@ bool Batch::add(RenderData *render_data) {
             return true;
         }
     }
-    // if mesh is large, render in normal way
-    if (indices.size() == 0 || (indices.size() + index_count_ > indices_limit_)) {
+    // if mesh does not fit into the budgets, render in normal way
+    int vertex_count = render_mesh->vertices().size();
+    int index_count = indices.size();
+    if (index_count == 0 || ((index_count + (int) index_count_ > indices_limit_
+            || vertex_count + (int) vertex_count_ > vertex_limit_)
+            && findFreeRange(vertex_count, index_count) < 0)) {
         if (draw_count_ > 0) {
             return false;
         } else {
@@ -127,7 +254,7 @@ bool Batch::add(RenderData *render_data) {
        }
     }
     render_data_set_.insert(render_data); // store all the renderdata which are in batch
-    updateMesh(render_mesh);
+    addMember(render_data);
     return true;
 }
 void Batch::clearData(){
@@ -135,7 +262,10 @@ void Batch::clearData(){
     index_count_ = 0;
     index_offset_ = 0;
     draw_count_=0;
-    matrix_index_map_.clear();
+    free_vertices_ = 0;
+    members_.clear();
+    free_ranges_.clear();
+    free_slots_.clear();
     matrix_indices_.clear();
     matrices_.clear();
     tex_coords_.clear();
@@ -146,20 +276,24 @@ void Batch::clearData(){
     batch_dirty_ = false;
 }
 
+/*
+ * Drop the members that were disabled. Returns true if there were any.
+ */
 bool Batch::isRenderModified(){
-     bool update_vbo = false;
+     bool removed = false;
      for(auto it= render_data_set_.begin();it!=render_data_set_.end();){
         if(!(*it)->enabled() || !(*it)->owner_object()->enabled()){
             (*it)->set_batching(false);
             (*it)->setBatchNull();
+            removeMember(*it);
             render_data_set_.erase(it++);
-            update_vbo = true;
+            removed = true;
         }
         else {
             ++it;
         }
     }
-    return update_vbo;
+    return removed;
 }
 void Batch::resetBatch(){
     clearData();
@@ -180,13 +314,14 @@ void Batch::meshInit(){
     }
 }
 bool Batch::setupMesh(bool batch_dirty){
-    bool update_vbo = isRenderModified();
+    isRenderModified();
     // batch is empty, add it back to the pool
     if(0 == render_data_set_.size()){
         resetBatch();
         return false;
     }
-    if(batch_dirty || update_vbo)
+    // compact once half of the vertices belong to removed members
+    if(batch_dirty || free_vertices_ * 2 > static_cast<int>(vertex_count_))
         regenerateMeshData();
     batch_dirty_ = false;
     if(!mesh_init_)
@@ -196,18 +331,7 @@ bool Batch::setupMesh(bool batch_dirty){
 void Batch::regenerateMeshData(){
     clearData();
     for(auto it= render_data_set_.begin();it!=render_data_set_.end();++it){
-        RenderData* render_data = *it;
-        Mesh *render_mesh = render_data->mesh();
-        const std::vector<unsigned short>& indices = render_mesh->indices();
-        Transform* const t = render_data->owner_object()->transform();
-        glm::mat4 model_matrix;
-        if (t != NULL) {
-            model_matrix = glm::mat4(t->getModelMatrix());
-        }
-        // Store the model matrix and its index into map for update
-        matrix_index_map_[render_data] = draw_count_;
-        matrices_.push_back(model_matrix);
-        updateMesh(render_mesh);
+        addMember(*it);
     }
 }
 }
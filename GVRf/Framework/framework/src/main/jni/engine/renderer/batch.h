@@ -40,21 +40,35 @@ public:
     void resetBatch();
     void meshInit();
     void regenerateMeshData();
+    /*
+     * Vertex and index budgets checked when a render data is added.
+     */
+    void setLimits(int no_vertices, int no_indices){
+        vertex_limit_ = no_vertices;
+        indices_limit_ = no_indices;
+    }
     void UpdateModelMatrix(RenderData* renderdata, glm::mat4 model_matrix){
-        if(renderdata){
-            matrices_[matrix_index_map_[renderdata]] = model_matrix;
+        auto it = members_.find(renderdata);
+        if(it != members_.end()){
+            matrices_[it->second.matrix_slot] = model_matrix;
         }
     }
     void removeRenderData(RenderData* renderdata){
         renderdata->set_batching(false);
         render_data_set_.erase(renderdata);
-        batch_dirty_ = true;
+        removeMember(renderdata);
         if(0 == render_data_set_.size())
             resetBatch();
     }
     const std::vector<glm::mat4>& get_matrices() {
         return matrices_;
     }
+    /*
+     * Bytes the batch mesh wrote to its GL buffers since the last call.
+     */
+    int takeUploadBytes() {
+        return mesh_.takeUploadBytes();
+    }
     int getNumberOfMeshes(){
         return draw_count_;
     }
@@ -85,11 +99,36 @@ public:
         return index_count_;
     }
 private:
-    void updateMesh(Mesh* render_mesh);
+    /*
+     * Vertices and indices of the merged mesh owned by one member. Ranges
+     * of removed members are kept as degenerate triangles on a free list
+     * and reused by later members that fit; only the changed ranges are
+     * uploaded. The mesh is compacted once half of it is free.
+     */
+    struct Range {
+        int first_vertex;
+        int vertex_count;
+        int first_index;
+        int index_count;
+    };
+    struct Member {
+        Range range;
+        int matrix_slot;
+    };
+
+    void addMember(RenderData* render_data);
+    void removeMember(RenderData* render_data);
+    int findFreeRange(int vertex_count, int index_count);
+    void writeMember(Mesh* render_mesh, const Member& member);
+    void uploadRange(const Range& range);
+    void updateMesh(Mesh* render_mesh, int matrix_slot);
     void clearData();
     bool isRenderModified();
     bool batch_dirty_;
-    std::unordered_map<RenderData*,int>matrix_index_map_;
+    std::unordered_map<RenderData*, Member> members_;
+    std::vector<Range> free_ranges_;
+    std::vector<int> free_slots_;
+    int free_vertices_;
     std::unordered_set<RenderData*>render_data_set_;
     Mesh mesh_;
     RenderData *renderdata_;
@@ -97,7 +136,7 @@ private:
     std::vector<glm::vec3> vertices_;
     std::vector<glm::vec3> normals_;
     std::vector<glm::vec2> tex_coords_;
-    std::vector<unsigned short> indices_;
+    std::vector<unsigned int> indices_;
     std::vector<glm::mat4> matrices_;
     std::vector<float> matrix_indices_;
     int vertex_limit_;
@@ -21,15 +21,15 @@
 #include "objects/scene.h"
 #include "objects/scene_object.h"
 #include "objects/components/camera.h"
-#define BATCH_SIZE 60
 namespace gvr {
 
-BatchManager::BatchManager(int batch_size, int max_indices){
-    batch_size_ = batch_size;
+BatchManager::BatchManager(int batch_size, int max_vertices, int max_indices){
+    batch_size_ = (batch_size < MAX_BATCH_SIZE) ? batch_size : MAX_BATCH_SIZE;
+    max_vertices_ = max_vertices;
     max_indices_ = max_indices;
 
     for(int i=0; i<BATCH_POOL_SIZE; i++){
-        Batch* new_batch = new Batch(max_indices_, max_indices_);
+        Batch* new_batch = new Batch(max_vertices_, max_indices_);
         batch_pool_.push_back(new_batch);
     }
 }
@@ -48,14 +48,24 @@ BatchManager::~BatchManager(){
   * shader type and mesh dynamic-ness
   */
 void BatchManager::batchSetup(std::vector<RenderData*>& render_data_vector) {
+    clearBatchSet();
+    addBatches(render_data_vector, 0, render_data_vector.size());
+}
+
+/*
+ * Set up the batches of render data start to end - 1 after the batches
+ * already set up, so that runs of the vector drawn some other way can be
+ * left out.
+ */
+void BatchManager::addBatches(std::vector<RenderData*>& render_data_vector, int start,
+        int end) {
    batch_indices_.clear();
-   int render_vector_size = render_data_vector.size();
    RenderData* prev = nullptr;
    RenderData* curr = nullptr;
 
-   if(render_vector_size != 0){
-       batch_indices_.push_back(0);
-       prev = render_data_vector[0];
+   if(start < end){
+       batch_indices_.push_back(start);
+       prev = render_data_vector[start];
    }
     /***
         Separate batch is created for following cases
@@ -64,23 +74,29 @@ void BatchManager::batchSetup(std::vector<RenderData*>& render_data_vector) {
        case 3: if any of the render-data properties fails to match between current and render data:  rendering order/ static or dynamic mesh/ no of passes/
                material and cull status in each render-pass, different states in render-data
     ***/
-    for (int i = 1; i < render_vector_size ; i++) {
+    for (int i = start + 1; i < end ; i++) {
         curr = render_data_vector[i];
         if(!(prev->batching() && prev->rendering_order() == curr->rendering_order() && isRenderPassEqual(prev,curr)
-            && !prev->getHashCode().compare(curr->getHashCode())) || !curr->batching()){
+            && prev->render_state() == curr->render_state()) || !curr->batching()){
             batch_indices_.push_back(i);
             prev = curr;
         }
     }
-    batch_indices_.push_back(render_data_vector.size());
-    clearBatchSet();
+    batch_indices_.push_back(end);
     for (int i = 1; i < batch_indices_.size(); i++) {
         createBatch(batch_indices_[i - 1], batch_indices_[i] - 1,render_data_vector);
     }
 }
 void BatchManager::renderBatches(RenderState& rstate) {
-    for (auto it = batch_set_.begin(); it != batch_set_.end(); ++it) {
-        Batch* batch = *it;
+    renderBatches(rstate, 0, batch_set_.size());
+}
+
+/*
+ * Render batches first to end - 1, in the order they were set up.
+ */
+void BatchManager::renderBatches(RenderState& rstate, int first, int end) {
+    for (int i = first; i < end; ++i) {
+        Batch* batch = batch_set_[i];
         rstate.material_override = batch->material(0);
         if(rstate.material_override == nullptr)
             continue;
@@ -117,26 +133,18 @@ void BatchManager::renderBatches(RenderState& rstate) {
         if(!batch->setupMesh(batch->isBatchDirty()))
             continue;
 
-        gRenderer->setRenderStates(renderdata, rstate);
-
-        if(rstate.is_multiview){
-           rstate.uniforms.u_view_[0] = rstate.scene->main_camera_rig()->left_camera()->getViewMatrix();
-           rstate.uniforms.u_view_[1] = rstate.scene->main_camera_rig()->right_camera()->getViewMatrix();
-        }
-
         const std::vector<glm::mat4>& matrices = batch->get_matrices();
 
         for(int passIndex =0; passIndex< renderdata->pass_count(); passIndex++){
-            gRenderer->set_face_culling(renderdata->pass(passIndex)->cull_face());
             rstate.material_override = batch->material(passIndex);
             if(rstate.material_override == nullptr)
                 continue;
 
-            rstate.shader_manager->getTextureShader()->render_batch(matrices,
-                        renderdata, rstate, batch->getIndexCount(),
-                        batch->getNumberOfMeshes());
+            gRenderer->renderBatch(rstate, renderdata, passIndex, matrices,
+                        batch->getIndexCount());
+            gRenderer->incrementDrawCalls();
         }
-        gRenderer->restoreRenderStates(renderdata);
+        gRenderer->incrementBatchUploadBytes(batch->takeUploadBytes());
     }
 }
 
@@ -220,13 +228,22 @@ void BatchManager::getNewBatch(RenderData* rdata, Batch** existing_batch){
 Batch* BatchManager::getNewBatch(){
     if(0 == batch_pool_.size()){
         for(int i=0; i<BATCH_POOL_SIZE; i++){
-            Batch* new_batch = new Batch(max_indices_, max_indices_);
+            Batch* new_batch = new Batch(max_vertices_, max_indices_);
             batch_pool_.push_back(new_batch);
         }
      }
      Batch* batch = batch_pool_.back();
      batch_pool_.pop_back();
+     batch->setLimits(max_vertices_, max_indices_);
      return batch;
 }
 
+void BatchManager::setBudget(int max_vertices, int max_indices){
+    max_vertices_ = max_vertices;
+    max_indices_ = max_indices;
+    for (auto it = batch_set_.begin(); it != batch_set_.end(); ++it) {
+        (*it)->setLimits(max_vertices_, max_indices_);
+    }
+}
+
 }
\ No newline at end of file
@@ -36,14 +36,42 @@ struct RenderState;
 extern bool isRenderPassEqual(RenderData* rdata1, RenderData* rdata2);
 class BatchManager{
 public:
-    BatchManager(int batch_size, int max_indices);
+    // u_matrices of the batching texture shader holds 60 model matrices
+    static const int MAX_BATCH_SIZE = 60;
+    static const int DEFAULT_MAX_VERTICES = 500;
+    static const int DEFAULT_MAX_INDICES = 500;
+
+    BatchManager(int batch_size, int max_vertices, int max_indices);
     ~BatchManager();
+    /*
+     * Vertex and index budget of one batch. Meshes that do not fit into
+     * an empty batch are drawn on their own. Batches already holding
+     * meshes keep them and apply the new budget to the next ones.
+     */
+    void setBudget(int max_vertices, int max_indices);
+    int getMaxVertices() const {
+        return max_vertices_;
+    }
+    int getMaxIndices() const {
+        return max_indices_;
+    }
     Batch* getNewBatch();
     void freeBatch(Batch* batch){
         batch_pool_.push_back(batch);
     }
     void batchSetup(std::vector<RenderData*>& render_data_vector);
+    void addBatches(std::vector<RenderData*>& render_data_vector, int start, int end);
     void renderBatches(RenderState& rstate);
+    void renderBatches(RenderState& rstate, int first, int end);
+    /*
+     * Batches set up since the last batchSetup() or clearBatches().
+     */
+    int getNumberOfBatches() const {
+        return batch_set_.size();
+    }
+    void clearBatches() {
+        clearBatchSet();
+    }
 
 private:
     void clearBatchSet(){
@@ -60,6 +88,7 @@ private:
      */
     std::vector<Batch*> batch_set_;
     std::unordered_map<Batch*, int> batch_map_;
+    int max_vertices_;
     int max_indices_;
     int batch_size_;
 
@@ -0,0 +1,312 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Occlusion culling against a small depth buffer rasterized on the CPU.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "cpu_occlusion_culler.h"
+#include "objects/bounding_volume.h"
+#include "objects/mesh.h"
+#include "objects/scene_object.h"
+#include "objects/components/render_data.h"
+#include "objects/components/transform.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GVR_OCCLUSION_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GVR_OCCLUSION_SSE
+#endif
+
+namespace gvr {
+
+// vertices closer to the eye than this are treated as crossing the near plane
+static const float NEAR_W = 1e-5f;
+
+#if defined(GVR_OCCLUSION_NEON)
+typedef float32x4_t vfloat;
+typedef uint32x4_t vmask;
+
+static inline vfloat vload(const float* p) { return vld1q_f32(p); }
+static inline void vstore(float* p, vfloat a) { vst1q_f32(p, a); }
+static inline vfloat vsplat(float f) { return vdupq_n_f32(f); }
+static inline vfloat vmul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+static inline vfloat vadd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return vminq_f32(a, b); }
+static inline vmask vnonnegative(vfloat a) { return vcgeq_f32(a, vdupq_n_f32(0.0f)); }
+static inline vmask vand(vmask a, vmask b) { return vandq_u32(a, b); }
+static inline vfloat vselect(vmask m, vfloat a, vfloat b) { return vbslq_f32(m, a, b); }
+#elif defined(GVR_OCCLUSION_SSE)
+typedef __m128 vfloat;
+typedef __m128 vmask;
+
+static inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+static inline void vstore(float* p, vfloat a) { _mm_storeu_ps(p, a); }
+static inline vfloat vsplat(float f) { return _mm_set1_ps(f); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+static inline vmask vnonnegative(vfloat a) { return _mm_cmpge_ps(a, _mm_setzero_ps()); }
+static inline vmask vand(vmask a, vmask b) { return _mm_and_ps(a, b); }
+static inline vfloat vselect(vmask m, vfloat a, vfloat b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+#endif
+
+CpuOcclusionCuller::CpuOcclusionCuller() {
+    int offset = 0;
+    for (int l = 0; l < LEVEL_COUNT; ++l) {
+        level_offset_[l] = offset;
+        level_width_[l] = std::max(WIDTH >> l, 1);
+        level_height_[l] = std::max(HEIGHT >> l, 1);
+        offset += level_width_[l] * level_height_[l];
+    }
+    depth_.resize(offset, 1.0f);
+}
+
+void CpuOcclusionCuller::begin(const glm::mat4& vp_matrix) {
+    vp_matrix_ = vp_matrix;
+    std::fill(depth_.begin(), depth_.begin() + WIDTH * HEIGHT, 1.0f);
+}
+
+static glm::vec3 toScreen(const glm::vec4& clip) {
+    float inv_w = 1.0f / clip.w;
+    return glm::vec3((clip.x * inv_w * 0.5f + 0.5f) * CpuOcclusionCuller::WIDTH,
+            (clip.y * inv_w * 0.5f + 0.5f) * CpuOcclusionCuller::HEIGHT, clip.z * inv_w);
+}
+
+static bool insideDepthRange(const glm::vec4& clip) {
+    return (clip.w >= NEAR_W) && (clip.z >= -clip.w) && (clip.z <= clip.w);
+}
+
+void CpuOcclusionCuller::addOccluder(const Mesh& mesh, const glm::mat4& model_matrix) {
+    const std::vector<glm::vec3>& vertices = mesh.vertices();
+    const std::vector<unsigned int>& indices = mesh.indices();
+    glm::mat4 mvp = vp_matrix_ * model_matrix;
+    int vertex_count = vertices.size();
+    // meshes without indices are drawn as plain triangle lists
+    int count = indices.empty() ? vertex_count : indices.size();
+
+    clip_.resize(vertex_count);
+    for (int i = 0; i < vertex_count; ++i) {
+        clip_[i] = mvp * glm::vec4(vertices[i], 1.0f);
+    }
+    for (int i = 0; i + 2 < count; i += 3) {
+        int ia = indices.empty() ? i : indices[i];
+        int ib = indices.empty() ? i + 1 : indices[i + 1];
+        int ic = indices.empty() ? i + 2 : indices[i + 2];
+        if (ia >= vertex_count || ib >= vertex_count || ic >= vertex_count) {
+            continue;
+        }
+        // clipping would only add depth, leaving the triangle out is safe
+        if (!insideDepthRange(clip_[ia]) || !insideDepthRange(clip_[ib])
+                || !insideDepthRange(clip_[ic])) {
+            continue;
+        }
+        rasterizeTriangle(toScreen(clip_[ia]), toScreen(clip_[ib]), toScreen(clip_[ic]));
+    }
+}
+
+/*
+ * Keep the nearest depth of every pixel whose center is inside the
+ * triangle. Rows are walked four pixels at a time on NEON or SSE.
+ */
+void CpuOcclusionCuller::rasterizeTriangle(const glm::vec3& a, const glm::vec3& b_in,
+        const glm::vec3& c_in) {
+    glm::vec3 b = b_in;
+    glm::vec3 c = c_in;
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+
+    if (area < 0.0f) {
+        std::swap(b, c);
+        area = -area;
+    }
+    if (area < 1e-6f) {
+        return;
+    }
+    int x0 = std::max(0, static_cast<int>(std::floor(std::min(a.x, std::min(b.x, c.x)))));
+    int x1 = std::min(WIDTH - 1, static_cast<int>(std::ceil(std::max(a.x, std::max(b.x, c.x)))));
+    int y0 = std::max(0, static_cast<int>(std::floor(std::min(a.y, std::min(b.y, c.y)))));
+    int y1 = std::min(HEIGHT - 1, static_cast<int>(std::ceil(std::max(a.y, std::max(b.y, c.y)))));
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    // edge functions A * x + B * y + C, positive inside; edge i is opposite vertex i
+    const glm::vec3* v[3] = { &a, &b, &c };
+    float ea[3], eb[3], ec[3];
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec3& p = *v[(i + 1) % 3];
+        const glm::vec3& q = *v[(i + 2) % 3];
+        ea[i] = p.y - q.y;
+        eb[i] = q.x - p.x;
+        ec[i] = p.x * q.y - p.y * q.x;
+    }
+    // depth is affine in screen space: z = zx * x + zy * y + z0
+    float inv_area = 1.0f / area;
+    float zx = (a.z * ea[0] + b.z * ea[1] + c.z * ea[2]) * inv_area;
+    float zy = (a.z * eb[0] + b.z * eb[1] + c.z * eb[2]) * inv_area;
+    float z0 = (a.z * ec[0] + b.z * ec[1] + c.z * ec[2]) * inv_area;
+
+#if defined(GVR_OCCLUSION_NEON) || defined(GVR_OCCLUSION_SSE)
+    static const float lane_offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+    vfloat lanes = vload(lane_offsets);
+    vfloat va0 = vsplat(ea[0]), va1 = vsplat(ea[1]), va2 = vsplat(ea[2]);
+    vfloat vzx = vsplat(zx);
+
+    x0 &= ~3;
+    for (int y = y0; y <= y1; ++y) {
+        float py = y + 0.5f;
+        vfloat row0 = vsplat(eb[0] * py + ec[0]);
+        vfloat row1 = vsplat(eb[1] * py + ec[1]);
+        vfloat row2 = vsplat(eb[2] * py + ec[2]);
+        vfloat rowz = vsplat(zy * py + z0);
+        float* row = &depth_[y * WIDTH];
+
+        for (int x = x0; x <= x1; x += 4) {
+            vfloat px = vadd(vsplat(static_cast<float>(x)), lanes);
+            vmask inside = vand(vnonnegative(vadd(vmul(va0, px), row0)),
+                    vand(vnonnegative(vadd(vmul(va1, px), row1)),
+                            vnonnegative(vadd(vmul(va2, px), row2))));
+            vfloat z = vadd(vmul(vzx, px), rowz);
+            vfloat old_z = vload(row + x);
+            vstore(row + x, vselect(inside, vmin(old_z, z), old_z));
+        }
+    }
+#else
+    for (int y = y0; y <= y1; ++y) {
+        float py = y + 0.5f;
+        float* row = &depth_[y * WIDTH];
+
+        for (int x = x0; x <= x1; ++x) {
+            float px = x + 0.5f;
+            if (ea[0] * px + eb[0] * py + ec[0] >= 0.0f
+                    && ea[1] * px + eb[1] * py + ec[1] >= 0.0f
+                    && ea[2] * px + eb[2] * py + ec[2] >= 0.0f) {
+                row[x] = std::min(row[x], zx * px + zy * py + z0);
+            }
+        }
+    }
+#endif
+}
+
+void CpuOcclusionCuller::buildPyramid() {
+    for (int l = 1; l < LEVEL_COUNT; ++l) {
+        const float* src = &depth_[level_offset_[l - 1]];
+        float* dst = &depth_[level_offset_[l]];
+        int src_width = level_width_[l - 1];
+        int src_height = level_height_[l - 1];
+
+        for (int y = 0; y < level_height_[l]; ++y) {
+            int sy0 = 2 * y;
+            int sy1 = std::min(sy0 + 1, src_height - 1);
+            for (int x = 0; x < level_width_[l]; ++x) {
+                int sx0 = 2 * x;
+                int sx1 = std::min(sx0 + 1, src_width - 1);
+                dst[y * level_width_[l] + x] = std::max(
+                        std::max(src[sy0 * src_width + sx0], src[sy0 * src_width + sx1]),
+                        std::max(src[sy1 * src_width + sx0], src[sy1 * src_width + sx1]));
+            }
+        }
+    }
+}
+
+bool CpuOcclusionCuller::isOccluded(const BoundingVolume& box) const {
+    const glm::vec3& lo = box.min_corner();
+    const glm::vec3& hi = box.max_corner();
+    glm::vec3 ndc_min(1.0f);
+    glm::vec3 ndc_max(-1.0f);
+
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec4 clip = vp_matrix_ * glm::vec4((corner & 1) ? hi.x : lo.x,
+                (corner & 2) ? hi.y : lo.y, (corner & 4) ? hi.z : lo.z, 1.0f);
+        if (clip.w < NEAR_W) {
+            return false;
+        }
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndc_min = glm::min(ndc_min, ndc);
+        ndc_max = glm::max(ndc_max, ndc);
+    }
+    // only parts of the box on screen could be tested
+    if (ndc_min.x < -1.0f || ndc_min.y < -1.0f || ndc_max.x > 1.0f || ndc_max.y > 1.0f
+            || ndc_min.z < -1.0f) {
+        return false;
+    }
+
+    int px0 = std::min(static_cast<int>((ndc_min.x * 0.5f + 0.5f) * WIDTH), WIDTH - 1);
+    int px1 = std::min(static_cast<int>((ndc_max.x * 0.5f + 0.5f) * WIDTH), WIDTH - 1);
+    int py0 = std::min(static_cast<int>((ndc_min.y * 0.5f + 0.5f) * HEIGHT), HEIGHT - 1);
+    int py1 = std::min(static_cast<int>((ndc_max.y * 0.5f + 0.5f) * HEIGHT), HEIGHT - 1);
+
+    // the coarsest level the box covers at most 2 x 2 texels of
+    int level = 0;
+    while ((level < LEVEL_COUNT - 1)
+            && (((px1 >> level) - (px0 >> level) > 1) || ((py1 >> level) - (py0 >> level) > 1))) {
+        ++level;
+    }
+
+    const float* texels = &depth_[level_offset_[level]];
+    int width = level_width_[level];
+    int tx1 = std::min(px1 >> level, width - 1);
+    int ty1 = std::min(py1 >> level, level_height_[level] - 1);
+    float farthest = -1.0f;
+    for (int ty = py0 >> level; ty <= ty1; ++ty) {
+        for (int tx = px0 >> level; tx <= tx1; ++tx) {
+            farthest = std::max(farthest, texels[ty * width + tx]);
+        }
+    }
+    return ndc_min.z > farthest;
+}
+
+int CpuOcclusionCuller::cull(const glm::mat4& vp_matrix,
+        const std::vector<SceneObject*>& scene_objects) {
+    bool have_occluders = false;
+
+    begin(vp_matrix);
+    for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
+        RenderData* render_data = (*it)->render_data();
+        Transform* transform = (*it)->transform();
+        if ((render_data != nullptr) && render_data->occluder()
+                && (render_data->mesh() != nullptr) && (transform != nullptr)) {
+            addOccluder(*render_data->mesh(), transform->getModelMatrix());
+            have_occluders = true;
+        }
+    }
+    if (!have_occluders) {
+        return 0;
+    }
+    buildPyramid();
+
+    // occluders stay, they are not tested against themselves
+    int culled = 0;
+    for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
+        SceneObject* object = *it;
+        RenderData* render_data = object->render_data();
+        if ((render_data != nullptr) && !render_data->occluder()
+                && (object->getMeshBoundingVolume().radius() > 0)
+                && isOccluded(object->getMeshBoundingVolume())) {
+            object->setCullStatus(true);
+            ++culled;
+        }
+    }
+    return culled;
+}
+
+}
@@ -0,0 +1,101 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Occlusion culling against a small depth buffer rasterized on the CPU.
+ ***************************************************************************/
+
+#ifndef CPU_OCCLUSION_CULLER_H_
+#define CPU_OCCLUSION_CULLER_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+class BoundingVolume;
+class Mesh;
+class SceneObject;
+
+/*
+ * Rasterizes the meshes of designated occluders into a low resolution
+ * depth buffer, reduces it to a hierarchical-Z pyramid holding the
+ * farthest depth of every texel and tests world space boxes against it.
+ * It does not touch GL, so the result is known in the frame it is
+ * needed, without the latency of occlusion queries.
+ *
+ * Depth is NDC z, 1 being the far plane. The test is conservative
+ * except that a pixel counts as covered when its center is: boxes
+ * crossing the near plane or the edge of the screen are always visible
+ * and occluder triangles crossing the near plane are left out.
+ */
+class CpuOcclusionCuller {
+public:
+    static const int WIDTH = 128;
+    static const int HEIGHT = 64;
+
+    CpuOcclusionCuller();
+
+    /*
+     * Clear the depth buffer for a new view.
+     */
+    void begin(const glm::mat4& vp_matrix);
+
+    /*
+     * Rasterize the triangles of mesh, placed with model_matrix.
+     */
+    void addOccluder(const Mesh& mesh, const glm::mat4& model_matrix);
+
+    /*
+     * Build the pyramid from the depth buffer, after the last occluder.
+     */
+    void buildPyramid();
+
+    /*
+     * True if the box, given in world space, is hidden behind the
+     * occluders.
+     */
+    bool isOccluded(const BoundingVolume& box) const;
+
+    /*
+     * Rasterize the occluders among scene_objects and mark the objects
+     * they hide culled. Everything stays in the list, so what is picked
+     * does not depend on what is occluded. Returns how many objects were
+     * culled.
+     */
+    int cull(const glm::mat4& vp_matrix, const std::vector<SceneObject*>& scene_objects);
+
+    /*
+     * Depth buffer, WIDTH x HEIGHT floats, bottom row first.
+     */
+    const float* depth() const {
+        return &depth_[0];
+    }
+
+private:
+    static const int LEVEL_COUNT = 8;
+
+    void rasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+    glm::mat4 vp_matrix_;
+    std::vector<float> depth_;           // all levels, level 0 first
+    int level_offset_[LEVEL_COUNT];
+    int level_width_[LEVEL_COUNT];
+    int level_height_[LEVEL_COUNT];
+    std::vector<glm::vec4> clip_;        // scratch for the occluder vertices
+};
+
+}
+#endif
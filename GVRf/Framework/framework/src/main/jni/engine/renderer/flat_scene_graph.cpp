@@ -0,0 +1,513 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Flattened, depth-first mirror of the scene graph used for culling.
+ ***************************************************************************/
+
+#include <algorithm>
+
+#include "flat_scene_graph.h"
+#include "frustum_kernel.h"
+
+#include "objects/scene_object.h"
+#include "objects/components/render_data.h"
+#include "objects/components/lod_group.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+// smallest subtree worth handing to another thread
+static const int MIN_TASK_NODES = 64;
+// tasks per thread, so the pool has something left to steal
+static const int TASKS_PER_THREAD = 8;
+
+FlatSceneGraph::FlatSceneGraph() :
+        root_(nullptr), hierarchy_version_(0), topology_valid_(false),
+        use_simd_(frustumKernelHasSimd()), deferred_(false), task_count_(0),
+        task_frustum_(nullptr) {
+}
+
+void FlatSceneGraph::sync(SceneObject* root) {
+    unsigned int version = SceneObject::hierarchyVersion();
+
+    if (!topology_valid_ || (root != root_) || (version != hierarchy_version_)) {
+        // read the version first so a change made during the rebuild
+        // causes another rebuild on the next frame
+        hierarchy_version_ = version;
+        rebuild(root);
+    }
+}
+
+void FlatSceneGraph::snapshot() {
+    int n = objects_.size();
+
+    for (int i = 0; i < n; ++i) {
+        load(i);
+    }
+}
+
+/*
+ * Reload node i when the cull first reaches it, which is after its
+ * parent, so only what is visited is read. A dirty bounding volume also
+ * dirties every ancestor, so refreshing a node brings its whole subtree's
+ * bounds up to date. Deferred culls keep to the snapshot.
+ */
+void FlatSceneGraph::refresh(int i) {
+    if (!deferred_) {
+        load(i);
+    }
+}
+
+/*
+ * Copy flags and bounds of node i from its scene object.
+ */
+void FlatSceneGraph::load(int i) {
+    SceneObject* object = objects_[i];
+    unsigned char flags = flags_[i] & HAS_CHILDREN;
+
+    if (object->enabled()) {
+        flags |= ENABLED;
+    }
+    if (object->visible()) {
+        flags |= VISIBLE;
+    }
+    RenderData* rdata = object->render_data();
+    render_data_[i] = rdata;
+    if (rdata != nullptr) {
+        const RenderPass* pass = rdata->pass(0);
+        if ((pass != nullptr) && (pass->material() != nullptr)) {
+            flags |= HAS_MATERIAL;
+        }
+    }
+
+    // levels can be added and removed without the hierarchy changing
+    LODGroup* lod_group = lod_groups_[i];
+    if ((lod_group != nullptr) && lod_group->enabled()) {
+        flags |= HAS_LOD_GROUP;
+        for (int j = i + 1; j < skips_[i]; j = skips_[j]) {
+            lod_levels_[j] = lod_group->levelOf(objects_[j]);
+        }
+    }
+    flags_[i] = flags;
+
+    const BoundingVolume& hbv = object->getBoundingVolume();
+    hbv_min_x_[i] = hbv.min_corner().x;
+    hbv_min_y_[i] = hbv.min_corner().y;
+    hbv_min_z_[i] = hbv.min_corner().z;
+    hbv_max_x_[i] = hbv.max_corner().x;
+    hbv_max_y_[i] = hbv.max_corner().y;
+    hbv_max_z_[i] = hbv.max_corner().z;
+
+    // only tested for nodes with children, a leaf's mesh bounds are its hbv
+    if (!(flags & HAS_CHILDREN)) {
+        return;
+    }
+    const BoundingVolume& mbv = object->getMeshBoundingVolume();
+    mbv_min_x_[i] = mbv.min_corner().x;
+    mbv_min_y_[i] = mbv.min_corner().y;
+    mbv_min_z_[i] = mbv.min_corner().z;
+    mbv_max_x_[i] = mbv.max_corner().x;
+    mbv_max_y_[i] = mbv.max_corner().y;
+    mbv_max_z_[i] = mbv.max_corner().z;
+}
+
+void FlatSceneGraph::rebuild(SceneObject* root) {
+    root_ = root;
+    objects_.clear();
+    parents_.clear();
+    skips_.clear();
+    flags_.clear();
+    lod_groups_.clear();
+    lod_levels_.clear();
+    if (nullptr != root) {
+        addNode(root, -1);
+    }
+
+    int n = objects_.size();
+    render_data_.resize(n);
+    results_.resize(n);
+    selected_levels_.resize(n);
+    plane_masks_.resize(n);
+    leaf_results_.resize(n);
+    hbv_min_x_.resize(n);
+    hbv_min_y_.resize(n);
+    hbv_min_z_.resize(n);
+    hbv_max_x_.resize(n);
+    hbv_max_y_.resize(n);
+    hbv_max_z_.resize(n);
+    mbv_min_x_.resize(n);
+    mbv_min_y_.resize(n);
+    mbv_min_z_.resize(n);
+    mbv_max_x_.resize(n);
+    mbv_max_y_.resize(n);
+    mbv_max_z_.resize(n);
+    topology_valid_ = true;
+
+    if (DEBUG_RENDERER) {
+        LOGD("FRUSTUM: rebuilt flat scene graph with %d nodes\n", n);
+    }
+}
+
+int FlatSceneGraph::addNode(SceneObject* object, int parent) {
+    int index = objects_.size();
+
+    objects_.push_back(object);
+    parents_.push_back(parent);
+    skips_.push_back(index + 1);
+    flags_.push_back(0);
+    lod_groups_.push_back(static_cast<LODGroup*>(
+            object->getComponent(LODGroup::getComponentType())));
+    lod_levels_.push_back(-1);
+
+    std::vector<SceneObject*> children = object->children();
+    if (children.size() > 0) {
+        flags_[index] = HAS_CHILDREN;
+    }
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        addNode(*it, index);
+    }
+    skips_[index] = objects_.size();
+    return index;
+}
+
+/*
+ * Same as SceneObject::frustumCull but reading the mirrored bounds.
+ */
+int FlatSceneGraph::cullNode(int i, const float frustum[6][4], int& planeMask) const {
+    unsigned char flags = flags_[i];
+
+    if (!(flags & ENABLED) || !(flags & VISIBLE)) {
+        return 0;
+    }
+
+    // 1. Check if the bounding volume intersects with or inside the view frustum
+    int checkResult = checkAABBVsFrustum(frustum,
+            hbv_min_x_[i], hbv_min_y_[i], hbv_min_z_[i],
+            hbv_max_x_[i], hbv_max_y_[i], hbv_max_z_[i], planeMask);
+
+    if (checkResult == FRUSTUM_OUTSIDE) {
+        return 0;
+    }
+    if (checkResult == FRUSTUM_INSIDE) {
+        return 3;
+    }
+
+    // 2. Skip the empty objects with no render data
+    if (!(flags & HAS_MATERIAL)) {
+        return 1;
+    }
+
+    // 3. Check if the object itself is intersecting with or inside the frustum
+    if (flags & HAS_CHILDREN) {
+        int tempMask = planeMask;
+        checkResult = checkAABBVsFrustum(frustum,
+                mbv_min_x_[i], mbv_min_y_[i], mbv_min_z_[i],
+                mbv_max_x_[i], mbv_max_y_[i], mbv_max_z_[i], tempMask);
+    }
+    return checkResult == FRUSTUM_OUTSIDE ? 1 : 2;
+}
+
+/*
+ * Pick the level of the LOD group of node i from the bounding sphere
+ * of its subtree.
+ */
+void FlatSceneGraph::selectLevel(int i, const glm::vec3& camera_position) {
+    float distance;
+    float screen_size;
+
+    if (screen_.active() && screen_.measure(camera_position,
+            glm::vec3(hbv_min_x_[i], hbv_min_y_[i], hbv_min_z_[i]),
+            glm::vec3(hbv_max_x_[i], hbv_max_y_[i], hbv_max_z_[i]),
+            distance, screen_size)) {
+        if (deferred_) {
+            selected_levels_[i] = lod_groups_[i]->choose(distance, screen_size);
+            results_[i] |= LEVEL_SELECTED;
+        } else {
+            lod_groups_[i]->select(distance, screen_size);
+        }
+    }
+}
+
+/*
+ * Whether node i is a LOD level its group did not select or is too
+ * small on screen. Either way its whole subtree goes.
+ */
+bool FlatSceneGraph::dropped(int i, const glm::vec3& camera_position) const {
+    int p = parents_[i];
+
+    if ((p >= 0) && (flags_[p] & HAS_LOD_GROUP) && (lod_levels_[i] >= 0)) {
+        int selected = (deferred_ && (results_[p] & LEVEL_SELECTED)) ?
+                selected_levels_[p] : lod_groups_[p]->selected();
+        if (lod_levels_[i] != selected) {
+            return true;
+        }
+    }
+    return screen_.tooSmall(camera_position,
+            glm::vec3(hbv_min_x_[i], hbv_min_y_[i], hbv_min_z_[i]),
+            glm::vec3(hbv_max_x_[i], hbv_max_y_[i], hbv_max_z_[i]));
+}
+
+/*
+ * Allows for on demand calculation of the camera distance; usually matters
+ * when transparent objects are in play.
+ */
+void FlatSceneGraph::bindCameraDistance(int i, const glm::vec3& camera_position) {
+    RenderData* renderData = render_data_[i];
+    if (nullptr == renderData) {
+        return;
+    }
+    if (deferred_) {
+        results_[i] |= DISTANCE_BOUND;
+    } else {
+        renderData->setCameraPosition(camera_position);
+    }
+}
+
+void FlatSceneGraph::setCullStatus(int i, bool cull) {
+    if (deferred_) {
+        results_[i] |= cull ? CULLED : ACCEPTED;
+    } else {
+        objects_[i]->setCullStatus(cull);
+    }
+}
+
+void FlatSceneGraph::accept(int i, std::vector<SceneObject*>& scene_objects) {
+    setCullStatus(i, false);
+    scene_objects.push_back(objects_[i]);
+}
+
+/*
+ * Accept every enabled node of the subtree rooted at i without testing it.
+ */
+void FlatSceneGraph::acceptSubtree(int i, const glm::vec3& camera_position,
+        std::vector<SceneObject*>& scene_objects) {
+    int end = skips_[i];
+
+    accept(i, scene_objects);
+    for (int j = i + 1; j < end;) {
+        refresh(j);
+        if (!(flags_[j] & ENABLED)) {
+            j = skips_[j];
+            continue;
+        }
+        if (dropped(j, camera_position)) {
+            setCullStatus(j, true);
+            j = skips_[j];
+            continue;
+        }
+        bindCameraDistance(j, camera_position);
+        if (flags_[j] & HAS_LOD_GROUP) {
+            selectLevel(j, camera_position);
+        }
+        accept(j, scene_objects);
+        ++j;
+    }
+}
+
+void FlatSceneGraph::cull(glm::vec3 camera_position, const float frustum[6][4],
+        std::vector<SceneObject*>& scene_objects, bool need_cull,
+        const ScreenSpaceCull& screen) {
+    int n = objects_.size();
+
+    screen_ = screen;
+    if (deferred_) {
+        std::fill(results_.begin(), results_.end(), 0);
+    }
+    if (!need_cull) {
+        if (n > 0) {
+            refresh(0);
+        }
+        if ((n > 0) && (flags_[0] & ENABLED)) {
+            bindCameraDistance(0, camera_position);
+            if (flags_[0] & HAS_LOD_GROUP) {
+                selectLevel(0, camera_position);
+            }
+            acceptSubtree(0, camera_position, scene_objects);
+        }
+        return;
+    }
+    if ((pool_ == nullptr) || (n < 2 * MIN_TASK_NODES)) {
+        cullRange(0, n, camera_position, frustum, scene_objects, 0);
+        return;
+    }
+
+    // Cull the top of the tree here and hand every small enough subtree
+    // to the pool. Each task remembers where its output goes so the merged
+    // list is in the same order as a serial cull.
+    int grain = std::max(MIN_TASK_NODES, n / (pool_->threadCount() * TASKS_PER_THREAD));
+    task_count_ = 0;
+    serial_objects_.clear();
+    cullRange(0, n, camera_position, frustum, serial_objects_, grain);
+
+    // the task only captures this so the std::function does not allocate
+    task_camera_position_ = camera_position;
+    task_frustum_ = frustum;
+    pool_->run(task_count_, [this](int t, int worker) {
+        CullTask& task = tasks_[t];
+        cullRange(task.node, skips_[task.node], task_camera_position_,
+                task_frustum_, task.objects, 0);
+    });
+
+    int next = 0;
+    for (int t = 0; t < task_count_; ++t) {
+        CullTask& task = tasks_[t];
+        scene_objects.insert(scene_objects.end(),
+                serial_objects_.begin() + next,
+                serial_objects_.begin() + task.insert_at);
+        scene_objects.insert(scene_objects.end(),
+                task.objects.begin(), task.objects.end());
+        next = task.insert_at;
+    }
+    scene_objects.insert(scene_objects.end(),
+            serial_objects_.begin() + next, serial_objects_.end());
+}
+
+/*
+ * Cull the nodes in [begin, end), which must be a sequence of whole
+ * subtrees. With a non-zero grain, subtrees with children and at most
+ * grain nodes are queued as tasks instead of being culled.
+ */
+void FlatSceneGraph::cullRange(int begin, int end, const glm::vec3& camera_position,
+        const float frustum[6][4], std::vector<SceneObject*>& scene_objects,
+        int grain) {
+    for (int i = begin; i < end;) {
+        if (!(flags_[i] & HAS_CHILDREN)) {
+            i = cullLeaves(i, camera_position, frustum, scene_objects);
+            continue;
+        }
+        if ((grain > 0) && (skips_[i] - i <= grain)) {
+            if (task_count_ == static_cast<int>(tasks_.size())) {
+                tasks_.push_back(CullTask());
+            }
+            CullTask& task = tasks_[task_count_++];
+            task.node = i;
+            task.insert_at = scene_objects.size();
+            task.objects.clear();
+            i = skips_[i];
+            continue;
+        }
+        refresh(i);
+        if (!(flags_[i] & ENABLED)) {
+            i = skips_[i];
+            continue;
+        }
+        if (dropped(i, camera_position)) {
+            setCullStatus(i, true);
+            i = skips_[i];
+            continue;
+        }
+        bindCameraDistance(i, camera_position);
+        if (flags_[i] & HAS_LOD_GROUP) {
+            selectLevel(i, camera_position);
+        }
+
+        // children continue with the plane mask left by their parent
+        int p = parents_[i];
+        int planeMask = (p < 0) ? 0 : plane_masks_[p];
+        int cullVal = cullNode(i, frustum, planeMask);
+        plane_masks_[i] = planeMask;
+
+        switch (cullVal) {
+        case 0:
+            setCullStatus(i, true);
+            i = skips_[i];
+            break;
+
+        case 1:
+            ++i;
+            break;
+
+        case 2:
+            accept(i, scene_objects);
+            ++i;
+            break;
+
+        default:
+            acceptSubtree(i, camera_position, scene_objects);
+            i = skips_[i];
+            break;
+        }
+    }
+}
+
+void FlatSceneGraph::set_cull_threads(int thread_count) {
+    int current = (pool_ == nullptr) ? 1 : pool_->threadCount();
+
+    if (thread_count == current) {
+        return;
+    }
+    if (thread_count > 1) {
+        pool_.reset(new WorkStealingPool(thread_count));
+    } else {
+        pool_.reset();
+    }
+}
+
+/*
+ * Cull the run of leaves starting at first that share its parent with a
+ * single kernel call. Leaves are only tested with their hierarchical
+ * bounding volume, so the result is what cullNode would return. Returns
+ * the index following the run.
+ */
+int FlatSceneGraph::cullLeaves(int first, const glm::vec3& camera_position,
+        const float frustum[6][4], std::vector<SceneObject*>& scene_objects) {
+    int n = objects_.size();
+    int p = parents_[first];
+    int parentMask = (p < 0) ? 0 : plane_masks_[p];
+    int end = first;
+
+    while ((end < n) && (parents_[end] == p) && !(flags_[end] & HAS_CHILDREN)) {
+        refresh(end);
+        plane_masks_[end] = parentMask;
+        ++end;
+    }
+
+    checkAABBsVsFrustum(frustum, end - first,
+            &hbv_min_x_[first], &hbv_min_y_[first], &hbv_min_z_[first],
+            &hbv_max_x_[first], &hbv_max_y_[first], &hbv_max_z_[first],
+            &plane_masks_[first], &leaf_results_[first], use_simd_);
+
+    for (int i = first; i < end; ++i) {
+        unsigned char flags = flags_[i];
+        int result = leaf_results_[i];
+
+        if (!(flags & ENABLED)) {
+            continue;
+        }
+        if (DEBUG_RENDERER && use_simd_) {
+            int mask = parentMask;
+            int expected = checkAABBVsFrustum(frustum,
+                    hbv_min_x_[i], hbv_min_y_[i], hbv_min_z_[i],
+                    hbv_max_x_[i], hbv_max_y_[i], hbv_max_z_[i], mask);
+            if ((expected != result) || (mask != plane_masks_[i])) {
+                LOGE("FRUSTUM: kernel mismatch for %s: %d/%x expected %d/%x\n",
+                        objects_[i]->name().c_str(), result, plane_masks_[i],
+                        expected, mask);
+            }
+        }
+
+        bindCameraDistance(i, camera_position);
+        if (!(flags & VISIBLE) || (result == FRUSTUM_OUTSIDE)
+                || dropped(i, camera_position)) {
+            setCullStatus(i, true);
+        } else if ((result == FRUSTUM_INSIDE) || (flags & HAS_MATERIAL)) {
+            accept(i, scene_objects);
+        }
+    }
+    return end;
+}
+
+}
@@ -0,0 +1,234 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Flattened, depth-first mirror of the scene graph used for culling.
+ ***************************************************************************/
+
+#ifndef FLAT_SCENE_GRAPH_H_
+#define FLAT_SCENE_GRAPH_H_
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+#include "work_stealing_pool.h"
+#include "screen_space_cull.h"
+
+namespace gvr {
+class SceneObject;
+class RenderData;
+class LODGroup;
+
+/*
+ * Structure-of-arrays copy of the scene hierarchy in depth-first order.
+ *
+ * Node i owns the index range [i, skip(i)) which holds itself and all of
+ * its descendants, so a whole subtree can be culled by jumping to skip(i)
+ * instead of recursing. The topology is only rebuilt when the scene graph
+ * changes shape; bounds and flags of a node are refreshed when the cull
+ * reaches it, so subtrees rejected as a whole are not read at all.
+ *
+ * Children of a LOD group that are not its selected level are culled
+ * with their subtree, as are subtrees too small on screen.
+ *
+ * A deferred cull can run off the GL thread. It reads nothing of the scene
+ * but what snapshot() copied, and instead of setting the cull status of
+ * objects, the camera position of render data and the level of LOD groups
+ * it records them per node for the GL thread to apply.
+ */
+class FlatSceneGraph {
+public:
+    enum NodeFlags {
+        ENABLED = 0x1,          // SceneObject::enabled()
+        VISIBLE = 0x2,          // SceneObject::visible()
+        HAS_MATERIAL = 0x4,     // render data with a material on pass 0
+        HAS_CHILDREN = 0x8,
+        HAS_LOD_GROUP = 0x10    // enabled LOD group component
+    };
+
+    enum CullResults {
+        CULLED = 0x1,           // SceneObject::setCullStatus(true)
+        ACCEPTED = 0x2,         // SceneObject::setCullStatus(false)
+        DISTANCE_BOUND = 0x4,   // RenderData::setCameraPosition
+        LEVEL_SELECTED = 0x8    // LODGroup::set_selected(selectedLevel(i))
+    };
+
+    FlatSceneGraph();
+
+    /*
+     * Rebuild the topology if the hierarchy below root changed since the
+     * last call.
+     */
+    void sync(SceneObject* root);
+
+    /*
+     * Copy flags and bounds of every node from the scene, which a
+     * deferred cull needs done after sync().
+     */
+    void snapshot();
+
+    /*
+     * Cull the mirrored hierarchy against the frustum planes built by
+     * Renderer::build_frustum. Visible objects are appended to
+     * scene_objects in the same order the recursive traversal produces.
+     * Per object the result matches SceneObject::frustumCull.
+     *
+     * LOD levels are selected only when screen is active, that is when
+     * culling for a camera; otherwise the groups keep their last level.
+     */
+    void cull(glm::vec3 camera_position, const float frustum[6][4],
+            std::vector<SceneObject*>& scene_objects, bool need_cull,
+            const ScreenSpaceCull& screen = ScreenSpaceCull());
+
+    /*
+     * Test runs of sibling leaves with the vector kernel instead of
+     * one by one. Results are the same either way.
+     */
+    void set_simd_culling(bool flag) {
+        use_simd_ = flag;
+    }
+
+    bool get_simd_culling() const {
+        return use_simd_;
+    }
+
+    void set_deferred(bool flag) {
+        deferred_ = flag;
+    }
+
+    bool get_deferred() const {
+        return deferred_;
+    }
+
+    /*
+     * Number of threads, the calling one included, to cull with.
+     * Values of 1 or less cull serially on the calling thread.
+     */
+    void set_cull_threads(int thread_count);
+
+    int get_cull_threads() const {
+        return (pool_ == nullptr) ? 1 : pool_->threadCount();
+    }
+
+    int size() const {
+        return objects_.size();
+    }
+
+    SceneObject* object(int i) const {
+        return objects_[i];
+    }
+
+    int parent(int i) const {
+        return parents_[i];
+    }
+
+    int skip(int i) const {
+        return skips_[i];
+    }
+
+    /*
+     * NodeFlags of node i as of the last cull that reached it.
+     */
+    unsigned char flags(int i) const {
+        return flags_[i];
+    }
+
+    RenderData* render_data(int i) const {
+        return render_data_[i];
+    }
+
+    LODGroup* lod_group(int i) const {
+        return lod_groups_[i];
+    }
+
+    /*
+     * CullResults of node i recorded by the last deferred cull, and the
+     * level it selected for the node's LOD group.
+     */
+    unsigned char results(int i) const {
+        return results_[i];
+    }
+
+    int selectedLevel(int i) const {
+        return selected_levels_[i];
+    }
+
+private:
+    FlatSceneGraph(const FlatSceneGraph&);
+    FlatSceneGraph& operator=(const FlatSceneGraph&);
+
+    struct CullTask {
+        int node;       // root of the subtree to cull
+        int insert_at;  // position in the serial output its objects go to
+        std::vector<SceneObject*> objects;
+    };
+
+    void rebuild(SceneObject* root);
+    void load(int i);
+    void refresh(int i);
+    void setCullStatus(int i, bool cull);
+    void cullRange(int begin, int end, const glm::vec3& camera_position,
+            const float frustum[6][4], std::vector<SceneObject*>& scene_objects,
+            int grain);
+    int addNode(SceneObject* object, int parent);
+    void accept(int i, std::vector<SceneObject*>& scene_objects);
+    void acceptSubtree(int i, const glm::vec3& camera_position,
+            std::vector<SceneObject*>& scene_objects);
+    void bindCameraDistance(int i, const glm::vec3& camera_position);
+    int cullNode(int i, const float frustum[6][4], int& planeMask) const;
+    void selectLevel(int i, const glm::vec3& camera_position);
+    bool dropped(int i, const glm::vec3& camera_position) const;
+    int cullLeaves(int first, const glm::vec3& camera_position,
+            const float frustum[6][4], std::vector<SceneObject*>& scene_objects);
+
+    SceneObject* root_;
+    unsigned int hierarchy_version_;
+    bool topology_valid_;
+    bool use_simd_;
+    bool deferred_;
+
+    std::vector<SceneObject*> objects_;
+    std::vector<int> parents_;
+    std::vector<int> skips_;
+    std::vector<unsigned char> flags_;
+    std::vector<int> plane_masks_;
+    std::vector<unsigned char> leaf_results_;
+    std::vector<RenderData*> render_data_;
+    std::vector<LODGroup*> lod_groups_;
+    std::vector<int> lod_levels_;       // level of the parent's LOD group, -1 if none
+    std::vector<unsigned char> results_;
+    std::vector<int> selected_levels_;
+    ScreenSpaceCull screen_;
+
+    // hierarchical bounding volume of the subtree
+    std::vector<float> hbv_min_x_, hbv_min_y_, hbv_min_z_;
+    std::vector<float> hbv_max_x_, hbv_max_y_, hbv_max_z_;
+    // bounding volume of the object's own mesh, kept for nodes with children
+    std::vector<float> mbv_min_x_, mbv_min_y_, mbv_min_z_;
+    std::vector<float> mbv_max_x_, mbv_max_y_, mbv_max_z_;
+
+    // parallel culling, tasks are reused across frames
+    std::unique_ptr<WorkStealingPool> pool_;
+    std::vector<CullTask> tasks_;
+    int task_count_;
+    glm::vec3 task_camera_position_;
+    const float (*task_frustum_)[4];
+    std::vector<SceneObject*> serial_objects_;
+};
+
+}
+#endif
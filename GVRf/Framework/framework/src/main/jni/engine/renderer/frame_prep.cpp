@@ -0,0 +1,235 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Culling and sorting of the next frame on a thread of its own.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "frame_prep.h"
+#include "objects/components/lod_group.h"
+#include "objects/components/render_data.h"
+#include "objects/scene.h"
+#include "objects/scene_object.h"
+#include "util/gvr_time.h"
+
+namespace gvr {
+
+/*
+ * Same test as Renderer::addRenderData.
+ */
+static bool isDrawable(RenderData* render_data) {
+    return (render_data != nullptr) && (render_data->material(0) != nullptr)
+            && render_data->enabled() && (render_data->mesh() != nullptr)
+            && (render_data->render_mask() != 0);
+}
+
+FramePrep::FramePrep() :
+        camera_position_(0.0f), frustum_culling_(true), hierarchy_version_(0),
+        sorted_(true), back_(0), front_(-1), cull_time_(0), sort_time_(0),
+        snapshot_time_(0), wait_time_(0), has_result_(false), requested_(0),
+        completed_(0), quit_(false) {
+    memset(frustum_, 0, sizeof(frustum_));
+    graph_.set_deferred(true);
+    thread_ = std::thread(&FramePrep::threadMain, this);
+}
+
+FramePrep::~FramePrep() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+void FramePrep::begin(Scene* scene, const glm::vec3& camera_position,
+        const float frustum[6][4], bool frustum_culling,
+        const ScreenSpaceCull& screen) {
+    long long start = getNanoTime();
+
+    finish();
+    hierarchy_version_ = SceneObject::hierarchyVersion();
+    graph_.sync(scene->getRoot());
+    graph_.snapshot();
+
+    // The render state of an object is computed when first asked for.
+    // Do it here so the prep thread only ever reads it.
+    int n = graph_.size();
+    drawable_.resize(n);
+    centers_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        RenderData* render_data = graph_.render_data(i);
+        drawable_[i] = isDrawable(render_data);
+        if (drawable_[i]) {
+            render_data->render_state();
+            centers_[i] = graph_.object(i)->getBoundingVolume().center();
+        }
+    }
+    camera_position_ = camera_position;
+    memcpy(frustum_, frustum, sizeof(frustum_));
+    frustum_culling_ = frustum_culling;
+    screen_ = screen;
+    has_result_ = true;
+    wait_time_ = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        requested_.fetch_add(1, std::memory_order_release);
+    }
+    wake_.notify_one();
+    snapshot_time_ = getNanoTime() - start;
+}
+
+void FramePrep::finish() {
+    unsigned int requested = requested_.load(std::memory_order_relaxed);
+
+    if (completed_.load(std::memory_order_acquire) == requested) {
+        return;
+    }
+    long long start = getNanoTime();
+    while (completed_.load(std::memory_order_acquire) != requested) {
+        std::this_thread::yield();
+    }
+    wait_time_ += getNanoTime() - start;
+}
+
+bool FramePrep::ready() const {
+    return has_result_ && (completed_.load(std::memory_order_acquire)
+            == requested_.load(std::memory_order_relaxed))
+            && (hierarchy_version_ == SceneObject::hierarchyVersion());
+}
+
+void FramePrep::swap(std::vector<SceneObject*>& scene_objects,
+        std::vector<RenderData*>& render_data) {
+    scene_objects.swap(scene_objects_);
+    render_data.swap(render_data_);
+    has_result_ = false;
+    front_ = back_;
+    back_ = 1 - back_;
+    apply(results_[front_]);
+
+    // the comparator reads the camera distances apply() just bound
+    if (!sorted_) {
+        std::sort(render_data.begin(), render_data.end(),
+                compareRenderDataByOrderShaderDistance);
+    }
+}
+
+void FramePrep::reapply() {
+    if ((front_ >= 0)
+            && (results_[front_].hierarchy_version == SceneObject::hierarchyVersion())) {
+        apply(results_[front_]);
+    }
+}
+
+void FramePrep::apply(const Results& results) {
+    for (auto it = results.culled.begin(); it != results.culled.end(); ++it) {
+        (*it)->setCullStatus(true);
+    }
+    for (auto it = results.accepted.begin(); it != results.accepted.end(); ++it) {
+        (*it)->setCullStatus(false);
+    }
+    for (auto it = results.distance_bound.begin(); it != results.distance_bound.end(); ++it) {
+        (*it)->setCameraPosition(results.camera_position);
+    }
+    for (auto it = results.levels.begin(); it != results.levels.end(); ++it) {
+        it->lod_group->set_selected(it->level);
+    }
+}
+
+void FramePrep::discard() {
+    finish();
+    has_result_ = false;
+    front_ = -1;
+}
+
+void FramePrep::threadMain() {
+    unsigned int seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            wake_.wait(lock, [this, seen]() {
+                return quit_ || (requested_.load(std::memory_order_acquire) != seen);
+            });
+            if (quit_) {
+                return;
+            }
+            seen = requested_.load(std::memory_order_acquire);
+        }
+        prepare();
+        completed_.store(seen, std::memory_order_release);
+    }
+}
+
+/*
+ * Cull and sort the snapshot. Nodes come out of the cull in index order,
+ * so collecting the recorded results by index keeps the order of the
+ * visible objects.
+ */
+void FramePrep::prepare() {
+    long long start = getNanoTime();
+    Results& results = results_[back_];
+
+    scene_objects_.clear();
+    render_data_.clear();
+    distances_.clear();
+    results.accepted.clear();
+    results.culled.clear();
+    results.distance_bound.clear();
+    results.levels.clear();
+    results.camera_position = camera_position_;
+    results.hierarchy_version = hierarchy_version_;
+    graph_.cull(camera_position_, frustum_, scene_objects_, frustum_culling_, screen_);
+
+    int n = graph_.size();
+    for (int i = 0; i < n; ++i) {
+        unsigned char flags = graph_.results(i);
+
+        if (flags & FlatSceneGraph::CULLED) {
+            results.culled.push_back(graph_.object(i));
+        }
+        if (flags & FlatSceneGraph::DISTANCE_BOUND) {
+            results.distance_bound.push_back(graph_.render_data(i));
+        }
+        if (flags & FlatSceneGraph::LEVEL_SELECTED) {
+            LevelSelection selection = { graph_.lod_group(i), graph_.selectedLevel(i) };
+            results.levels.push_back(selection);
+        }
+        if (!(flags & FlatSceneGraph::ACCEPTED)) {
+            continue;
+        }
+        results.accepted.push_back(graph_.object(i));
+        if (drawable_[i]) {
+            // same as RenderData::camera_distance, from the snapshot
+            glm::vec3 difference = centers_[i] - camera_position_;
+            render_data_.push_back(graph_.render_data(i));
+            distances_.push_back(glm::dot(difference, difference));
+        }
+    }
+    long long culled = getNanoTime();
+    cull_time_ = culled - start;
+
+    // the comparator would ask the render data for their distance,
+    // which is left to swap() on the GL thread
+    sorted_ = render_sorter_.sort(render_data_, distances_);
+    sort_time_ = getNanoTime() - culled;
+}
+
+}
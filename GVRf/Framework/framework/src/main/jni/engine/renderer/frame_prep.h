@@ -0,0 +1,184 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Culling and sorting of the next frame on a thread of its own.
+ ***************************************************************************/
+
+#ifndef FRAME_PREP_H_
+#define FRAME_PREP_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "flat_scene_graph.h"
+#include "render_sorter.h"
+
+namespace gvr {
+class LODGroup;
+class RenderData;
+class Scene;
+class SceneObject;
+
+/*
+ * Prepares the render data of the next frame while the GL thread submits
+ * the current one.
+ *
+ * begin() runs on the GL thread. It mirrors the scene into a flat scene
+ * graph owned by the preparer and snapshots what depends on transforms,
+ * the world bounds and bounding centers, so the application can keep
+ * moving objects while the prep thread culls and sorts from the snapshot
+ * into its own buffers. swap() exchanges those buffers with the
+ * renderer's, so each side keeps reusing two sets of vectors and neither
+ * allocates in steady state.
+ *
+ * The handoff is a pair of frame counters: the GL thread bumps requested_
+ * and the prep thread bumps completed_ once it is done with the buffers.
+ * Whoever the counters say owns the buffers is the only one touching
+ * them, and finish() spins on completed_ rather than taking a lock.
+ *
+ * The thread does not write to the scene. The cull status of scene
+ * objects, the camera position of render data and the levels LOD groups
+ * select go to a back buffer, which swap() makes the front one and
+ * applies on the GL thread, so the statuses batches read are always
+ * those of the frame being drawn. The thread still reads the materials
+ * and render state of render data for sorting; begin() computes the
+ * render state so that reading it is all the thread does.
+ */
+class FramePrep {
+public:
+    FramePrep();
+    ~FramePrep();
+
+    /*
+     * GL thread: snapshot the scene and start preparing it as seen from
+     * camera_position through frustum.
+     */
+    void begin(Scene* scene, const glm::vec3& camera_position, const float frustum[6][4],
+            bool frustum_culling, const ScreenSpaceCull& screen);
+
+    /*
+     * GL thread: wait for the preparation started by begin(), if any.
+     */
+    void finish();
+
+    /*
+     * Whether a finished preparation is waiting for swap() and the scene
+     * hierarchy has not changed since its snapshot was taken.
+     */
+    bool ready() const;
+
+    /*
+     * GL thread, after finish(): exchange the prepared visible objects
+     * and sorted render data with the given vectors.
+     */
+    void swap(std::vector<SceneObject*>& scene_objects, std::vector<RenderData*>& render_data);
+
+    /*
+     * GL thread: apply the results of the last swap() again, after some
+     * other cull, like the one for shadow casters, overwrote them.
+     */
+    void reapply();
+
+    /*
+     * Drop a preparation nobody is going to draw.
+     */
+    void discard();
+
+    /*
+     * Time the prep thread spent culling and sorting the last snapshot,
+     * in nanoseconds.
+     */
+    long long cullTime() const {
+        return cull_time_;
+    }
+    long long sortTime() const {
+        return sort_time_;
+    }
+
+    /*
+     * Time the GL thread spent taking the last snapshot and waiting for
+     * it to be prepared, in nanoseconds.
+     */
+    long long snapshotTime() const {
+        return snapshot_time_;
+    }
+    long long waitTime() const {
+        return wait_time_;
+    }
+
+private:
+    FramePrep(const FramePrep&);
+    FramePrep& operator=(const FramePrep&);
+
+    struct LevelSelection {
+        LODGroup* lod_group;
+        int level;
+    };
+
+    // what the cull of a snapshot changes in the scene
+    struct Results {
+        std::vector<SceneObject*> accepted;
+        std::vector<SceneObject*> culled;
+        std::vector<RenderData*> distance_bound;
+        std::vector<LevelSelection> levels;
+        glm::vec3 camera_position;
+        unsigned int hierarchy_version;
+    };
+
+    void threadMain();
+    void prepare();
+    void apply(const Results& results);
+
+    // snapshot, written by begin() and read by the prep thread
+    FlatSceneGraph graph_;
+    glm::vec3 camera_position_;
+    float frustum_[6][4];
+    bool frustum_culling_;
+    ScreenSpaceCull screen_;
+    unsigned int hierarchy_version_;
+    std::vector<unsigned char> drawable_;
+    std::vector<glm::vec3> centers_;
+
+    // results, written by the prep thread and taken by swap()
+    std::vector<SceneObject*> scene_objects_;
+    std::vector<RenderData*> render_data_;
+    std::vector<float> distances_;
+    RenderSorter render_sorter_;
+    bool sorted_;
+    Results results_[2];
+    int back_;          // results_ the prep thread writes
+    int front_;         // results_ applied by the last swap(), -1 if none
+    long long cull_time_;
+    long long sort_time_;
+
+    long long snapshot_time_;
+    long long wait_time_;
+    bool has_result_;
+
+    std::thread thread_;
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::atomic<unsigned int> requested_;
+    std::atomic<unsigned int> completed_;
+    bool quit_;
+};
+
+}
+#endif
@@ -0,0 +1,233 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * AABB vs. view frustum tests, one box at a time or several per call.
+ ***************************************************************************/
+
+#include "frustum_kernel.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GVR_FRUSTUM_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GVR_FRUSTUM_SSE
+#endif
+
+namespace gvr {
+
+int checkAABBVsFrustum(const float frustum[6][4],
+        float Xmin, float Ymin, float Zmin,
+        float Xmax, float Ymax, float Zmax, int& planeMask) {
+    bool isCompleteInside = true;
+
+    for (int p = 0; p < 6; p++) {
+        if ((planeMask >> p) & 1) {
+            continue;
+        }
+        const float* plane = frustum[p];
+        float xa = plane[0] * Xmin, xb = plane[0] * Xmax;
+        float ya = plane[1] * Ymin, yb = plane[1] * Ymax;
+        float za = plane[2] * Zmin, zb = plane[2] * Zmax;
+        float d = plane[3];
+        int count = 0;
+
+        // summed in the same order as the scalar test to get identical rounding
+        count += (xa + ya + za + d > 0);
+        count += (xb + ya + za + d > 0);
+        count += (xa + yb + za + d > 0);
+        count += (xb + yb + za + d > 0);
+        count += (xa + ya + zb + d > 0);
+        count += (xb + ya + zb + d > 0);
+        count += (xa + yb + zb + d > 0);
+        count += (xb + yb + zb + d > 0);
+
+        // All vertices are completely outside the frustum plane
+        if (count == 0) {
+            return FRUSTUM_OUTSIDE;
+        }
+        if (count < 8) {
+            isCompleteInside = false;
+        } else {
+            planeMask |= (1 << p);
+        }
+    }
+    return isCompleteInside ? FRUSTUM_INSIDE : FRUSTUM_INTERSECT;
+}
+
+#if defined(GVR_FRUSTUM_NEON) || defined(GVR_FRUSTUM_SSE)
+
+#if defined(GVR_FRUSTUM_NEON)
+typedef float32x4_t vfloat;
+
+static inline vfloat vload(const float* p) { return vld1q_f32(p); }
+static inline vfloat vsplat(float f) { return vdupq_n_f32(f); }
+static inline vfloat vmul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+static inline vfloat vadd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b) { return vmaxq_f32(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return vminq_f32(a, b); }
+
+/*
+ * Bit n of the result is set if lane n is greater than zero.
+ */
+static inline int vpositive(vfloat a) {
+    static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vandq_u32(vcgtq_f32(a, vdupq_n_f32(0.0f)),
+            vld1q_u32(lane_bits));
+    uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    sum = vpadd_u32(sum, sum);
+    return vget_lane_u32(sum, 0);
+}
+#else
+typedef __m128 vfloat;
+
+static inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+static inline vfloat vsplat(float f) { return _mm_set1_ps(f); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+
+static inline int vpositive(vfloat a) {
+    return _mm_movemask_ps(_mm_cmpgt_ps(a, _mm_setzero_ps()));
+}
+#endif
+
+static const int ALL_LANES = (1 << FRUSTUM_KERNEL_WIDTH) - 1;
+
+/*
+ * Test FRUSTUM_KERNEL_WIDTH boxes. The eight corner sums are built exactly
+ * like the scalar test does, so a lane's largest sum is positive iff at
+ * least one corner is in front of the plane and its smallest sum is
+ * positive iff all of them are.
+ */
+static void checkGroup(const float frustum[6][4],
+        const float* Xmin, const float* Ymin, const float* Zmin,
+        const float* Xmax, const float* Ymax, const float* Zmax,
+        int* plane_masks, unsigned char* results) {
+    vfloat xmin = vload(Xmin), xmax = vload(Xmax);
+    vfloat ymin = vload(Ymin), ymax = vload(Ymax);
+    vfloat zmin = vload(Zmin), zmax = vload(Zmax);
+    int masks[FRUSTUM_KERNEL_WIDTH];
+    int shared = ~0;
+    int outside = 0;    // lanes completely outside some plane
+    int straddle = 0;   // lanes crossing some plane
+
+    for (int l = 0; l < FRUSTUM_KERNEL_WIDTH; ++l) {
+        masks[l] = plane_masks[l];
+        shared &= masks[l];
+    }
+
+    for (int p = 0; p < 6; p++) {
+        // siblings usually arrive with the same mask from their parent
+        if ((shared >> p) & 1) {
+            continue;
+        }
+        int active = 0;
+        for (int l = 0; l < FRUSTUM_KERNEL_WIDTH; ++l) {
+            if (!((masks[l] >> p) & 1)) {
+                active |= 1 << l;
+            }
+        }
+        active &= ~outside;
+        if (active == 0) {
+            continue;
+        }
+
+        const float* plane = frustum[p];
+        vfloat a = vsplat(plane[0]), b = vsplat(plane[1]);
+        vfloat c = vsplat(plane[2]), d = vsplat(plane[3]);
+        vfloat xa = vmul(a, xmin), xb = vmul(a, xmax);
+        vfloat ya = vmul(b, ymin), yb = vmul(b, ymax);
+        vfloat za = vmul(c, zmin), zb = vmul(c, zmax);
+        vfloat xaya = vadd(xa, ya), xbya = vadd(xb, ya);
+        vfloat xayb = vadd(xa, yb), xbyb = vadd(xb, yb);
+
+        vfloat s0 = vadd(vadd(xaya, za), d);
+        vfloat s1 = vadd(vadd(xbya, za), d);
+        vfloat s2 = vadd(vadd(xayb, za), d);
+        vfloat s3 = vadd(vadd(xbyb, za), d);
+        vfloat s4 = vadd(vadd(xaya, zb), d);
+        vfloat s5 = vadd(vadd(xbya, zb), d);
+        vfloat s6 = vadd(vadd(xayb, zb), d);
+        vfloat s7 = vadd(vadd(xbyb, zb), d);
+
+        vfloat hi = vmax(vmax(vmax(s0, s1), vmax(s2, s3)),
+                vmax(vmax(s4, s5), vmax(s6, s7)));
+        vfloat lo = vmin(vmin(vmin(s0, s1), vmin(s2, s3)),
+                vmin(vmin(s4, s5), vmin(s6, s7)));
+        int any_in = vpositive(hi);
+        int all_in = vpositive(lo);
+
+        outside |= active & ~any_in;
+        straddle |= active & any_in & ~all_in;
+        int inside = active & all_in;
+        for (int l = 0; l < FRUSTUM_KERNEL_WIDTH; ++l) {
+            if ((inside >> l) & 1) {
+                masks[l] |= 1 << p;
+            }
+        }
+        if (outside == ALL_LANES) {
+            break;
+        }
+    }
+
+    for (int l = 0; l < FRUSTUM_KERNEL_WIDTH; ++l) {
+        plane_masks[l] = masks[l];
+        if ((outside >> l) & 1) {
+            results[l] = FRUSTUM_OUTSIDE;
+        } else if ((straddle >> l) & 1) {
+            results[l] = FRUSTUM_INTERSECT;
+        } else {
+            results[l] = FRUSTUM_INSIDE;
+        }
+    }
+}
+
+bool frustumKernelHasSimd() {
+    return true;
+}
+
+#else
+
+bool frustumKernelHasSimd() {
+    return false;
+}
+
+#endif
+
+void checkAABBsVsFrustum(const float frustum[6][4], int count,
+        const float* xmin, const float* ymin, const float* zmin,
+        const float* xmax, const float* ymax, const float* zmax,
+        int* plane_masks, unsigned char* results, bool use_simd) {
+    int i = 0;
+
+#if defined(GVR_FRUSTUM_NEON) || defined(GVR_FRUSTUM_SSE)
+    if (use_simd) {
+        for (; i + FRUSTUM_KERNEL_WIDTH <= count; i += FRUSTUM_KERNEL_WIDTH) {
+            checkGroup(frustum, xmin + i, ymin + i, zmin + i,
+                    xmax + i, ymax + i, zmax + i,
+                    plane_masks + i, results + i);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        results[i] = checkAABBVsFrustum(frustum, xmin[i], ymin[i], zmin[i],
+                xmax[i], ymax[i], zmax[i], plane_masks[i]);
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * AABB vs. view frustum tests, one box at a time or several per call.
+ ***************************************************************************/
+
+#ifndef FRUSTUM_KERNEL_H_
+#define FRUSTUM_KERNEL_H_
+
+namespace gvr {
+
+/*
+ * Same values as the AABB_STATE enum used by SceneObject::frustumCull.
+ */
+enum FrustumTestResult {
+    FRUSTUM_OUTSIDE = 0, FRUSTUM_INTERSECT = 1, FRUSTUM_INSIDE = 2
+};
+
+/*
+ * Number of boxes the vector kernel tests per iteration.
+ */
+static const int FRUSTUM_KERNEL_WIDTH = 4;
+
+/*
+ * Test one AABB against the frustum planes built by Renderer::build_frustum.
+ * Planes set in planeMask are skipped and planes the box is completely
+ * inside of are added to it. This is the scalar reference for the batch
+ * kernel and gives the same results as SceneObject::checkAABBVsFrustumOpt.
+ */
+int checkAABBVsFrustum(const float frustum[6][4],
+        float xmin, float ymin, float zmin,
+        float xmax, float ymax, float zmax, int& planeMask);
+
+/*
+ * Test count AABBs, given as separate arrays of corner coordinates, against
+ * the frustum. plane_masks holds the incoming plane mask of every box and
+ * receives the updated one; results receives a FrustumTestResult per box.
+ *
+ * With use_simd the boxes are tested FRUSTUM_KERNEL_WIDTH at a time using
+ * NEON or SSE, whichever the target has; planes already in the mask of
+ * every box in a group are not evaluated at all. Results and masks are
+ * identical to calling checkAABBVsFrustum on each box.
+ */
+void checkAABBsVsFrustum(const float frustum[6][4], int count,
+        const float* xmin, const float* ymin, const float* zmin,
+        const float* xmax, const float* ymax, const float* zmax,
+        int* plane_masks, unsigned char* results, bool use_simd);
+
+/*
+ * True if checkAABBsVsFrustum has a vector implementation on this target.
+ */
+bool frustumKernelHasSimd();
+
+}
+#endif
@@ -0,0 +1,187 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Replays recorded render commands with GL.
+ ***************************************************************************/
+
+#include "gl_command_backend.h"
+#include "gl_renderer.h"
+#include "objects/scene.h"
+#include "shaders/shader_manager.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+/*
+ * Put the uniform blocks and instance matrices into the uniform ring and
+ * upload them. Their offsets go after those of the lists being replayed
+ * already, an external renderer may replay a list of its own.
+ */
+void GLCommandBackend::stage(const RenderCommandList& commands, int base) {
+    GLUniformRing& ring = renderer_.uniform_ring_;
+    int count = commands.size();
+
+    offsets_.resize(base + count, -1);
+    for (int i = base; i < base + count; ++i) {
+        const RenderCommand& command = commands[i - base];
+        if (command.type == RenderCommand::UNIFORM_BLOCK) {
+            offsets_[i] = ring.append(commands.blockData(command.block.first),
+                    command.block.size);
+            if (offsets_[i] < 0) {
+                LOGE("Rendering error: no room for a uniform block of %d bytes",
+                        command.block.size);
+            }
+        } else if ((command.type == RenderCommand::DRAW)
+                && (command.draw.instance_location >= 0)) {
+            offsets_[i] = ring.append(commands.matrices(command.draw.first_matrix),
+                    command.draw.instances * sizeof(glm::mat4));
+            if (offsets_[i] < 0) {
+                LOGE("Rendering error: no room for %d instance matrices",
+                        command.draw.instances);
+            }
+        }
+    }
+    ring.flush();
+}
+
+void GLCommandBackend::replay(RenderState& rstate, const RenderCommandList& commands) {
+    GLuint program = 0;
+    int count = commands.size();
+    int base = offsets_.size();
+
+    stage(commands, base);
+
+    for (int i = 0; i < count; ++i) {
+        const RenderCommand& command = commands[i];
+        switch (command.type) {
+        case RenderCommand::BIND_PROGRAM:
+            program = command.program;
+            renderer_.gl_state_.useProgram(program);
+            break;
+
+        case RenderCommand::SET_STATE:
+            renderer_.applyStateBlock(commands.state(command.state.block),
+                    command.state.stencil_only);
+            renderer_.set_face_culling(command.state.cull_face);
+            break;
+
+        case RenderCommand::LINE_WIDTH:
+            glLineWidth(command.line_width);
+            break;
+
+        case RenderCommand::UNIFORM:
+            uniform(commands, command.uniform);
+            break;
+
+        case RenderCommand::BIND_TEXTURE:
+            glActiveTexture(GL_TEXTURE0 + command.texture.unit);
+            glBindTexture(command.texture.target, command.texture.id);
+            break;
+
+        case RenderCommand::UNIFORM_BLOCK:
+            if (offsets_[base + i] >= 0) {
+                glBindBufferRange(GL_UNIFORM_BUFFER, command.block.binding,
+                        renderer_.uniform_ring_.buffer(), offsets_[base + i], command.block.size);
+            }
+            break;
+
+        case RenderCommand::LIGHT_BLOCK:
+            renderer_.light_blocks_.bind(command.light_block, rstate.scene->getLightList());
+            break;
+
+        case RenderCommand::DRAW:
+            draw(command.draw, offsets_[base + i], program);
+            break;
+
+        case RenderCommand::EXTERNAL:
+            rstate.shader_manager->getExternalRendererShader()->drawExternal(&rstate,
+                    command.external.render_data, commands.matrices(command.external.mvp)[0]);
+            program = 0;
+            break;
+
+        default:
+            break;
+        }
+    }
+    offsets_.resize(base);
+    if (base == 0) {
+        renderer_.uniform_ring_.fence();
+    }
+}
+
+void GLCommandBackend::uniform(const RenderCommandList& commands,
+        const RenderCommand::UniformArgs& uniform) {
+    const float* values = commands.floats(uniform.first);
+
+    switch (uniform.type) {
+    case RenderCommand::INT:
+        glUniform1iv(uniform.location, uniform.count, commands.ints(uniform.first));
+        break;
+    case RenderCommand::FLOAT:
+        glUniform1fv(uniform.location, uniform.count, values);
+        break;
+    case RenderCommand::VEC2:
+        glUniform2fv(uniform.location, uniform.count, values);
+        break;
+    case RenderCommand::VEC3:
+        glUniform3fv(uniform.location, uniform.count, values);
+        break;
+    case RenderCommand::VEC4:
+        glUniform4fv(uniform.location, uniform.count, values);
+        break;
+    case RenderCommand::MAT4:
+        glUniformMatrix4fv(uniform.location, uniform.count, GL_FALSE, values);
+        break;
+    default:
+        break;
+    }
+}
+
+void GLCommandBackend::draw(const RenderCommand::DrawArgs& draw, int matrix_offset,
+        GLuint program) {
+    if (program == 0) {
+        return;
+    }
+    int instances = 1;
+
+    if (draw.skinned) {
+        draw.mesh->generateBoneArrayBuffers(program);
+    }
+    glBindVertexArray(draw.mesh->getVAOId(program));
+    if (draw.instance_location >= 0) {
+        if (matrix_offset < 0) {
+            glBindVertexArray(0);
+            return;
+        }
+        renderer_.bindInstanceMatrices(matrix_offset, draw.instance_location);
+        instances = draw.instances;
+    }
+    if (draw.index_type != 0) {
+        if (instances > 1) {
+            glDrawElementsInstanced(draw.mode, draw.count, draw.index_type, 0, instances);
+        } else {
+            glDrawElements(draw.mode, draw.count, draw.index_type, 0);
+        }
+    } else if (instances > 1) {
+        glDrawArraysInstanced(draw.mode, 0, draw.count, instances);
+    } else {
+        glDrawArrays(draw.mode, 0, draw.count);
+    }
+    glBindVertexArray(0);
+    checkGLError("GLCommandBackend::draw");
+}
+
+}
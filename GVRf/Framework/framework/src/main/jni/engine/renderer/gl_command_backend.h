@@ -0,0 +1,59 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Replays recorded render commands with GL.
+ ***************************************************************************/
+
+#ifndef GL_COMMAND_BACKEND_H_
+#define GL_COMMAND_BACKEND_H_
+
+#include <vector>
+
+#include "GLES3/gl3.h"
+
+#include "render_commands.h"
+
+namespace gvr {
+class GLRenderer;
+
+/*
+ * Issues the GL calls of a command list through the state cache, uniform
+ * ring and draw commands of the renderer that owns it. Runs on the GL
+ * thread. The uniform blocks and instance matrices of the list are put
+ * into the ring and uploaded together before the first draw.
+ */
+class GLCommandBackend: public RenderCommandBackend {
+public:
+    explicit GLCommandBackend(GLRenderer& renderer) :
+            renderer_(renderer) {
+    }
+
+    void replay(RenderState& rstate, const RenderCommandList& commands);
+
+private:
+    GLCommandBackend(const GLCommandBackend&);
+    GLCommandBackend& operator=(const GLCommandBackend&);
+
+    void stage(const RenderCommandList& commands, int base);
+    void uniform(const RenderCommandList& commands, const RenderCommand::UniformArgs& uniform);
+    void draw(const RenderCommand::DrawArgs& draw, int matrix_offset, GLuint program);
+
+    GLRenderer& renderer_;
+    std::vector<int> offsets_;  // in the uniform ring, per command
+};
+
+}
+#endif
@@ -0,0 +1,169 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Uniform buffers holding the parameters of all the lights in a scene.
+ ***************************************************************************/
+
+#include <cstring>
+
+#include "gl_light_blocks.h"
+#include "gl_uniform_ring.h"
+#include "objects/light.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+static const int MAX_NAME_LENGTH = 128;
+
+GLLightBlocks::GLLightBlocks() :
+        serial_(1), bound_(-1) {
+}
+
+GLLightBlocks::~GLLightBlocks() {
+    for (auto it = layouts_.begin(); it != layouts_.end(); ++it) {
+        glDeleteBuffers(1, &it->buffer);
+    }
+}
+
+bool GLLightBlocks::sameLayout(const Layout& a, const Layout& b) {
+    if ((a.size != b.size) || (a.members.size() != b.members.size())) {
+        return false;
+    }
+    for (int i = 0; i < static_cast<int>(a.members.size()); ++i) {
+        const Member& ma = a.members[i];
+        const Member& mb = b.members[i];
+        if ((ma.offset != mb.offset) || (ma.type != mb.type) || (ma.key != mb.key)
+                || (ma.light_id != mb.light_id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int GLLightBlocks::init(GLuint program) {
+    GLuint block = glGetUniformBlockIndex(program, "Lights_ubo");
+    if (block == GL_INVALID_INDEX) {
+        return -1;
+    }
+
+    Layout layout;
+    GLint count = 0;
+    GLint size = 0;
+    glGetActiveUniformBlockiv(program, block, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+    glGetActiveUniformBlockiv(program, block, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &count);
+    std::vector<GLint> indices(count);
+    if (count > 0) {
+        glGetActiveUniformBlockiv(program, block, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES,
+                &indices[0]);
+    }
+    layout.size = size;
+    layout.buffer = 0;
+    layout.serial = 0;
+
+    // members are named <light id>.<uniform key>
+    for (int i = 0; i < count; ++i) {
+        GLuint index = indices[i];
+        char name[MAX_NAME_LENGTH];
+        GLsizei length = 0;
+        GLint array_size = 0;
+        GLint offset = -1;
+        Member member;
+
+        glGetActiveUniform(program, index, sizeof(name), &length, &array_size,
+                &member.type, name);
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+        const char* dot = strchr(name, '.');
+        if ((dot == nullptr) || (offset < 0)) {
+            LOGW("Lights_ubo of program %d: ignoring %s", program, name);
+            continue;
+        }
+        if ((array_size != 1) || !Light::isUniformType(member.type)) {
+            LOGE("Lights_ubo of program %d: lights cannot supply %s, type 0x%x[%d]",
+                    program, name, member.type, array_size);
+            continue;
+        }
+        member.light_id.assign(name, dot - name);
+        member.key = dot + 1;
+        member.offset = offset;
+        layout.members.push_back(member);
+    }
+    glUniformBlockBinding(program, block, LIGHT_UBO_BINDING);
+
+    for (int i = 0; i < static_cast<int>(layouts_.size()); ++i) {
+        if (sameLayout(layouts_[i], layout)) {
+            return i;
+        }
+    }
+    glGenBuffers(1, &layout.buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, layout.buffer);
+    glBufferData(GL_UNIFORM_BUFFER, layout.size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    layouts_.push_back(layout);
+    bound_ = -1;
+    return layouts_.size() - 1;
+}
+
+void GLLightBlocks::update(const std::vector<Light*>& lights) {
+    bool changed = versions_.size() != lights.size();
+
+    versions_.resize(lights.size());
+    for (int i = 0; i < static_cast<int>(lights.size()); ++i) {
+        Light* light = lights[i];
+        unsigned int version = (light != nullptr) ? light->version() : 0;
+        if ((versions_[i].first != light) || (versions_[i].second != version)) {
+            versions_[i] = std::make_pair(light, version);
+            changed = true;
+        }
+    }
+    if (changed) {
+        ++serial_;
+    }
+    bound_ = -1;
+}
+
+void GLLightBlocks::bind(int index, const std::vector<Light*>& lights) {
+    if ((index < 0) || (index >= static_cast<int>(layouts_.size()))) {
+        return;
+    }
+    Layout& layout = layouts_[index];
+    if ((layout.serial != serial_) && (layout.size > 0)) {
+        write(layout, lights);
+        glBindBuffer(GL_UNIFORM_BUFFER, layout.buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, layout.size, &data_[0]);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        layout.serial = serial_;
+    }
+    if (bound_ != index) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_UBO_BINDING, layout.buffer);
+        bound_ = index;
+    }
+}
+
+void GLLightBlocks::write(const Layout& layout, const std::vector<Light*>& lights) {
+    data_.assign(layout.size, 0);
+
+    for (auto it = layout.members.begin(); it != layout.members.end(); ++it) {
+        for (auto l = lights.begin(); l != lights.end(); ++l) {
+            Light* light = *l;
+            if ((light != nullptr) && (light->getLightID() == it->light_id)) {
+                light->writeUniform(it->key, it->type, &data_[it->offset]);
+                break;
+            }
+        }
+    }
+}
+
+}
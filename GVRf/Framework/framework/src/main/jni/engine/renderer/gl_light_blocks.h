@@ -0,0 +1,99 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Uniform buffers holding the parameters of all the lights in a scene.
+ ***************************************************************************/
+
+#ifndef GL_LIGHT_BLOCKS_H_
+#define GL_LIGHT_BLOCKS_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gl/gl_headers.h"
+
+namespace gvr {
+class Light;
+
+/*
+ * Lit shaders generated for GLSL 300 declare every light of the scene
+ * as a member of one block:
+ *
+ *     layout (std140) uniform Lights_ubo {
+ *         UniformGVRDirectLight light0;
+ *         UniformGVRSpotLight light1;
+ *     };
+ *
+ * The layout of a program's block is read once, when it is linked, and
+ * programs declaring the same block share one buffer. update() notices
+ * when any light changed; the buffer of a layout is then rewritten the
+ * next time a program using it is bound, so unchanged lights cost one
+ * buffer bind per pass instead of a uniform upload per light and draw.
+ */
+class GLLightBlocks {
+public:
+    GLLightBlocks();
+    ~GLLightBlocks();
+
+    /*
+     * Read the Lights_ubo block of program and assign its binding point.
+     * Returns the index of its layout, or -1 if the program has no block.
+     */
+    int init(GLuint program);
+
+    /*
+     * Once per pass, before drawing: check the lights for changes and
+     * forget which buffer is bound.
+     */
+    void update(const std::vector<Light*>& lights);
+
+    /*
+     * Bind the buffer of layout to LIGHT_UBO_BINDING, writing the current
+     * values of lights into it first if they changed since.
+     */
+    void bind(int layout, const std::vector<Light*>& lights);
+
+private:
+    GLLightBlocks(const GLLightBlocks&);
+    GLLightBlocks& operator=(const GLLightBlocks&);
+
+    struct Member {
+        std::string light_id;
+        std::string key;
+        GLenum type;
+        int offset;
+    };
+
+    struct Layout {
+        int size;
+        std::vector<Member> members;
+        GLuint buffer;
+        unsigned int serial;    // of the light values in buffer
+    };
+
+    static bool sameLayout(const Layout& a, const Layout& b);
+    void write(const Layout& layout, const std::vector<Light*>& lights);
+
+    std::vector<Layout> layouts_;
+    std::vector<std::pair<Light*, unsigned int> > versions_;
+    std::vector<char> data_;
+    unsigned int serial_;   // bumped whenever a light changes
+    int bound_;
+};
+
+}
+#endif
@@ -0,0 +1,288 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Occlusion queries recycled across frames.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "gl_occlusion_queries.h"
+#include "gl_state_cache.h"
+#include "glm/gtc/type_ptr.hpp"
+#include "objects/bounding_volume.h"
+#include "objects/scene_object.h"
+#include "shaders/material/bounding_box_shader.h"
+
+namespace gvr {
+
+// corners of the unit cube and its twelve triangles, facing out
+static const GLfloat CUBE_VERTICES[] = {
+        0, 0, 0,   1, 0, 0,   1, 1, 0,   0, 1, 0,
+        0, 0, 1,   1, 0, 1,   1, 1, 1,   0, 1, 1
+};
+
+static const GLubyte CUBE_INDICES[] = {
+        0, 2, 1,   0, 3, 2,     // -z
+        4, 5, 6,   4, 6, 7,     // +z
+        0, 1, 5,   0, 5, 4,     // -y
+        3, 6, 2,   3, 7, 6,     // +y
+        0, 4, 7,   0, 7, 3,     // -x
+        1, 2, 6,   1, 6, 5      // +x
+};
+
+GLOcclusionQueries::GLOcclusionQueries() :
+        frame_(0), queries_issued_(0), stalls_(0), latency_(0), shader_(nullptr),
+        proxy_vao_(0) {
+    proxy_buffers_[0] = proxy_buffers_[1] = 0;
+}
+
+GLOcclusionQueries::~GLOcclusionQueries() {
+    for (auto it = queries_.begin(); it != queries_.end(); ++it) {
+        glDeleteQueries(1, &it->id);
+    }
+    if (proxy_vao_ != 0) {
+        glDeleteVertexArrays(1, &proxy_vao_);
+        glDeleteBuffers(2, proxy_buffers_);
+    }
+}
+
+void GLOcclusionQueries::beginFrame() {
+    ++frame_;
+
+    // schedules of a frame that was never rendered
+    for (auto it = scheduled_.begin(); it != scheduled_.end(); ++it) {
+        entries_[*it].scheduled = false;
+    }
+    scheduled_.clear();
+
+    int results = 0;
+    int total_age = 0;
+    int kept = 0;
+    stalls_ = 0;
+    for (auto it = in_flight_.begin(); it != in_flight_.end(); ++it) {
+        Query& query = queries_[*it];
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            ++stalls_;
+            in_flight_[kept++] = *it;
+            continue;
+        }
+        GLuint passed = GL_FALSE;
+        glGetQueryObjectuiv(query.id, GL_QUERY_RESULT, &passed);
+
+        bool group = query.members.size() > 1;
+        for (auto m = query.members.begin(); m != query.members.end(); ++m) {
+            auto found = entries_.find(*m);
+            if (found == entries_.end()) {
+                continue;
+            }
+            Entry& entry = found->second;
+            entry.pending = false;
+            entry.last_tested = query.frame;
+            if (!group) {
+                entry.visible = (passed != GL_FALSE);
+                entry.split = false;
+            } else if (passed) {
+                // some of them may show, find out which ones next frame
+                entry.split = true;
+            } else {
+                entry.visible = false;
+                entry.split = false;
+            }
+        }
+        total_age += frame_ - query.frame;
+        ++results;
+        free_.push_back(*it);
+    }
+    in_flight_.resize(kept);
+    latency_ = (results > 0) ? static_cast<float>(total_age) / results : 0.0f;
+
+    if (frame_ % FORGET_FRAMES == 0) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (frame_ - it->second.last_seen > FORGET_FRAMES) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool GLOcclusionQueries::visible(SceneObject* object) {
+    auto it = entries_.find(object);
+    if (it == entries_.end()) {
+        // spread the retests of objects showing up together over frames
+        int stagger = (reinterpret_cast<uintptr_t>(object) >> 4) % VISIBLE_RETEST_FRAMES;
+        Entry entry = { frame_, frame_ - stagger, true, false, false, false };
+        it = entries_.insert(std::make_pair(object, entry)).first;
+    }
+    Entry& entry = it->second;
+    entry.last_seen = frame_;
+    if (!entry.pending && !entry.scheduled
+            && (!entry.visible || frame_ - entry.last_tested >= VISIBLE_RETEST_FRAMES)) {
+        entry.scheduled = true;
+        scheduled_.push_back(object);
+    }
+    return entry.visible;
+}
+
+int GLOcclusionQueries::acquireQuery() {
+    if (free_.empty()) {
+        GLuint ids[POOL_GROWTH];
+        glGenQueries(POOL_GROWTH, ids);
+        for (int i = 0; i < POOL_GROWTH; ++i) {
+            Query query;
+            query.id = ids[i];
+            query.frame = 0;
+            free_.push_back(queries_.size());
+            queries_.push_back(query);
+        }
+    }
+    int index = free_.back();
+    free_.pop_back();
+    return index;
+}
+
+void GLOcclusionQueries::createProxy() {
+    glGenVertexArrays(1, &proxy_vao_);
+    glGenBuffers(2, proxy_buffers_);
+    glBindVertexArray(proxy_vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, proxy_buffers_[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
+    glVertexAttribPointer(shader_->positionLocation(), 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(shader_->positionLocation());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, proxy_buffers_[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(CUBE_INDICES), CUBE_INDICES, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLOcclusionQueries::drawBox(const glm::mat4& vp_matrix, const glm::vec3& min_corner,
+        const glm::vec3& max_corner) {
+    glm::mat4 box_matrix;
+    glm::vec3 size(max_corner - min_corner);
+    box_matrix[0][0] = size.x;
+    box_matrix[1][1] = size.y;
+    box_matrix[2][2] = size.z;
+    box_matrix[3] = glm::vec4(min_corner, 1.0f);
+    glm::mat4 mvp_matrix(vp_matrix * box_matrix);
+    glUniformMatrix4fv(shader_->mvpLocation(), 1, GL_FALSE, glm::value_ptr(mvp_matrix));
+    glDrawElements(GL_TRIANGLES, sizeof(CUBE_INDICES), GL_UNSIGNED_BYTE, 0);
+}
+
+/*
+ * Test the box of box_owner for all members: its own mesh for a single
+ * object, its whole subtree for a group of siblings.
+ */
+void GLOcclusionQueries::issueQuery(const glm::mat4& vp_matrix,
+        const glm::vec3& camera_position, float margin, SceneObject* box_owner,
+        SceneObject* const* members, int count) {
+    const BoundingVolume& mesh_volume = box_owner->getMeshBoundingVolume();
+    const BoundingVolume& volume = ((count == 1) && (mesh_volume.radius() > 0)) ?
+            mesh_volume : box_owner->getBoundingVolume();
+
+    // the near plane would clip the box away with the camera inside it
+    glm::vec3 min_corner(volume.min_corner() - glm::vec3(margin));
+    glm::vec3 max_corner(volume.max_corner() + glm::vec3(margin));
+    if (glm::all(glm::greaterThanEqual(camera_position, min_corner))
+            && glm::all(glm::lessThanEqual(camera_position, max_corner))) {
+        for (int i = 0; i < count; ++i) {
+            Entry& entry = entries_[members[i]];
+            entry.visible = true;
+            entry.split = false;
+            entry.last_tested = frame_;
+        }
+        return;
+    }
+
+    int index = acquireQuery();
+    Query& query = queries_[index];
+    query.frame = frame_;
+    query.members.assign(members, members + count);
+    glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, query.id);
+    drawBox(vp_matrix, volume.min_corner(), volume.max_corner());
+    glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+    in_flight_.push_back(index);
+    for (int i = 0; i < count; ++i) {
+        entries_[members[i]].pending = true;
+    }
+    ++queries_issued_;
+}
+
+void GLOcclusionQueries::issue(GLStateCache& gl_state, BoundingBoxShader* shader,
+        const glm::mat4& view_matrix, const glm::mat4& projection_matrix) {
+    queries_issued_ = 0;
+    if (scheduled_.empty()) {
+        return;
+    }
+    if (proxy_vao_ == 0) {
+        shader_ = shader;
+        createProxy();
+    }
+    glm::mat4 vp_matrix(projection_matrix * view_matrix);
+    glm::vec3 camera_position(glm::inverse(view_matrix)[3]);
+    float margin = 0.0f;
+    if (projection_matrix[2][3] != 0.0f) {
+        // twice the near plane distance of a perspective projection
+        margin = 2.0f * projection_matrix[3][2] / (projection_matrix[2][2] - 1.0f);
+    }
+
+    gl_state.enable(GL_DEPTH_TEST, true);
+    gl_state.depthFunc(GL_LEQUAL);
+    gl_state.depthMask(false);
+    gl_state.colorMask(false);
+    gl_state.enable(GL_CULL_FACE, false);
+    gl_state.enable(GL_BLEND, false);
+    gl_state.useProgram(shader_->programId());
+    glBindVertexArray(proxy_vao_);
+
+    // hidden siblings share one query for their parent's subtree
+    auto grouped_end = std::partition(scheduled_.begin(), scheduled_.end(),
+            [this](SceneObject* object) {
+                const Entry& entry = entries_[object];
+                return !entry.visible && !entry.split && (object->parent() != nullptr);
+            });
+    std::sort(scheduled_.begin(), grouped_end,
+            [](SceneObject* a, SceneObject* b) {
+                return a->parent() < b->parent();
+            });
+    int grouped = grouped_end - scheduled_.begin();
+    for (int i = 0; i < grouped;) {
+        SceneObject* parent = scheduled_[i]->parent();
+        int end = i + 1;
+        while ((end < grouped) && (scheduled_[end]->parent() == parent)) {
+            ++end;
+        }
+        if (end - i > 1) {
+            issueQuery(vp_matrix, camera_position, margin, parent, &scheduled_[i], end - i);
+        } else {
+            issueQuery(vp_matrix, camera_position, margin, scheduled_[i], &scheduled_[i], 1);
+        }
+        i = end;
+    }
+    for (int i = grouped; i < static_cast<int>(scheduled_.size()); ++i) {
+        issueQuery(vp_matrix, camera_position, margin, scheduled_[i], &scheduled_[i], 1);
+    }
+    glBindVertexArray(0);
+
+    for (auto it = scheduled_.begin(); it != scheduled_.end(); ++it) {
+        entries_[*it].scheduled = false;
+    }
+    scheduled_.clear();
+}
+
+}
@@ -0,0 +1,141 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Occlusion queries recycled across frames.
+ ***************************************************************************/
+
+#ifndef GL_OCCLUSION_QUERIES_H_
+#define GL_OCCLUSION_QUERIES_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "gl/gl_headers.h"
+#include "glm/glm.hpp"
+
+namespace gvr {
+class BoundingBoxShader;
+class GLStateCache;
+class SceneObject;
+
+/*
+ * Temporally coherent GPU occlusion culling.
+ *
+ * Objects keep the visibility of their last test until a newer result
+ * arrives, so nobody waits for the GPU. Hidden objects are tested again
+ * every frame and visible ones only every VISIBLE_RETEST_FRAMES frames,
+ * staggered so they do not all come due together. Hidden siblings are
+ * tested together against the hierarchical bounding volume of their
+ * parent; only when that turns out visible are they tested one by one.
+ *
+ * Queries come from a pool that grows as needed and is never freed
+ * before the renderer, and every test draws the same unit cube scaled
+ * to the world space box.
+ */
+class GLOcclusionQueries {
+public:
+    static const int VISIBLE_RETEST_FRAMES = 8;
+
+    GLOcclusionQueries();
+    ~GLOcclusionQueries();
+
+    /*
+     * Collect the results that arrived since the last frame, before the
+     * first call to visible().
+     */
+    void beginFrame();
+
+    /*
+     * Visibility of the object according to its latest result. Also
+     * schedules a test for issue() when one is due.
+     */
+    bool visible(SceneObject* object);
+
+    /*
+     * Test the scheduled objects against the depth buffer of the pass
+     * just rendered with the given view.
+     */
+    void issue(GLStateCache& gl_state, BoundingBoxShader* shader,
+            const glm::mat4& view_matrix, const glm::mat4& projection_matrix);
+
+    /*
+     * Queries issued by the last issue().
+     */
+    int queriesIssued() const {
+        return queries_issued_;
+    }
+
+    /*
+     * Queries still pending at the last beginFrame(). The renderer used
+     * the previous visibility for them instead of waiting.
+     */
+    int stalls() const {
+        return stalls_;
+    }
+
+    /*
+     * Average age in frames of the results collected by the last
+     * beginFrame().
+     */
+    float latency() const {
+        return latency_;
+    }
+
+private:
+    GLOcclusionQueries(const GLOcclusionQueries&);
+    GLOcclusionQueries& operator=(const GLOcclusionQueries&);
+
+    static const int POOL_GROWTH = 32;
+    static const int FORGET_FRAMES = 120;
+
+    struct Entry {
+        int last_seen;
+        int last_tested;
+        bool visible;
+        bool scheduled;
+        bool pending;
+        bool split;     // the last group test of its siblings was visible
+    };
+
+    struct Query {
+        GLuint id;
+        int frame;
+        std::vector<const SceneObject*> members;
+    };
+
+    int acquireQuery();
+    void createProxy();
+    void drawBox(const glm::mat4& vp_matrix, const glm::vec3& min_corner,
+            const glm::vec3& max_corner);
+    void issueQuery(const glm::mat4& vp_matrix, const glm::vec3& camera_position,
+            float margin, SceneObject* box_owner, SceneObject* const* members, int count);
+
+    int frame_;
+    int queries_issued_;
+    int stalls_;
+    float latency_;
+    std::unordered_map<const SceneObject*, Entry> entries_;
+    std::vector<Query> queries_;
+    std::vector<int> free_;
+    std::vector<int> in_flight_;
+    std::vector<SceneObject*> scheduled_;
+    BoundingBoxShader* shader_;
+    GLuint proxy_vao_;
+    GLuint proxy_buffers_[2];
+};
+
+}
+#endif
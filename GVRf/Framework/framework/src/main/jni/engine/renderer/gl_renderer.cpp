@@ -22,6 +22,7 @@
 
 #include "objects/post_effect_data.h"
 #include "objects/scene.h"
+#include "objects/components/shadow_map.h"
 #include "objects/textures/render_texture.h"
 #include "shaders/shader_manager.h"
 #include "shaders/post_effect_shader_manager.h"
@@ -30,7 +31,7 @@
 namespace gvr
 {
 
-    void GLRenderer::clearBuffers(const Camera &camera) const
+    void GLRenderer::clearBuffers(const Camera &camera)
     {
         GLbitfield mask = GL_DEPTH_BUFFER_BIT;
 
@@ -43,10 +44,73 @@ namespace gvr
         if (useStencilBuffer_)
         {
             mask |= GL_STENCIL_BUFFER_BIT;
-            glStencilMask(~0);
+            gl_state_.stencilMask(~0);
         }
         glClear(mask);
     }
+
+    void GLRenderer::beginRenderStates(RenderState& rstate)
+    {
+        ShaderUniformsPerObject& uniforms = rstate.uniforms;
+        ViewBlock view;
+
+        if (rstate.is_multiview && !rstate.shadow_map)
+        {
+            const CameraRig* rig = rstate.scene->main_camera_rig();
+            uniforms.u_view_[0] = rig->left_camera()->getViewMatrix();
+            uniforms.u_view_[1] = rig->right_camera()->getViewMatrix();
+            uniforms.u_view_inv_[0] = glm::inverse(uniforms.u_view_[0]);
+            uniforms.u_view_inv_[1] = glm::inverse(uniforms.u_view_[1]);
+        }
+        uniforms.u_view_inv = glm::inverse(uniforms.u_view);
+        view.u_view = uniforms.u_view;
+        view.u_proj = uniforms.u_proj;
+        view.u_view_inv = uniforms.u_view_inv;
+        for (int eye = 0; eye < 2; ++eye)
+        {
+            view.u_view_[eye] = uniforms.u_view_[eye];
+            view.u_view_inv_[eye] = uniforms.u_view_inv_[eye];
+        }
+        uniform_ring_.bind(VIEW_UBO_BINDING, &view, sizeof(view));
+        rstate.uniform_ring = &uniform_ring_;
+        light_blocks_.update(rstate.scene->getLightList());
+        rstate.light_blocks = &light_blocks_;
+        rstate.instance_count = 0;
+
+        rstate.gl_state = &gl_state_;
+        gl_state_.invalidate();
+        gl_state_.depthMask(true);
+        gl_state_.enable(GL_DEPTH_TEST, true);
+        gl_state_.depthFunc(GL_LEQUAL);
+        gl_state_.enable(GL_CULL_FACE, true);
+        gl_state_.frontFace(GL_CCW);
+        gl_state_.cullFace(GL_BACK);
+        if (!rstate.shadow_map)
+        {
+            gl_state_.enable(GL_BLEND, true);
+            gl_state_.blendEquation(GL_FUNC_ADD);
+            gl_state_.blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        gl_state_.enable(GL_SAMPLE_ALPHA_TO_COVERAGE, false);
+        gl_state_.enable(GL_POLYGON_OFFSET_FILL, false);
+        gl_state_.enable(GL_STENCIL_TEST, false);
+        gl_state_.colorMask(true);
+        GL(glLineWidth(1.0f));
+    }
+
+    void GLRenderer::endRenderStates()
+    {
+        gl_state_.enable(GL_POLYGON_OFFSET_FILL, false);
+        gl_state_.enable(GL_DEPTH_TEST, true);
+        gl_state_.depthMask(true);
+        gl_state_.colorMask(true);
+        gl_state_.enable(GL_STENCIL_TEST, false);
+        gl_state_.enable(GL_BLEND, true);
+        gl_state_.enable(GL_SAMPLE_ALPHA_TO_COVERAGE, false);
+        gl_state_.enable(GL_CULL_FACE, true);
+        gl_state_.cullFace(GL_BACK);
+        numberGLCallsAvoided += gl_state_.takeCallsAvoided();
+    }
     void GLRenderer::renderCamera(Scene* scene, Camera* camera, int framebufferId,
             int viewportX, int viewportY, int viewportWidth, int viewportHeight,
             ShaderManager* shader_manager,
@@ -73,18 +137,7 @@ namespace gvr
 
         std::vector<PostEffectData*> post_effects = camera->post_effect_data();
 
-        GL(glDepthMask(GL_TRUE));
-        GL(glEnable(GL_DEPTH_TEST));
-        GL(glDepthFunc(GL_LEQUAL));
-        GL(glEnable(GL_CULL_FACE));
-        GL(glFrontFace(GL_CCW));
-        GL(glCullFace(GL_BACK));
-        GL(glEnable(GL_BLEND));
-        GL(glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE));
-        GL(glBlendEquation(GL_FUNC_ADD));
-        GL(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
-        GL(glDisable(GL_POLYGON_OFFSET_FILL));
-        GL(glLineWidth(1.0f));
+        beginRenderStates(rstate);
 
         if (post_effects.size() == 0)
         {
@@ -93,6 +146,8 @@ namespace gvr
 
             clearBuffers(*camera);
             renderRenderDataVector(rstate);
+            issueOcclusionQueries(rstate);
+            endRenderStates();
         }
         else
         {
@@ -111,6 +166,8 @@ namespace gvr
             {
                 GL(renderRenderData(rstate, *it));
             }
+            issueOcclusionQueries(rstate);
+            endRenderStates();
             GL(glDisable(GL_DEPTH_TEST));
             GL(glDisable(GL_CULL_FACE));
             for (int i = 0; i < post_effects.size() - 1; ++i)
@@ -164,24 +221,13 @@ namespace gvr
                 std::terminate();
             }
             state_sort();
-            GL(glEnable (GL_BLEND));
-            GL(glBlendEquation (GL_FUNC_ADD));
-            GL(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
         }
-        GL(glDepthMask(GL_TRUE));
-        GL(glEnable (GL_DEPTH_TEST));
-        GL(glDepthFunc (GL_LEQUAL));
-        GL(glEnable (GL_CULL_FACE));
-        GL(glFrontFace (GL_CCW));
-        GL(glCullFace (GL_BACK));
-        GL(glDisable (GL_POLYGON_OFFSET_FILL));
-        GL(glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE));
-        GL(glLineWidth(1.0f));
         if ((post_effects.size() == 0) ||
             (post_effect_render_texture_a == nullptr))
         {
             saveRenderTexture->useStencil(useStencilBuffer_);
             renderTarget->beginRendering();
+            beginRenderStates(rstate);
             for (auto it = render_data_vector.begin();
                  it != render_data_vector.end();
                  ++it)
@@ -192,6 +238,7 @@ namespace gvr
                     GL(renderRenderData(rstate, rdata));
                 }
             }
+            endRenderStates();
             renderTarget->endRendering();
         }
         else
@@ -201,6 +248,7 @@ namespace gvr
             renderTexture->useStencil(useStencilBuffer_);
             renderTarget->setTexture(renderTexture);
             renderTarget->beginRendering();
+            beginRenderStates(rstate);
             for (auto it = render_data_vector.begin();
                  it != render_data_vector.end();
                  ++it)
@@ -211,6 +259,7 @@ namespace gvr
                     GL(renderRenderData(rstate, rdata));
                 }
             }
+            endRenderStates();
             GL(glDisable(GL_DEPTH_TEST));
             GL(glDisable(GL_CULL_FACE));
             renderTarget->endRendering();
@@ -241,7 +290,8 @@ namespace gvr
     }
 
 /**
- * Set the render states for render data
+ * Set the render states for render data. Each render data sets all of
+ * its state and the state cache drops whatever is already in place.
  */
     void GLRenderer::setRenderStates(RenderData *render_data, RenderState &rstate)
     {
@@ -249,105 +299,54 @@ namespace gvr
         if (!(rstate.render_mask & render_data->render_mask()))
             return;
 
-        if (render_data->offset())
-        {
-            GL(glEnable(GL_POLYGON_OFFSET_FILL));
-            GL(glPolygonOffset(render_data->offset_factor(), render_data->offset_units()));
-        }
-        if (!render_data->depth_test())
-        {
-            GL(glDisable(GL_DEPTH_TEST));
-        }
+        const RenderStateBlock& state = render_data->render_state();
+        applyStateBlock(state, state.stencil_test
+                && (RenderData::Queue::Stencil == render_data->rendering_order()));
+    }
 
-        if (!render_data->depth_mask())
+    void GLRenderer::applyStateBlock(const RenderStateBlock& state, bool stencil_only)
+    {
+        gl_state_.enable(GL_POLYGON_OFFSET_FILL, state.offset);
+        if (state.offset)
         {
-            GL(glDepthMask(GL_FALSE););
+            gl_state_.polygonOffset(state.offset_factor, state.offset_units);
         }
+        gl_state_.enable(GL_DEPTH_TEST, state.depth_test);
+        gl_state_.depthMask(state.depth_mask && !stencil_only);
+        gl_state_.colorMask(!stencil_only);
 
-        if (render_data->stencil_test())
+        gl_state_.enable(GL_STENCIL_TEST, state.stencil_test);
+        if (state.stencil_test)
         {
-            GL(glEnable(GL_STENCIL_TEST));
+            gl_state_.stencilFunc(state.stencil_func_func, state.stencil_func_ref,
+                                  state.stencil_func_mask);
 
-            GL(glStencilFunc(render_data->stencil_func_func(), render_data->stencil_func_ref(),
-                             render_data->stencil_func_mask()));
-
-            int sfail = render_data->stencil_op_sfail();
-            int dpfail = render_data->stencil_op_dpfail();
-            int dppass = render_data->stencil_op_dppass();
+            int sfail = state.stencil_op_sfail;
+            int dpfail = state.stencil_op_dpfail;
+            int dppass = state.stencil_op_dppass;
             if (0 != sfail && 0 != dpfail && 0 != dppass)
             {
-                GL(glStencilOp(sfail, dpfail, dppass));
+                gl_state_.stencilOp(sfail, dpfail, dppass);
             }
 
-            GL(glStencilMask(render_data->stencil_mask_mask()));
-            if (RenderData::Queue::Stencil == render_data->rendering_order())
-            {
-                GL(glDepthMask(GL_FALSE));
-                GL(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
-            }
+            gl_state_.stencilMask(state.stencil_mask_mask);
         }
 
-        if (!render_data->alpha_blend())
+        gl_state_.enable(GL_BLEND, state.alpha_blend);
+        gl_state_.enable(GL_SAMPLE_ALPHA_TO_COVERAGE, state.alpha_to_coverage);
+        if (state.alpha_to_coverage)
         {
-            GL(glDisable(GL_BLEND));
-        }
-        if (render_data->alpha_to_coverage())
-        {
-            GL(glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE));
-            GL(glSampleCoverage(render_data->sample_coverage(),
-                                render_data->invert_coverage_mask()));
-        }
-        glBlendFunc(render_data->source_alpha_blend_func(), render_data->dest_alpha_blend_func());
-    }
-/**
- * Restore the render states for render data
- */
-    void GLRenderer::restoreRenderStates(RenderData *render_data)
-    {
-        if (render_data->cull_face() != RenderData::CullBack)
-        {
-            GL(glEnable(GL_CULL_FACE));
-            GL(glCullFace(GL_BACK));
-        }
-
-        if (render_data->offset())
-        {
-            GL(glDisable(GL_POLYGON_OFFSET_FILL));
-        }
-        if (!render_data->depth_test())
-        {
-            GL(glEnable(GL_DEPTH_TEST));
-        }
-
-        if (!render_data->depth_mask())
-        {
-            GL(glDepthMask(GL_TRUE));
-        }
-
-        if (render_data->stencil_test())
-        {
-            GL(glDisable(GL_STENCIL_TEST));
-            if (RenderData::Queue::Stencil == render_data->rendering_order())
-            {
-                GL(glDepthMask(GL_TRUE));
-                GL(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
-            }
-        }
-
-        if (!render_data->alpha_blend())
-        {
-            GL(glEnable(GL_BLEND));
-        }
-        if (render_data->alpha_to_coverage())
-        {
-            GL(glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE));
+            gl_state_.sampleCoverage(state.sample_coverage, state.invert_coverage_mask);
         }
+        gl_state_.blendFunc(state.source_alpha_blend_func, state.dest_alpha_blend_func);
     }
 
     /**
      * Generate shadow maps for all the lights that cast shadows.
      * The scene is rendered from the viewpoint of the light using a
      * special depth shader (GVRDepthShader) to create the shadow map.
+     * The cached static casters of every light are dropped when the
+     * scene invalidated its shadow maps or objects were added or removed.
      * @see Renderer::renderShadowMap Light::makeShadowMap
      */
     void GLRenderer::makeShadowMaps(Scene* scene, ShaderManager* shader_manager)
@@ -355,10 +354,23 @@ namespace gvr
         const std::vector<Light*> lights = scene->getLightList();
         GLint drawFB, readFB;
         int texIndex = 0;
-
+        unsigned int hierarchy_version = SceneObject::hierarchyVersion();
+        bool invalid = scene->isShadowMapsInvalid()
+                || (hierarchy_version != shadow_hierarchy_version_);
+
+        shadowCasters = 0;
+        shadowMapsUpdated = 0;
+        shadowMapsSkipped = 0;
+        shadow_hierarchy_version_ = hierarchy_version;
+        scene->validateShadowMaps();
         glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFB);
         glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFB);
         for (auto it = lights.begin(); it != lights.end(); ++it) {
+            ShadowMap* shadowMap = (*it)->getShadowMap();
+            if (invalid && (shadowMap != nullptr))
+            {
+                shadowMap->invalidateStaticCache();
+            }
             (*it)->makeShadowMap(scene, shader_manager, texIndex);
             ++texIndex;
         }
@@ -366,6 +378,59 @@ namespace gvr
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFB);
     }
 
+    /**
+     * Draw the shadow casters of one light into its layer of the shadow
+     * map array. The static casters are drawn into the cache of the
+     * shadow map when it is no longer valid and copied from there
+     * otherwise. Casters are culled against the light camera, dynamic
+     * ones are also dropped when their shadow cannot reach the view.
+     */
+    void GLRenderer::renderShadowMap(ShadowMap* shadow_map, Scene* scene,
+                                     ShaderManager* shader_manager)
+    {
+        RenderState& rstate = shadow_map->getRenderState();
+        Camera* camera = shadow_map->getCamera();
+        glm::mat4 light_matrix(camera->getProjectionMatrix() * camera->getViewMatrix());
+        bool static_valid = shadow_map->isStaticCacheValid(light_matrix);
+
+        if (static_valid && !shadow_map->isUpdateDue())
+        {
+            ++shadowMapsSkipped;
+            return;
+        }
+        rstate.shader_manager = shader_manager;
+        rstate.scene = scene;
+        rstate.is_multiview = false;
+        cullShadowCasters(scene, camera, static_casters_, dynamic_casters_);
+        if (!static_valid)
+        {
+            shadow_map->beginStaticRendering();
+            renderShadowCasters(rstate, static_casters_);
+            shadow_map->endStaticRendering(light_matrix, !static_casters_.empty());
+        }
+        shadow_map->beginRendering();
+        shadow_map->copyStaticCache();
+        renderShadowCasters(rstate, dynamic_casters_);
+        shadow_map->endRendering();
+        ++shadowMapsUpdated;
+    }
+
+    void GLRenderer::renderShadowCasters(RenderState& rstate,
+                                         const std::vector<RenderData*>& casters)
+    {
+        if (casters.empty())
+        {
+            return;
+        }
+        beginRenderStates(rstate);
+        for (auto it = casters.begin(); it != casters.end(); ++it)
+        {
+            GL(renderRenderData(rstate, *it));
+        }
+        endRenderStates();
+        shadowCasters += casters.size();
+    }
+
     void GLRenderer::renderCamera(Scene* scene, Camera* camera,
             RenderTexture* render_texture, ShaderManager* shader_manager,
             PostEffectShaderManager* post_effect_shader_manager,
@@ -412,34 +477,19 @@ namespace gvr
     {
         switch (cull_face)
         {
-            case RenderData::CullFront:glEnable(GL_CULL_FACE);
-                glCullFace(GL_FRONT);
+            case RenderData::CullFront:gl_state_.enable(GL_CULL_FACE, true);
+                gl_state_.cullFace(GL_FRONT);
                 break;
 
-            case RenderData::CullNone:glDisable(GL_CULL_FACE);
+            case RenderData::CullNone:gl_state_.enable(GL_CULL_FACE, false);
                 break;
 
                 // CullBack as Default
-            default:glEnable(GL_CULL_FACE);
-                glCullFace(GL_BACK);
+            default:gl_state_.enable(GL_CULL_FACE, true);
+                gl_state_.cullFace(GL_BACK);
                 break;
         }
     }
-    bool GLRenderer::checkTextureReady(Material* material) {
-        int shaderType = material->shader_type();
-
-        //Skip custom shader here since they are rendering multiple textures
-        //Check the textures later inside the rendering pass inside the custom shader
-        if (shaderType < 0 || shaderType >= Material::ShaderType::BUILTIN_SHADER_SIZE)
-        {
-            return true;
-        }
-        else
-        {
-            return material->isMainTextureReady();
-        }
-     }
-
     void GLRenderer::occlusion_cull(Scene* scene,
             std::vector<SceneObject*>& scene_objects, ShaderManager *shader_manager,
             glm::mat4 vp_matrix) {
@@ -447,6 +497,11 @@ namespace gvr
         if(!occlusion_cull_init(scene, scene_objects))
             return;
 
+        // objects keep their last result, the queries go out after rendering
+        occlusion_queries_.beginFrame();
+        occlusionQueries = 0;
+        occlusionStalls = occlusion_queries_.stalls();
+        occlusionLatency = occlusion_queries_.latency();
         for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it)
         {
             SceneObject *scene_object = (*it);
@@ -455,224 +510,42 @@ namespace gvr
             {
                 continue;
             }
-
-            //If a query was issued on an earlier or same frame and if results are
-            //available, then update the same. If results are unavailable, do nothing
-            if (!scene_object->is_query_issued())
+            // hidden by the CPU occlusion culler, no query needed
+            if (scene_object->isCulled())
             {
+                scene->pick(scene_object);
                 continue;
             }
-
-            //If a previous query is active, do not issue a new query.
-            //This avoids overloading the GPU with too many queries
-            //Queries may span multiple frames
-
-            bool is_query_issued = scene_object->is_query_issued();
-            if (!is_query_issued)
-            {
-                //Setup basic bounding box and material
-                RenderData *bounding_box_render_data(new RenderData());
-                Mesh *bounding_box_mesh = render_data->mesh()->createBoundingBox();
-                Material *bbox_material = new Material(
-                        Material::BOUNDING_BOX_SHADER);
-                RenderPass *pass = new RenderPass();
-                pass->set_material(bbox_material);
-                bounding_box_render_data->set_mesh(bounding_box_mesh);
-                bounding_box_render_data->add_pass(pass);
-
-                GLuint *query = scene_object->get_occlusion_array();
-
-                glDepthFunc(GL_LEQUAL);
-                glEnable(GL_DEPTH_TEST);
-                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-
-                glm::mat4 model_matrix_tmp(
-                        scene_object->transform()->getModelMatrix());
-                glm::mat4 mvp_matrix_tmp(vp_matrix * model_matrix_tmp);
-
-                //Issue the query only with a bounding box
-                glBeginQuery(GL_ANY_SAMPLES_PASSED, query[0]);
-                shader_manager->getBoundingBoxShader()->render(mvp_matrix_tmp,
-                        bounding_box_render_data,
-                        bounding_box_render_data->material(0));
-                glEndQuery(GL_ANY_SAMPLES_PASSED);
-                scene_object->set_query_issued(true);
-
-                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-
-                //Delete the generated bounding box mesh
-                bounding_box_mesh->cleanUp();
-                delete bbox_material;
-                delete pass;
-                delete bounding_box_render_data;
-            }
-
-            GLuint query_result = GL_FALSE;
-            GLuint *query = (*it)->get_occlusion_array();
-            glGetQueryObjectuiv(query[0], GL_QUERY_RESULT_AVAILABLE, &query_result);
-
-            if (query_result)
+            if (occlusion_queries_.visible(scene_object))
             {
-                GLuint pixel_count;
-                glGetQueryObjectuiv(query[0], GL_QUERY_RESULT, &pixel_count);
-                bool visibility = ((pixel_count & GL_TRUE) == GL_TRUE);
-
-                (*it)->set_visible(visibility);
-                (*it)->set_query_issued(false);
-                addRenderData((*it)->render_data());
+                addRenderData(render_data);
                 scene->pick(scene_object);
             }
         }
-        scene->unlockColliders();
+        scene->publishVisibleColliders();
     }
 
-    void GLRenderer::renderMesh(RenderState &rstate, RenderData *render_data)
+    void GLRenderer::issueOcclusionQueries(RenderState& rstate)
     {
-
-        for (int curr_pass = 0; curr_pass < render_data->pass_count(); ++curr_pass)
+        if (!rstate.scene->get_occlusion_culling())
         {
-            numberTriangles += render_data->mesh()->getNumTriangles();
-            numberDrawCalls++;
-
-            set_face_culling(render_data->pass(curr_pass)->cull_face());
-            Material* curr_material = rstate.material_override;
-
-            if (curr_material == nullptr)
-                curr_material = render_data->pass(curr_pass)->material();
-            if (curr_material != nullptr)
-            {
-                GL(renderMaterialShader(rstate, render_data, curr_material));
-            }
-        }
-    }
-
-    void GLRenderer::renderMaterialShader(RenderState& rstate, RenderData* render_data, Material *curr_material) {
-
-        if (Material::ShaderType::BEING_GENERATED == curr_material->shader_type()) {
-            return;
-        }
-
-        //Skip the material whose texture is not ready with some exceptions
-        if (!checkTextureReady(curr_material))
             return;
-        ShaderManager* shader_manager = rstate.shader_manager;
-        Transform* const t = render_data->owner_object()->transform();
-
-        if (t == nullptr)
-            return;
-
-        rstate.uniforms.u_model = t->getModelMatrix();
-    	rstate.uniforms.u_mv = rstate.uniforms.u_view * rstate.uniforms.u_model;
-    	rstate.uniforms.u_mv_it = glm::inverseTranspose(rstate.uniforms.u_mv);
-    	rstate.uniforms.u_mvp = rstate.uniforms.u_proj * rstate.uniforms.u_mv;
-        rstate.uniforms.u_right = rstate.render_mask & RenderData::RenderMaskBit::Right;
-
-
-        if(rstate.is_multiview  && !rstate.shadow_map){
-            rstate.uniforms.u_view_[0] = rstate.scene->main_camera_rig()->left_camera()->getViewMatrix();
-            rstate.uniforms.u_view_[1] = rstate.scene->main_camera_rig()->right_camera()->getViewMatrix();
-            rstate.uniforms.u_mv_[0] = rstate.uniforms.u_view_[0] * rstate.uniforms.u_model;
-            rstate.uniforms.u_mv_[1] = rstate.uniforms.u_view_[1] * rstate.uniforms.u_model;
-            rstate.uniforms.u_mv_it_[0] = glm::inverseTranspose(rstate.uniforms.u_mv_[0]);
-            rstate.uniforms.u_mv_it_[1] = glm::inverseTranspose(rstate.uniforms.u_mv_[1]);
-            rstate.uniforms.u_mvp_[0] = rstate.uniforms.u_proj * rstate.uniforms.u_mv_[0];
-            rstate.uniforms.u_mvp_[1] = rstate.uniforms.u_proj * rstate.uniforms.u_mv_[1];
-        }
-        Mesh* mesh = render_data->mesh();
-
-        GLuint programId = -1;
-        ShaderBase* shader = NULL;
-
-        try {
-             //TODO: Improve this logic to avoid a big "switch case"
-            if (rstate.material_override != nullptr)
-                curr_material = rstate.material_override;
-             switch (curr_material->shader_type()) {
-                case Material::ShaderType::UNLIT_HORIZONTAL_STEREO_SHADER:
-                	shader = shader_manager->getUnlitHorizontalStereoShader();
-                    break;
-                case Material::ShaderType::UNLIT_VERTICAL_STEREO_SHADER:
-                    shader = shader_manager->getUnlitVerticalStereoShader();
-                    break;
-                case Material::ShaderType::OES_SHADER:
-                    shader = shader_manager->getOESShader();
-                    break;
-                case Material::ShaderType::OES_HORIZONTAL_STEREO_SHADER:
-                    shader = shader_manager->getOESHorizontalStereoShader();
-                    break;
-                case Material::ShaderType::OES_VERTICAL_STEREO_SHADER:
-                    shader = shader_manager->getOESVerticalStereoShader();
-                    break;
-                case Material::ShaderType::CUBEMAP_SHADER:
-                    shader = shader_manager->getCubemapShader();
-                    break;
-                case Material::ShaderType::CUBEMAP_REFLECTION_SHADER:
-                    if(rstate.is_multiview ){
-                        rstate.uniforms.u_view_inv_[0] = glm::inverse(rstate.uniforms.u_view_[0]);
-                        rstate.uniforms.u_view_inv_[1] = glm::inverse(rstate.uniforms.u_view_[1]);
-                    }
-                    else
-                        rstate.uniforms.u_view_inv = glm::inverse(rstate.uniforms.u_view);
-                    shader = shader_manager->getCubemapReflectionShader();
-                    break;
-                case Material::ShaderType::TEXTURE_SHADER:
-                    shader = shader_manager->getTextureShader();
-                    break;
-                case Material::ShaderType::EXTERNAL_RENDERER_SHADER:
-                    shader = shader_manager->getExternalRendererShader();
-                    break;
-                case Material::ShaderType::ASSIMP_SHADER:
-                    shader = shader_manager->getAssimpShader();
-                    break;
-                case Material::ShaderType::LIGHTMAP_SHADER:
-                    shader = shader_manager->getLightMapShader();
-                    break;
-    			case Material::ShaderType::UNLIT_FBO_SHADER:
-    				shader = shader_manager->getUnlitFboShader();
-                    break;
-                default:
-                    shader = shader_manager->getCustomShader(curr_material->shader_type());
-                    break;
-            }
-             if (shader == NULL) {
-                 LOGE("Rendering error: GVRRenderData shader cannot be determined\n");
-                 shader_manager->getErrorShader()->render(&rstate, render_data, curr_material);
-                 return;
-             }
-             if ((render_data->draw_mode() == GL_LINE_STRIP) ||
-                 (render_data->draw_mode() == GL_LINES) ||
-                 (render_data->draw_mode() == GL_LINE_LOOP)) {
-                 if (curr_material->hasUniform("line_width")) {
-                     float lineWidth = curr_material->getFloat("line_width");
-                     glLineWidth(lineWidth);
-                 }
-                 else {
-                     glLineWidth(1.0f);
-                 }
-             }
-             shader->render(&rstate, render_data, curr_material);
-        } catch (const std::string &error) {
-            LOGE(
-                    "Error detected in Renderer::renderRenderData; name : %s, error : %s",
-                    render_data->owner_object()->name().c_str(),
-                    error.c_str());
-            shader_manager->getErrorShader()->render(&rstate, render_data, curr_material);
         }
+        occlusion_queries_.issue(gl_state_, rstate.shader_manager->getBoundingBoxShader(),
+                rstate.uniforms.u_view, rstate.uniforms.u_proj);
+        occlusionQueries += occlusion_queries_.queriesIssued();
+    }
 
-        programId = shader->getProgramId();
-        //there is no program associated with EXTERNAL_RENDERER_SHADER
-        if (-1 != programId) {
-            glBindVertexArray(mesh->getVAOId(programId));
-            if (mesh->indices().size() > 0) {
-                glDrawElements(render_data->draw_mode(), mesh->indices().size(), GL_UNSIGNED_SHORT, 0);
-
-            } else {
-                glDrawArrays(render_data->draw_mode(), 0, mesh->vertices().size());
-            }
-            glBindVertexArray(0);
+    void GLRenderer::bindInstanceMatrices(int offset, GLint location)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, uniform_ring_.buffer());
+        for (int column = 0; column < 4; ++column)
+        {
+            glVertexAttribPointer(location + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (const GLvoid*) (offset + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location + column, 1);
+            glEnableVertexAttribArray(location + column);
         }
-        checkGLError("renderMesh::renderMaterialShader");
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 }
-
-
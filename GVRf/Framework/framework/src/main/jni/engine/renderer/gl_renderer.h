@@ -40,6 +40,11 @@
 #include "gl/gl_program.h"
 #include <unordered_map>
 #include "renderer.h"
+#include "gl_state_cache.h"
+#include "gl_uniform_ring.h"
+#include "gl_light_blocks.h"
+#include "gl_occlusion_queries.h"
+#include "gl_command_backend.h"
 
 typedef unsigned long Long;
 namespace gvr {
@@ -52,11 +57,13 @@ class RenderData;
 class RenderTexture;
 class ShaderManager;
 class Light;
+class ShaderBase;
 
 class GLRenderer: public Renderer {
     friend class Renderer;
+    friend class GLCommandBackend;
 protected:
-    GLRenderer(){}
+    GLRenderer() : command_backend_(*this), shadow_hierarchy_version_(0) {}
     virtual ~GLRenderer(){}
 public:
     // pure virtual
@@ -72,13 +79,13 @@ public:
              RenderTexture* post_effect_render_texture_a,
              RenderTexture* post_effect_render_texture_b, bool);
 
-    void restoreRenderStates(RenderData* render_data);
     void setRenderStates(RenderData* render_data, RenderState& rstate);
     virtual void cullAndRender(RenderTarget* renderTarget, Scene* scene,
                         ShaderManager* shader_manager, PostEffectShaderManager* post_effect_shader_manager,
                         RenderTexture* post_effect_render_texture_a,
                         RenderTexture* post_effect_render_texture_b);
     void makeShadowMaps(Scene* scene, ShaderManager* shader_manager);
+    void renderShadowMap(ShadowMap* shadow_map, Scene* scene, ShaderManager* shader_manager);
 
 
     // Specific to GL
@@ -98,17 +105,49 @@ public:
      void set_face_culling(int cull_face);
 
 private:
-    // this is specific to GL
-    bool checkTextureReady(Material* material);
-
-    // Pure Virtual
-    virtual void renderMesh(RenderState& rstate, RenderData* render_data);
-    virtual void renderMaterialShader(RenderState& rstate, RenderData* render_data, Material *material) ;
+    RenderCommandBackend* commandBackend() {
+        return &command_backend_;
+    }
+    /*
+     * Set the state of a render state block through the state cache.
+     */
+    void applyStateBlock(const RenderStateBlock& state, bool stencil_only);
     void occlusion_cull(Scene* scene,
                     std::vector<SceneObject*>& scene_objects,
                     ShaderManager *shader_manager, glm::mat4 vp_matrix);
 
-    void clearBuffers(const Camera& camera) const;
+    void clearBuffers(const Camera& camera);
+    /*
+     * Point the a_instance_matrix attribute at location in the bound VAO
+     * to the model matrices of this draw, at offset in the uniform ring.
+     */
+    void bindInstanceMatrices(int offset, GLint location);
+
+    /*
+     * Forget the cached GL state, set the defaults a pass starts from and
+     * upload the per view matrices.
+     */
+    void beginRenderStates(RenderState& rstate);
+    /*
+     * Put the defaults back after the last render data of a pass.
+     */
+    void endRenderStates();
+    /*
+     * Issue the occlusion queries culling scheduled, against the depth
+     * buffer of the pass just rendered.
+     */
+    void issueOcclusionQueries(RenderState& rstate);
+    /*
+     * Draw casters into the shadow map bound for rendering.
+     */
+    void renderShadowCasters(RenderState& rstate, const std::vector<RenderData*>& casters);
+
+    GLStateCache gl_state_;
+    GLUniformRing uniform_ring_;
+    GLLightBlocks light_blocks_;
+    GLOcclusionQueries occlusion_queries_;
+    GLCommandBackend command_backend_;
+    unsigned int shadow_hierarchy_version_;    // when the static shadows were last invalidated
 };
 
 }
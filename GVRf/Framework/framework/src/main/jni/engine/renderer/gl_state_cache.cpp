@@ -0,0 +1,202 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Shadow copy of the GL state that filters out redundant GL calls.
+ ***************************************************************************/
+
+#include "gl_state_cache.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+GLStateCache::GLStateCache() :
+        known_(0), calls_avoided_(0), enabled_(0), depth_mask_(true),
+        depth_func_(GL_LESS), color_mask_(true), cull_face_(GL_BACK),
+        front_face_(GL_CCW), offset_factor_(0.0f), offset_units_(0.0f),
+        blend_equation_(GL_FUNC_ADD), blend_src_(GL_ONE), blend_dst_(GL_ZERO),
+        sample_coverage_(1.0f), invert_coverage_(GL_FALSE),
+        stencil_func_(GL_ALWAYS), stencil_ref_(0), stencil_func_mask_(~0u),
+        stencil_sfail_(GL_KEEP), stencil_dpfail_(GL_KEEP),
+        stencil_dppass_(GL_KEEP), stencil_mask_(~0u), program_(0) {
+}
+
+void GLStateCache::invalidate() {
+    known_ = 0;
+}
+
+void GLStateCache::enable(GLenum cap, bool enable) {
+    int index;
+
+    switch (cap) {
+    case GL_BLEND:
+        index = CAP_BLEND;
+        break;
+    case GL_CULL_FACE:
+        index = CAP_CULL_FACE;
+        break;
+    case GL_DEPTH_TEST:
+        index = CAP_DEPTH_TEST;
+        break;
+    case GL_POLYGON_OFFSET_FILL:
+        index = CAP_POLYGON_OFFSET_FILL;
+        break;
+    case GL_SAMPLE_ALPHA_TO_COVERAGE:
+        index = CAP_SAMPLE_ALPHA_TO_COVERAGE;
+        break;
+    case GL_STENCIL_TEST:
+        index = CAP_STENCIL_TEST;
+        break;
+    default:
+        // not tracked
+        if (enable) {
+            GL(glEnable(cap));
+        } else {
+            GL(glDisable(cap));
+        }
+        return;
+    }
+
+    int bit = 1 << index;
+    if (unchanged(bit, ((enabled_ & bit) != 0) == enable)) {
+        return;
+    }
+    if (enable) {
+        enabled_ |= bit;
+        GL(glEnable(cap));
+    } else {
+        enabled_ &= ~bit;
+        GL(glDisable(cap));
+    }
+}
+
+void GLStateCache::depthMask(bool mask) {
+    if (unchanged(KNOWN_DEPTH_MASK, depth_mask_ == mask)) {
+        return;
+    }
+    depth_mask_ = mask;
+    GL(glDepthMask(mask ? GL_TRUE : GL_FALSE));
+}
+
+void GLStateCache::depthFunc(GLenum func) {
+    if (unchanged(KNOWN_DEPTH_FUNC, depth_func_ == func)) {
+        return;
+    }
+    depth_func_ = func;
+    GL(glDepthFunc(func));
+}
+
+void GLStateCache::colorMask(bool mask) {
+    if (unchanged(KNOWN_COLOR_MASK, color_mask_ == mask)) {
+        return;
+    }
+    color_mask_ = mask;
+    GLboolean gl_mask = mask ? GL_TRUE : GL_FALSE;
+    GL(glColorMask(gl_mask, gl_mask, gl_mask, gl_mask));
+}
+
+void GLStateCache::cullFace(GLenum mode) {
+    if (unchanged(KNOWN_CULL_FACE, cull_face_ == mode)) {
+        return;
+    }
+    cull_face_ = mode;
+    GL(glCullFace(mode));
+}
+
+void GLStateCache::frontFace(GLenum mode) {
+    if (unchanged(KNOWN_FRONT_FACE, front_face_ == mode)) {
+        return;
+    }
+    front_face_ = mode;
+    GL(glFrontFace(mode));
+}
+
+void GLStateCache::polygonOffset(float factor, float units) {
+    if (unchanged(KNOWN_POLYGON_OFFSET,
+            offset_factor_ == factor && offset_units_ == units)) {
+        return;
+    }
+    offset_factor_ = factor;
+    offset_units_ = units;
+    GL(glPolygonOffset(factor, units));
+}
+
+void GLStateCache::blendEquation(GLenum mode) {
+    if (unchanged(KNOWN_BLEND_EQUATION, blend_equation_ == mode)) {
+        return;
+    }
+    blend_equation_ = mode;
+    GL(glBlendEquation(mode));
+}
+
+void GLStateCache::blendFunc(GLenum sfactor, GLenum dfactor) {
+    if (unchanged(KNOWN_BLEND_FUNC,
+            blend_src_ == sfactor && blend_dst_ == dfactor)) {
+        return;
+    }
+    blend_src_ = sfactor;
+    blend_dst_ = dfactor;
+    GL(glBlendFunc(sfactor, dfactor));
+}
+
+void GLStateCache::sampleCoverage(float value, GLboolean invert) {
+    if (unchanged(KNOWN_SAMPLE_COVERAGE,
+            sample_coverage_ == value && invert_coverage_ == invert)) {
+        return;
+    }
+    sample_coverage_ = value;
+    invert_coverage_ = invert;
+    GL(glSampleCoverage(value, invert));
+}
+
+void GLStateCache::stencilFunc(GLenum func, GLint ref, GLuint mask) {
+    if (unchanged(KNOWN_STENCIL_FUNC, stencil_func_ == func
+            && stencil_ref_ == ref && stencil_func_mask_ == mask)) {
+        return;
+    }
+    stencil_func_ = func;
+    stencil_ref_ = ref;
+    stencil_func_mask_ = mask;
+    GL(glStencilFunc(func, ref, mask));
+}
+
+void GLStateCache::stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass) {
+    if (unchanged(KNOWN_STENCIL_OP, stencil_sfail_ == sfail
+            && stencil_dpfail_ == dpfail && stencil_dppass_ == dppass)) {
+        return;
+    }
+    stencil_sfail_ = sfail;
+    stencil_dpfail_ = dpfail;
+    stencil_dppass_ = dppass;
+    GL(glStencilOp(sfail, dpfail, dppass));
+}
+
+void GLStateCache::stencilMask(GLuint mask) {
+    if (unchanged(KNOWN_STENCIL_MASK, stencil_mask_ == mask)) {
+        return;
+    }
+    stencil_mask_ = mask;
+    GL(glStencilMask(mask));
+}
+
+void GLStateCache::useProgram(GLuint program) {
+    if (unchanged(KNOWN_PROGRAM, program_ == program)) {
+        return;
+    }
+    program_ = program;
+    GL(glUseProgram(program));
+}
+
+}
@@ -0,0 +1,132 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Shadow copy of the GL state that filters out redundant GL calls.
+ ***************************************************************************/
+
+#ifndef GL_STATE_CACHE_H_
+#define GL_STATE_CACHE_H_
+
+#include "gl/gl_headers.h"
+
+namespace gvr {
+
+/*
+ * Remembers the last value given to each piece of fixed function state
+ * and only calls GL when a new value differs from it.
+ *
+ * The cache can only be trusted while nothing else touches the same
+ * state, so the renderer invalidates it at the start of every pass and
+ * whoever hands control to foreign GL code (external renderers, texture
+ * capture) has to invalidate it afterwards. After invalidate() the next
+ * call of every kind goes to GL.
+ */
+class GLStateCache {
+public:
+    GLStateCache();
+
+    void invalidate();
+
+    /*
+     * Redundant calls filtered out since the last call, which resets it.
+     */
+    int takeCallsAvoided() {
+        int avoided = calls_avoided_;
+        calls_avoided_ = 0;
+        return avoided;
+    }
+
+    void enable(GLenum cap, bool enable);
+    void depthMask(bool mask);
+    void depthFunc(GLenum func);
+    void colorMask(bool mask);
+    void cullFace(GLenum mode);
+    void frontFace(GLenum mode);
+    void polygonOffset(float factor, float units);
+    void blendEquation(GLenum mode);
+    void blendFunc(GLenum sfactor, GLenum dfactor);
+    void sampleCoverage(float value, GLboolean invert);
+    void stencilFunc(GLenum func, GLint ref, GLuint mask);
+    void stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass);
+    void stencilMask(GLuint mask);
+    void useProgram(GLuint program);
+
+private:
+    GLStateCache(const GLStateCache&);
+    GLStateCache& operator=(const GLStateCache&);
+
+    enum Cap {
+        CAP_BLEND, CAP_CULL_FACE, CAP_DEPTH_TEST, CAP_POLYGON_OFFSET_FILL,
+        CAP_SAMPLE_ALPHA_TO_COVERAGE, CAP_STENCIL_TEST, CAP_COUNT
+    };
+
+    // one bit per piece of state whose cached value matches GL
+    enum Known {
+        KNOWN_DEPTH_MASK = 1 << CAP_COUNT,
+        KNOWN_DEPTH_FUNC = KNOWN_DEPTH_MASK << 1,
+        KNOWN_COLOR_MASK = KNOWN_DEPTH_MASK << 2,
+        KNOWN_CULL_FACE = KNOWN_DEPTH_MASK << 3,
+        KNOWN_FRONT_FACE = KNOWN_DEPTH_MASK << 4,
+        KNOWN_POLYGON_OFFSET = KNOWN_DEPTH_MASK << 5,
+        KNOWN_BLEND_EQUATION = KNOWN_DEPTH_MASK << 6,
+        KNOWN_BLEND_FUNC = KNOWN_DEPTH_MASK << 7,
+        KNOWN_SAMPLE_COVERAGE = KNOWN_DEPTH_MASK << 8,
+        KNOWN_STENCIL_FUNC = KNOWN_DEPTH_MASK << 9,
+        KNOWN_STENCIL_OP = KNOWN_DEPTH_MASK << 10,
+        KNOWN_STENCIL_MASK = KNOWN_DEPTH_MASK << 11,
+        KNOWN_PROGRAM = KNOWN_DEPTH_MASK << 12
+    };
+
+    /*
+     * True if the state is known to already have the wanted value;
+     * otherwise marks it as known, since the caller is about to set it.
+     */
+    bool unchanged(int known, bool same) {
+        if ((known_ & known) && same) {
+            ++calls_avoided_;
+            return true;
+        }
+        known_ |= known;
+        return false;
+    }
+
+    int known_;
+    int calls_avoided_;
+    int enabled_;
+    bool depth_mask_;
+    GLenum depth_func_;
+    bool color_mask_;
+    GLenum cull_face_;
+    GLenum front_face_;
+    float offset_factor_;
+    float offset_units_;
+    GLenum blend_equation_;
+    GLenum blend_src_;
+    GLenum blend_dst_;
+    float sample_coverage_;
+    GLboolean invert_coverage_;
+    GLenum stencil_func_;
+    GLint stencil_ref_;
+    GLuint stencil_func_mask_;
+    GLenum stencil_sfail_;
+    GLenum stencil_dpfail_;
+    GLenum stencil_dppass_;
+    GLuint stencil_mask_;
+    GLuint program_;
+};
+
+}
+#endif
@@ -0,0 +1,264 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Uniform buffer ring for the matrices computed by the renderer.
+ ***************************************************************************/
+
+#include <cstddef>
+#include <cstring>
+
+#include "gl_uniform_ring.h"
+#include "renderer.h"
+#include "render_commands.h"
+#include "glm/gtc/type_ptr.hpp"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+const char VIEW_UBO_GLSL[] =
+        "layout (std140) uniform View_ubo {\n"
+        "    mat4 u_view;\n"
+        "    mat4 u_proj;\n"
+        "    mat4 u_view_inv;\n"
+        "    mat4 u_view_[2];\n"
+        "    mat4 u_view_inv_[2];\n"
+        "};\n";
+
+static const char* const MATRIX_NAMES[GLTransformBlock::MATRIX_COUNT] = {
+        "u_model", "u_mv", "u_mv_it", "u_mvp"
+};
+
+static const char* const MATRIX_ARRAY_NAMES[GLTransformBlock::MATRIX_COUNT] = {
+        nullptr, "u_mv_[0]", "u_mv_it_[0]", "u_mvp_[0]"
+};
+
+static const GLuint64 FENCE_TIMEOUT = 100000000; // 100 ms
+
+/*
+ * Offset of a member of block, or -1 if the block does not have it.
+ */
+static int memberOffset(GLuint program, GLuint block, const char* name,
+        int* stride) {
+    GLuint index = GL_INVALID_INDEX;
+    GLint member_block = -1;
+    GLint offset = -1;
+
+    if (name == nullptr) {
+        return -1;
+    }
+    glGetUniformIndices(program, 1, &name, &index);
+    if (index == GL_INVALID_INDEX) {
+        return -1;
+    }
+    glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &member_block);
+    if (member_block != static_cast<GLint>(block)) {
+        return -1;
+    }
+    glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+    if (stride != nullptr) {
+        GLint array_stride = 0;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &array_stride);
+        *stride = array_stride;
+    }
+    return offset;
+}
+
+bool GLTransformBlock::init(GLuint program) {
+    GLuint view_block = glGetUniformBlockIndex(program, "View_ubo");
+    if (view_block != GL_INVALID_INDEX) {
+        GLint view_size = 0;
+        glGetActiveUniformBlockiv(program, view_block, GL_UNIFORM_BLOCK_DATA_SIZE, &view_size);
+        if (view_size != static_cast<GLint>(sizeof(ViewBlock))
+                || memberOffset(program, view_block, "u_view_inv_[0]", nullptr)
+                        != offsetof(ViewBlock, u_view_inv_)) {
+            LOGE("View_ubo of program %d is not declared as expected", program);
+        } else {
+            glUniformBlockBinding(program, view_block, VIEW_UBO_BINDING);
+        }
+    }
+
+    size_ = 0;
+    GLuint block = glGetUniformBlockIndex(program, "Transform_ubo");
+    if (block == GL_INVALID_INDEX) {
+        return false;
+    }
+    for (int m = 0; m < MATRIX_COUNT; ++m) {
+        strides_[m] = 0;
+        offsets_[m] = memberOffset(program, block, MATRIX_NAMES[m], nullptr);
+        if (offsets_[m] < 0) {
+            offsets_[m] = memberOffset(program, block, MATRIX_ARRAY_NAMES[m], &strides_[m]);
+        }
+    }
+    GLint size = 0;
+    glGetActiveUniformBlockiv(program, block, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+    if (size > MAX_SIZE) {
+        LOGE("Transform_ubo of program %d is too large: %d bytes", program, size);
+        return false;
+    }
+    glUniformBlockBinding(program, block, TRANSFORM_UBO_BINDING);
+    size_ = size;
+    return size_ > 0;
+}
+
+bool GLTransformBlock::record(RenderCommandList& commands,
+        const ShaderUniformsPerObject& uniforms, bool multiview) const {
+    if (size_ <= 0) {
+        return false;
+    }
+    write(commands.uniformBlock(TRANSFORM_UBO_BINDING, size_), uniforms, multiview);
+    return true;
+}
+
+void GLTransformBlock::write(char* data, const ShaderUniformsPerObject& uniforms,
+        bool multiview) const {
+    const glm::mat4* single[MATRIX_COUNT] = {
+            &uniforms.u_model, &uniforms.u_mv, &uniforms.u_mv_it, &uniforms.u_mvp
+    };
+    const glm::mat4* eyes[MATRIX_COUNT] = {
+            nullptr, uniforms.u_mv_, uniforms.u_mv_it_, uniforms.u_mvp_
+    };
+
+    for (int m = 0; m < MATRIX_COUNT; ++m) {
+        if (offsets_[m] < 0) {
+            continue;
+        }
+        if (strides_[m] == 0) {
+            memcpy(data + offsets_[m], glm::value_ptr(*single[m]), sizeof(glm::mat4));
+            continue;
+        }
+        for (int eye = 0; eye < 2; ++eye) {
+            const glm::mat4& matrix = multiview ? eyes[m][eye] : *single[m];
+            memcpy(data + offsets_[m] + eye * strides_[m], glm::value_ptr(matrix),
+                    sizeof(glm::mat4));
+        }
+    }
+}
+
+GLUniformRing::GLUniformRing() :
+        buffer_(0), alignment_(256), head_(0), segment_(0), staging_offset_(0) {
+    for (int i = 0; i < SEGMENT_COUNT; ++i) {
+        fences_[i] = 0;
+        full_[i] = false;
+    }
+}
+
+GLUniformRing::~GLUniformRing() {
+    for (int i = 0; i < SEGMENT_COUNT; ++i) {
+        if (fences_[i] != 0) {
+            glDeleteSync(fences_[i]);
+        }
+    }
+    if (buffer_ != 0) {
+        glDeleteBuffers(1, &buffer_);
+    }
+}
+
+/*
+ * Reserve size bytes, moving on to the next segment once the GPU is
+ * done with it if the current one is full. Returns -1 if the next
+ * segment was filled up since the last fence(), that is if one pass
+ * needs more than the whole ring.
+ */
+int GLUniformRing::allocate(int size) {
+    int offset = (head_ + alignment_ - 1) / alignment_ * alignment_;
+
+    if (offset + size > (segment_ + 1) * SEGMENT_SIZE) {
+        int next = (segment_ + 1) % SEGMENT_COUNT;
+        if (full_[next]) {
+            return -1;
+        }
+        flush();
+        full_[segment_] = true;
+        segment_ = next;
+        if (fences_[segment_] != 0) {
+            while (glClientWaitSync(fences_[segment_], GL_SYNC_FLUSH_COMMANDS_BIT,
+                    FENCE_TIMEOUT) == GL_TIMEOUT_EXPIRED) {
+                LOGW("GLUniformRing: waiting for the GPU to release segment %d", segment_);
+            }
+            glDeleteSync(fences_[segment_]);
+            fences_[segment_] = 0;
+        }
+        offset = segment_ * SEGMENT_SIZE;
+    }
+    head_ = offset + size;
+    return offset;
+}
+
+bool GLUniformRing::bind(GLuint binding, const void* data, int size) {
+    int offset = append(data, size);
+    if (offset < 0) {
+        return false;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer_, offset, size);
+    return true;
+}
+
+int GLUniformRing::append(const void* data, int size) {
+    if (size > SEGMENT_SIZE) {
+        return -1;
+    }
+    if (buffer_ == 0) {
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment > 0) {
+            alignment_ = alignment;
+        }
+        // created through the copy target so the uniform and vertex bindings stay as they are
+        glGenBuffers(1, &buffer_);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+        glBufferData(GL_COPY_WRITE_BUFFER, SEGMENT_COUNT * SEGMENT_SIZE, nullptr, GL_STREAM_DRAW);
+    }
+
+    int offset = allocate(size);
+    if (offset < 0) {
+        return -1;
+    }
+    if (staging_.empty()) {
+        staging_offset_ = offset;
+    }
+    // the alignment padding is uploaded along, it keeps the range in one piece
+    staging_.resize(offset + size - staging_offset_);
+    memcpy(&staging_[offset - staging_offset_], data, size);
+    return offset;
+}
+
+void GLUniformRing::flush() {
+    if (staging_.empty()) {
+        return;
+    }
+    int size = staging_.size();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    void* dest = glMapBufferRange(GL_COPY_WRITE_BUFFER, staging_offset_, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dest == nullptr) {
+        LOGE("GLUniformRing: cannot map %d bytes at %d", size, staging_offset_);
+    } else {
+        memcpy(dest, &staging_[0], size);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    staging_.clear();
+}
+
+void GLUniformRing::fence() {
+    for (int i = 0; i < SEGMENT_COUNT; ++i) {
+        if (full_[i]) {
+            fences_[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            full_[i] = false;
+        }
+    }
+}
+
+}
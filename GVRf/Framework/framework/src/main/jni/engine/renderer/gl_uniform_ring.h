@@ -0,0 +1,174 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Uniform buffer ring for the matrices computed by the renderer.
+ ***************************************************************************/
+
+#ifndef GL_UNIFORM_RING_H_
+#define GL_UNIFORM_RING_H_
+
+#include <vector>
+
+#include "gl/gl_headers.h"
+#include "glm/glm.hpp"
+
+namespace gvr {
+struct ShaderUniformsPerObject;
+class GLUniformRing;
+class RenderCommandList;
+
+/*
+ * Uniform blocks the renderer fills for programs that declare them.
+ *
+ * Transform_ubo holds the per draw matrices. A program may declare any
+ * of u_model, u_mv, u_mv_it and u_mvp in it, in any order, or for
+ * multiview the arrays u_mv_[2], u_mv_it_[2] and u_mvp_[2]; only the
+ * declared ones are computed and written.
+ *
+ * View_ubo holds the per view matrices. It is written once per pass and
+ * shared by every program, so it has to be declared exactly like
+ * VIEW_UBO_GLSL.
+ *
+ * Lights_ubo holds the lights of the scene, see GLLightBlocks.
+ */
+enum UniformBlockBinding {
+    TRANSFORM_UBO_BINDING = 0, VIEW_UBO_BINDING = 1, LIGHT_UBO_BINDING = 2
+};
+
+extern const char VIEW_UBO_GLSL[];
+
+/*
+ * Contents of View_ubo, std140.
+ */
+struct ViewBlock {
+    glm::mat4 u_view;
+    glm::mat4 u_proj;
+    glm::mat4 u_view_inv;
+    glm::mat4 u_view_[2];
+    glm::mat4 u_view_inv_[2];
+};
+
+/*
+ * Layout of the Transform_ubo block of one program.
+ */
+class GLTransformBlock {
+public:
+    enum Matrix {
+        MODEL, MV, MV_IT, MVP, MATRIX_COUNT
+    };
+
+    GLTransformBlock() : size_(0) {
+    }
+
+    /*
+     * Look the blocks up in program and assign their binding points.
+     * Returns false if the program has no Transform_ubo.
+     */
+    bool init(GLuint program);
+
+    bool valid() const {
+        return size_ > 0;
+    }
+
+    int size() const {
+        return size_;
+    }
+
+    bool has(Matrix matrix) const {
+        return offsets_[matrix] >= 0;
+    }
+
+    /*
+     * Record the declared matrices as the contents of Transform_ubo.
+     * Returns false if the program has no such block.
+     */
+    bool record(RenderCommandList& commands, const ShaderUniformsPerObject& uniforms,
+            bool multiview) const;
+
+private:
+    static const int MAX_SIZE = 1024;
+
+    void write(char* data, const ShaderUniformsPerObject& uniforms,
+            bool multiview) const;
+
+    int size_;
+    int offsets_[MATRIX_COUNT];
+    int strides_[MATRIX_COUNT];  // 0 unless declared as a multiview array
+};
+
+/*
+ * One buffer used as a ring. Blocks are appended and bound by offset,
+ * either as uniform blocks or as per instance vertex attributes.
+ * Appended blocks are staged in memory and flush() uploads all of them
+ * with one unsynchronized mapping, so a pass maps the buffer once
+ * rather than once per draw. The ring is split into segments; a fence
+ * per segment, set by fence() after the draws that read it, keeps it
+ * from overwriting data the GPU has not read yet.
+ */
+class GLUniformRing {
+public:
+    GLUniformRing();
+    ~GLUniformRing();
+
+    /*
+     * Stage size bytes and bind them to binding. Returns false if the
+     * block does not fit into a segment. They have to be flushed before
+     * a draw reads them.
+     */
+    bool bind(GLuint binding, const void* data, int size);
+
+    /*
+     * Stage size bytes. Returns their offset in buffer(), or -1 if they
+     * do not fit into a segment.
+     */
+    int append(const void* data, int size);
+
+    /*
+     * Upload the blocks staged since the last flush.
+     */
+    void flush();
+
+    /*
+     * Fence the segments filled up since the last call. Has to follow
+     * the draws that read them.
+     */
+    void fence();
+
+    GLuint buffer() const {
+        return buffer_;
+    }
+
+private:
+    GLUniformRing(const GLUniformRing&);
+    GLUniformRing& operator=(const GLUniformRing&);
+
+    static const int SEGMENT_COUNT = 4;
+    static const int SEGMENT_SIZE = 256 * 1024;
+
+    int allocate(int size);
+
+    GLuint buffer_;
+    int alignment_;
+    int head_;
+    int segment_;
+    GLsync fences_[SEGMENT_COUNT];
+    bool full_[SEGMENT_COUNT];      // filled up, waiting for fence()
+    std::vector<char> staging_;
+    int staging_offset_;            // offset of staging_ in the buffer
+};
+
+}
+#endif
@@ -0,0 +1,168 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Recorded render commands and the backends that replay them.
+ ***************************************************************************/
+
+#include "render_commands.h"
+
+namespace gvr {
+
+unsigned int RenderCommandList::epoch_ = 0;
+
+// float components of each RenderCommand::UniformType
+static const int UNIFORM_SIZES[] = { 1, 1, 2, 3, 4, 16 };
+
+int RenderCommandList::addMatrices(const glm::mat4* matrices, int count) {
+    int first = matrices_.size();
+    matrices_.insert(matrices_.end(), matrices, matrices + count);
+    return first;
+}
+
+void RenderCommandList::bindProgram(unsigned int program) {
+    RenderCommand command;
+    command.type = RenderCommand::BIND_PROGRAM;
+    command.program = program;
+    commands_.push_back(command);
+}
+
+void RenderCommandList::setState(const RenderStateBlock& block, int cull_face,
+        bool stencil_only) {
+    // render data drawn in a row mostly share their state
+    if (states_.empty() || (states_.back() != block)) {
+        states_.push_back(block);
+    }
+    RenderCommand command;
+    command.type = RenderCommand::SET_STATE;
+    command.state.block = states_.size() - 1;
+    command.state.cull_face = cull_face;
+    command.state.stencil_only = stencil_only;
+    commands_.push_back(command);
+}
+
+void RenderCommandList::lineWidth(float width) {
+    RenderCommand command;
+    command.type = RenderCommand::LINE_WIDTH;
+    command.line_width = width;
+    commands_.push_back(command);
+}
+
+void RenderCommandList::uniform(int location, RenderCommand::UniformType type, int count,
+        const float* values) {
+    if (location < 0) {
+        return;
+    }
+    RenderCommand command;
+    command.type = RenderCommand::UNIFORM;
+    command.uniform.location = location;
+    command.uniform.type = type;
+    command.uniform.count = count;
+    command.uniform.first = floats_.size();
+    floats_.insert(floats_.end(), values, values + count * UNIFORM_SIZES[type]);
+    commands_.push_back(command);
+}
+
+void RenderCommandList::uniform1i(int location, int value) {
+    if (location < 0) {
+        return;
+    }
+    RenderCommand command;
+    command.type = RenderCommand::UNIFORM;
+    command.uniform.location = location;
+    command.uniform.type = RenderCommand::INT;
+    command.uniform.count = 1;
+    command.uniform.first = ints_.size();
+    ints_.push_back(value);
+    commands_.push_back(command);
+}
+
+void RenderCommandList::bindTexture(int unit, int target, unsigned int id) {
+    RenderCommand command;
+    command.type = RenderCommand::BIND_TEXTURE;
+    command.texture.unit = unit;
+    command.texture.target = target;
+    command.texture.id = id;
+    commands_.push_back(command);
+}
+
+char* RenderCommandList::uniformBlock(int binding, int size) {
+    RenderCommand command;
+    command.type = RenderCommand::UNIFORM_BLOCK;
+    command.block.binding = binding;
+    command.block.first = block_data_.size();
+    command.block.size = size;
+    block_data_.resize(block_data_.size() + size, 0);
+    commands_.push_back(command);
+    return &block_data_[command.block.first];
+}
+
+void RenderCommandList::bindLightBlock(int layout) {
+    RenderCommand command;
+    command.type = RenderCommand::LIGHT_BLOCK;
+    command.light_block = layout;
+    commands_.push_back(command);
+}
+
+void RenderCommandList::draw(Mesh* mesh, int mode, int count, int index_type,
+        int first_matrix, int instances, int instance_location, bool skinned) {
+    RenderCommand command;
+    command.type = RenderCommand::DRAW;
+    command.draw.mesh = mesh;
+    command.draw.mode = mode;
+    command.draw.count = count;
+    command.draw.index_type = index_type;
+    command.draw.first_matrix = first_matrix;
+    command.draw.instances = instances;
+    command.draw.instance_location = instance_location;
+    command.draw.skinned = skinned;
+    commands_.push_back(command);
+}
+
+void RenderCommandList::external(RenderData* render_data, const glm::mat4& mvp) {
+    RenderCommand command;
+    command.type = RenderCommand::EXTERNAL;
+    command.external.render_data = render_data;
+    command.external.mvp = addMatrices(&mvp, 1);
+    commands_.push_back(command);
+}
+
+NullCommandBackend::NullCommandBackend() {
+    reset();
+}
+
+void NullCommandBackend::reset() {
+    for (int i = 0; i < RenderCommand::TYPE_COUNT; ++i) {
+        counts_[i] = 0;
+    }
+    uniform_bytes_ = 0;
+}
+
+void NullCommandBackend::replay(RenderState& rstate, const RenderCommandList& commands) {
+    int count = commands.size();
+    for (int i = 0; i < count; ++i) {
+        const RenderCommand& command = commands[i];
+        ++counts_[command.type];
+        if (command.type == RenderCommand::UNIFORM) {
+            const RenderCommand::UniformArgs& uniform = command.uniform;
+            uniform_bytes_ += uniform.count * UNIFORM_SIZES[uniform.type] * sizeof(float);
+        } else if (command.type == RenderCommand::UNIFORM_BLOCK) {
+            uniform_bytes_ += command.block.size;
+        }
+    }
+    RenderCommandList::invalidate();
+}
+
+}
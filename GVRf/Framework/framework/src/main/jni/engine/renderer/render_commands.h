@@ -0,0 +1,288 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Recorded render commands and the backends that replay them.
+ ***************************************************************************/
+
+#ifndef RENDER_COMMANDS_H_
+#define RENDER_COMMANDS_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "objects/components/render_data.h"
+
+namespace gvr {
+class Mesh;
+struct RenderState;
+
+/*
+ * One step of a recorded pass. Commands are plain values: programs and
+ * textures by their GL names, uniforms by location with their values
+ * copied into the list that holds them, along with render states,
+ * matrices and uniform block contents. Draw modes, index types and
+ * texture targets use the GL values.
+ *
+ * Meshes are the one exception, they are referenced so the backend can
+ * upload what changed before drawing. EXTERNAL hands a render data to
+ * the external renderer, which draws it with calls of its own.
+ */
+struct RenderCommand {
+    enum Type {
+        BIND_PROGRAM,   // program
+        SET_STATE,      // state
+        LINE_WIDTH,     // line_width
+        UNIFORM,        // uniform
+        BIND_TEXTURE,   // texture
+        UNIFORM_BLOCK,  // block, bound from the uniform ring
+        LIGHT_BLOCK,    // light_block, a GLLightBlocks layout
+        DRAW,           // draw
+        EXTERNAL,       // external
+        TYPE_COUNT
+    };
+
+    enum UniformType {
+        INT, FLOAT, VEC2, VEC3, VEC4, MAT4
+    };
+
+    struct StateArgs {
+        int block;          // render state in the list
+        int cull_face;
+        bool stencil_only;
+    };
+    struct UniformArgs {
+        int location;
+        int type;           // UniformType
+        int count;          // array elements
+        int first;          // values in the list, ints for INT and floats otherwise
+    };
+    struct TextureArgs {
+        int unit;
+        int target;
+        unsigned int id;
+    };
+    struct BlockArgs {
+        int binding;
+        int first;          // bytes in the list
+        int size;
+    };
+    struct DrawArgs {
+        Mesh* mesh;
+        int mode;
+        int count;
+        int index_type;     // 0 to draw arrays
+        int first_matrix;   // instance matrices in the list
+        int instances;      // 0 for a single draw without instance matrices
+        int instance_location;  // of a_instance_matrix, -1 if the program has none
+        bool skinned;       // upload the bone data of the mesh first
+    };
+    struct ExternalArgs {
+        RenderData* render_data;
+        int mvp;            // matrix in the list
+    };
+
+    Type type;
+    union {
+        unsigned int program;
+        StateArgs state;
+        float line_width;
+        UniformArgs uniform;
+        TextureArgs texture;
+        BlockArgs block;
+        int light_block;
+        DrawArgs draw;
+        ExternalArgs external;
+    };
+};
+
+/*
+ * A pass worth of commands. Clearing keeps the storage, so a list reused
+ * every frame stops allocating once it has seen the largest pass.
+ *
+ * Shaders record the values of their uniforms here instead of setting
+ * them; recording makes no GL calls. Uniforms at location -1 are not
+ * recorded.
+ */
+class RenderCommandList {
+public:
+    RenderCommandList() {
+    }
+
+    void clear() {
+        commands_.clear();
+        states_.clear();
+        matrices_.clear();
+        floats_.clear();
+        ints_.clear();
+        block_data_.clear();
+    }
+
+    /*
+     * Clear a list that is not going to be replayed. Shaders skip
+     * uniforms they recorded before with the same values; that no longer
+     * holds for anything recorded before the last discard.
+     */
+    void discard() {
+        clear();
+        invalidate();
+    }
+
+    /*
+     * Make shaders record every uniform again, as after a discard. For
+     * replays that do not reach the GPU.
+     */
+    static void invalidate() {
+        ++epoch_;
+    }
+
+    /*
+     * Changes with every discard anywhere. Shaders that skip recording
+     * unchanged uniforms compare it with the epoch they recorded them in.
+     */
+    static unsigned int epoch() {
+        return epoch_;
+    }
+
+    int size() const {
+        return commands_.size();
+    }
+
+    const RenderCommand& operator[](int index) const {
+        return commands_[index];
+    }
+
+    const RenderStateBlock& state(int index) const {
+        return states_[index];
+    }
+
+    const glm::mat4* matrices(int first) const {
+        return &matrices_[first];
+    }
+
+    const float* floats(int first) const {
+        return &floats_[first];
+    }
+
+    const int* ints(int first) const {
+        return &ints_[first];
+    }
+
+    const char* blockData(int first) const {
+        return &block_data_[first];
+    }
+
+    int addMatrices(const glm::mat4* matrices, int count);
+
+    void bindProgram(unsigned int program);
+    void setState(const RenderStateBlock& block, int cull_face, bool stencil_only);
+    void lineWidth(float width);
+
+    void uniform(int location, RenderCommand::UniformType type, int count,
+            const float* values);
+    void uniform1i(int location, int value);
+    void uniform1f(int location, float value) {
+        uniform(location, RenderCommand::FLOAT, 1, &value);
+    }
+    void uniform2f(int location, float x, float y) {
+        const float values[] = { x, y };
+        uniform(location, RenderCommand::VEC2, 1, values);
+    }
+    void uniform3f(int location, float x, float y, float z) {
+        const float values[] = { x, y, z };
+        uniform(location, RenderCommand::VEC3, 1, values);
+    }
+    void uniform4f(int location, float x, float y, float z, float w) {
+        const float values[] = { x, y, z, w };
+        uniform(location, RenderCommand::VEC4, 1, values);
+    }
+    void uniform4fv(int location, int count, const float* values) {
+        uniform(location, RenderCommand::VEC4, count, values);
+    }
+    void uniformMatrix4fv(int location, int count, const float* values) {
+        uniform(location, RenderCommand::MAT4, count, values);
+    }
+
+    void bindTexture(int unit, int target, unsigned int id);
+
+    /*
+     * Reserve size zeroed bytes for a uniform block bound to binding and
+     * return them to be filled in. They move with the next call.
+     */
+    char* uniformBlock(int binding, int size);
+    void bindLightBlock(int layout);
+
+    void draw(Mesh* mesh, int mode, int count, int index_type, int first_matrix,
+            int instances, int instance_location, bool skinned);
+    void external(RenderData* render_data, const glm::mat4& mvp);
+
+private:
+    RenderCommandList(const RenderCommandList&);
+    RenderCommandList& operator=(const RenderCommandList&);
+
+    static unsigned int epoch_;
+
+    std::vector<RenderCommand> commands_;
+    std::vector<RenderStateBlock> states_;
+    std::vector<glm::mat4> matrices_;
+    std::vector<float> floats_;
+    std::vector<int> ints_;
+    std::vector<char> block_data_;
+};
+
+/*
+ * Turns a command list into API calls.
+ */
+class RenderCommandBackend {
+public:
+    virtual ~RenderCommandBackend() {
+    }
+    virtual void replay(RenderState& rstate, const RenderCommandList& commands) = 0;
+};
+
+/*
+ * Walks the commands without calling any graphics API, so recording
+ * can be timed on its own or without a GPU. Nothing gets drawn, so the
+ * uniforms shaders skip as already set are invalidated.
+ */
+class NullCommandBackend: public RenderCommandBackend {
+public:
+    NullCommandBackend();
+
+    void replay(RenderState& rstate, const RenderCommandList& commands);
+
+    /*
+     * Commands of the given type replayed since the last reset().
+     */
+    int count(RenderCommand::Type type) const {
+        return counts_[type];
+    }
+
+    /*
+     * Bytes of uniform values and uniform blocks replayed since the last
+     * reset(), what a backend would upload.
+     */
+    int uniformBytes() const {
+        return uniform_bytes_;
+    }
+    void reset();
+
+private:
+    int counts_[RenderCommand::TYPE_COUNT];
+    int uniform_bytes_;
+};
+
+}
+#endif
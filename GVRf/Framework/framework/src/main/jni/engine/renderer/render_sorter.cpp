@@ -0,0 +1,180 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Sorts render data by packed 64-bit keys with a radix sort.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "render_sorter.h"
+#include "objects/components/render_data.h"
+
+namespace gvr {
+
+static const int ORDER_BITS = 6;
+static const int SHADER_BITS = 8;
+static const int PASS_COUNT_BITS = 2;
+static const int MATERIAL_BITS = 14;
+static const int CULL_FACE_BITS = 2;   // CullBack, CullFront or CullNone
+static const int HASH_BITS = 8;
+
+static const int ORDER_SHIFT = 58;
+static const int SHADER_SHIFT = 50;
+static const int PASS_COUNT_SHIFT = 48;
+static const int MATERIAL_SHIFT = 34;
+static const int CULL_FACE_SHIFT = MATERIAL_SHIFT - CULL_FACE_BITS;
+static const int HASH_SHIFT = CULL_FACE_SHIFT - HASH_BITS;
+static const int DISTANCE_BITS = HASH_SHIFT;
+
+/*
+ * Sort and remove duplicates; false if more than 2^bits values remain.
+ */
+template<class T>
+static bool makeRanks(std::vector<T>& values, int bits) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values.size() <= (1u << bits);
+}
+
+template<class T>
+static uint64_t rankOf(const std::vector<T>& ranks, const T& value) {
+    return std::lower_bound(ranks.begin(), ranks.end(), value) - ranks.begin();
+}
+
+/*
+ * Bit pattern of a non-negative float, which orders the same as the float.
+ */
+static uint32_t distanceBits(float distance) {
+    uint32_t bits;
+
+    if (!(distance > 0.0f)) {
+        return 0;
+    }
+    memcpy(&bits, &distance, sizeof(bits));
+    return bits;
+}
+
+bool RenderSorter::sort(std::vector<RenderData*>& render_data) {
+    return sort(render_data, nullptr);
+}
+
+bool RenderSorter::sort(std::vector<RenderData*>& render_data,
+        const std::vector<float>& distances) {
+    return sort(render_data, distances.data());
+}
+
+bool RenderSorter::sort(std::vector<RenderData*>& render_data, const float* distances) {
+    int count = render_data.size();
+
+    if (count < 2) {
+        return true;
+    }
+
+    orders_.clear();
+    shaders_.clear();
+    pass_counts_.clear();
+    materials_.clear();
+    hash_codes_.clear();
+    for (auto it = render_data.begin(); it != render_data.end(); ++it) {
+        RenderData* rdata = *it;
+        Material* material = rdata->material(0);
+
+        orders_.push_back(rdata->rendering_order());
+        shaders_.push_back(material->shader_type());
+        pass_counts_.push_back(rdata->pass_count());
+        materials_.push_back(material);
+        hash_codes_.push_back(rdata->getHashCode());
+    }
+
+    if (!makeRanks(orders_, ORDER_BITS) || !makeRanks(shaders_, SHADER_BITS)
+            || !makeRanks(pass_counts_, PASS_COUNT_BITS)
+            || !makeRanks(materials_, MATERIAL_BITS)
+            || !makeRanks(hash_codes_, HASH_BITS)) {
+        return false;
+    }
+
+    entries_.resize(count);
+    for (int i = 0; i < count; ++i) {
+        RenderData* rdata = render_data[i];
+        Material* material = rdata->material(0);
+        int order = rdata->rendering_order();
+        uint64_t key = (rankOf(orders_, order) << ORDER_SHIFT)
+                | (rankOf(shaders_, static_cast<int>(material->shader_type())) << SHADER_SHIFT);
+
+        // camera distance is evaluated once here instead of per comparison
+        uint32_t distance = distanceBits((distances != nullptr) ?
+                distances[i] : rdata->camera_distance());
+        if (order >= RenderData::Transparent && order < RenderData::Overlay) {
+            key |= 0xFFFFFFFFu - distance;
+        } else {
+            key |= (rankOf(pass_counts_, rdata->pass_count()) << PASS_COUNT_SHIFT)
+                    | (rankOf(materials_, material) << MATERIAL_SHIFT)
+                    | (static_cast<uint64_t>(rdata->cull_face(0) & ((1 << CULL_FACE_BITS) - 1))
+                            << CULL_FACE_SHIFT)
+                    | (rankOf(hash_codes_, rdata->getHashCode()) << HASH_SHIFT)
+                    | (distance >> (32 - DISTANCE_BITS));
+        }
+        entries_[i].key = key;
+        entries_[i].render_data = rdata;
+    }
+
+    radixSort();
+
+    for (int i = 0; i < count; ++i) {
+        render_data[i] = entries_[i].render_data;
+    }
+    return true;
+}
+
+/*
+ * Stable LSD radix sort of entries_ on the key, one byte per pass.
+ */
+void RenderSorter::radixSort() {
+    int count = entries_.size();
+    unsigned int histogram[8][256];
+
+    memset(histogram, 0, sizeof(histogram));
+    for (int i = 0; i < count; ++i) {
+        uint64_t key = entries_[i].key;
+        for (int b = 0; b < 8; ++b) {
+            ++histogram[b][(key >> (b * 8)) & 0xFF];
+        }
+    }
+
+    scratch_.resize(count);
+    for (int b = 0; b < 8; ++b) {
+        unsigned int* buckets = histogram[b];
+
+        // every key has the same byte here, the pass would not move anything
+        if (buckets[(entries_[0].key >> (b * 8)) & 0xFF] == static_cast<unsigned int>(count)) {
+            continue;
+        }
+        unsigned int offset = 0;
+        for (int d = 0; d < 256; ++d) {
+            unsigned int n = buckets[d];
+            buckets[d] = offset;
+            offset += n;
+        }
+        for (int i = 0; i < count; ++i) {
+            const Entry& entry = entries_[i];
+            scratch_[buckets[(entry.key >> (b * 8)) & 0xFF]++] = entry;
+        }
+        entries_.swap(scratch_);
+    }
+}
+
+}
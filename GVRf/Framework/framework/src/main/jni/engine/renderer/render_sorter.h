@@ -0,0 +1,91 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Sorts render data by packed 64-bit keys with a radix sort.
+ ***************************************************************************/
+
+#ifndef RENDER_SORTER_H_
+#define RENDER_SORTER_H_
+
+#include <vector>
+#include <cstdint>
+
+namespace gvr {
+class RenderData;
+class Material;
+
+/*
+ * Orders render data the same way compareRenderDataByOrderShaderDistance
+ * does, but evaluates every sort criterion once per render data and packs
+ * them into a 64-bit key:
+ *
+ *   63..58  rendering order rank
+ *   57..50  shader type rank
+ *   transparent queue:
+ *   31..0   camera distance, inverted so the farthest comes first
+ *   everything else:
+ *   49..48  pass count rank
+ *   47..34  material rank
+ *   33..32  cull face
+ *   31..24  state hash rank
+ *   23..0   camera distance, quantized
+ *
+ * Ranks are dense per frame and keep the order of the values they stand
+ * for (material pointers, render state hashes, ...). The keys are then sorted
+ * with a stable LSD radix sort, skipping the byte columns that are the same
+ * for every key.
+ */
+class RenderSorter {
+public:
+    RenderSorter() {
+    }
+
+    /*
+     * Sort render_data in place. Returns false and leaves it untouched if
+     * the frame has more distinct values of some criterion than its key
+     * field can rank; the caller then has to fall back to the comparator.
+     */
+    bool sort(std::vector<RenderData*>& render_data);
+
+    /*
+     * Same, with the camera distance of each render data given instead
+     * of taken from RenderData::camera_distance.
+     */
+    bool sort(std::vector<RenderData*>& render_data, const std::vector<float>& distances);
+
+private:
+    RenderSorter(const RenderSorter&);
+    RenderSorter& operator=(const RenderSorter&);
+
+    struct Entry {
+        uint64_t key;
+        RenderData* render_data;
+    };
+
+    bool sort(std::vector<RenderData*>& render_data, const float* distances);
+    void radixSort();
+
+    std::vector<Entry> entries_;
+    std::vector<Entry> scratch_;
+    std::vector<int> orders_;
+    std::vector<int> shaders_;
+    std::vector<int> pass_counts_;
+    std::vector<Material*> materials_;
+    std::vector<unsigned int> hash_codes_;
+};
+
+}
+#endif
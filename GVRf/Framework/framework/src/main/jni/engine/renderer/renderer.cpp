@@ -18,18 +18,22 @@
  ***************************************************************************/
 
 #include "renderer.h"
+#include "frustum_kernel.h"
 #include "glm/gtc/matrix_inverse.hpp"
 
+#include "objects/components/lod_group.h"
+#include "objects/components/perspective_camera.h"
 #include "objects/post_effect_data.h"
 #include "objects/scene.h"
 #include "objects/textures/render_texture.h"
 #include "shaders/shader_manager.h"
 #include "shaders/post_effect_shader_manager.h"
+#include "util/gvr_time.h"
+#include "util/gvr_alloc_counter.h"
 
 #include "gl_renderer.h"
 #include "vulkan_renderer.h"
-#define MAX_INDICES 500
-#define BATCH_SIZE 60
+#define MAX_INSTANCES 1024
 bool do_batching = true;
 
 namespace gvr {
@@ -56,14 +60,15 @@ Renderer* Renderer::getInstance(const char* type){
     }
     return instance;
 }
-Renderer::Renderer():numberDrawCalls(0), numberTriangles(0), batch_manager(nullptr) {
+Renderer::Renderer():batch_manager(nullptr), numberDrawCalls(0), numberTriangles(0), numberGLCallsAvoided(0), cullTime(0), sortTime(0), cullAllocations(-1), batchUploadBytes(0), cpuOccluded(0), cpuOcclusionTime(0), occlusionQueries(0), occlusionStalls(0), occlusionLatency(0), numberRenderCommands(0), commandRecordTime(0), commandReplayTime(0), shadowCasters(0), shadowMapsUpdated(0), shadowMapsSkipped(0), frame_prep_(nullptr) {
     if(do_batching && !gRenderer->isVulkanInstace()) {
-        batch_manager = new BatchManager(BATCH_SIZE, MAX_INDICES);
+        batch_manager = new BatchManager(BatchManager::MAX_BATCH_SIZE,
+                BatchManager::DEFAULT_MAX_VERTICES, BatchManager::DEFAULT_MAX_INDICES);
     }
 }
 void Renderer::frustum_cull(glm::vec3 camera_position, SceneObject *object,
         float frustum[6][4], std::vector<SceneObject*>& scene_objects,
-        bool need_cull, int planeMask) {
+        bool need_cull, int planeMask, const ScreenSpaceCull& screen) {
 
     // frustumCull() return 3 possible values:
     // 0 when the HBV of the object is completely outside the frustum: cull itself and all its children out
@@ -76,23 +81,18 @@ void Renderer::frustum_cull(glm::vec3 camera_position, SceneObject *object,
         return;
     }
 
+    // drop what is too small to see, children included
+    const BoundingVolume& volume = object->getBoundingVolume();
+    if (screen.tooSmall(camera_position, volume.min_corner(), volume.max_corner())) {
+        object->setCullStatus(true);
+        return;
+    }
+
     //allows for on demand calculation of the camera distance; usually matters
     //when transparent objects are in play
     RenderData* renderData = object->render_data();
     if (nullptr != renderData) {
-        renderData->setCameraDistanceLambda([object, camera_position]() {
-            // Transform the bounding volume
-            BoundingVolume bounding_volume_ = object->getBoundingVolume();
-            glm::vec4 transformed_sphere_center(bounding_volume_.center(), 1.0f);
-
-            // Calculate distance from camera
-            glm::vec4 position(camera_position, 1.0f);
-            glm::vec4 difference = transformed_sphere_center - position;
-            float distance = glm::dot(difference, difference);
-
-            // this distance will be used when sorting transparent objects
-            return distance;
-        });
+        renderData->setCameraPosition(camera_position);
     }
 
     if (need_cull) {
@@ -116,10 +116,40 @@ void Renderer::frustum_cull(glm::vec3 camera_position, SceneObject *object,
         scene_objects.push_back(object);
     }
 
-    const std::vector<SceneObject*> children = object->children();
+    // of the levels of a LOD group only the selected one is culled further
+    LODGroup* lod_group = static_cast<LODGroup*>(
+            object->getComponent(LODGroup::getComponentType()));
+    if ((lod_group != nullptr) && !lod_group->enabled()) {
+        lod_group = nullptr;
+    }
+    float distance;
+    float screen_size;
+    if ((lod_group != nullptr) && screen.active() && screen.measure(camera_position,
+            volume.min_corner(), volume.max_corner(), distance, screen_size)) {
+        lod_group->select(distance, screen_size);
+    }
+
+    // walked under the lock, a copy of the list would allocate every frame
+    const std::vector<SceneObject*>& children = object->lockChildren();
     for (auto it = children.begin(); it != children.end(); ++it) {
-        frustum_cull(camera_position, *it, frustum, scene_objects, need_cull, planeMask);
+        if (lod_group != nullptr) {
+            int level = lod_group->levelOf(*it);
+            if ((level >= 0) && (level != lod_group->selected())) {
+                (*it)->setCullStatus(true);
+                continue;
+            }
+        }
+        frustum_cull(camera_position, *it, frustum, scene_objects, need_cull, planeMask, screen);
     }
+    object->unlockChildren();
+}
+
+/*
+ * What culling from camera needs to measure sizes on screen.
+ */
+ScreenSpaceCull Renderer::screenSpaceCull(Scene* scene, Camera* camera) {
+    return ScreenSpaceCull(camera->getProjectionMatrix(),
+            scene->get_cull_viewport_height(), scene->get_small_feature_culling());
 }
 
 void Renderer::state_sort() {
@@ -127,8 +157,14 @@ void Renderer::state_sort() {
     // 1. rendering order first to maintain specified order
     // 2. shader type second to minimize the gl cost of switching shader
     // 3. camera distance last to minimize overdraw
-    std::sort(render_data_vector.begin(), render_data_vector.end(),
-            compareRenderDataByOrderShaderDistance);
+    // The radix sorter packs these into integer keys; the comparator is only
+    // used for frames with more distinct states than the keys can hold.
+    long long start = getNanoTime();
+    if (!render_sorter_.sort(render_data_vector)) {
+        std::sort(render_data_vector.begin(), render_data_vector.end(),
+                compareRenderDataByOrderShaderDistance);
+    }
+    sortTime = getNanoTime() - start;
 
     if (DEBUG_RENDERER) {
         LOGD("SORTING: After sorting");
@@ -173,13 +209,263 @@ void Renderer::cull(Scene *scene, Camera *camera,
             || camera->owner_object()->transform() == nullptr) {
         return;
     }
-    cullFromCamera(scene, camera, shader_manager);
+    long long allocations = getAllocationCount();
+    batchUploadBytes = 0;
+    bool pipelined = scene->get_pipelined_prep();
+    if (pipelined) {
+        pipelinedCull(scene, camera, shader_manager);
+    } else {
+        if (frame_prep_ != nullptr) {
+            frame_prep_->discard();
+        }
+        cullFromCamera(scene, camera, shader_manager);
+
+        // Note: this needs to be scaled to sort on N states
+        state_sort();
+    }
+    if (allocations >= 0) {
+        cullAllocations = getAllocationCount() - allocations;
+    }
 
-    // Note: this needs to be scaled to sort on N states
-    state_sort();
+    if (!pipelined) {
+        setupBatches(scene, shader_manager);
+    }
+}
 
-    if(do_batching && !gRenderer->isVulkanInstace()){
+/*
+ * With instancing, render data whose shaders draw instanced are left out
+ * of the batches. The vector is split into runs that are drawn either
+ * instanced or from their batches, in the order it was sorted in.
+ */
+void Renderer::setupBatches(Scene* scene, ShaderManager* shader_manager) {
+    draw_runs_.clear();
+    instanced_runs_ = false;
+    if (!do_batching || isVulkanInstace()) {
+        return;
+    }
+    if (!scene->get_instancing()) {
         batch_manager->batchSetup(render_data_vector);
+        return;
+    }
+    instanced_runs_ = true;
+    batch_manager->clearBatches();
+
+    int count = render_data_vector.size();
+    int start = 0;
+    bool instanced = (count > 0) && isInstanceable(shader_manager, render_data_vector[0]);
+
+    while (start < count) {
+        DrawRun run = { start, start + 1, 0, 0, instanced };
+        while (run.end < count) {
+            instanced = isInstanceable(shader_manager, render_data_vector[run.end]);
+            if (instanced != run.instanced) {
+                break;
+            }
+            ++run.end;
+        }
+        if (!run.instanced) {
+            run.first_batch = batch_manager->getNumberOfBatches();
+            batch_manager->addBatches(render_data_vector, run.start, run.end);
+            run.end_batch = batch_manager->getNumberOfBatches();
+        }
+        draw_runs_.push_back(run);
+        start = run.end;
+    }
+}
+
+/*
+ * True if every pass of render_data is drawn by a shader with instance
+ * matrices. Render data that instancing would draw on their own anyway,
+ * the transparent ones and those with batching disabled, stay with the
+ * batches.
+ */
+bool Renderer::isInstanceable(ShaderManager* shader_manager, RenderData* render_data) {
+    int order = render_data->rendering_order();
+    if (!render_data->batching()
+            || (order >= RenderData::Transparent && order < RenderData::Overlay)) {
+        return false;
+    }
+    for (int i = 0; i < render_data->pass_count(); ++i) {
+        Material* material = render_data->pass(i)->material();
+        if (material == nullptr) {
+            return false;
+        }
+        ShaderBase* shader = selectShader(shader_manager, material);
+        if ((shader == nullptr) || !shader->supportsInstancing()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Draw what the prep thread made of the previous frame and have it
+ * prepare this one while the GL thread renders. A frame that changed the
+ * scene hierarchy is prepared right away instead, since the last snapshot
+ * may still hold objects that are gone.
+ */
+void Renderer::pipelinedCull(Scene* scene, Camera* camera, ShaderManager* shader_manager) {
+    glm::mat4 view_matrix = camera->getViewMatrix();
+    glm::mat4 vp_matrix = glm::mat4(camera->getProjectionMatrix() * view_matrix);
+    glm::vec3 campos(view_matrix[3]);
+    float frustum[6][4];
+
+    ScreenSpaceCull screen(screenSpaceCull(scene, camera));
+
+    if (frame_prep_ == nullptr) {
+        frame_prep_ = new FramePrep();
+    }
+    buildCullFrustum(scene, camera, vp_matrix, frustum);
+    frame_prep_->finish();
+    if (!frame_prep_->ready()) {
+        frame_prep_->begin(scene, campos, frustum, scene->get_frustum_culling(), screen);
+        frame_prep_->finish();
+    }
+    // also applies the cull status, camera distances and LOD levels of
+    // the prepared frame, which the prep thread only recorded
+    frame_prep_->swap(scene_objects_vector, render_data_vector);
+    cullTime = frame_prep_->cullTime();
+    sortTime = frame_prep_->sortTime();
+    cpuOccluded = 0;
+    cpuOcclusionTime = 0;
+
+    scene->clearVisibleColliders();
+    for (auto it = scene_objects_vector.begin(); it != scene_objects_vector.end(); ++it) {
+        scene->pick(*it);
+    }
+    scene->publishVisibleColliders();
+
+    setupBatches(scene, shader_manager);
+    frame_prep_->begin(scene, campos, frustum, scene->get_frustum_culling(), screen);
+}
+
+void Renderer::finishFramePrep() {
+    if (frame_prep_ != nullptr) {
+        frame_prep_->finish();
+    }
+}
+
+/*
+ * Build the view frustum, one that holds both eyes when culling for the
+ * rig's center camera.
+ */
+void Renderer::buildCullFrustum(Scene* scene, Camera* camera, const glm::mat4& vp_matrix,
+        float frustum[6][4]) {
+    const CameraRig* rig = scene->main_camera_rig();
+    if (scene->get_stereo_culling() && (nullptr != rig)
+            && (rig->center_camera() == camera)
+            && (nullptr != rig->left_camera()) && (nullptr != rig->right_camera())) {
+        Camera* left = rig->left_camera();
+        Camera* right = rig->right_camera();
+        build_stereo_frustum(frustum,
+                left->getProjectionMatrix() * left->getViewMatrix(),
+                right->getProjectionMatrix() * right->getViewMatrix());
+    } else {
+        build_frustum(frustum, (const float*) glm::value_ptr(vp_matrix));
+    }
+}
+
+/*
+ * Whether the shadow of the box can fall into the view frustum. The
+ * shadow is bounded by the box swept away from the light up to the far
+ * plane of the light camera.
+ */
+static bool shadowReachesView(const float view_frustum[6][4], const BoundingVolume& volume,
+        const glm::vec3& light_position, const glm::vec3& light_direction,
+        bool perspective, float light_far) {
+    glm::vec3 sweep_min(volume.min_corner());
+    glm::vec3 sweep_max(volume.max_corner());
+
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 corner((i & 1) ? volume.max_corner().x : volume.min_corner().x,
+                (i & 2) ? volume.max_corner().y : volume.min_corner().y,
+                (i & 4) ? volume.max_corner().z : volume.min_corner().z);
+        glm::vec3 end(corner);
+        if (perspective) {
+            glm::vec3 ray(corner - light_position);
+            float distance = glm::length(ray);
+            if ((distance > 0.0f) && (distance < light_far)) {
+                end = light_position + ray * (light_far / distance);
+            }
+        } else {
+            float depth = glm::dot(corner - light_position, light_direction);
+            if (depth < light_far) {
+                end = corner + light_direction * (light_far - depth);
+            }
+        }
+        sweep_min = glm::min(sweep_min, end);
+        sweep_max = glm::max(sweep_max, end);
+    }
+    int planeMask = 0;
+    return checkAABBVsFrustum(view_frustum, sweep_min.x, sweep_min.y, sweep_min.z,
+            sweep_max.x, sweep_max.y, sweep_max.z, planeMask) != FRUSTUM_OUTSIDE;
+}
+
+void Renderer::cullShadowCasters(Scene* scene, Camera* light_camera,
+        std::vector<RenderData*>& static_casters,
+        std::vector<RenderData*>& dynamic_casters) {
+    glm::mat4 light_view = light_camera->getViewMatrix();
+    glm::mat4 light_proj = light_camera->getProjectionMatrix();
+    glm::mat4 light_vp(light_proj * light_view);
+    glm::mat4 light_world(glm::inverse(light_view));
+    glm::vec3 light_position(light_world[3]);
+    glm::vec3 light_direction(-glm::normalize(glm::vec3(light_world[2])));
+    bool perspective = (light_proj[2][3] != 0.0f);
+    float light_far = perspective ? light_proj[3][2] / (light_proj[2][2] + 1.0f)
+            : (light_proj[3][2] - 1.0f) / light_proj[2][2];
+    float light_frustum[6][4];
+
+    // the prep thread writes to the same objects
+    finishFramePrep();
+    static_casters.clear();
+    dynamic_casters.clear();
+    shadow_objects_.clear();
+    build_frustum(light_frustum, (const float*) glm::value_ptr(light_vp));
+    SceneObject* root = scene->getRoot();
+    if (scene->get_flat_culling()) {
+        FlatSceneGraph& flat_graph = scene->getFlatSceneGraph();
+        flat_graph.sync(root);
+        flat_graph.cull(light_position, light_frustum, shadow_objects_, true);
+    } else {
+        frustum_cull(light_position, root, light_frustum, shadow_objects_, true, 0,
+                ScreenSpaceCull());
+    }
+    // batches draw by the cull status, which has to be the camera's again
+    if (frame_prep_ != nullptr) {
+        frame_prep_->reapply();
+    }
+
+    const CameraRig* rig = scene->main_camera_rig();
+    Camera* view_camera = (nullptr != rig) ? rig->center_camera() : nullptr;
+    float view_frustum[6][4];
+    if (nullptr != view_camera) {
+        glm::mat4 view_vp(view_camera->getProjectionMatrix() * view_camera->getViewMatrix());
+        buildCullFrustum(scene, view_camera, view_vp, view_frustum);
+    }
+
+    for (auto it = shadow_objects_.begin(); it != shadow_objects_.end(); ++it) {
+        SceneObject* object = *it;
+        RenderData* render_data = object->render_data();
+        if ((render_data == nullptr) || !render_data->cast_shadows()
+                || (render_data->material(0) == nullptr) || !render_data->enabled()
+                || (render_data->mesh() == nullptr)) {
+            continue;
+        }
+        // the static cache outlives the view, which may turn towards
+        // shadows it does not reach now: static casters are only culled
+        // against the light
+        if (render_data->static_caster()) {
+            static_casters.push_back(render_data);
+            continue;
+        }
+        const BoundingVolume& mesh_volume = object->getMeshBoundingVolume();
+        const BoundingVolume& volume = (mesh_volume.radius() > 0) ?
+                mesh_volume : object->getBoundingVolume();
+        if ((nullptr != view_camera) && !shadowReachesView(view_frustum, volume,
+                light_position, light_direction, perspective, light_far)) {
+            continue;
+        }
+        dynamic_casters.push_back(render_data);
     }
 }
 
@@ -189,20 +475,22 @@ void Renderer::cull(Scene *scene, Camera *camera,
 void Renderer::cullFromCamera(Scene *scene, Camera* camera,
         ShaderManager* shader_manager)
 {
-    std::vector<SceneObject*> scene_objects;
+    // reused across frames so steady state culling does not allocate
+    std::vector<SceneObject*>& scene_objects = scene_objects_vector;
     glm::mat4 view_matrix = camera->getViewMatrix();
     glm::mat4 projection_matrix = camera->getProjectionMatrix();
     glm::mat4 vp_matrix = glm::mat4(projection_matrix * view_matrix);
     glm::vec3 campos(view_matrix[3]);
 
-    scene_objects.reserve(1024);
+    // the prep thread writes to the same objects
+    finishFramePrep();
     scene_objects.clear();
     render_data_vector.clear();
 
     // Travese all scene objects in the scene as a tree and do frustum culling at the same time if enabled
-    // 1. Build the view frustum
+    // 1. Build the view frustum, one that holds both eyes when culling for the rig's center camera
     float frustum[6][4];
-    build_frustum(frustum, (const float*) glm::value_ptr(vp_matrix));
+    buildCullFrustum(scene, camera, vp_matrix, frustum);
 
     // 2. Iteratively execute frustum culling for each root object (as well as its children objects recursively)
     SceneObject *object = scene->getRoot();
@@ -210,24 +498,236 @@ void Renderer::cullFromCamera(Scene *scene, Camera* camera,
         LOGD("FRUSTUM: start frustum culling for root %s\n", object->name().c_str());
     }
     //    frustum_cull(camera->owner_object()->transform()->position(), object, frustum, scene_objects, scene->get_frustum_culling(), 0);
-    frustum_cull(campos, object, frustum, scene_objects, scene->get_frustum_culling(), 0);
+    ScreenSpaceCull screen(screenSpaceCull(scene, camera));
+    long long start = getNanoTime();
+    if (scene->get_flat_culling()) {
+        FlatSceneGraph& flat_graph = scene->getFlatSceneGraph();
+        flat_graph.sync(object);
+        flat_graph.cull(campos, frustum, scene_objects, scene->get_frustum_culling(), screen);
+    } else {
+        frustum_cull(campos, object, frustum, scene_objects, scene->get_frustum_culling(), 0,
+                screen);
+    }
+    cullTime = getNanoTime() - start;
     if (DEBUG_RENDERER) {
         LOGD("FRUSTUM: end frustum culling for root %s\n", object->name().c_str());
     }
-    // 3. do occlusion culling, if enabled
+    // 3. drop what the designated occluders hide, if enabled
+    cpuOccluded = 0;
+    cpuOcclusionTime = 0;
+    if (scene->get_cpu_occlusion_culling()) {
+        cpuOcclusionCull(scene_objects, vp_matrix);
+    }
+
+    // 4. do occlusion culling, if enabled
     occlusion_cull(scene, scene_objects, shader_manager, vp_matrix);
 }
 
+void Renderer::cpuOcclusionCull(const std::vector<SceneObject*>& scene_objects,
+        const glm::mat4& vp_matrix) {
+    long long start = getNanoTime();
+
+    cpuOccluded = cpu_occlusion_culler_.cull(vp_matrix, scene_objects);
+    cpuOcclusionTime = getNanoTime() - start;
+}
+
 
 void Renderer::renderRenderDataVector(RenderState &rstate) {
+    if (instanced_runs_) {
+        for (auto it = draw_runs_.begin(); it != draw_runs_.end(); ++it) {
+            if (it->instanced) {
+                renderRenderDataRun(rstate, it->start, it->end);
+            } else {
+                batch_manager->renderBatches(rstate, it->first_batch, it->end_batch);
+            }
+        }
+        return;
+    }
+    if (do_batching && !gRenderer->isVulkanInstace()) {
+        batch_manager->renderBatches(rstate);
+        return;
+    }
+    renderRenderDataRun(rstate, 0, render_data_vector.size());
+}
 
-    if (!do_batching || gRenderer->isVulkanInstace() ) {
-        for (auto it = render_data_vector.begin();
-                it != render_data_vector.end(); ++it) {
-            GL(renderRenderData(rstate, *it));
+/*
+ * Record render data start to end - 1 and replay them.
+ */
+void Renderer::renderRenderDataRun(RenderState& rstate, int start, int end) {
+    RenderCommandList& commands = frame_commands_;
+    long long time = getNanoTime();
+
+    commands.clear();
+    recordRenderDataVector(rstate, start, end, commands);
+    if (buildPending(rstate)) {
+        commands.discard();
+        time = getNanoTime();
+        recordRenderDataVector(rstate, start, end, commands);
+        pending_builds_.clear();
+    }
+    replayCommands(rstate, commands, time);
+}
+
+void Renderer::recordRenderDataVector(RenderState& rstate, int start, int end,
+        RenderCommandList& commands) {
+    if (rstate.scene->get_instancing() && !gRenderer->isVulkanInstace()) {
+        recordInstanced(rstate, start, end, commands);
+        return;
+    }
+    for (int i = start; i < end; ++i) {
+        recordRenderData(rstate, render_data_vector[i], nullptr, 0, commands);
+    }
+}
+
+/*
+ * Build what the shaders recorded since the last call were missing, on
+ * the thread of the graphics API. Returns false if there was nothing.
+ */
+bool Renderer::buildPending(RenderState& rstate) {
+    if (pending_builds_.empty()) {
+        return false;
+    }
+    for (auto it = pending_builds_.begin(); it != pending_builds_.end(); ++it) {
+        rstate.instance_count = it->instances;
+        try {
+            it->shader->build(&rstate, it->render_data, it->material);
+        } catch (const std::string& error) {
+            LOGE("Error detected in Renderer::buildPending; error : %s", error.c_str());
+        }
+    }
+    rstate.instance_count = 0;
+    pending_builds_.clear();
+    return true;
+}
+
+void Renderer::replayCommands(RenderState& rstate, const RenderCommandList& commands,
+        long long start) {
+    long long recorded = getNanoTime();
+    RenderCommandBackend* backend = rstate.scene->get_null_backend() ?
+            &null_backend_ : commandBackend();
+
+    backend->replay(rstate, commands);
+    commandRecordTime += recorded - start;
+    commandReplayTime += getNanoTime() - recorded;
+    numberRenderCommands += commands.size();
+}
+
+/*
+ * True if rdata can be drawn as an instance of first, the render data
+ * that starts a run: same rendering order, passes and render state.
+ */
+static bool isInstanceOf(RenderData* first, RenderData* rdata) {
+    return rdata->batching() && first->rendering_order() == rdata->rendering_order()
+            && isRenderPassEqual(first, rdata)
+            && first->render_state() == rdata->render_state();
+}
+
+/*
+ * Sorting puts render data with the same passes and render state next
+ * to each other, ordered by distance. Each such run is split by mesh and
+ * every mesh is drawn once, instanced. The transparent queue has to stay
+ * back to front and render data with batching disabled are drawn on
+ * their own.
+ */
+void Renderer::recordInstanced(RenderState& rstate, int start, int end,
+        RenderCommandList& commands) {
+    while (start < end) {
+        RenderData* first = render_data_vector[start];
+        int order = first->rendering_order();
+        int next = start + 1;
+
+        if (first->batching()
+                && !(order >= RenderData::Transparent && order < RenderData::Overlay)) {
+            while ((next < end) && isInstanceOf(first, render_data_vector[next])) {
+                ++next;
+            }
+        }
+        if (next - start == 1) {
+            recordRenderData(rstate, first, nullptr, 0, commands);
+        } else {
+            recordInstanceRun(rstate, start, next, commands);
+        }
+        start = next;
+    }
+}
+
+void Renderer::recordInstanceRun(RenderState& rstate, int start, int end,
+        RenderCommandList& commands) {
+    instance_entries_.clear();
+    for (int i = start; i < end; ++i) {
+        InstanceEntry entry = { render_data_vector[i]->mesh(), i };
+        instance_entries_.push_back(entry);
+    }
+    // by mesh, keeping the distance order within each mesh
+    std::sort(instance_entries_.begin(), instance_entries_.end());
+
+    int count = instance_entries_.size();
+    for (int i = 0; i < count;) {
+        Mesh* mesh = instance_entries_[i].mesh;
+        instance_group_.clear();
+        while ((i < count) && (instance_entries_[i].mesh == mesh)
+                && (instance_group_.size() < MAX_INSTANCES)) {
+            instance_group_.push_back(render_data_vector[instance_entries_[i].index]);
+            ++i;
+        }
+        if (instance_group_.size() == 1) {
+            recordRenderData(rstate, instance_group_[0], nullptr, 0, commands);
+        } else {
+            recordInstances(rstate, instance_group_.data(), instance_group_.size(), commands);
+        }
+    }
+}
+
+void Renderer::recordInstances(RenderState& rstate, RenderData** render_data, int count,
+        RenderCommandList& commands) {
+    RenderData* first = nullptr;
+
+    // the first matrix has to be the one of first, it also goes to u_model;
+    // members without a transform are drawn on their own, as they would
+    // be without instancing
+    instance_matrices_.clear();
+    for (int i = 0; i < count; ++i) {
+        Transform* const t = render_data[i]->owner_object()->transform();
+        if (t == nullptr) {
+            recordRenderData(rstate, render_data[i], nullptr, 0, commands);
+            continue;
+        }
+        if (first == nullptr) {
+            first = render_data[i];
+        }
+        instance_matrices_.push_back(t->getModelMatrix());
+    }
+    if (instance_matrices_.size() == 1) {
+        recordRenderData(rstate, first, nullptr, 0, commands);
+    } else if (first != nullptr) {
+        recordRenderData(rstate, first, instance_matrices_.data(), instance_matrices_.size(),
+                commands);
+    }
+}
+
+void updateObjectMatrices(RenderState& rstate, int usage) {
+    ShaderUniformsPerObject& uniforms = rstate.uniforms;
+
+    if (!(usage & (ShaderBase::USE_MV | ShaderBase::USE_MV_IT | ShaderBase::USE_MVP))) {
+        return;
+    }
+    uniforms.u_mv = uniforms.u_view * uniforms.u_model;
+    if (usage & ShaderBase::USE_MV_IT) {
+        uniforms.u_mv_it = glm::inverseTranspose(uniforms.u_mv);
+    }
+    if (usage & ShaderBase::USE_MVP) {
+        uniforms.u_mvp = uniforms.u_proj * uniforms.u_mv;
+    }
+    if (rstate.is_multiview && !rstate.shadow_map) {
+        for (int eye = 0; eye < 2; ++eye) {
+            uniforms.u_mv_[eye] = uniforms.u_view_[eye] * uniforms.u_model;
+            if (usage & ShaderBase::USE_MV_IT) {
+                uniforms.u_mv_it_[eye] = glm::inverseTranspose(uniforms.u_mv_[eye]);
+            }
+            if (usage & ShaderBase::USE_MVP) {
+                uniforms.u_mvp_[eye] = uniforms.u_proj * uniforms.u_mv_[eye];
+            }
         }
-    } else {
-         batch_manager->renderBatches(rstate);
     }
 }
 
@@ -250,17 +750,19 @@ void Renderer::addRenderData(RenderData *render_data) {
 
 bool Renderer::occlusion_cull_init(Scene* scene, std::vector<SceneObject*>& scene_objects){
 
-    scene->lockColliders();
     scene->clearVisibleColliders();
     bool do_culling = scene->get_occlusion_culling();
     if (!do_culling) {
         for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
             SceneObject *scene_object = (*it);
             RenderData* render_data = scene_object->render_data();
-            addRenderData(render_data);
+            // hidden by the CPU occlusion culler, but still pickable
+            if (!scene_object->isCulled()) {
+                addRenderData(render_data);
+            }
             scene->pick(scene_object);
         }
-        scene->unlockColliders();
+        scene->publishVisibleColliders();
         return false;
     }
 
@@ -362,6 +864,71 @@ void Renderer::build_frustum(float frustum[6][4], const float *vp_matrix) {
     frustum[5][3] /= t;
 }
 
+/*
+ * Corners of the frustum of a view projection matrix in world space.
+ */
+static void frustum_corners(const glm::mat4& vp_matrix, glm::vec3 corners[8]) {
+    glm::mat4 inverse_vp = glm::inverse(vp_matrix);
+
+    for (int i = 0; i < 8; ++i) {
+        glm::vec4 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f,
+                (i & 4) ? 1.0f : -1.0f, 1.0f);
+        glm::vec4 corner = inverse_vp * ndc;
+        corners[i] = glm::vec3(corner) / corner.w;
+    }
+}
+
+/*
+ * Move a frustum plane outwards until all the corners are on its inside.
+ * Returns how far the plane was moved.
+ */
+static float enclose_corners(float plane[4], const glm::vec3 corners[8]) {
+    float shift = 0;
+
+    for (int i = 0; i < 8; ++i) {
+        float distance = plane[0] * corners[i].x + plane[1] * corners[i].y
+                + plane[2] * corners[i].z + plane[3];
+        if (distance < shift) {
+            shift = distance;
+        }
+    }
+    plane[3] -= shift;
+    return -shift;
+}
+
+/*
+ * Build one conservative frustum holding the frusta of both eyes so a
+ * stereo pair can be culled once. Every plane of either eye is pushed out
+ * to contain the other eye's frustum; since the frusta are convex that
+ * plane then bounds both. The left plane comes from the left eye, the
+ * right plane from the right eye, and for the others the candidate that
+ * had to move the least is kept. For the usual parallel eyes only the
+ * left and right planes differ from a single eye's frustum.
+ */
+void Renderer::build_stereo_frustum(float frustum[6][4],
+        const glm::mat4& left_vp_matrix, const glm::mat4& right_vp_matrix) {
+    float left_frustum[6][4];
+    float right_frustum[6][4];
+    glm::vec3 left_corners[8];
+    glm::vec3 right_corners[8];
+
+    build_frustum(left_frustum, (const float*) glm::value_ptr(left_vp_matrix));
+    build_frustum(right_frustum, (const float*) glm::value_ptr(right_vp_matrix));
+    frustum_corners(left_vp_matrix, left_corners);
+    frustum_corners(right_vp_matrix, right_corners);
+
+    for (int p = 0; p < 6; ++p) {
+        float left_shift = enclose_corners(left_frustum[p], right_corners);
+        float right_shift = enclose_corners(right_frustum[p], left_corners);
+        bool use_left = (p == 1) || ((p != 0) && (left_shift <= right_shift));
+        const float* plane = use_left ? left_frustum[p] : right_frustum[p];
+
+        for (int i = 0; i < 4; ++i) {
+            frustum[p][i] = plane[i];
+        }
+    }
+}
+
 
 bool Renderer::isShader3d(const Material* curr_material) {
     bool shaders3d;
@@ -404,18 +971,214 @@ bool Renderer::isDefaultPosition3d(const Material* curr_material) {
 }
 
 void Renderer::renderRenderData(RenderState& rstate, RenderData* render_data) {
+    renderRenderData(rstate, render_data, scratch_commands_);
+}
+
+void Renderer::renderRenderData(RenderState& rstate, RenderData* render_data,
+        RenderCommandList& commands) {
+    long long start = getNanoTime();
+
+    commands.clear();
+    recordRenderData(rstate, render_data, nullptr, 0, commands);
+    if (buildPending(rstate)) {
+        commands.discard();
+        start = getNanoTime();
+        recordRenderData(rstate, render_data, nullptr, 0, commands);
+        pending_builds_.clear();
+    }
+    replayCommands(rstate, commands, start);
+}
+
+void Renderer::renderBatch(RenderState& rstate, RenderData* render_data, int pass,
+        const std::vector<glm::mat4>& matrices, int index_count) {
+    RenderCommandList& commands = scratch_commands_;
+    TextureShader* shader = rstate.shader_manager->getTextureShader();
+    Material* material = rstate.material_override;
+    const RenderStateBlock& state = render_data->render_state();
+    int cull_face = render_data->pass(pass)->cull_face();
+    bool stencil_only = state.stencil_test
+            && (RenderData::Queue::Stencil == render_data->rendering_order());
+    long long start = getNanoTime();
+
+    if (!checkTextureReady(material)) {
+        return;
+    }
+    commands.clear();
+    commands.setState(state, cull_face, stencil_only);
+    try {
+        if (!shader->recordBatch(&rstate, render_data, material, matrices, commands)) {
+            shader->buildBatch(&rstate, render_data);
+            commands.discard();
+            start = getNanoTime();
+            commands.setState(state, cull_face, stencil_only);
+            if (!shader->recordBatch(&rstate, render_data, material, matrices, commands)) {
+                commands.discard();
+                return;
+            }
+        }
+    } catch (const std::string& error) {
+        LOGE("Error detected in Renderer::renderBatch; error : %s", error.c_str());
+        commands.discard();
+        return;
+    }
+    Mesh* mesh = render_data->mesh();
+    commands.draw(mesh, render_data->draw_mode(), index_count, mesh->indexType(), -1, 0, -1,
+            false);
+    replayCommands(rstate, commands, start);
+}
+
+/*
+ * Every pass sets its complete state, so nothing is restored afterwards;
+ * unchanged state is filtered out by the backend.
+ */
+void Renderer::recordRenderData(RenderState& rstate, RenderData* render_data,
+        const glm::mat4* instance_matrices, int instance_count,
+        RenderCommandList& commands) {
     if (!(rstate.render_mask & render_data->render_mask()))
         return;
+    if (render_data->mesh() == 0)
+        return;
+
+    const RenderStateBlock& state = render_data->render_state();
+    bool stencil_only = state.stencil_test
+            && (RenderData::Queue::Stencil == render_data->rendering_order());
+    int instances = (instance_count > 0) ? instance_count : 1;
+    int first_matrix = (instance_count > 0) ?
+            commands.addMatrices(instance_matrices, instance_count) : -1;
+
+    for (int curr_pass = 0; curr_pass < render_data->pass_count(); ++curr_pass) {
+        numberTriangles += render_data->mesh()->getNumTriangles() * instances;
+        numberDrawCalls++;
+
+        commands.setState(state, render_data->pass(curr_pass)->cull_face(), stencil_only);
+        Material* curr_material = rstate.material_override;
+
+        if (curr_material == nullptr)
+            curr_material = render_data->pass(curr_pass)->material();
+        if (curr_material != nullptr) {
+            recordPass(rstate, render_data, curr_material, first_matrix, instance_count,
+                    commands);
+        }
+    }
+}
+
+void Renderer::recordPass(RenderState& rstate, RenderData* render_data, Material* material,
+        int first_matrix, int instances, RenderCommandList& commands) {
+    if (Material::ShaderType::BEING_GENERATED == material->shader_type()) {
+        return;
+    }
+    //Skip the material whose texture is not ready with some exceptions
+    if (!checkTextureReady(material))
+        return;
+    Transform* const t = render_data->owner_object()->transform();
+    if (t == nullptr)
+        return;
+
+    rstate.uniforms.u_right = rstate.render_mask & RenderData::RenderMaskBit::Right;
+    ShaderBase* shader = selectShader(rstate.shader_manager, material);
+    bool error = (shader == nullptr);
+    if (error) {
+        LOGE("Rendering error: GVRRenderData shader cannot be determined\n");
+        shader = rstate.shader_manager->getErrorShader();
+    }
+    // skipped until its program is built, like a material whose shader
+    // is still being generated
+    if (!shader->prepare(rstate.shader_manager) || !shader->texturesReady(material)) {
+        return;
+    }
+    int mode = render_data->draw_mode();
+    if ((mode == GL_LINE_STRIP) || (mode == GL_LINES) || (mode == GL_LINE_LOOP)) {
+        commands.lineWidth(material->hasUniform("line_width") ?
+                material->getFloat("line_width") : 1.0f);
+    }
+    rstate.uniforms.u_model = t->getModelMatrix();
+    rstate.instance_count = instances;
+    ShaderBase* drawn = recordShader(rstate, shader, render_data, material, commands);
+    rstate.instance_count = 0;
+
+    // there is no program for the external renderer, it draws by itself
+    if ((drawn == nullptr) || error || (drawn->getProgramId() == static_cast<GLuint>(-1))) {
+        return;
+    }
+    Mesh* mesh = render_data->mesh();
+    int count = mesh->vertices().size();
+    int index_type = 0;
+    if (mesh->indices().size() > 0) {
+        count = mesh->indices().size();
+        index_type = mesh->indexType();
+    }
+    GLint location = drawn->instanceMatrixLocation();
+    if (location >= 0) {
+        if (first_matrix < 0) {
+            first_matrix = commands.addMatrices(&rstate.uniforms.u_model, 1);
+            instances = 1;
+        }
+        commands.draw(mesh, mode, count, index_type, first_matrix, instances, location,
+                drawn->skinned());
+        return;
+    }
+    commands.draw(mesh, mode, count, index_type, -1, 0, -1, drawn->skinned());
+
+    // a program without instance matrices draws the others one by one
+    for (int i = 1; i < instances; ++i) {
+        rstate.uniforms.u_model = commands.matrices(first_matrix)[i];
+        updateObjectMatrices(rstate, drawn->matrixUsage());
+        if (!drawn->record(&rstate, render_data, material, commands)) {
+            return;
+        }
+        commands.draw(mesh, mode, count, index_type, -1, 0, -1, drawn->skinned());
+        numberDrawCalls++;
+    }
+}
+
+/*
+ * Record the program and uniforms of shader, or of the error shader if
+ * that fails. Returns the shader recorded, nullptr if it has to be built
+ * first.
+ */
+ShaderBase* Renderer::recordShader(RenderState& rstate, ShaderBase* shader,
+        RenderData* render_data, Material* material, RenderCommandList& commands) {
+    updateObjectMatrices(rstate, shader->matrixUsage());
+    try {
+        if (shader->record(&rstate, render_data, material, commands)) {
+            return shader;
+        }
+    } catch (const std::string& error) {
+        LOGE("Error detected in Renderer::renderRenderData; name : %s, error : %s",
+             render_data->owner_object()->name().c_str(), error.c_str());
+        shader = rstate.shader_manager->getErrorShader();
+        updateObjectMatrices(rstate, shader->matrixUsage());
+        if (shader->record(&rstate, render_data, material, commands)) {
+            return shader;
+        }
+    }
+    PendingBuild build = { shader, render_data, material, rstate.instance_count };
+    pending_builds_.push_back(build);
+    return nullptr;
+}
+
+/*
+ * Shader of a material. Builtin shaders are built on first use, the
+ * others come from the custom shaders of the shader manager.
+ */
+ShaderBase* Renderer::selectShader(ShaderManager* shader_manager, Material* material) {
+    try {
+        return shader_manager->getShader(material->shader_type());
+    } catch (const std::string& error) {
+        LOGE("Error detected in Renderer::selectShader; error : %s", error.c_str());
+        return nullptr;
+    }
+}
+
+bool Renderer::checkTextureReady(Material* material) {
+    int shaderType = material->shader_type();
 
-    // Set the states
-    setRenderStates(render_data, rstate);
-    if (render_data->mesh() != 0) {
-        GL(renderMesh(rstate, render_data));
+    //Skip custom shader here since they are rendering multiple textures
+    //Check the textures later inside the rendering pass inside the custom shader
+    if (shaderType < 0 || shaderType >= Material::ShaderType::BUILTIN_SHADER_SIZE) {
+        return true;
     }
-    // Restoring to Default.
-    // TODO: There's a lot of redundant state changes. If on every render face culling is being set there's no need to
-    // restore defaults. Possibly later we could add a OpenGL state wrapper to avoid redundant api calls.
-    restoreRenderStates(render_data);
+    return material->isMainTextureReady();
 }
 
 void Renderer::renderPostEffectData(Camera* camera,
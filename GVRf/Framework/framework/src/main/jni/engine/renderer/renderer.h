@@ -33,6 +33,11 @@
 #include "gl/gl_program.h"
 #include <unordered_map>
 #include "batch_manager.h"
+#include "render_sorter.h"
+#include "cpu_occlusion_culler.h"
+#include "render_commands.h"
+#include "frame_prep.h"
+#include "screen_space_cull.h"
 
 typedef unsigned long Long;
 namespace gvr {
@@ -45,8 +50,13 @@ class PostEffectShaderManager;
 class RenderData;
 class RenderTarget;
 class RenderTexture;
+class ShadowMap;
 class ShaderManager;
 class Light;
+class GLStateCache;
+class GLUniformRing;
+class GLLightBlocks;
+class ShaderBase;
 
 /*
  * These uniforms are commonly used in shaders.
@@ -81,13 +91,27 @@ struct RenderState {
     ShaderManager*          shader_manager;
     bool                    shadow_map;
     bool                    is_multiview;
+    GLStateCache*           gl_state;   // set by the GL renderer for each pass
+    GLUniformRing*          uniform_ring;
+    GLLightBlocks*          light_blocks;   // set by the GL renderer for each pass
+    int                     instance_count;     // 0 unless recording instances
 };
 
+/*
+ * Compute the per object matrices in usage, a ShaderBase::MatrixUsage
+ * mask, from u_model and the per view matrices of the pass.
+ */
+void updateObjectMatrices(RenderState& rstate, int usage);
+
 class Renderer {
 public:
     void resetStats() {
         numberDrawCalls = 0;
         numberTriangles = 0;
+        numberGLCallsAvoided = 0;
+        numberRenderCommands = 0;
+        commandRecordTime = 0;
+        commandReplayTime = 0;
     }
     bool isVulkanInstace(){
         return isVulkan_;
@@ -95,6 +119,15 @@ public:
     void freeBatch(Batch* batch){
         batch_manager->freeBatch(batch);
     }
+    /*
+     * Vertex and index budget of the batches this renderer merges meshes
+     * into. Indices are 32 bit, so budgets above 65535 vertices work.
+     */
+    void setBatchBudget(int max_vertices, int max_indices){
+        if (nullptr != batch_manager) {
+            batch_manager->setBudget(max_vertices, max_indices);
+        }
+    }
     int getNumberDrawCalls() {
         return numberDrawCalls;
     }
@@ -108,6 +141,105 @@ public:
      int incrementDrawCalls(){
         return ++numberDrawCalls;
      }
+     void incrementBatchUploadBytes(int bytes) {
+        batchUploadBytes += bytes;
+     }
+     /*
+      * Bytes batches wrote to their vertex and index buffers this frame.
+      * Cleared when culling, like the cull time.
+      */
+     int getBatchUploadBytes() {
+        return batchUploadBytes;
+     }
+     /*
+      * GL state calls skipped because they would not have changed anything.
+      */
+     int getNumberGLCallsAvoided() {
+        return numberGLCallsAvoided;
+     }
+     /*
+      * Time spent in the last frustum culling pass, in nanoseconds.
+      * Not cleared by resetStats since culling runs once per frame
+      * while the stats are reset for every camera.
+      */
+     long long getCullTime() {
+        return cullTime;
+     }
+     /*
+      * Time spent sorting the render data of the last cull, in nanoseconds.
+      */
+     long long getSortTime() {
+        return sortTime;
+     }
+     /*
+      * Heap allocations made by the last cull and sort, or -1 when built
+      * without GVR_COUNT_ALLOCATIONS.
+      */
+     int getCullAllocations() {
+        return cullAllocations;
+     }
+     /*
+      * Objects the CPU occlusion culler removed in the last cull and the
+      * time it took, in nanoseconds.
+      */
+     int getCpuOccluded() {
+        return cpuOccluded;
+     }
+     long long getCpuOcclusionTime() {
+        return cpuOcclusionTime;
+     }
+     /*
+      * GPU occlusion queries issued in the last frame, queries whose
+      * result was not ready when culling wanted it and the average age
+      * in frames of the results that were.
+      */
+     int getOcclusionQueries() {
+        return occlusionQueries;
+     }
+     int getOcclusionStalls() {
+        return occlusionStalls;
+     }
+     float getOcclusionLatency() {
+        return occlusionLatency;
+     }
+     /*
+      * Render commands recorded for the last camera and the time spent
+      * recording and replaying them, in nanoseconds.
+      */
+     int getNumberRenderCommands() {
+        return numberRenderCommands;
+     }
+     long long getCommandRecordTime() {
+        return commandRecordTime;
+     }
+     long long getCommandReplayTime() {
+        return commandReplayTime;
+     }
+     /*
+      * Time the GL thread spent on pipelined frame preparation in the
+      * last frame: taking the snapshot and waiting for the prep thread,
+      * in nanoseconds.
+      */
+     long long getFramePrepSnapshotTime() {
+        return (frame_prep_ != nullptr) ? frame_prep_->snapshotTime() : 0;
+     }
+     long long getFramePrepWaitTime() {
+        return (frame_prep_ != nullptr) ? frame_prep_->waitTime() : 0;
+     }
+     /*
+      * Shadow casters drawn into shadow maps in the last frame, the
+      * shadow maps that were drawn and the ones that kept their shadows
+      * from an earlier frame.
+      */
+     int getShadowCasters() {
+        return shadowCasters;
+     }
+     int getShadowMapsUpdated() {
+        return shadowMapsUpdated;
+     }
+     int getShadowMapsSkipped() {
+        return shadowMapsSkipped;
+     }
      static Renderer* getInstance(const char* type = " ");
      static void resetInstance(){
         delete instance;
@@ -117,7 +249,23 @@ public:
      virtual void renderRenderDataVector(RenderState &rstate);
      virtual void cull(Scene *scene, Camera *camera,
             ShaderManager* shader_manager);
+     /*
+      * Wait for the frame being prepared in the background, if any.
+      * Has to be called before the scene is changed again.
+      */
+     void finishFramePrep();
+     /*
+      * Record the render data on its own and replay it right away.
+      */
      virtual void renderRenderData(RenderState& rstate, RenderData* render_data);
+     void renderRenderData(RenderState& rstate, RenderData* render_data,
+             RenderCommandList& commands);
+     /*
+      * Draw one pass of a batch, the merged meshes of render_data with the
+      * model matrices of the render data that went into it.
+      */
+     void renderBatch(RenderState& rstate, RenderData* render_data, int pass,
+             const std::vector<glm::mat4>& matrices, int index_count);
 
 
      virtual void renderCamera(Scene* scene, Camera* camera,
@@ -147,20 +295,44 @@ public:
             RenderTexture* post_effect_render_texture_b, bool) = 0;
     virtual void cullFromCamera(Scene *scene, Camera *camera,
                                 ShaderManager* shader_manager);
-    virtual void restoreRenderStates(RenderData* render_data) = 0;
     virtual void setRenderStates(RenderData* render_data, RenderState& rstate) = 0;
     virtual void cullAndRender(RenderTarget* renderTarget, Scene* scene,
                         ShaderManager* shader_manager, PostEffectShaderManager* post_effect_shader_manager,
                         RenderTexture* post_effect_render_texture_a,
                         RenderTexture* post_effect_render_texture_b) = 0;
     virtual void makeShadowMaps(Scene* scene, ShaderManager* shader_manager) = 0;
+    /*
+     * Draw the casters of one light into its shadow map, if it is due.
+     */
+    virtual void renderShadowMap(ShadowMap* shadow_map, Scene* scene,
+            ShaderManager* shader_manager) = 0;
 
 private:
     static bool isVulkan_;
     virtual void build_frustum(float frustum[6][4], const float *vp_matrix);
+    void build_stereo_frustum(float frustum[6][4], const glm::mat4& left_vp_matrix,
+            const glm::mat4& right_vp_matrix);
+    void buildCullFrustum(Scene* scene, Camera* camera, const glm::mat4& vp_matrix,
+            float frustum[6][4]);
+    void pipelinedCull(Scene* scene, Camera* camera, ShaderManager* shader_manager);
+    void setupBatches(Scene* scene, ShaderManager* shader_manager);
+    bool isInstanceable(ShaderManager* shader_manager, RenderData* render_data);
     virtual void frustum_cull(glm::vec3 camera_position, SceneObject *object,
             float frustum[6][4], std::vector<SceneObject*>& scene_objects,
-            bool continue_cull, int planeMask);
+            bool continue_cull, int planeMask, const ScreenSpaceCull& screen);
+    ScreenSpaceCull screenSpaceCull(Scene* scene, Camera* camera);
+
+    void renderRenderDataRun(RenderState& rstate, int start, int end);
+    void recordInstanced(RenderState& rstate, int start, int end, RenderCommandList& commands);
+    void recordInstanceRun(RenderState& rstate, int start, int end,
+            RenderCommandList& commands);
+    void recordRenderDataVector(RenderState& rstate, int start, int end,
+            RenderCommandList& commands);
+    void recordPass(RenderState& rstate, RenderData* render_data, Material* material,
+            int first_matrix, int instances, RenderCommandList& commands);
+    ShaderBase* recordShader(RenderState& rstate, ShaderBase* shader,
+            RenderData* render_data, Material* material, RenderCommandList& commands);
+    bool buildPending(RenderState& rstate);
 
     virtual bool isShader3d(const Material* curr_material);
     virtual bool isDefaultPosition3d(const Material* curr_material);
@@ -175,16 +347,58 @@ private:
 protected:
     Renderer();
     virtual ~Renderer(){
+        delete frame_prep_;
         delete batch_manager;
     }
     virtual void state_sort();
-    virtual void renderMesh(RenderState& rstate, RenderData* render_data) = 0;
-    virtual void renderMaterialShader(RenderState& rstate, RenderData* render_data, Material *material) = 0;
+    /*
+     * Append the commands drawing every pass of render_data, as instances
+     * with the given model matrices if there are any. Recording does not
+     * touch the graphics API: shaders that still have to build something
+     * are noted in pending_builds_ and skipped.
+     */
+    void recordRenderData(RenderState& rstate, RenderData* render_data,
+            const glm::mat4* instance_matrices, int instance_count,
+            RenderCommandList& commands);
+    /*
+     * Draw count render datas that share a mesh, passes and render state
+     * as instances of the first one.
+     */
+    void recordInstances(RenderState& rstate, RenderData** render_data, int count,
+            RenderCommandList& commands);
+    /*
+     * Replay commands with the backend of this renderer, or the null
+     * backend if the scene asks for it. start is when recording began.
+     */
+    void replayCommands(RenderState& rstate, const RenderCommandList& commands,
+            long long start);
+    /*
+     * The backend replaying what this renderer records.
+     */
+    virtual RenderCommandBackend* commandBackend() {
+        return &null_backend_;
+    }
+    ShaderBase* selectShader(ShaderManager* shader_manager, Material* material);
+    bool checkTextureReady(Material* material);
     virtual void occlusion_cull(Scene* scene,
                 std::vector<SceneObject*>& scene_objects,
                 ShaderManager *shader_manager, glm::mat4 vp_matrix) = 0;
     void addRenderData(RenderData *render_data);
+    /*
+     * Mark the objects hidden behind the occluders among them culled.
+     * They are not drawn but stay in the list to be picked.
+     */
+    void cpuOcclusionCull(const std::vector<SceneObject*>& scene_objects,
+            const glm::mat4& vp_matrix);
     virtual bool occlusion_cull_init(Scene* scene, std::vector<SceneObject*>& scene_objects);
+    /*
+     * Collect the shadow casters the light camera sees. Dynamic casters
+     * are also dropped when they cannot throw a shadow into the view of
+     * the main camera rig; static ones are kept for the cache.
+     */
+    void cullShadowCasters(Scene* scene, Camera* light_camera,
+            std::vector<RenderData*>& static_casters,
+            std::vector<RenderData*>& dynamic_casters);
 
     virtual void
             renderPostEffectData(Camera* camera,
@@ -192,8 +406,69 @@ protected:
             PostEffectShaderManager* post_effect_shader_manager);
 
     std::vector<RenderData*> render_data_vector;
+    std::vector<SceneObject*> scene_objects_vector;
     int numberDrawCalls;
     int numberTriangles;
+    int numberGLCallsAvoided;
+    long long cullTime;
+    long long sortTime;
+    int cullAllocations;
+    int batchUploadBytes;
+    int cpuOccluded;
+    long long cpuOcclusionTime;
+    int occlusionQueries;
+    int occlusionStalls;
+    float occlusionLatency;
+    int numberRenderCommands;
+    long long commandRecordTime;
+    long long commandReplayTime;
+    int shadowCasters;
+    int shadowMapsUpdated;
+    int shadowMapsSkipped;
+    RenderSorter render_sorter_;
+    CpuOcclusionCuller cpu_occlusion_culler_;
+
+    RenderCommandList frame_commands_;      // the render data vector of a pass
+    RenderCommandList scratch_commands_;    // single render data drawn right away
+    NullCommandBackend null_backend_;
+    std::vector<glm::mat4> instance_matrices_;
+
+    // shaders that could not be recorded until they are built
+    struct PendingBuild {
+        ShaderBase* shader;
+        RenderData* render_data;
+        Material* material;
+        int instances;
+    };
+    std::vector<PendingBuild> pending_builds_;
+    FramePrep* frame_prep_;     // created the first time a scene asks for it
+    std::vector<SceneObject*> shadow_objects_;
+    std::vector<RenderData*> static_casters_;
+    std::vector<RenderData*> dynamic_casters_;
+
+    // reused by recordInstanced to group a run of render data by mesh
+    struct InstanceEntry {
+        Mesh* mesh;
+        int index;
+
+        bool operator<(const InstanceEntry& other) const {
+            return (mesh != other.mesh) ? (mesh < other.mesh) : (index < other.index);
+        }
+    };
+    std::vector<InstanceEntry> instance_entries_;
+    std::vector<RenderData*> instance_group_;
+
+    // runs of the render data vector drawn instanced or from the batches
+    // between first_batch and end_batch, set up by the cull
+    struct DrawRun {
+        int start;
+        int end;
+        int first_batch;
+        int end_batch;
+        bool instanced;
+    };
+    std::vector<DrawRun> draw_runs_;
+    bool instanced_runs_ = false;     // whether draw_runs_ replace the batches
     bool useStencilBuffer_ = false;
 
 public:
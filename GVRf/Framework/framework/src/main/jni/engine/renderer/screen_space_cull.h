@@ -0,0 +1,103 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Projected size of bounding volumes for LOD selection and small feature
+ * culling.
+ ***************************************************************************/
+
+#ifndef SCREEN_SPACE_CULL_H_
+#define SCREEN_SPACE_CULL_H_
+
+#include <cfloat>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+
+/*
+ * What culling from a camera needs to know to tell how large an object
+ * appears on screen. The default is inactive: culling for shadow maps
+ * keeps the LOD levels the camera picked and drops nothing for its size.
+ */
+struct ScreenSpaceCull {
+    ScreenSpaceCull() :
+            projection_scale(0.0f), orthographic(false),
+            viewport_height(0), min_pixels(0.0f) {
+    }
+
+    ScreenSpaceCull(const glm::mat4& projection, int height, float pixels) :
+            projection_scale(projection[1][1]),
+            orthographic(projection[2][3] == 0.0f),
+            viewport_height(height), min_pixels(pixels) {
+    }
+
+    bool active() const {
+        return projection_scale > 0.0f;
+    }
+
+    /*
+     * Fraction of the viewport height covered by the sphere, FLT_MAX when
+     * the camera is inside it.
+     */
+    float screenSize(const glm::vec3& camera_position, const glm::vec3& center,
+            float radius) const {
+        if (orthographic) {
+            return radius * projection_scale;
+        }
+        float distance = glm::length(center - camera_position);
+        return (distance > radius) ? radius * projection_scale / distance : FLT_MAX;
+    }
+
+    /*
+     * Camera distance and screen size of the sphere around the box.
+     * Returns false for an empty box.
+     */
+    bool measure(const glm::vec3& camera_position, const glm::vec3& min_corner,
+            const glm::vec3& max_corner, float& distance, float& screen_size) const {
+        if (!(min_corner.x <= max_corner.x)) {
+            return false;
+        }
+        glm::vec3 center(0.5f * (min_corner + max_corner));
+        float radius = 0.5f * glm::length(max_corner - min_corner);
+        distance = glm::length(center - camera_position);
+        screen_size = screenSize(camera_position, center, radius);
+        return true;
+    }
+
+    /*
+     * Whether the box covers fewer than min_pixels rows of the viewport.
+     * Empty boxes are never too small.
+     */
+    bool tooSmall(const glm::vec3& camera_position, const glm::vec3& min_corner,
+            const glm::vec3& max_corner) const {
+        float distance;
+        float screen_size;
+
+        if ((min_pixels <= 0.0f) || (viewport_height <= 0) || !measure(camera_position,
+                min_corner, max_corner, distance, screen_size)) {
+            return false;
+        }
+        return screen_size * viewport_height < min_pixels;
+    }
+
+    float projection_scale;     // element [1][1] of the projection matrix
+    bool orthographic;
+    int viewport_height;        // in pixels
+    float min_pixels;           // small feature culling threshold, 0 disables it
+};
+
+}
+#endif
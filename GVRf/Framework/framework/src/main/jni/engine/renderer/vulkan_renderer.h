@@ -83,18 +83,16 @@ public:
              PostEffectShaderManager* post_effect_shader_manager,
              RenderTexture* post_effect_render_texture_a,
              RenderTexture* post_effect_render_texture_b, bool){}
-    void restoreRenderStates(RenderData* render_data){}
     void setRenderStates(RenderData* render_data, RenderState& rstate){}
     virtual void cullAndRender(RenderTarget* renderTarget, Scene* scene,
                         ShaderManager* shader_manager, PostEffectShaderManager* post_effect_shader_manager,
                         RenderTexture* post_effect_render_texture_a,
                         RenderTexture* post_effect_render_texture_b) {};
     void makeShadowMaps(Scene* scene, ShaderManager* shader_manager){}
+    void renderShadowMap(ShadowMap* shadow_map, Scene* scene, ShaderManager* shader_manager){}
     void set_face_culling(int cull_face){}
 
 private:
-    void renderMesh(RenderState& rstate, RenderData* render_data){}
-    void renderMaterialShader(RenderState& rstate, RenderData* render_data, Material *material){}
     void occlusion_cull(Scene* scene,
                 std::vector<SceneObject*>& scene_objects,
                 ShaderManager *shader_manager, glm::mat4 vp_matrix){}
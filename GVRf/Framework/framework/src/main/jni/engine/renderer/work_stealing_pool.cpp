@@ -0,0 +1,140 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Small work-stealing thread pool for per-frame parallel loops.
+ ***************************************************************************/
+
+#include "work_stealing_pool.h"
+
+namespace gvr {
+
+WorkStealingPool::WorkStealingPool(int thread_count) :
+        task_(nullptr), generation_(0), remaining_(0), quit_(false) {
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+    for (int i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::unique_ptr<Queue>(new Queue()));
+        queues_.back()->head = 0;
+        queues_.back()->tail = 0;
+    }
+    for (int i = 1; i < thread_count; ++i) {
+        threads_.push_back(std::thread(&WorkStealingPool::workerMain, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    for (auto it = threads_.begin(); it != threads_.end(); ++it) {
+        it->join();
+    }
+}
+
+void WorkStealingPool::run(int count, const Task& task) {
+    int workers = queues_.size();
+
+    if (count <= 0) {
+        return;
+    }
+    if (workers == 1) {
+        for (int i = 0; i < count; ++i) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    // publish the task before any index becomes visible to a thief
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        task_ = &task;
+        remaining_ = count;
+    }
+    for (int w = 0; w < workers; ++w) {
+        Queue& queue = *queues_[w];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.head = w * count / workers;
+        queue.tail = (w + 1) * count / workers;
+    }
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(lock_);
+    done_.wait(lock, [this]() { return remaining_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkStealingPool::workerMain(int worker) {
+    unsigned int seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            wake_.wait(lock, [this, seen]() {
+                return quit_ || (generation_ != seen);
+            });
+            if (quit_) {
+                return;
+            }
+            seen = generation_;
+        }
+        drain(worker);
+    }
+}
+
+void WorkStealingPool::drain(int worker) {
+    int task;
+
+    while (popOrSteal(worker, task)) {
+        (*task_)(task, worker);
+        if (--remaining_ == 0) {
+            std::lock_guard<std::mutex> lock(lock_);
+            done_.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::popOrSteal(int worker, int& task) {
+    int workers = queues_.size();
+
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (own.head < own.tail) {
+            task = own.head++;
+            return true;
+        }
+    }
+    for (int i = 1; i < workers; ++i) {
+        Queue& victim = *queues_[(worker + i) % workers];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (victim.head < victim.tail) {
+            task = --victim.tail;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,87 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Small work-stealing thread pool for per-frame parallel loops.
+ ***************************************************************************/
+
+#ifndef WORK_STEALING_POOL_H_
+#define WORK_STEALING_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gvr {
+
+/*
+ * Runs a batch of indexed tasks on a fixed set of threads. The thread
+ * calling run() is worker 0 and takes part in the work, so a pool of
+ * N threads starts N - 1 background threads.
+ *
+ * Tasks are handed out as contiguous blocks, one per worker. A worker
+ * takes tasks from the front of its own block and, once that is empty,
+ * steals from the back of the others'. Running a batch does not allocate.
+ */
+class WorkStealingPool {
+public:
+    typedef std::function<void(int task, int worker)> Task;
+
+    explicit WorkStealingPool(int thread_count);
+    ~WorkStealingPool();
+
+    int threadCount() const {
+        return queues_.size();
+    }
+
+    /*
+     * Call task(i, worker) for every i in [0, count) and return when
+     * all of them are done. Must not be called from inside a task.
+     */
+    void run(int count, const Task& task);
+
+private:
+    WorkStealingPool(const WorkStealingPool&);
+    WorkStealingPool& operator=(const WorkStealingPool&);
+
+    // tasks [head, tail) of the current run; the owner takes from the
+    // head and thieves from the tail
+    struct Queue {
+        std::mutex lock;
+        int head;
+        int tail;
+    };
+
+    void workerMain(int worker);
+    void drain(int worker);
+    bool popOrSteal(int worker, int& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const Task* task_;
+    unsigned int generation_;
+    std::atomic<int> remaining_;
+    bool quit_;
+};
+
+}
+#endif
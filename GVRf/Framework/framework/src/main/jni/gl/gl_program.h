@@ -22,9 +22,11 @@
 
 #include <string>
 #include "gl/gl_headers.h"
+#include "gl/gl_program_cache.h"
 
 #include "util/gvr_log.h"
 #include "util/gvr_gl.h"
+#include "util/gvr_time.h"
 
 namespace gvr {
 class GLProgram {
@@ -91,6 +93,16 @@ public:
             const GLint* pVertexSourceStringLengths,
             const char** pFragmentSourceStrings,
             const GLint* pFragmentSourceStringLengths) {
+        long long start = getNanoTime();
+        unsigned long long key = GLProgramCache::key(strLength, pVertexSourceStrings,
+                pVertexSourceStringLengths, pFragmentSourceStrings,
+                pFragmentSourceStringLengths);
+        GLuint cached = GLProgramCache::load(key);
+        if (cached) {
+            GLProgramCache::countProgram(true, getNanoTime() - start);
+            return cached;
+        }
+
         GLuint vertexShader = loadShader(GL_VERTEX_SHADER, strLength,
                 pVertexSourceStrings, pVertexSourceStringLengths);
         if (!vertexShader) {
@@ -118,6 +130,10 @@ public:
             glAttachShader(program, pixelShader);
             checkGLError("glAttachShader");
 
+            bool retrievable = GLProgramCache::enabled();
+            if (retrievable) {
+                glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            }
             glLinkProgram(program);
             GLint linkStatus = GL_FALSE;
             glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
@@ -134,6 +150,11 @@ public:
                 }
                 glDeleteProgram(program);
                 program = 0;
+            } else {
+                if (retrievable) {
+                    GLProgramCache::store(key, program);
+                }
+                GLProgramCache::countProgram(false, getNanoTime() - start);
             }
         }
         return program;
@@ -0,0 +1,265 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Linked GL programs saved to disk between runs.
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gl_program_cache.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+static const unsigned int CACHE_MAGIC = 0x50525647;  // "GVRP"
+static const unsigned int CACHE_VERSION = 1;
+static const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+static const unsigned long long FNV_PRIME = 1099511628211ULL;
+// far beyond any real program, keeps a garbage header from allocating
+static const unsigned int MAX_BINARY_LENGTH = 16 * 1024 * 1024;
+
+struct CacheHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned long long key;
+    unsigned int format;
+    unsigned int length;
+    unsigned long long checksum;
+};
+
+// programs may be built on the GL thread and by GLProgramCompiler
+static std::mutex cache_lock;
+static std::string directory;
+static std::string driver;
+static int binary_formats = -1;
+
+static int compiled_programs = 0;
+static int cached_programs = 0;
+static long long compile_time = 0;
+static long long load_time = 0;
+
+static unsigned long long hash(unsigned long long h, const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    for (size_t i = 0; i < length; ++i) {
+        h = (h ^ bytes[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+static unsigned long long hashSources(unsigned long long h, int count,
+        const char** sources, const GLint* lengths) {
+    for (int i = 0; i < count; ++i) {
+        size_t length = (lengths != nullptr && lengths[i] >= 0) ? lengths[i] : strlen(sources[i]);
+        h = hash(h, sources[i], length);
+    }
+    // keep "ab" + "c" apart from "a" + "bc"
+    return hash(h, "\n", 1);
+}
+
+static std::string cacheDirectory() {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    return directory;
+}
+
+static std::string cachePath(const std::string& dir, unsigned long long key) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", key);
+    return dir + name;
+}
+
+static void discard(const std::string& path, const char* reason) {
+    LOGW("GLProgramCache: discarding %s, %s", path.c_str(), reason);
+    unlink(path.c_str());
+}
+
+void GLProgramCache::setDirectory(const std::string& dir) {
+    if (!dir.empty() && (mkdir(dir.c_str(), 0700) != 0) && (errno != EEXIST)) {
+        LOGE("GLProgramCache: cannot create %s, errno %d", dir.c_str(), errno);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(cache_lock);
+    directory = dir;
+}
+
+bool GLProgramCache::enabled() {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    if (binary_formats < 0) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binary_formats = formats;
+        if (formats == 0) {
+            LOGW("GLProgramCache: the driver has no program binary formats");
+        }
+    }
+    return (binary_formats > 0) && !directory.empty();
+}
+
+unsigned long long GLProgramCache::key(int count, const char** vertex_sources,
+        const GLint* vertex_lengths, const char** fragment_sources,
+        const GLint* fragment_lengths) {
+    std::unique_lock<std::mutex> lock(cache_lock);
+    if (driver.empty()) {
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (int i = 0; i < 3; ++i) {
+            const char* value = reinterpret_cast<const char*>(glGetString(names[i]));
+            if (value != nullptr) {
+                driver += value;
+            }
+            driver += '\n';
+        }
+    }
+    unsigned long long h = hash(FNV_OFFSET, driver.data(), driver.size());
+    lock.unlock();
+    h = hashSources(h, count, vertex_sources, vertex_lengths);
+    return hashSources(h, count, fragment_sources, fragment_lengths);
+}
+
+GLuint GLProgramCache::load(unsigned long long key) {
+    if (!enabled()) {
+        return 0;
+    }
+    std::string path = cachePath(cacheDirectory(), key);
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return 0;
+    }
+
+    CacheHeader header;
+    std::vector<char> binary;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1;
+    valid = valid && (header.magic == CACHE_MAGIC) && (header.version == CACHE_VERSION)
+            && (header.key == key) && (header.length > 0)
+            && (header.length <= MAX_BINARY_LENGTH);
+
+    // the binary has to fill the rest of the file, check before allocating
+    if (valid) {
+        long start = ftell(file);
+        valid = (fseek(file, 0, SEEK_END) == 0)
+                && (ftell(file) - start == static_cast<long>(header.length))
+                && (fseek(file, start, SEEK_SET) == 0);
+    }
+    if (valid) {
+        binary.resize(header.length);
+        valid = fread(&binary[0], 1, header.length, file) == header.length;
+    }
+    fclose(file);
+    if (!valid || (hash(FNV_OFFSET, &binary[0], binary.size()) != header.checksum)) {
+        discard(path, "the file is corrupt");
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    GLint status = GL_FALSE;
+    glProgramBinary(program, header.format, &binary[0], header.length);
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        glDeleteProgram(program);
+        discard(path, "the driver rejected it");
+        return 0;
+    }
+    return program;
+}
+
+void GLProgramCache::store(unsigned long long key, GLuint program) {
+    std::string dir = cacheDirectory();
+    GLint length = 0;
+
+    if (dir.empty()) {
+        return;
+    }
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    CacheHeader header;
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, &binary[0]);
+    if (written <= 0) {
+        return;
+    }
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = written;
+    header.checksum = hash(FNV_OFFSET, &binary[0], written);
+
+    // write a temporary file and rename it, so a crash cannot leave a
+    // partial binary under the real name. The name is unique to the
+    // process and thread, as two threads may store the same program.
+    std::string path = cachePath(dir, key);
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), ".%d.%zx.tmp", static_cast<int>(getpid()),
+            std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::string temp = path + suffix;
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (file == nullptr) {
+        LOGW("GLProgramCache: cannot write %s, errno %d", temp.c_str(), errno);
+        return;
+    }
+    bool ok = (fwrite(&header, sizeof(header), 1, file) == 1)
+            && (fwrite(&binary[0], 1, written, file) == static_cast<size_t>(written));
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || (rename(temp.c_str(), path.c_str()) != 0)) {
+        LOGW("GLProgramCache: cannot write %s", path.c_str());
+        unlink(temp.c_str());
+    }
+}
+
+void GLProgramCache::countProgram(bool cached, long long time) {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    if (cached) {
+        ++cached_programs;
+        load_time += time;
+    } else {
+        ++compiled_programs;
+        compile_time += time;
+    }
+}
+
+int GLProgramCache::compiledPrograms() {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    return compiled_programs;
+}
+
+int GLProgramCache::cachedPrograms() {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    return cached_programs;
+}
+
+long long GLProgramCache::compileTime() {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    return compile_time;
+}
+
+long long GLProgramCache::loadTime() {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    return load_time;
+}
+
+}
@@ -0,0 +1,90 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Linked GL programs saved to disk between runs.
+ ***************************************************************************/
+
+#ifndef GL_PROGRAM_CACHE_H_
+#define GL_PROGRAM_CACHE_H_
+
+#include <string>
+
+#include "gl/gl_headers.h"
+
+namespace gvr {
+
+/*
+ * Keeps the binaries of linked programs in a directory supplied by the
+ * application, so the next launch can skip compiling and linking.
+ *
+ * A binary is stored under a 64 bit hash of the shader sources, which
+ * include the defines, and of the GL vendor, renderer and version. A new
+ * driver therefore misses the cache instead of loading stale binaries.
+ * Each file carries a header with its key, length and a checksum of the
+ * binary; files that fail these checks, or that the driver refuses to
+ * load, are deleted and the program is built from source again.
+ *
+ * Nothing is cached until setDirectory() is called.
+ */
+class GLProgramCache {
+public:
+    /*
+     * Any thread: where to keep the binaries. An empty path turns the
+     * cache off.
+     */
+    static void setDirectory(const std::string& directory);
+
+    /*
+     * GL thread: the key of the program built from these sources.
+     */
+    static unsigned long long key(int count, const char** vertex_sources,
+            const GLint* vertex_lengths, const char** fragment_sources,
+            const GLint* fragment_lengths);
+
+    /*
+     * GL thread: create a program from the binary stored under key.
+     * Returns 0 if there is none or it could not be used.
+     */
+    static GLuint load(unsigned long long key);
+
+    /*
+     * GL thread: whether programs should be linked retrievable, so that
+     * store() can read their binaries back.
+     */
+    static bool enabled();
+
+    /*
+     * GL thread: save the binary of a linked program under key.
+     */
+    static void store(unsigned long long key, GLuint program);
+
+    /*
+     * Programs created since startup by compiling their sources or by
+     * loading a cached binary, and the time spent on each in
+     * nanoseconds.
+     */
+    static void countProgram(bool cached, long long time);
+    static int compiledPrograms();
+    static int cachedPrograms();
+    static long long compileTime();
+    static long long loadTime();
+
+private:
+    GLProgramCache();
+};
+
+}
+#endif
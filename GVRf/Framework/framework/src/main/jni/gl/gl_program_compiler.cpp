@@ -0,0 +1,169 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Builds GL programs on a thread with a context of its own.
+ ***************************************************************************/
+
+#include "gl_program_compiler.h"
+#include "gl/gl_program.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+GLProgramCompiler::Job::~Job() {
+    delete program_;
+}
+
+void GLProgramCompiler::Job::wait() const {
+    while (!done()) {
+        std::this_thread::yield();
+    }
+}
+
+GLProgramCompiler::GLProgramCompiler() :
+        display_(EGL_NO_DISPLAY), context_(EGL_NO_CONTEXT), surface_(EGL_NO_SURFACE),
+        pending_(0), async_(false), started_(false), failed_(false), quit_(false) {
+}
+
+GLProgramCompiler::~GLProgramCompiler() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            quit_ = true;
+        }
+        wake_.notify_all();
+        thread_.join();
+    }
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+        (*it)->done_.store(true, std::memory_order_release);
+    }
+    if (surface_ != EGL_NO_SURFACE) {
+        eglDestroySurface(display_, surface_);
+    }
+    if (context_ != EGL_NO_CONTEXT) {
+        eglDestroyContext(display_, context_);
+    }
+}
+
+/*
+ * Create a context sharing with the current one, using the same config,
+ * and the thread that builds the programs with it.
+ */
+bool GLProgramCompiler::start() {
+    if (started_) {
+        return !failed_;
+    }
+    started_ = true;
+
+    EGLContext current = eglGetCurrentContext();
+    display_ = eglGetCurrentDisplay();
+    if ((display_ == EGL_NO_DISPLAY) || (current == EGL_NO_CONTEXT)) {
+        LOGW("GLProgramCompiler: no current context to share");
+        failed_ = true;
+        return false;
+    }
+
+    EGLint config_id = 0;
+    EGLint count = 0;
+    EGLConfig config;
+    eglQueryContext(display_, current, EGL_CONFIG_ID, &config_id);
+    const EGLint config_attribs[] = { EGL_CONFIG_ID, config_id, EGL_NONE };
+    if (!eglChooseConfig(display_, config_attribs, &config, 1, &count) || (count < 1)) {
+        LOGW("GLProgramCompiler: cannot find config %d", config_id);
+        failed_ = true;
+        return false;
+    }
+    const EGLint context_attribs[] = { EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE };
+    context_ = eglCreateContext(display_, config, current, context_attribs);
+    if (context_ == EGL_NO_CONTEXT) {
+        LOGW("GLProgramCompiler: cannot create a shared context, error 0x%x", eglGetError());
+        failed_ = true;
+        return false;
+    }
+
+    // without a pbuffer the context is made current surfaceless
+    const EGLint surface_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    surface_ = eglCreatePbufferSurface(display_, config, surface_attribs);
+    thread_ = std::thread(&GLProgramCompiler::threadMain, this);
+    return true;
+}
+
+std::shared_ptr<GLProgramCompiler::Job> GLProgramCompiler::submit(
+        const std::string& vertex_shader, const std::string& fragment_shader) {
+    std::shared_ptr<Job> job = std::make_shared<Job>(vertex_shader, fragment_shader);
+
+    if (async_ && start() && !failed_) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            queue_.push_back(job);
+        }
+        wake_.notify_one();
+    } else {
+        build(*job);
+        job->done_.store(true, std::memory_order_release);
+    }
+    return job;
+}
+
+void GLProgramCompiler::threadMain() {
+    if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+        LOGW("GLProgramCompiler: cannot make the shared context current, error 0x%x",
+                eglGetError());
+        failed_ = true;
+    }
+
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            wake_.wait(lock, [this]() {
+                return quit_ || !queue_.empty();
+            });
+            if (quit_) {
+                break;
+            }
+            job = queue_.front();
+            queue_.pop_front();
+        }
+        // a failed job is built again on the GL thread
+        if (!failed_) {
+            build(*job);
+            // the program has to be complete before another context uses it
+            glFinish();
+        }
+        job->done_.store(true, std::memory_order_release);
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (!failed_) {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    eglReleaseThread();
+}
+
+void GLProgramCompiler::build(Job& job) {
+    try {
+        job.program_ = new GLProgram(job.vertex_shader_.c_str(), job.fragment_shader_.c_str());
+    } catch (const std::string& error) {
+        LOGW("GLProgramCompiler: %s", error.c_str());
+        job.program_ = nullptr;
+    }
+    job.vertex_shader_.clear();
+    job.fragment_shader_.clear();
+}
+
+}
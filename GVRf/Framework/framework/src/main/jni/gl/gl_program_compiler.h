@@ -0,0 +1,138 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Builds GL programs on a thread with a context of its own.
+ ***************************************************************************/
+
+#ifndef GL_PROGRAM_COMPILER_H_
+#define GL_PROGRAM_COMPILER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "gl/gl_headers.h"
+
+namespace gvr {
+class GLProgram;
+
+/*
+ * Compiles and links programs away from the GL thread.
+ *
+ * The first asynchronous submit() creates an EGL context sharing objects
+ * with the one current on the GL thread, and a thread which makes it
+ * current and builds the queued programs one after the other. Program
+ * objects are shared, so once a job is done its program can be used by
+ * the GL thread directly.
+ *
+ * If asynchronous compiles are off, or the shared context cannot be
+ * made, submit() builds the program on the calling thread and returns a
+ * job that is already done.
+ */
+class GLProgramCompiler {
+public:
+    class Job {
+    public:
+        Job(const std::string& vertex_shader, const std::string& fragment_shader) :
+                vertex_shader_(vertex_shader), fragment_shader_(fragment_shader),
+                program_(nullptr), done_(false) {
+        }
+        ~Job();
+
+        /*
+         * Whether the program has been built, or failed to build.
+         */
+        bool done() const {
+            return done_.load(std::memory_order_acquire);
+        }
+
+        /*
+         * GL thread: wait until done().
+         */
+        void wait() const;
+
+        /*
+         * After done(): hand the program over to the caller. Returns null
+         * if it could not be built.
+         */
+        GLProgram* take() {
+            GLProgram* program = program_;
+            program_ = nullptr;
+            return program;
+        }
+
+    private:
+        Job(const Job&);
+        Job& operator=(const Job&);
+
+        friend class GLProgramCompiler;
+        std::string vertex_shader_;
+        std::string fragment_shader_;
+        GLProgram* program_;
+        std::atomic<bool> done_;
+    };
+
+    GLProgramCompiler();
+    ~GLProgramCompiler();
+
+    void setAsync(bool async) {
+        async_ = async;
+    }
+    bool async() const {
+        return async_;
+    }
+
+    /*
+     * GL thread: build a program from these sources.
+     */
+    std::shared_ptr<Job> submit(const std::string& vertex_shader,
+            const std::string& fragment_shader);
+
+    /*
+     * Jobs submitted and not done yet.
+     */
+    int pending() const {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+private:
+    GLProgramCompiler(const GLProgramCompiler&);
+    GLProgramCompiler& operator=(const GLProgramCompiler&);
+
+    bool start();
+    void threadMain();
+    void build(Job& job);
+
+    EGLDisplay display_;
+    EGLContext context_;
+    EGLSurface surface_;
+    std::thread thread_;
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::deque<std::shared_ptr<Job> > queue_;
+    std::atomic<int> pending_;
+    bool async_;
+    bool started_;
+    std::atomic<bool> failed_;
+    bool quit_;
+};
+
+}
+#endif
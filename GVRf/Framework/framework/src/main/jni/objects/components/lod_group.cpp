@@ -0,0 +1,158 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Picks which child of its owner is drawn, by camera distance or size
+ * on screen.
+ ***************************************************************************/
+
+#include "lod_group.h"
+
+#include "objects/scene_object.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+// default hysteresis, a tenth of the metric
+static const float DEFAULT_HYSTERESIS = 0.1f;
+
+LODGroup::LODGroup() :
+        Component(LODGroup::getComponentType()), mode_(DISTANCE),
+        hysteresis_(DEFAULT_HYSTERESIS), selected_(-1) {
+}
+
+LODGroup::~LODGroup() {
+}
+
+/*
+ * Culling caches which scene objects own a group along with the
+ * hierarchy, so attaching or detaching one has to invalidate it.
+ */
+void LODGroup::set_owner_object(SceneObject* owner_object) {
+    if (owner_object != owner_object_) {
+        SceneObject::invalidateHierarchy();
+    }
+    Component::set_owner_object(owner_object);
+}
+
+bool LODGroup::addRange(float range, SceneObject* object) {
+    return insertLevel(DISTANCE, range, object);
+}
+
+bool LODGroup::addLevel(float min_size, SceneObject* object) {
+    return insertLevel(SCREEN_SIZE, min_size, object);
+}
+
+/*
+ * Keep distance ranges ascending and screen sizes descending, so the
+ * finest level comes first either way.
+ */
+bool LODGroup::insertLevel(Mode mode, float threshold, SceneObject* object) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    for (auto it = levels_.begin(); it != levels_.end(); ++it) {
+        if (it->object == object) {
+            levels_.erase(it);
+            break;
+        }
+    }
+    if (levels_.empty()) {
+        mode_ = mode;
+    } else if (mode != mode_) {
+        LOGE("LODGroup: cannot mix distance ranges and screen sizes");
+        return false;
+    }
+
+    auto it = levels_.begin();
+    while ((it != levels_.end()) && ((mode_ == DISTANCE) ?
+            (it->threshold <= threshold) : (it->threshold >= threshold))) {
+        ++it;
+    }
+    Level level = { threshold, object };
+    levels_.insert(it, level);
+    selected_ = 0;
+    return true;
+}
+
+void LODGroup::removeLevel(SceneObject* object) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    for (auto it = levels_.begin(); it != levels_.end(); ++it) {
+        if (it->object == object) {
+            levels_.erase(it);
+            break;
+        }
+    }
+    selected_ = levels_.empty() ? -1 : 0;
+}
+
+void LODGroup::clear() {
+    std::lock_guard<std::mutex> lock(lock_);
+    levels_.clear();
+    selected_ = -1;
+}
+
+int LODGroup::levelOf(const SceneObject* object) const {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    int n = levels_.size();
+    for (int i = 0; i < n; ++i) {
+        if (levels_[i].object == object) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int LODGroup::levelFor(float metric) const {
+    int n = levels_.size();
+
+    if (mode_ == DISTANCE) {
+        for (int i = n - 1; i >= 0; --i) {
+            if (metric >= levels_[i].threshold) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (metric >= levels_[i].threshold) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int LODGroup::select(float distance, float screen_size) {
+    selected_ = choose(distance, screen_size);
+    return selected_;
+}
+
+int LODGroup::choose(float distance, float screen_size) const {
+    std::lock_guard<std::mutex> lock(lock_);
+    float metric = (mode_ == DISTANCE) ? distance : screen_size;
+    int level = levelFor(metric);
+
+    // stay on the current level until the metric leaves its range by
+    // more than the hysteresis, whichever side it is on
+    if ((level != selected_)
+            && ((levelFor(metric * (1.0f + hysteresis_)) == selected_)
+            || (levelFor(metric * (1.0f - hysteresis_)) == selected_))) {
+        level = selected_;
+    }
+    return level;
+}
+
+}
@@ -0,0 +1,142 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Picks which child of its owner is drawn, by camera distance or size
+ * on screen.
+ ***************************************************************************/
+
+#ifndef LOD_GROUP_H_
+#define LOD_GROUP_H_
+
+#include <mutex>
+#include <vector>
+
+#include "objects/components/component.h"
+
+namespace gvr {
+
+/*
+ * Level of detail group. Each level is a child of the owner; culling
+ * selects one of them per frame and skips the others, so only the render
+ * data of the selected level makes it into the render list.
+ *
+ * Levels are either distance ranges, the level with the largest range
+ * not beyond the camera distance being drawn, or minimum screen sizes,
+ * the first level whose minimum the owner's bounding sphere reaches being
+ * drawn. Screen sizes are fractions of the viewport height. Nothing is
+ * drawn when the metric falls short of every level.
+ *
+ * To keep levels from popping back and forth around a threshold the
+ * selected level is kept while the metric is within the hysteresis
+ * fraction of its range.
+ */
+class LODGroup: public Component {
+public:
+    enum Mode {
+        DISTANCE = 0,
+        SCREEN_SIZE = 1
+    };
+
+    LODGroup();
+    virtual ~LODGroup();
+
+    static long long getComponentType() {
+        return COMPONENT_TYPE_LOD_GROUP;
+    }
+
+    virtual void set_owner_object(SceneObject* owner_object);
+
+    /*
+     * Add a level drawn from the camera distance range on. Returns false,
+     * adding nothing, if the group already has screen size levels.
+     */
+    bool addRange(float range, SceneObject* object);
+
+    /*
+     * Add a level drawn while the owner covers at least min_size of the
+     * viewport height. Returns false, adding nothing, if the group
+     * already has distance ranges.
+     */
+    bool addLevel(float min_size, SceneObject* object);
+
+    void removeLevel(SceneObject* object);
+    void clear();
+
+    Mode mode() const {
+        return mode_;
+    }
+
+    float hysteresis() const {
+        return hysteresis_;
+    }
+
+    void set_hysteresis(float hysteresis) {
+        hysteresis_ = hysteresis;
+    }
+
+    /*
+     * Index of the level object shows, -1 if it is not a level.
+     */
+    int levelOf(const SceneObject* object) const;
+
+    /*
+     * Level picked by the last camera cull, -1 when nothing is drawn.
+     */
+    int selected() const {
+        return selected_;
+    }
+
+    /*
+     * Pick the level for the camera distance and screen size of the
+     * owner's bounding sphere. Only called for the camera, other views
+     * like shadow maps keep the level it picked.
+     */
+    int select(float distance, float screen_size);
+
+    /*
+     * Level select() would pick, without picking it. Lets a cull off the
+     * GL thread decide and set_selected() apply the choice later.
+     */
+    int choose(float distance, float screen_size) const;
+
+    void set_selected(int level) {
+        selected_ = level;
+    }
+
+private:
+    LODGroup(const LODGroup& lod_group);
+    LODGroup(LODGroup&& lod_group);
+    LODGroup& operator=(const LODGroup& lod_group);
+    LODGroup& operator=(LODGroup&& lod_group);
+
+    struct Level {
+        float threshold;
+        SceneObject* object;
+    };
+
+    bool insertLevel(Mode mode, float threshold, SceneObject* object);
+    int levelFor(float metric) const;
+
+private:
+    mutable std::mutex lock_;
+    std::vector<Level> levels_;
+    Mode mode_;
+    float hysteresis_;
+    int selected_;
+};
+
+}
+#endif
@@ -0,0 +1,100 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "objects/components/lod_group.h"
+#include "objects/scene_object.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C" {
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeLODGroup_ctor(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeLODGroup_getComponentType(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeLODGroup_addRange(JNIEnv * env,
+            jobject obj, jlong jlod_group, jfloat range, jlong jscene_object);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeLODGroup_addLevel(JNIEnv * env,
+            jobject obj, jlong jlod_group, jfloat min_size, jlong jscene_object);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeLODGroup_removeLevel(JNIEnv * env,
+            jobject obj, jlong jlod_group, jlong jscene_object);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeLODGroup_setHysteresis(JNIEnv * env,
+            jobject obj, jlong jlod_group, jfloat hysteresis);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeLODGroup_getSelectedLevel(JNIEnv * env,
+            jobject obj, jlong jlod_group);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeLODGroup_ctor(JNIEnv * env, jobject obj) {
+    return reinterpret_cast<jlong>(new LODGroup());
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeLODGroup_getComponentType(JNIEnv * env, jobject obj) {
+    return LODGroup::getComponentType();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeLODGroup_addRange(JNIEnv * env,
+        jobject obj, jlong jlod_group, jfloat range, jlong jscene_object) {
+    LODGroup* lod_group = reinterpret_cast<LODGroup*>(jlod_group);
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    return static_cast<jboolean>(lod_group->addRange(range, scene_object));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeLODGroup_addLevel(JNIEnv * env,
+        jobject obj, jlong jlod_group, jfloat min_size, jlong jscene_object) {
+    LODGroup* lod_group = reinterpret_cast<LODGroup*>(jlod_group);
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    return static_cast<jboolean>(lod_group->addLevel(min_size, scene_object));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeLODGroup_removeLevel(JNIEnv * env,
+        jobject obj, jlong jlod_group, jlong jscene_object) {
+    LODGroup* lod_group = reinterpret_cast<LODGroup*>(jlod_group);
+    lod_group->removeLevel(reinterpret_cast<SceneObject*>(jscene_object));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeLODGroup_setHysteresis(JNIEnv * env,
+        jobject obj, jlong jlod_group, jfloat hysteresis) {
+    LODGroup* lod_group = reinterpret_cast<LODGroup*>(jlod_group);
+    lod_group->set_hysteresis(hysteresis);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeLODGroup_getSelectedLevel(JNIEnv * env,
+        jobject obj, jlong jlod_group) {
+    LODGroup* lod_group = reinterpret_cast<LODGroup*>(jlod_group);
+    return lod_group->selected();
+}
+
+}
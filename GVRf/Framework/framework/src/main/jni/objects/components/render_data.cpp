@@ -14,11 +14,91 @@
  */
 
 
+#include <cstring>
+
 #include "objects/hybrid_object.h"
 #include "objects/components/render_data.h"
+#include "objects/scene_object.h"
 
 namespace gvr {
 
+/*
+ * One FNV-1a step per byte of value.
+ */
+template<class T>
+static void hashValue(unsigned int& hash, const T& value) {
+    unsigned char bytes[sizeof(T)];
+
+    memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+}
+
+static void hashValue(unsigned int& hash, float value) {
+    // -0.0 == 0.0, so they have to hash the same
+    value += 0.0f;
+    hashValue<float>(hash, value);
+}
+
+void RenderStateBlock::computeHash() {
+    unsigned int h = 2166136261u;
+
+    hashValue(h, light);
+    hashValue(h, use_light);
+    hashValue(h, use_lightmap);
+    hashValue(h, render_mask);
+    hashValue(h, offset);
+    hashValue(h, offset_factor);
+    hashValue(h, offset_units);
+    hashValue(h, depth_test);
+    hashValue(h, depth_mask);
+    hashValue(h, alpha_blend);
+    hashValue(h, source_alpha_blend_func);
+    hashValue(h, dest_alpha_blend_func);
+    hashValue(h, alpha_to_coverage);
+    hashValue(h, sample_coverage);
+    hashValue(h, invert_coverage_mask);
+    hashValue(h, draw_mode);
+    hashValue(h, stencil_test);
+    hashValue(h, stencil_func_func);
+    hashValue(h, stencil_func_ref);
+    hashValue(h, stencil_func_mask);
+    hashValue(h, stencil_mask_mask);
+    hashValue(h, stencil_op_sfail);
+    hashValue(h, stencil_op_dpfail);
+    hashValue(h, stencil_op_dppass);
+    hash = h;
+}
+
+bool RenderStateBlock::operator==(const RenderStateBlock& other) const {
+    return hash == other.hash
+            && light == other.light
+            && use_light == other.use_light
+            && use_lightmap == other.use_lightmap
+            && render_mask == other.render_mask
+            && offset == other.offset
+            && offset_factor == other.offset_factor
+            && offset_units == other.offset_units
+            && depth_test == other.depth_test
+            && depth_mask == other.depth_mask
+            && alpha_blend == other.alpha_blend
+            && source_alpha_blend_func == other.source_alpha_blend_func
+            && dest_alpha_blend_func == other.dest_alpha_blend_func
+            && alpha_to_coverage == other.alpha_to_coverage
+            && sample_coverage == other.sample_coverage
+            && invert_coverage_mask == other.invert_coverage_mask
+            && draw_mode == other.draw_mode
+            && stencil_test == other.stencil_test
+            && stencil_func_func == other.stencil_func_func
+            && stencil_func_ref == other.stencil_func_ref
+            && stencil_func_mask == other.stencil_func_mask
+            && stencil_mask_mask == other.stencil_mask_mask
+            && stencil_op_sfail == other.stencil_op_sfail
+            && stencil_op_dpfail == other.stencil_op_dpfail
+            && stencil_op_dppass == other.stencil_op_dppass;
+}
+
 RenderData::~RenderData() {
 }
 
@@ -76,11 +156,11 @@ void RenderData::adjustRenderingOrderForTransparency() {
 }
 
 
-bool RenderData::cull_face(int pass) const {
+int RenderData::cull_face(int pass) const {
     if (pass >= 0 && pass < render_pass_list_.size()) {
         return render_pass_list_[pass]->cull_face();
     }
-    return nullptr;
+    return RenderData::CullBack;
 }
 
 Material* RenderData::material(int pass) const {
@@ -92,26 +172,78 @@ Material* RenderData::material(int pass) const {
 
 void RenderData::setCameraDistanceLambda(std::function<float()> func) {
     cameraDistanceLambda_ = func;
+    camera_distance_dirty_ = false;
+}
+
+float RenderData::camera_distance() {
+    if (nullptr != cameraDistanceLambda_) {
+        camera_distance_ = cameraDistanceLambda_();
+        cameraDistanceLambda_ = nullptr;
+    } else if (camera_distance_dirty_) {
+        // this distance will be used when sorting transparent objects
+        SceneObject* owner = owner_object();
+        if (nullptr != owner) {
+            glm::vec3 difference = owner->getBoundingVolume().center() - camera_position_;
+            camera_distance_ = glm::dot(difference, difference);
+        }
+        camera_distance_dirty_ = false;
+    }
+    return camera_distance_;
 }
 
 void RenderData::setStencilFunc(int func, int ref, int mask) {
     stencilFuncFunc_= func;
     stencilFuncRef_ = ref;
     stencilFuncMask_ = mask;
+    hash_code_dirty_ = true;
 }
 
 void RenderData::setStencilOp(int sfail, int dpfail, int dppass) {
     stencilOpSfail_ = sfail;
     stencilOpDpfail_ = dpfail;
     stencilOpDppass_ = dppass;
+    hash_code_dirty_ = true;
 }
 
 void RenderData::setStencilMask(unsigned int mask) {
     stencilMaskMask_ = mask;
+    hash_code_dirty_ = true;
 }
 
 void RenderData::setStencilTest(bool flag) {
     stencilTestFlag_ = flag;
+    hash_code_dirty_ = true;
+}
+
+void RenderData::updateRenderState() {
+    RenderStateBlock& state = render_state_;
+
+    state.light = light_;
+    state.use_light = use_light_;
+    state.use_lightmap = use_lightmap_;
+    state.render_mask = render_mask_;
+    state.offset = offset_;
+    state.offset_factor = offset_factor_;
+    state.offset_units = offset_units_;
+    state.depth_test = depth_test_;
+    state.depth_mask = depth_mask_;
+    state.alpha_blend = alpha_blend_;
+    state.source_alpha_blend_func = source_alpha_blend_func_;
+    state.dest_alpha_blend_func = dest_alpha_blend_func_;
+    state.alpha_to_coverage = alpha_to_coverage_;
+    state.sample_coverage = sample_coverage_;
+    state.invert_coverage_mask = invert_coverage_mask_;
+    state.draw_mode = draw_mode_;
+    state.stencil_test = stencilTestFlag_;
+    state.stencil_func_func = stencilFuncFunc_;
+    state.stencil_func_ref = stencilFuncRef_;
+    state.stencil_func_mask = stencilFuncMask_;
+    state.stencil_mask_mask = stencilMaskMask_;
+    state.stencil_op_sfail = stencilOpSfail_;
+    state.stencil_op_dpfail = stencilOpDpfail_;
+    state.stencil_op_dppass = stencilOpDppass_;
+    state.computeHash();
+    hash_code_dirty_ = false;
 }
 
 bool compareRenderDataByOrderShaderDistance(RenderData *i, RenderData *j) {
@@ -138,7 +270,7 @@ bool compareRenderDataByOrderShaderDistance(RenderData *i, RenderData *j) {
                 //falling back to camera distance.
                 if (i->material(0) == j->material(0)) {
                     if (i->cull_face(0) == j->cull_face(0)) {
-                        if (i->getHashCode().compare(j->getHashCode()) == 0) {
+                        if (i->getHashCode() == j->getHashCode()) {
                             // otherwise sort from front to back
                             return i->camera_distance() < j->camera_distance();
                         }
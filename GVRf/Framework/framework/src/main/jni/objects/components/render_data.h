@@ -29,7 +29,6 @@
 #include "objects/components/component.h"
 #include "objects/render_pass.h"
 #include "objects/material.h"
-#include<sstream>
 typedef unsigned long Long;
 namespace gvr {
 class Mesh;
@@ -39,16 +38,46 @@ class Batch;
 class TextureCapturer;
 class RenderPass;
 
-template<typename T> std::string to_string(T value) {
-    //create an output string stream
-    std::ostringstream os;
-
-    //throw the value into the string stream
-    os << value;
-
-    //convert the string stream into a string and return
-    return os.str();
-}
+/*
+ * Everything about a RenderData that decides how it is drawn apart from
+ * its mesh and render passes. RenderData rebuilds it when one of these
+ * properties changes and it is read-only otherwise, so the hash is
+ * computed once per change instead of on every comparison.
+ */
+struct RenderStateBlock {
+    Light* light;
+    bool use_light;
+    bool use_lightmap;
+    int render_mask;
+    bool offset;
+    float offset_factor;
+    float offset_units;
+    bool depth_test;
+    bool depth_mask;
+    bool alpha_blend;
+    int source_alpha_blend_func;
+    int dest_alpha_blend_func;
+    bool alpha_to_coverage;
+    float sample_coverage;
+    GLboolean invert_coverage_mask;
+    GLenum draw_mode;
+    bool stencil_test;
+    int stencil_func_func;
+    int stencil_func_ref;
+    int stencil_func_mask;
+    unsigned int stencil_mask_mask;
+    int stencil_op_sfail;
+    int stencil_op_dpfail;
+    int stencil_op_dppass;
+    unsigned int hash;
+
+    void computeHash();
+
+    bool operator==(const RenderStateBlock& other) const;
+    bool operator!=(const RenderStateBlock& other) const {
+        return !(*this == other);
+    }
+};
 
 class RenderData: public Component {
 public:
@@ -65,20 +94,21 @@ public:
     };
 
     RenderData() :
-            Component(RenderData::getComponentType()), mesh_(0), light_(0),
-                    use_light_(false), use_lightmap_(false), batching_(true),
-                    render_mask_(DEFAULT_RENDER_MASK), batch_(nullptr),
-                    rendering_order_(DEFAULT_RENDERING_ORDER), hash_code_dirty_(true),
+            Component(RenderData::getComponentType()), mesh_(0), batch_(nullptr),
+                    hash_code_dirty_(true), light_(0), dirty_flag_(std::make_shared<bool>(true)),
+                    source_alpha_blend_func_(GL_ONE), dest_alpha_blend_func_(GL_ONE_MINUS_SRC_ALPHA),
+                    use_light_(false), batching_(true), use_lightmap_(false),
+                    render_mask_(DEFAULT_RENDER_MASK), rendering_order_(DEFAULT_RENDERING_ORDER),
                     offset_(false), offset_factor_(0.0f), offset_units_(0.0f),
                     depth_test_(true), depth_mask_(true), alpha_blend_(true), alpha_to_coverage_(false),
-                    source_alpha_blend_func_(GL_ONE), dest_alpha_blend_func_(GL_ONE_MINUS_SRC_ALPHA),
+                    cast_shadows_(true), occluder_(false), static_caster_(false),
                     sample_coverage_(1.0f), invert_coverage_mask_(GL_FALSE), draw_mode_(GL_TRIANGLES),
-                    texture_capturer(0), cast_shadows_(true), dirty_flag_(std::make_shared<bool>(true)) {
+                    texture_capturer(0) {
     }
 
     void copy(const RenderData& rdata) {
         Component(rdata.getComponentType());
-        hash_code = rdata.hash_code;
+        render_state_ = rdata.render_state_;
         mesh_ = rdata.mesh_;
         light_ = rdata.light_;
         use_light_ = rdata.use_light_;
@@ -86,6 +116,8 @@ public:
         batching_ = rdata.batching_;
         render_mask_ = rdata.render_mask_;
         cast_shadows_ = rdata.cast_shadows_;
+        occluder_ = rdata.occluder_;
+        static_caster_ = rdata.static_caster_;
         batch_ = rdata.batch_;
         for(int i=0;i<rdata.render_pass_list_.size();i++) {
             render_pass_list_.push_back((rdata.render_pass_list_)[i]);
@@ -209,6 +241,30 @@ public:
         cast_shadows_ = cast_shadows;
     }
 
+    /*
+     * Occluders are rasterized by the CPU occlusion culler and hide the
+     * objects behind them. Large, simple, opaque meshes work best.
+     */
+    bool occluder() {
+        return occluder_;
+    }
+
+    void set_occluder(bool occluder) {
+        occluder_ = occluder;
+    }
+
+    /*
+     * Static shadow casters are kept in a cached layer of every shadow
+     * map and only drawn again when the shadow maps are invalidated.
+     */
+    bool static_caster() {
+        return static_caster_;
+    }
+
+    void set_static_caster(bool static_caster) {
+        static_caster_ = static_caster;
+    }
+
     Batch* getBatch() {
         return batch_;
     }
@@ -229,7 +285,7 @@ public:
         batch_ = nullptr;
     }
 
-    bool cull_face(int pass=0) const ;
+    int cull_face(int pass=0) const ;
 
     bool offset() const {
         return offset_;
@@ -279,6 +335,7 @@ public:
     void set_alpha_blend_func(int sourceblend, int destblend) {
         source_alpha_blend_func_ = sourceblend;
         dest_alpha_blend_func_ = destblend;
+        hash_code_dirty_ = true;
     }
 
     int source_alpha_blend_func() const {
@@ -329,13 +386,7 @@ public:
         return draw_mode_;
     }
 
-    float camera_distance() {
-        if (nullptr != cameraDistanceLambda_) {
-            camera_distance_ = cameraDistanceLambda_();
-            cameraDistanceLambda_ = nullptr;
-        }
-        return camera_distance_;
-    }
+    float camera_distance();
 
     void set_draw_mode(GLenum draw_mode) {
         draw_mode_ = draw_mode;
@@ -354,43 +405,30 @@ public:
         return texture_capturer;
     }
 
-    std::string getHashCode() {
+    const RenderStateBlock& render_state() {
         if (hash_code_dirty_) {
-            std::string render_data_string;
-            render_data_string.append(to_string(use_light_));
-            render_data_string.append(to_string(light_));
-            render_data_string.append(to_string(getComponentType()));
-            render_data_string.append(to_string(use_lightmap_));
-            render_data_string.append(to_string(render_mask_));
-            render_data_string.append(to_string(offset_));
-            render_data_string.append(to_string(offset_factor_));
-            render_data_string.append(to_string(offset_units_));
-            render_data_string.append(to_string(depth_test_));
-            render_data_string.append(to_string(depth_mask_));
-            render_data_string.append(to_string(alpha_blend_));
-            render_data_string.append(to_string(alpha_to_coverage_));
-            render_data_string.append(to_string(sample_coverage_));
-            render_data_string.append(to_string(invert_coverage_mask_));
-            render_data_string.append(to_string(draw_mode_));
-
-            render_data_string.append(to_string(stencilTestFlag_));
-            render_data_string.append(to_string(stencilMaskMask_));
-            render_data_string.append(to_string(stencilFuncFunc_));
-            render_data_string.append(to_string(stencilFuncRef_));
-            render_data_string.append(to_string(stencilFuncMask_));
-            render_data_string.append(to_string(stencilOpSfail_));
-            render_data_string.append(to_string(stencilOpDpfail_));
-            render_data_string.append(to_string(stencilOpDppass_));
-
-            hash_code = render_data_string;
-            hash_code_dirty_ = false;
-
+            updateRenderState();
         }
-        return hash_code;
+        return render_state_;
+    }
+
+    unsigned int getHashCode() {
+        return render_state().hash;
     }
 
     void setCameraDistanceLambda(std::function<float()> func);
 
+    /*
+     * Have camera_distance() computed on demand from the owner's
+     * bounding volume and this camera position. Unlike a lambda
+     * this does not allocate, so it is used while culling.
+     */
+    void setCameraPosition(const glm::vec3& camera_position) {
+        camera_position_ = camera_position;
+        camera_distance_dirty_ = true;
+        cameraDistanceLambda_ = nullptr;
+    }
+
     void setStencilFunc(int func, int ref, int mask);
 
     void setStencilOp(int sfail, int dpfail, int dppass);
@@ -412,13 +450,15 @@ private:
     RenderData& operator=(const RenderData& render_data);
     RenderData& operator=(RenderData&& render_data);
 
+    void updateRenderState();
+
 private:
     static const int DEFAULT_RENDER_MASK = Left | Right;
     static const int DEFAULT_RENDERING_ORDER = Geometry;
     Mesh* mesh_;
     Batch* batch_;
     bool hash_code_dirty_;
-    std::string hash_code;
+    RenderStateBlock render_state_;
     std::vector<RenderPass*> render_pass_list_;
     Light* light_;
     std::shared_ptr<bool> dirty_flag_;
@@ -437,10 +477,14 @@ private:
     bool alpha_blend_;
     bool alpha_to_coverage_;
     bool cast_shadows_;
+    bool occluder_;
+    bool static_caster_;
     float sample_coverage_;
     GLboolean invert_coverage_mask_;
     GLenum draw_mode_;
     float camera_distance_;
+    glm::vec3 camera_position_;
+    bool camera_distance_dirty_ = false;
     TextureCapturer *texture_capturer;
 
     std::function<float()> cameraDistanceLambda_ = nullptr;
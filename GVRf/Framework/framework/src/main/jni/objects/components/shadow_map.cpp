@@ -13,12 +13,22 @@
  * limitations under the License.
  */
 #include "shadow_map.h"
+#include "gl/gl_frame_buffer.h"
+#include "gl/gl_render_buffer.h"
+#include "engine/renderer/render_commands.h"
 
 namespace gvr {
 
 ShadowMap::ShadowMap(Material* mtl)
 : RenderTarget(nullptr),
-  mLayerIndex(-1)
+  mLayerIndex(-1),
+  mUpdateRate(1),
+  mFramesUntilUpdate(0),
+  mStaticValid(false),
+  mStaticCasters(false),
+  mStaticFrameBuffer(nullptr),
+  mStaticColor(nullptr),
+  mStaticDepth(nullptr)
 {
     mRenderState.material_override = mtl;
 }
@@ -29,20 +39,109 @@ ShadowMap::~ShadowMap()
     {
         mRenderTexture = nullptr;
     }
+    delete mStaticFrameBuffer;
+    delete mStaticColor;
+    delete mStaticDepth;
 }
 
 void ShadowMap::setLayerIndex(int layerIndex)
 {
+    if (layerIndex != mLayerIndex)
+    {
+        // the layer holds the shadows of some other light
+        mFramesUntilUpdate = 0;
+    }
     mLayerIndex = layerIndex;
 }
 
-void ShadowMap::bindTexture(int loc, int texIndex)
+void ShadowMap::setUpdateRate(int frames)
+{
+    mUpdateRate = (frames < 1) ? 1 : frames;
+    if (mFramesUntilUpdate > mUpdateRate)
+    {
+        mFramesUntilUpdate = mUpdateRate;
+    }
+}
+
+bool ShadowMap::isUpdateDue()
+{
+    if (--mFramesUntilUpdate > 0)
+    {
+        return false;
+    }
+    mFramesUntilUpdate = mUpdateRate;
+    return true;
+}
+
+bool ShadowMap::isStaticCacheValid(const glm::mat4& light_matrix) const
+{
+    return mStaticValid && (light_matrix == mStaticMatrix);
+}
+
+void ShadowMap::beginStaticRendering()
+{
+    int width = mRenderTexture->width();
+    int height = mRenderTexture->height();
+
+    if (mStaticFrameBuffer == nullptr)
+    {
+        mStaticFrameBuffer = new GLFrameBuffer();
+        mStaticColor = new GLRenderBuffer();
+        mStaticDepth = new GLRenderBuffer();
+        glBindRenderbuffer(GL_RENDERBUFFER, mStaticColor->id());
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, mStaticDepth->id());
+        glRenderbufferStorage(GL_RENDERBUFFER, RenderTextureArray::DEPTH_FORMAT, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, mStaticFrameBuffer->id());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                  mStaticColor->id());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                                  mStaticDepth->id());
+        checkGLError("ShadowMap::beginStaticRendering");
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, mStaticFrameBuffer->id());
+    glViewport(0, 0, width, height);
+    glScissor(0, 0, width, height);
+    glDepthMask(GL_TRUE);
+    glClearColor(0, 0, 0, 1);
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    setupRenderState();
+}
+
+void ShadowMap::endStaticRendering(const glm::mat4& light_matrix, bool has_casters)
+{
+    mStaticMatrix = light_matrix;
+    mStaticValid = true;
+    mStaticCasters = has_casters;
+    mFramesUntilUpdate = mUpdateRate;
+}
+
+void ShadowMap::copyStaticCache()
+{
+    if (!mStaticCasters || (mStaticFrameBuffer == nullptr))
+    {
+        return;
+    }
+    int width = mRenderTexture->width();
+    int height = mRenderTexture->height();
+
+    // the layer is bound for drawing by beginRendering
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, mStaticFrameBuffer->id());
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height,
+                      GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    checkGLError("ShadowMap::copyStaticCache");
+}
+
+void ShadowMap::recordTexture(int loc, int texIndex, RenderCommandList& commands)
 {
     RenderTextureArray* texArray = static_cast<RenderTextureArray*>(mRenderTexture);
 
-    if (texArray)
+    if (texArray && (loc >= 0))
     {
-        texArray->bindTexture(loc, texIndex);
+        commands.bindTexture(texIndex, texArray->getTarget(), texArray->getId());
+        commands.uniform1i(loc, texIndex);
     }
 }
 
@@ -59,4 +158,15 @@ void  ShadowMap::beginRendering()
     mRenderState.shadow_map = true;
 }
 
+void ShadowMap::setupRenderState()
+{
+    mRenderState.uniforms.u_proj = mCamera->getProjectionMatrix();
+    mRenderState.uniforms.u_view = mCamera->getViewMatrix();
+    mRenderState.uniforms.u_right = false;
+    mRenderState.viewportWidth = mRenderTexture->width();
+    mRenderState.viewportHeight = mRenderTexture->height();
+    mRenderState.render_mask = 1;
+    mRenderState.shadow_map = true;
+}
+
 }
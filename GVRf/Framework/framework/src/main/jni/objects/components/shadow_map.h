@@ -19,10 +19,20 @@
 
 #include "render_target.h"
 #include "objects/textures/render_texture.h"
+#include "glm/glm.hpp"
 
 namespace gvr {
 class GLFrameBuffer;
+class GLRenderBuffer;
+class RenderCommandList;
 
+    /*
+     * Shadow casters marked static are drawn into a cache of their own,
+     * which is copied into the layer before the other casters are drawn.
+     * The cache is drawn again only when it is invalidated or the light
+     * moves. The whole shadow map may also be updated less often than
+     * every frame.
+     */
     class ShadowMap : public RenderTarget
     {
     public:
@@ -30,10 +40,59 @@ class GLFrameBuffer;
         ~ShadowMap();
         virtual void  beginRendering();
         void setLayerIndex(int layerIndex);
-        void bindTexture(int loc, int texture_index);
+        /*
+         * Record binding the shadow map texture array to
+         * texture_index for the sampler at loc.
+         */
+        void recordTexture(int loc, int texture_index, RenderCommandList& commands);
+
+        /*
+         * Frames from one update of the shadow map to the next, 1 to
+         * update it every frame.
+         */
+        void setUpdateRate(int frames);
+        int getUpdateRate() const { return mUpdateRate; }
+
+        /*
+         * Called once a frame. Whether the shadow map has to be drawn,
+         * which is every getUpdateRate() frames or right away after its
+         * layer changed.
+         */
+        bool isUpdateDue();
+
+        /*
+         * Whether the static casters in the cache were drawn with the
+         * given light view projection matrix and not invalidated since.
+         */
+        bool isStaticCacheValid(const glm::mat4& light_matrix) const;
+        void invalidateStaticCache() { mStaticValid = false; }
+
+        /*
+         * Draw the static casters into the cache instead of the layer.
+         * has_casters is false when there were none, so the cache does
+         * not need to be copied.
+         */
+        void beginStaticRendering();
+        void endStaticRendering(const glm::mat4& light_matrix, bool has_casters);
+
+        /*
+         * After beginRendering(), start the layer from the cached static
+         * casters.
+         */
+        void copyStaticCache();
 
     protected:
+        void    setupRenderState();
+
         int     mLayerIndex;
+        int     mUpdateRate;
+        int     mFramesUntilUpdate;
+        bool    mStaticValid;
+        bool    mStaticCasters;
+        glm::mat4   mStaticMatrix;
+        GLFrameBuffer*  mStaticFrameBuffer;
+        GLRenderBuffer* mStaticColor;
+        GLRenderBuffer* mStaticDepth;
     };
 }
 #endif
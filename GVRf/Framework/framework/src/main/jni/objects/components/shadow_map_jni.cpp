@@ -9,6 +9,10 @@ namespace gvr
     extern "C" {
     JNIEXPORT jlong JNICALL
     Java_org_gearvrf_NativeShadowMap_ctor(JNIEnv *env, jobject obj, jobject jmaterial);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeShadowMap_setUpdateRate(JNIEnv *env, jobject obj, jlong jshadow_map,
+                                                   jint frames);
     };
 
     JNIEXPORT jlong JNICALL
@@ -18,4 +22,12 @@ namespace gvr
         return reinterpret_cast<jlong>(new ShadowMap(material));
     }
 
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeShadowMap_setUpdateRate(JNIEnv *env, jobject obj, jlong jshadow_map,
+                                                   jint frames)
+    {
+        ShadowMap* shadowMap = reinterpret_cast<ShadowMap*>(jshadow_map);
+        shadowMap->setUpdateRate(frames);
+    }
+
 }
@@ -7,6 +7,7 @@
 #include "glm/gtc/type_ptr.hpp"
 #include "glm/gtc/matrix_inverse.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include "engine/renderer/renderer.h"
 #include "objects/components/render_data.h"
 #include "objects/components/texture_capturer.h"
 #include "objects/material.h"
@@ -152,9 +153,12 @@ void TextureCapturer::render(RenderState* rstate, RenderData* render_data) {
     textureMaterial.setVec4("specular_color", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
     textureMaterial.setFloat("specular_exponent", 0.0f);
 
-    TextureShader *textureShader = mShaderManager->getTextureShader();
-
-    textureShader->render(rstate, render_data, &textureMaterial);
+    // drawn on its own, the frame commands are being replayed
+    RenderCommandList commands;
+    Material* material_override = rstate->material_override;
+    rstate->material_override = &textureMaterial;
+    gRenderer->renderRenderData(*rstate, render_data, commands);
+    rstate->material_override = material_override;
 }
 
 glm::mat4 TextureCapturer::getModelViewMatrix() {
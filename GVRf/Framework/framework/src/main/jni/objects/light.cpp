@@ -16,109 +16,192 @@
 /***************************************************************************
  * JNI
  ***************************************************************************/
+#include <cstring>
+
 #include "light.h"
 #include "glm/gtc/type_ptr.hpp"
 #include "glm/gtc/matrix_access.hpp"
 #include "objects/components/shadow_map.h"
 #include "objects/textures/render_texture.h"
 #include "objects/components/custom_camera.h"
+#include "engine/renderer/render_commands.h"
 
 namespace gvr {
 
-/*
- * Loads the uniforms associated with this light
- * into the GPU if they have changed.
- * @param program   ID of shader program light is bound ot
- * @param texIndex  next available texture location
- */
-    void Light::render(int program, int texIndex)
+    /*
+     * Looks up the locations of the uniforms of this light
+     * in a program that does not declare them in Lights_ubo.
+     * @param program   ID of GL shader program
+     */
+    void Light::findUniforms(int program)
     {
-        auto it = dirty_.find(program);
+        std::string lname = lightID_ + ".";
 
-        if (it != dirty_.end() && !it->second)
-            return;
+        for (auto it = floats_.begin(); it != floats_.end(); ++it)
+        {
+            offsets_[it->first][program] = glGetUniformLocation(program, (lname + it->first).c_str());
+        }
+        for (auto it = vec3s_.begin(); it != vec3s_.end(); ++it)
+        {
+            offsets_[it->first][program] = glGetUniformLocation(program, (lname + it->first).c_str());
+        }
+        for (auto it = vec4s_.begin(); it != vec4s_.end(); ++it)
+        {
+            offsets_[it->first][program] = glGetUniformLocation(program, (lname + it->first).c_str());
+        }
+        for (auto it = mat4s_.begin(); it != mat4s_.end(); ++it)
+        {
+            offsets_[it->first][program] = glGetUniformLocation(program, (lname + it->first).c_str());
+        }
+    }
+
+    /*
+     * Records the uniforms associated with this light
+     * unless the program has them already.
+     * @param program   ID of shader program light is bound to
+     * @param commands  where to record them
+     */
+    void Light::record(int program, RenderCommandList& commands)
+    {
         if (lightID_.empty())
         {
             return;
         }
-        dirty_[program] = false;
-        std::string key;
-        std::string lname = lightID_ + ".";
-        int offset;
-
+        auto it = recorded_.find(program);
+        if ((it != recorded_.end()) && (it->second.version == version_)
+                && (it->second.epoch == RenderCommandList::epoch()))
+        {
+            return;
+        }
         for (auto it = floats_.begin(); it != floats_.end(); ++it)
         {
-            key = lname + it->first;
-            offset = getOffset(it->first, program);
-            if (offset <= 0)
-            {
-                offset = glGetUniformLocation(program, key.c_str());
-                offsets_[it->first][program] = offset;
-            }
-            if (offset >= 0)
-                glUniform1f(offset, it->second);
+            commands.uniform1f(getOffset(it->first, program), it->second);
     #ifdef DEBUG_LIGHT
-            LOGD("LIGHT: %s = %f\n", key.c_str(), it->second);
+            LOGD("LIGHT: %s = %f\n", it->first.c_str(), it->second);
     #endif
         }
-
         for (auto it = vec3s_.begin(); it != vec3s_.end(); ++it)
         {
-            offset = getOffset(it->first, program);
-            key = lname + it->first;
-            if (offset <= 0)
-            {
-                offset = glGetUniformLocation(program, key.c_str());
-                offsets_[it->first][program] = offset;
-              }
-            if (offset >= 0)
-            {
-                glm::vec3 v = it->second;
-                glUniform3f(offset, v.x, v.y, v.z);
-    #ifdef DEBUG_LIGHT
-                LOGD("LIGHT: %s = %f, %f, %f\n", key.c_str(), v.x, v.y, v.z);
-    #endif
-            }
+            glm::vec3 v = it->second;
+            commands.uniform3f(getOffset(it->first, program), v.x, v.y, v.z);
+        }
+        for (auto it = vec4s_.begin(); it != vec4s_.end(); ++it)
+        {
+            glm::vec4 v = it->second;
+            commands.uniform4f(getOffset(it->first, program), v.x, v.y, v.z, v.w);
         }
+        for (auto it = mat4s_.begin(); it != mat4s_.end(); ++it)
+        {
+            commands.uniformMatrix4fv(getOffset(it->first, program), 1,
+                    glm::value_ptr(it->second));
+        }
+        Recorded recorded = { version_, RenderCommandList::epoch() };
+        recorded_[program] = recorded;
+    }
 
+    bool Light::hasUniforms(int program) const
+    {
+        for (auto it = floats_.begin(); it != floats_.end(); ++it)
+        {
+            if (getOffset(it->first, program) == -2)
+                return false;
+        }
+        for (auto it = vec3s_.begin(); it != vec3s_.end(); ++it)
+        {
+            if (getOffset(it->first, program) == -2)
+                return false;
+        }
         for (auto it = vec4s_.begin(); it != vec4s_.end(); ++it)
         {
-            offset = getOffset(it->first, program);
-            key = lname + it->first;
-            if (offset <= 0)
+            if (getOffset(it->first, program) == -2)
+                return false;
+        }
+        for (auto it = mat4s_.begin(); it != mat4s_.end(); ++it)
+        {
+            if (getOffset(it->first, program) == -2)
+                return false;
+        }
+        return true;
+    }
+
+    bool Light::writeUniform(const std::string& key, GLenum type, char* data) const
+    {
+        switch (type)
+        {
+            case GL_FLOAT:
             {
-                offset = glGetUniformLocation(program, key.c_str());
-                offsets_[it->first][program] = offset;
+                auto it = floats_.find(key);
+                if (it == floats_.end())
+                    return false;
+                memcpy(data, &it->second, sizeof(float));
+                return true;
             }
-            if (offset >= 0)
+            case GL_FLOAT_VEC3:
             {
-                glm::vec4 v = it->second;
-                glUniform4f(offset, v.x, v.y, v.z, v.w);
-    #ifdef DEBUG_LIGHT
-                LOGD("LIGHT: %s = %f, %f, %f, %f\n", key.c_str(), v.x, v.y, v.z, v.w);
-    #endif
+                auto it = vec3s_.find(key);
+                if (it == vec3s_.end())
+                    return false;
+                memcpy(data, glm::value_ptr(it->second), sizeof(glm::vec3));
+                return true;
             }
-        }
-        for (auto it = mat4s_.begin(); it != mat4s_.end(); ++it)
-        {
-            offset = getOffset(it->first, program);
-            key = lname + it->first;
-            if (offset <= 0)
+            case GL_FLOAT_VEC4:
             {
-                offset = glGetUniformLocation(program, key.c_str());
-                offsets_[it->first][program] = offset;
+                auto it = vec4s_.find(key);
+                if (it == vec4s_.end())
+                    return false;
+                memcpy(data, glm::value_ptr(it->second), sizeof(glm::vec4));
+                return true;
             }
-            if (offset >= 0)
+            case GL_INT:
+            case GL_BOOL:
             {
-                glm::mat4 v = it->second;
-                glUniformMatrix4fv(offset, 1, GL_FALSE, glm::value_ptr(v));
-    #ifdef DEBUG_LIGHT
-                LOGD("LIGHT: %s\n", key.c_str());
-    #endif
+                // std140 bools are 4 bytes like ints
+                auto it = floats_.find(key);
+                if (it == floats_.end())
+                    return false;
+                GLint value = static_cast<GLint>(it->second);
+                memcpy(data, &value, sizeof(GLint));
+                return true;
+            }
+            case GL_FLOAT_MAT3:
+            {
+                // std140 pads each column to 16 bytes
+                auto it = mat4s_.find(key);
+                if (it == mat4s_.end())
+                    return false;
+                for (int column = 0; column < 3; ++column)
+                    memcpy(data + column * sizeof(glm::vec4),
+                           glm::value_ptr(it->second[column]), sizeof(glm::vec3));
+                return true;
+            }
+            case GL_FLOAT_MAT4:
+            {
+                // std140 stores the columns 16 bytes apart, like glm
+                auto it = mat4s_.find(key);
+                if (it == mat4s_.end())
+                    return false;
+                memcpy(data, glm::value_ptr(it->second), sizeof(glm::mat4));
+                return true;
             }
         }
+        return false;
     }
 
+    bool Light::isUniformType(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_FLOAT:
+            case GL_FLOAT_VEC3:
+            case GL_FLOAT_VEC4:
+            case GL_INT:
+            case GL_BOOL:
+            case GL_FLOAT_MAT3:
+            case GL_FLOAT_MAT4:
+                return true;
+        }
+        return false;
+    }
 
     /**
      * Renders the shadow map for this light.
@@ -136,10 +219,7 @@ namespace gvr {
         }
         shadowMap->setLayerIndex(texIndex);
         setFloat("shadow_map_index", (float) texIndex);
-        Renderer::getInstance()->cullAndRender(shadowMap, scene, shader_manager,
-                     (PostEffectShaderManager*) nullptr,
-                     (RenderTexture*) nullptr,
-                     (RenderTexture*) nullptr);
+        Renderer::getInstance()->renderShadowMap(shadowMap, scene, shader_manager);
         return true;
     }
  
@@ -41,6 +41,7 @@ class SceneObject;
 class Scene;
 class ShaderManager;
 class ShadowMap;
+class RenderCommandList;
 
 //#define DEBUG_LIGHT 1
 
@@ -49,7 +50,8 @@ public:
 
     explicit Light()
     :   Component(Light::getComponentType()),
-		shadowMapIndex_(-1) {
+		shadowMapIndex_(-1),
+		version_(0) {
     }
 
     static long long getComponentType() {
@@ -181,13 +183,54 @@ public:
     }
 
 
+    /**
+     * Internal function called when a shader builds its
+     * program: looks up the light uniforms in it.
+     * @param program   ID of GL shader program
+     */
+    void findUniforms(int program);
+
+    /**
+     * Whether findUniforms has looked up every uniform
+     * of this light in the program.
+     * @param program   ID of GL shader program
+     */
+    bool hasUniforms(int program) const;
+
     /**
      * Internal function called at the start of each shader
-     * to update the light uniforms (if necessary).
+     * to record the light uniforms (if necessary), once
+     * hasUniforms holds for the program.
      * @param program   ID of GL shader program
-     * @param texIndex  GL texture index for shadow map
+     * @param commands  command list to record them in
+     */
+    void record(int program, RenderCommandList& commands);
+
+    /**
+     * Internal function called when a light uniform block
+     * is rewritten: copies the value of one uniform.
+     * @param key   name of the uniform
+     * @param type  GL type of the block member
+     * @param data  where the member starts in the block
+     * @return false if the light has no such uniform
      */
-    void render(int program, int texIndex);
+    bool writeUniform(const std::string& key, GLenum type, char* data) const;
+
+    /**
+     * Whether writeUniform can fill a block member of a GL type.
+     * Lights hold floats, vec3s, vec4s and mat4s; int and bool
+     * members are converted from floats and mat3 members taken
+     * from the upper left of a mat4.
+     * @param type  GL type of the block member
+     */
+    static bool isUniformType(GLenum type);
+
+    /**
+     * Changes each time a uniform of this light changes.
+     */
+    unsigned int version() const {
+        return version_;
+    }
 
     /**
      * Internal function called at the start of each frame
@@ -221,30 +264,38 @@ private:
      * Mark the light as needing update for all shaders using it
      */
     void setDirty() {
-        for (auto it = dirty_.begin(); it != dirty_.end(); ++it) {
-            it->second = true;
-        }
+        ++version_;
     }
 
     /*
-     * Get the GL uniform offset for a named uniform.
+     * Get the GL uniform offset for a named uniform,
+     * -2 if it has not been looked up yet for this program.
      */
-    int getOffset(std::string key, int programId) {
+    int getOffset(const std::string& key, int programId) const {
         auto it = offsets_.find(key);
         if (it != offsets_.end()) {
-            std::map<int, int> offsets = it->second;
+            const std::map<int, int>& offsets = it->second;
             auto it2 = offsets.find(programId);
             if (it2 != offsets.end()) {
                 return it2->second;
             }
         }
-        return -1;
+        return -2;
     }
 
 private:
     int shadowMapIndex_;
+    unsigned int version_;
     std::string lightID_;
-    std::map<int, bool> dirty_;
+    /*
+     * Version of the uniforms last recorded for a program and the
+     * command list epoch it was recorded in.
+     */
+    struct Recorded {
+        unsigned int version;
+        unsigned int epoch;
+    };
+    std::map<int, Recorded> recorded_;
     std::map<std::string, float> floats_;
     std::map<std::string, glm::vec3> vec3s_;
     std::map<std::string, glm::vec4> vec4s_;
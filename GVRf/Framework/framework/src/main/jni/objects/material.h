@@ -20,17 +20,21 @@
 #ifndef MATERIAL_H_
 #define MATERIAL_H_
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <unordered_set>
 #include <string>
+#include <vector>
 
 #include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
 
 #include "objects/hybrid_object.h"
 #include "objects/textures/texture.h"
 #include "objects/components/render_data.h"
 #include "objects/helpers.h"
+#include "objects/material_params.h"
 
 namespace gvr {
 
@@ -61,16 +65,14 @@ public:
     explicit Material(ShaderType shader_type) :
             shader_type_(shader_type),
             textures_(),
-            floats_(),
-            vec2s_(),
-            vec3s_(),
-            vec4s_(),
+            layout_(0),
+            version_(MaterialParams::nextVersion()),
             shader_feature_set_(0)
     {
         switch (shader_type) {
         default:
-            vec3s_["color"] = glm::vec3(1.0f, 1.0f, 1.0f);
-            floats_["opacity"] = 1.0f;
+            setVec3("color", glm::vec3(1.0f, 1.0f, 1.0f));
+            setFloat("opacity", 1.0f);
             break;
         }
     }
@@ -121,96 +123,81 @@ public:
     }
 
     float getFloat(const std::string& key) {
-        auto it = floats_.find(key);
-        if (it != floats_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getFloat() : " + key + " not found";
-            throw error;
-        }
+        return *getParam(key, 1, "Material::getFloat() : ");
     }
     void setFloat(const std::string& key, float value) {
-        floats_[key] = value;
-        dirty();
+        setParam(key, 1, &value);
     }
 
     glm::vec2 getVec2(const std::string& key) {
-        auto it = vec2s_.find(key);
-        if (it != vec2s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getVec2() : " + key + " not found";
-            throw error;
-        }
+        return glm::make_vec2(getParam(key, 2, "Material::getVec2() : "));
     }
 
     void setVec2(const std::string& key, glm::vec2 vector) {
-        vec2s_[key] = vector;
-        dirty();
+        setParam(key, 2, glm::value_ptr(vector));
     }
 
     glm::vec3 getVec3(const std::string& key) {
-        auto it = vec3s_.find(key);
-        if (it != vec3s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getVec3() : " + key + " not found";
-            throw error;
-        }
+        return glm::make_vec3(getParam(key, 3, "Material::getVec3() : "));
     }
 
     void setVec3(const std::string& key, glm::vec3 vector) {
-        vec3s_[key] = vector;
-        dirty();
+        setParam(key, 3, glm::value_ptr(vector));
     }
 
     glm::vec4 getVec4(const std::string& key) {
-        auto it = vec4s_.find(key);
-        if (it != vec4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getVec4() : " + key + " not found";
-            throw error;
-        }
+        return glm::make_vec4(getParam(key, 4, "Material::getVec4() : "));
     }
 
     void setVec4(const std::string& key, glm::vec4 vector) {
-        vec4s_[key] = vector;
-        dirty();
+        setParam(key, 4, glm::value_ptr(vector));
     }
 
     glm::mat4 getMat4(const std::string& key) {
-        auto it = mat4s_.find(key);
-        if (it != mat4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getMat4() : " + key + " not found";
-            throw error;
-        }
+        return glm::make_mat4(getParam(key, 16, "Material::getMat4() : "));
     }
 
     bool hasUniform(const std::string& key) const {
-        if (vec3s_.find(key) != vec3s_.end()) {
-            return true;
-        }
-        if (vec2s_.find(key) != vec2s_.end()) {
-            return true;
-        }
-        if (vec4s_.find(key) != vec4s_.end()) {
-            return true;
-        }
-        if (mat4s_.find(key) != mat4s_.end()) {
-            return true;
-        }
-        if (floats_.find(key) != floats_.end()) {
-            return true;
-        }
-        return false;
+        return findSlot(MaterialParams::find(key)) != nullptr;
     }
 
     void setMat4(const std::string& key, glm::mat4 matrix) {
-        mat4s_[key] = matrix;
-        dirty();
+        setParam(key, 16, glm::value_ptr(matrix));
+    }
+
+    /*
+     * Values of the parameter with this interned id, or null if the
+     * material does not have it with that many floats.
+     */
+    const float* findParam(int id, int size) const {
+        const MaterialParamSlot* slot = findSlot(id);
+        if ((slot == nullptr) || (slot->size != size)) {
+            return nullptr;
+        }
+        return &params_[slot->offset];
+    }
+
+    /*
+     * All the parameter values; findParam() points into this block.
+     */
+    const float* params() const {
+        return params_.data();
+    }
+
+    /*
+     * Interned id of the parameters this material has, see
+     * MaterialParams::internLayout.
+     */
+    unsigned int layout() const {
+        return layout_;
+    }
+
+    /*
+     * Changes whenever a parameter is set. No two materials ever have
+     * the same version.
+     */
+    unsigned int version() const {
+        return version_;
     }
 
     int get_shader_feature_set() {
@@ -242,15 +229,50 @@ public:
     Material& operator=(const Material& material);
     Material& operator=(Material&& material);
 
+    const MaterialParamSlot* findSlot(int id) const {
+        for (auto it = param_slots_.begin(); it != param_slots_.end(); ++it) {
+            if (it->id == id) {
+                return &(*it);
+            }
+        }
+        return nullptr;
+    }
+
+    const float* getParam(const std::string& key, int size, const char* error) const {
+        const float* values = findParam(MaterialParams::find(key), size);
+        if (values == nullptr) {
+            throw error + key + " not found";
+        }
+        return values;
+    }
+
+    void setParam(const std::string& key, int size, const float* values) {
+        int id = MaterialParams::intern(key);
+        const MaterialParamSlot* slot = findSlot(id);
+
+        if ((slot == nullptr) || (slot->size != size)) {
+            MaterialParamSlot added = { id, size, static_cast<int>(params_.size()) };
+            if (slot != nullptr) {
+                param_slots_.erase(param_slots_.begin() + (slot - &param_slots_[0]));
+            }
+            param_slots_.push_back(added);
+            params_.resize(params_.size() + size);
+            layout_ = MaterialParams::internLayout(param_slots_);
+            slot = &param_slots_.back();
+        }
+        std::copy(values, values + size, params_.begin() + slot->offset);
+        version_ = MaterialParams::nextVersion();
+        dirty();
+    }
+
 private:
     ShaderType shader_type_;
     std::map<std::string, Texture*> textures_;
     Texture* main_texture = NULL;
-    std::map<std::string, float> floats_;
-    std::map<std::string, glm::vec2> vec2s_;
-    std::map<std::string, glm::vec3> vec3s_;
-    std::map<std::string, glm::vec4> vec4s_;
-    std::map<std::string, glm::mat4> mat4s_;
+    std::vector<MaterialParamSlot> param_slots_;
+    std::vector<float> params_;     // all the uniform values, packed
+    unsigned int layout_;
+    unsigned int version_;
     std::unordered_set<std::shared_ptr<bool>> dirty_flags_;
 
     unsigned int shader_feature_set_;
@@ -0,0 +1,75 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Interned names and layouts of material parameters.
+ ***************************************************************************/
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "material_params.h"
+
+namespace gvr {
+
+// materials are changed from Java threads and read on the GL thread
+static std::mutex params_lock;
+static std::unordered_map<std::string, int> param_ids;
+static std::map<std::vector<int>, unsigned int> layout_ids;
+static std::atomic<unsigned int> next_version(0);
+
+int MaterialParams::intern(const std::string& key) {
+    std::lock_guard<std::mutex> lock(params_lock);
+    auto it = param_ids.find(key);
+    if (it != param_ids.end()) {
+        return it->second;
+    }
+    int id = param_ids.size();
+    param_ids[key] = id;
+    return id;
+}
+
+int MaterialParams::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(params_lock);
+    auto it = param_ids.find(key);
+    return (it != param_ids.end()) ? it->second : -1;
+}
+
+unsigned int MaterialParams::internLayout(const std::vector<MaterialParamSlot>& slots) {
+    std::vector<int> key;
+
+    key.reserve(slots.size() * 3);
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        key.push_back(it->id);
+        key.push_back(it->size);
+        key.push_back(it->offset);
+    }
+    std::lock_guard<std::mutex> lock(params_lock);
+    auto it = layout_ids.find(key);
+    if (it != layout_ids.end()) {
+        return it->second;
+    }
+    unsigned int id = layout_ids.size() + 1;
+    layout_ids[key] = id;
+    return id;
+}
+
+unsigned int MaterialParams::nextVersion() {
+    return next_version.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}
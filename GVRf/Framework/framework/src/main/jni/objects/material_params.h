@@ -0,0 +1,73 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Interned names and layouts of material parameters.
+ ***************************************************************************/
+
+#ifndef MATERIAL_PARAMS_H_
+#define MATERIAL_PARAMS_H_
+
+#include <string>
+#include <vector>
+
+namespace gvr {
+
+/*
+ * Where one parameter sits in the float block of a material. Size is
+ * the number of floats: 1, 2, 3, 4 or 16 for a mat4.
+ */
+struct MaterialParamSlot {
+    int id;
+    int size;
+    int offset;
+};
+
+/*
+ * Parameter names are interned to small integers once, so shaders can
+ * find the uniforms of a material by index instead of by string.
+ *
+ * The set of slots of a material is interned as well: materials which
+ * were given the same parameters in the same order share a layout id,
+ * and a shader binds every material of a layout with the same plan.
+ */
+class MaterialParams {
+public:
+    /*
+     * Id of key, registering it if it is new.
+     */
+    static int intern(const std::string& key);
+
+    /*
+     * Id of key, or -1 if no material ever had it.
+     */
+    static int find(const std::string& key);
+
+    /*
+     * Id shared by all materials with exactly these slots.
+     */
+    static unsigned int internLayout(const std::vector<MaterialParamSlot>& slots);
+
+    /*
+     * A value no material has had before, for Material::version().
+     */
+    static unsigned int nextVersion();
+
+private:
+    MaterialParams();
+};
+
+}
+#endif
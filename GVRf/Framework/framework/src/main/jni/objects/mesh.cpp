@@ -17,10 +17,16 @@
  * The mesh for rendering.
  ***************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "mesh.h"
+#include "mesh_optimizer.h"
 
 #include "assimp/Importer.hpp"
 #include "glm/gtc/matrix_inverse.hpp"
+#include "glm/gtc/packing.hpp"
 
 
 namespace gvr {
@@ -173,118 +179,283 @@ namespace gvr {
         }
     }
 
-    void Mesh::createAttributeMapping(int programId, int& totalStride, int &attrLen) {
-        totalStride = attrLen = 0;
-        if (programId == -1) {
-            // If program id has not been set, return.
-            return;
+    /*
+     * Lay out every attribute of the mesh in one vertex, in id order;
+     * offsets and the stride are in bytes.
+     */
+    void Mesh::createAttributeMapping(int &attrLen) {
+        GLAttributeMapping attrData;
+
+        attrMapping.clear();
+        attrLen = std::max(vertices_.size(), normals_.size());
+        if (vertices_.size() > 0) {
+            attrData.id = VertexAttributes::POSITION;
+            attrData.size = 3;
+            attrData.length = vertices_.size();
+            attrData.data = (const float*) vertices_.data();
+            attrMapping.push_back(attrData);
+        }
+        if (normals_.size() > 0) {
+            attrData.id = VertexAttributes::NORMAL;
+            attrData.size = 3;
+            attrData.length = normals_.size();
+            attrData.data = (const float*) normals_.data();
+            attrMapping.push_back(attrData);
+        }
+        for (auto it = float_vectors_.begin(); it != float_vectors_.end(); ++it) {
+            attrData.id = it->first;
+            attrData.size = 1;
+            attrData.length = it->second.size();
+            attrData.data = it->second.data();
+            attrMapping.push_back(attrData);
+        }
+        for (auto it = vec2_vectors_.begin(); it != vec2_vectors_.end(); ++it) {
+            attrData.id = it->first;
+            attrData.size = 2;
+            attrData.length = it->second.size();
+            attrData.data = (const float*) it->second.data();
+            attrMapping.push_back(attrData);
+        }
+        for (auto it = vec3_vectors_.begin(); it != vec3_vectors_.end(); ++it) {
+            attrData.id = it->first;
+            attrData.size = 3;
+            attrData.length = it->second.size();
+            attrData.data = (const float*) it->second.data();
+            attrMapping.push_back(attrData);
+        }
+        for (auto it = vec4_vectors_.begin(); it != vec4_vectors_.end(); ++it) {
+            attrData.id = it->first;
+            attrData.size = 4;
+            attrData.length = it->second.size();
+            attrData.data = (const float*) it->second.data();
+            attrMapping.push_back(attrData);
+        }
+        std::sort(attrMapping.begin(), attrMapping.end(),
+                [](const GLAttributeMapping& a, const GLAttributeMapping& b) {
+                    return a.id < b.id;
+                });
+
+        vertex_stride_ = 0;
+        for (auto it = attrMapping.begin(); it != attrMapping.end(); ++it) {
+            if ((it->length != attrLen) && (it->length > 0)) {
+                LOGE(" $$$$*** Attib length does not match %d vs %d", it->length, attrLen);
+            }
+            chooseAttributeType(*it);
+            it->offset = vertex_stride_;
+            vertex_stride_ += it->bytes;
+        }
+    }
+
+    /*
+     * True if every value comes back from a half float within bound.
+     */
+    static bool fitsHalf(const float* data, int count, float bound) {
+        for (int i = 0; i < count; ++i) {
+            float back = glm::unpackHalf1x16(glm::packHalf1x16(data[i]));
+            if (!(std::fabs(back - data[i]) <= bound)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool fitsSnorm(const float* data, int count) {
+        for (int i = 0; i < count; ++i) {
+            if (!(std::fabs(data[i]) <= 1.0f)) {
+                return false;
+            }
         }
-        GLint numActiveAtributes;
+        return true;
+    }
+
+    float Mesh::positionBound() {
+        const BoundingVolume& bv = getBoundingVolume();
+        return glm::length(bv.max_corner() - bv.min_corner()) / 4096.0f;
+    }
+
+    /*
+     * The type an attribute is uploaded as. Positions have to stay within
+     * 1/4096 of the size of the mesh, texture coordinates within 1/1024;
+     * direction vectors are packed when they fit in [-1, 1], where 10 bits
+     * are within 1/1022 anyway. Attribute offsets stay 4 byte aligned.
+     */
+    void Mesh::chooseAttributeType(GLAttributeMapping& attr) {
+        static const int tangent = VertexAttributes::intern("a_tangent");
+        static const int bitangent = VertexAttributes::intern("a_bitangent");
+        int count = attr.length * attr.size;
+
+        attr.components = attr.size;
+        attr.type = GL_FLOAT;
+        attr.normalized = GL_FALSE;
+        attr.bytes = attr.size * sizeof(GLfloat);
+
+        attr.bound = 0.0f;
+
+        if (attr.id == VertexAttributes::POSITION) {
+            if (vertex_format_ & PACK_POSITIONS) {
+                float bound = positionBound();
+                if (fitsHalf(attr.data, count, bound)) {
+                    attr.type = GL_HALF_FLOAT;
+                    attr.bound = bound;
+                }
+            }
+        } else if ((attr.id == VertexAttributes::NORMAL) || (attr.id == tangent)
+                || (attr.id == bitangent)) {
+            if ((vertex_format_ & PACK_NORMALS) && (attr.size >= 3)
+                    && fitsSnorm(attr.data, count)) {
+                attr.type = GL_INT_2_10_10_10_REV;
+                attr.components = 4;
+                attr.normalized = GL_TRUE;
+                attr.bytes = sizeof(GLuint);
+            }
+        } else if ((vertex_format_ & PACK_TEXCOORDS) && (attr.size == 2)
+                && (VertexAttributes::name(attr.id).compare(0, 10, "a_texcoord") == 0)) {
+            if (fitsHalf(attr.data, count, 1.0f / 1024.0f)) {
+                attr.type = GL_HALF_FLOAT;
+                attr.bound = 1.0f / 1024.0f;
+            }
+        }
+        if (attr.type == GL_HALF_FLOAT) {
+            attr.bytes = (attr.size * sizeof(GLushort) + 3) & ~3;
+        }
+    }
+
+    /*
+     * Interleave vertices first to first + count into buffer, which is
+     * sized once and then written attribute by attribute at the stride,
+     * packing as chooseAttributeType() decided. Arrays shorter than the
+     * mesh read as zero past their end.
+     */
+    void Mesh::createBuffer(std::vector<GLubyte> &buffer, int first, int count) {
+        buffer.assign(vertex_stride_ * count, 0);
+        for (auto it = attrMapping.begin(); it != attrMapping.end(); ++it) {
+            const GLAttributeMapping& currAttr = *it;
+            int available = std::max(0, std::min(count, currAttr.length - first));
+            const float* src = currAttr.data + first * currAttr.size;
+            GLubyte* dest = buffer.data() + currAttr.offset;
+
+            switch (currAttr.type) {
+                case GL_HALF_FLOAT:
+                    for (int i = 0; i < available; ++i) {
+                        GLushort half[4];
+                        for (GLuint k = 0; k < currAttr.size; ++k) {
+                            half[k] = glm::packHalf1x16(src[k]);
+                        }
+                        memcpy(dest, half, currAttr.size * sizeof(GLushort));
+                        src += currAttr.size;
+                        dest += vertex_stride_;
+                    }
+                    break;
+                case GL_INT_2_10_10_10_REV:
+                    for (int i = 0; i < available; ++i) {
+                        glm::vec4 v(src[0], src[1], src[2],
+                                (currAttr.size > 3) ? src[3] : 0.0f);
+                        GLuint packed = glm::packSnorm3x10_1x2(v);
+                        memcpy(dest, &packed, sizeof(packed));
+                        src += currAttr.size;
+                        dest += vertex_stride_;
+                    }
+                    break;
+                default:
+                    for (int i = 0; i < available; ++i) {
+                        memcpy(dest, src, currAttr.size * sizeof(GLfloat));
+                        src += currAttr.size;
+                        dest += vertex_stride_;
+                    }
+                    break;
+            }
+        }
+    }
+
+    /*
+     * Which layout the active attributes of a program make. The
+     * attributes set up elsewhere count as well, so a VAO they were
+     * pointed in is never shared with a program reading the mesh there.
+     */
+    unsigned int Mesh::layoutOf(GLuint programId) {
+        auto found = program_layouts_.find(programId);
+        if (found != program_layouts_.end()) {
+            return found->second;
+        }
+        GLint numActiveAtributes = 0;
         glGetProgramiv(programId, GL_ACTIVE_ATTRIBUTES, &numActiveAtributes);
         GLchar attrName[512];
-        GLAttributeMapping attrData;
+        std::vector<std::pair<int, int>> pairs;
 
         for (int i = 0; i < numActiveAtributes; i++) {
             GLsizei length;
             GLint size;
             GLenum type;
             glGetActiveAttrib(programId, i, 512, &length, &size, &type, attrName);
+            int loc = glGetAttribLocation(programId, attrName);
+            pairs.push_back(std::make_pair(loc, VertexAttributes::intern(attrName)));
+        }
+        std::sort(pairs.begin(), pairs.end());
+
+        std::vector<int> bindings;
+        bindings.reserve(pairs.size() * 2);
+        for (auto it = pairs.begin(); it != pairs.end(); ++it) {
+            bindings.push_back(it->first);
+            bindings.push_back(it->second);
+        }
+        unsigned int layout = VertexAttributes::internLayout(bindings);
+        program_layouts_[programId] = layout;
+
+        auto vao = layout_vaos_.find(layout);
+        if (vao == layout_vaos_.end()) {
+            LayoutVao added;
+            added.vaoID = 0;
+            added.has_bones = false;
+            added.bindings.swap(bindings);
+            layout_vaos_[layout] = added;
+        }
+        return layout;
+    }
+
+    /*
+     * Point the attributes of a layout into the shared buffers. Done
+     * again whenever the buffers are rebuilt, as offsets and the stride
+     * may have changed; bone attributes are left alone.
+     */
+    void Mesh::setupVao(LayoutVao& vao) {
+        if (vao.vaoID == 0) {
+            glGenVertexArrays(1, &vao.vaoID);
+        }
+        glBindVertexArray(vao.vaoID);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID_);
+        glBindBuffer(GL_ARRAY_BUFFER, vboID_);
+
+        for (size_t i = 0; i < vao.bindings.size(); i += 2) {
+            GLuint loc = vao.bindings[i];
+            int id = vao.bindings[i + 1];
+            const std::string name = VertexAttributes::name(id);
+
             if (std::find(dynamicAttribute_Names_.begin(), dynamicAttribute_Names_.end(),
-                          attrName) != dynamicAttribute_Names_.end()) {
+                          name) != dynamicAttribute_Names_.end()) {
                 // Skip dynamic attributes. Currently only bones are dynamic attributes which changes each frame.
                 // They are handled seperately.
+                continue;
             }
-            else {
-                attrData.type = GL_FLOAT;
-                int loc = glGetAttribLocation(programId, attrName);
-                attrData.index = loc;
-                attrData.data = NULL;
-                attrData.offset = totalStride;
-                bool addData = true;
-                int len = 0;
-
-                // Two things to note --
-                // 1. The 3 builtin buffers are still seperate from the maps used for the other attributes
-                // 2. The attribute index *has* to be 0, 1 and 2 for position, tex_coords and normal. The
-                // index from querying via glGetActiveAttrib cannot be used. Needs analysis.
-                if (strcmp(attrName, "a_position") == 0) {
-                    attrData.size = 3;
-                    len = vertices_.size();
-                    attrData.data = vertices_.data();
-                }
-                else if (strcmp(attrName, "a_normal") == 0) {
-                    attrData.size = 3;
-                    len = normals_.size();
-                    attrData.data = normals_.data();
-                }
-                else {
-
-                    switch (type) {
-                        case GL_FLOAT:
-                            attrData.size = 1;
-                            {
-                                const std::vector<float> &curr = getFloatVector(attrName);
-                                len = curr.size();
-                                attrData.data = curr.data();
-                            }
-                            break;
-                        case GL_FLOAT_VEC2:
-                            attrData.size = 2;
-                            {
-                                const std::vector<glm::vec2> &curr = getVec2Vector(attrName);
-                                len = curr.size();
-                                attrData.data = curr.data();
-                            }
-                            break;
-                        case GL_FLOAT_VEC3:
-                            attrData.size = 3;
-                            {
-                                const std::vector<glm::vec3> &curr = getVec3Vector(attrName);
-                                len = curr.size();
-                                attrData.data = curr.data();
-                            }
-                            break;
-                        case GL_FLOAT_VEC4:
-                            attrData.size = 4;
-                            {
-                                const std::vector<glm::vec4> &curr = getVec4Vector(attrName);
-                                len = curr.size();
-                                attrData.data = curr.data();
-                            }
-                            break;
-                        default:
-                            addData = false;
-                            LOGE("Looking up %s failed ", attrName);
-                            break;
-                    }
-                }
-                if (addData) {
-                    totalStride += attrData.size;
-                    attrMapping.push_back(attrData);
-                    if (attrLen == 0)
-                        attrLen = len;
-                    else {
-                        if (len != attrLen)
-                            LOGE(" $$$$*** Attib length does not match %d vs %d", len, attrLen);
-                    }
-                }
+            if (name == "a_instance_matrix") {
+                // Per instance, the renderer points it at the model matrices of each draw.
+                continue;
             }
-        }
-    }
-
-    void Mesh::createBuffer(std::vector<GLfloat> &buffer, int attrLength) {
-        for (int i = 0; i < attrLength; i++) {
-            for (auto it = attrMapping.begin(); it != attrMapping.end(); ++it) {
-                GLAttributeMapping currAttr = *it;
-                const float *ptr = (float *) currAttr.data;
-                for (int k = 0; k < currAttr.size; k++) {
-                    buffer.push_back(ptr[i * currAttr.size + k]);
-                }
+            auto it = std::find_if(attrMapping.begin(), attrMapping.end(),
+                    [id](const GLAttributeMapping& m) { return m.id == id; });
+            if ((it == attrMapping.end()) || (it->length == 0)) {
+                LOGE("Looking up %s failed ", name.c_str());
+                glDisableVertexAttribArray(loc);
+                continue;
             }
+            glVertexAttribPointer(loc, it->components, it->type, it->normalized,
+                                  vertex_stride_, (GLvoid *) (uintptr_t) it->offset);
+            glEnableVertexAttribArray(loc);
         }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
-
     const GLuint Mesh::getVAOId(int programId) {
         if (programId == -1) {
             LOGI("!! %p Prog Id -- %d ", this, programId);
@@ -294,25 +465,44 @@ namespace gvr {
         {
             generateVAO(programId);
         }
-        auto it = program_ids_.find(programId);
-        if (it != program_ids_.end())
+        else if (!dirty_vertices_.empty() || !dirty_indices_.empty())
         {
-            GLVaoVboId id = it->second;
-            return id.vaoID;
+            uploadDirtyRanges();
         }
-        vao_dirty_ = true;
-        generateVAO(programId);
-        it = program_ids_.find(programId);
-        if (it != program_ids_.end())
+        LayoutVao& vao = layout_vaos_[layoutOf(programId)];
+        if (vao.vaoID == 0)
+        {
+            setupVao(vao);
+        }
+        if (vao.vaoID == 0)
         {
-            GLVaoVboId id = it->second;
-            return id.vaoID;
+            LOGI("!! %p Error in creating VAO  for Prog Id -- %d", this, programId);
+        }
+        return vao.vaoID;
+    }
+
+    void Mesh::deleteVaoForProgram(int programId) {
+        auto it = program_layouts_.find(programId);
+        if (it == program_layouts_.end()) {
+            return;
+        }
+        unsigned int layout = it->second;
+        program_layouts_.erase(it);
+        for (auto p = program_layouts_.begin(); p != program_layouts_.end(); ++p) {
+            if (p->second == layout) {
+                return;     // still used by another program
+            }
+        }
+        auto vao = layout_vaos_.find(layout);
+        if (vao != layout_vaos_.end()) {
+            if (vao->second.vaoID != 0) {
+                GL(glDeleteVertexArrays(1, &vao->second.vaoID));
+            }
+            layout_vaos_.erase(vao);
         }
-        LOGI("!! %p Error in creating VAO  for Prog Id -- %d", this, programId);
-        return 0;
     }
 
-// generate vertex array object
+// upload the vertex and index buffers shared by all programs
     void Mesh::generateVAO(int programId) {
         if (!vao_dirty_) {
              return;
@@ -327,66 +517,266 @@ namespace gvr {
                  vertices_.size(), normals_.size());
         }
 
-        GLuint vaoID_;
-        GLuint triangle_vboID_;
-        GLuint static_vboID_;
-        auto it = program_ids_.find(programId);
-        if (it != program_ids_.end()) {
+        if (vboID_ == 0) {
+            glGenBuffers(1, &vboID_);
+            glGenBuffers(1, &iboID_);
+        }
+        // no VAO may pick up the index buffer binding
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID_);
+        index_type_ = chooseIndexType();
+        if (index_type_ == GL_UNSIGNED_SHORT) {
+            std::vector<GLushort> narrow(indices_.begin(), indices_.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * narrow.size(),
+                         narrow.data(), GL_STATIC_DRAW);
+        } else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices_.size(),
+                         indices_.data(), GL_STATIC_DRAW);
+        }
+        numTriangles_ = indices_.size() / 3;
+
+        int attrLength;
+        createAttributeMapping(attrLength);
+
+        std::vector<GLubyte> buffer;
+        createBuffer(buffer, 0, attrLength);
+        glBindBuffer(GL_ARRAY_BUFFER, vboID_);
+        glBufferData(GL_ARRAY_BUFFER, buffer.size(), buffer.data(), GL_STATIC_DRAW);
+        upload_bytes_ += buffer.size() + indexSize() * indices_.size();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        // the layout may have moved, point the VAOs made so far at it again
+        for (auto it = layout_vaos_.begin(); it != layout_vaos_.end(); ++it) {
+            if (it->second.vaoID != 0) {
+                setupVao(it->second);
+            }
+        }
+        if (programId != -1) {
+            LayoutVao& vao = layout_vaos_[layoutOf(programId)];
+            if (vao.vaoID == 0) {
+                setupVao(vao);
+            }
+        }
+        vao_dirty_ = false;
+        dirty_vertices_.clear();
+        dirty_indices_.clear();
+    }
+
+    /*
+     * Add [first, first + count) to the dirty ranges, merged with those it
+     * overlaps or touches. Ranges far apart stay separate so the parts in
+     * between are not uploaded.
+     */
+    void Mesh::markDirty(std::vector<DirtyRange>& ranges, int first, int count) {
+        DirtyRange range = { first, first + count };
+
+        for (auto it = ranges.begin(); it != ranges.end();) {
+            if ((it->first <= range.end) && (range.first <= it->end)) {
+                range.first = std::min(range.first, it->first);
+                range.end = std::max(range.end, it->end);
+                it = ranges.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        ranges.push_back(range);
+    }
+
+    template <class T>
+    static void copyRange(std::vector<T>& dest, int first, const T* src, int count,
+            const char* what) {
+        if (first < 0 || count < 0 || static_cast<size_t>(first + count) > dest.size()) {
+            std::string error = std::string("Mesh::update : range outside of ") + what;
+            throw error;
+        }
+        std::copy(src, src + count, dest.begin() + first);
+    }
 
-            GLVaoVboId ids = it->second;
-            vaoID_ = ids.vaoID;
-            triangle_vboID_ = ids.triangle_vboID;
-            static_vboID_ = ids.static_vboID;
+    /*
+     * Values written in place have to fit the type their attribute was
+     * packed as. If they do not, the next upload lays out the whole mesh
+     * again and chooses the types anew. Half float positions are bound by
+     * the size of the mesh, so they are also laid out again when it
+     * shrinks.
+     */
+    void Mesh::checkPacking(int id, const float* data, int count) {
+        if (vao_dirty_) {
+            return;
         }
-        else {
-            glGenVertexArrays(1, &vaoID_);
-            glGenBuffers(1, &triangle_vboID_);
-            glGenBuffers(1, &static_vboID_);
+        for (auto it = attrMapping.begin(); it != attrMapping.end(); ++it) {
+            if (it->id != id) {
+                continue;
+            }
+            int values = count * it->size;
+            bool fits = true;
+            if (it->type == GL_HALF_FLOAT) {
+                float bound = (id == VertexAttributes::POSITION) ? positionBound() : it->bound;
+                fits = (bound >= it->bound) && fitsHalf(data, values, bound);
+            } else if (it->type == GL_INT_2_10_10_10_REV) {
+                fits = fitsSnorm(data, values);
+            }
+            if (!fits) {
+                vao_dirty_ = true;
+            }
+            return;
         }
+    }
 
+    void Mesh::updateVertices(int first, const glm::vec3* vertices, int count) {
+        copyRange(vertices_, first, vertices, count, "vertices");
+        have_bounding_volume_ = false;
+        checkPacking(VertexAttributes::POSITION, (const float*) vertices, count);
+        markDirty(dirty_vertices_, first, count);
+    }
 
-        glBindVertexArray(vaoID_);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triangle_vboID_);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short) * indices_.size(),
-                     &indices_[0], GL_STATIC_DRAW);
-        numTriangles_ = indices_.size() / 3;
+    void Mesh::updateNormals(int first, const glm::vec3* normals, int count) {
+        copyRange(normals_, first, normals, count, "normals");
+        checkPacking(VertexAttributes::NORMAL, (const float*) normals, count);
+        markDirty(dirty_vertices_, first, count);
+    }
 
-        attrMapping.clear();
-        int totalStride;
-        int attrLength;
-        createAttributeMapping(programId, totalStride, attrLength);
+    void Mesh::updateVec2Vector(std::string key, int first, const glm::vec2* data, int count) {
+        auto it = vec2_vectors_.find(VertexAttributes::find(key));
+        if (it == vec2_vectors_.end()) {
+            std::string error = "Mesh::updateVec2Vector() : " + key + " not found";
+            throw error;
+        }
+        copyRange(it->second, first, data, count, key.c_str());
+        checkPacking(it->first, (const float*) data, count);
+        markDirty(dirty_vertices_, first, count);
+    }
 
-        std::vector<GLfloat> buffer;
-        createBuffer(buffer, attrLength);
-        glBindBuffer(GL_ARRAY_BUFFER, static_vboID_);
+    void Mesh::updateFloatVector(std::string key, int first, const float* data, int count) {
+        auto it = float_vectors_.find(VertexAttributes::find(key));
+        if (it == float_vectors_.end()) {
+            std::string error = "Mesh::updateFloatVector() : " + key + " not found";
+            throw error;
+        }
+        copyRange(it->second, first, data, count, key.c_str());
+        markDirty(dirty_vertices_, first, count);
+    }
 
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * buffer.size(), &buffer[0],
-                     GL_STATIC_DRAW);
-        int localCnt = 0;
-        for (std::vector<GLAttributeMapping>::iterator it = attrMapping.begin();
-             it != attrMapping.end(); ++it) {
-            GLAttributeMapping currData = *it;
-            glVertexAttribPointer(currData.index, currData.size, currData.type, 0,
-                                  totalStride * sizeof(GLfloat),
-                                  (GLvoid *) (currData.offset * sizeof(GLfloat)));
-            glEnableVertexAttribArray(currData.index);
+    /*
+     * 16 bit indices are enough as long as every vertex can be addressed
+     * with them; ranges updated in place always fall inside the vertices.
+     */
+    GLenum Mesh::chooseIndexType() const {
+        size_t vertex_count = std::max(vertices_.size(), normals_.size());
+        for (auto it = vec2_vectors_.begin(); it != vec2_vectors_.end(); ++it) {
+            vertex_count = std::max(vertex_count, it->second.size());
         }
+        for (auto it = float_vectors_.begin(); it != float_vectors_.end(); ++it) {
+            vertex_count = std::max(vertex_count, it->second.size());
+        }
+        return (vertex_count <= 0x10000) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
 
+    void Mesh::updateIndices(int first, const unsigned int* indices, int count) {
+        copyRange(indices_, first, indices, count, "indices");
+        markDirty(dirty_indices_, first, count);
+    }
 
-        // done generation
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    /*
+     * Write the ranges changed in place into the shared buffers, one call
+     * per range. They are bound to the copy target so no VAO picks them up.
+     */
+    void Mesh::uploadDirtyRanges() {
+        std::vector<GLubyte> buffer;
+        std::vector<GLushort> narrow;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vboID_);
+        for (auto it = dirty_vertices_.begin(); it != dirty_vertices_.end(); ++it) {
+            createBuffer(buffer, it->first, it->end - it->first);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, vertex_stride_ * it->first,
+                    buffer.size(), buffer.data());
+            upload_bytes_ += buffer.size();
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, iboID_);
+        for (auto it = dirty_indices_.begin(); it != dirty_indices_.end(); ++it) {
+            int index_count = it->end - it->first;
+            const void* data = &indices_[it->first];
+            if (index_type_ == GL_UNSIGNED_SHORT) {
+                narrow.assign(indices_.begin() + it->first, indices_.begin() + it->end);
+                data = narrow.data();
+            }
+            glBufferSubData(GL_COPY_WRITE_BUFFER, indexSize() * it->first,
+                    indexSize() * index_count, data);
+            upload_bytes_ += indexSize() * index_count;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        dirty_vertices_.clear();
+        dirty_indices_.clear();
+    }
 
-        if (it == program_ids_.end())
-        {
-            GLVaoVboId id;
-            id.vaoID = vaoID_;
-            id.static_vboID = static_vboID_;
-            id.triangle_vboID = triangle_vboID_;
-            program_ids_[programId] = id;
+    template <class T>
+    static bool sameLength(const std::map<int, std::vector<T>>& vectors, size_t length) {
+        for (auto it = vectors.begin(); it != vectors.end(); ++it) {
+            if (it->second.size() != length) {
+                return false;
+            }
         }
-        vao_dirty_ = false;
+        return true;
+    }
+
+    template <class T>
+    static void remapAll(std::map<int, std::vector<T>>& vectors,
+            const std::vector<unsigned int>& remap) {
+        for (auto it = vectors.begin(); it != vectors.end(); ++it) {
+            MeshOptimizer::remapVertices(it->second, remap);
+        }
+    }
+
+    void Mesh::optimize(float overdraw_threshold, float* report) {
+        int vertex_count = vertices_.size();
+        std::vector<unsigned int> indices(indices_);
+        bool valid = (indices.size() % 3 == 0);
+
+        for (auto it = indices.begin(); valid && (it != indices.end()); ++it) {
+            valid = (*it < static_cast<unsigned int>(vertex_count));
+        }
+        float acmr_before = MeshOptimizer::acmr(indices, vertex_count);
+        float atvr_before = MeshOptimizer::atvr(indices, vertex_count);
+        if (report) {
+            report[0] = report[2] = acmr_before;
+            report[1] = report[3] = atvr_before;
+        }
+        if (!valid) {
+            LOGW("Mesh::optimize : not a triangle list over the vertices, left as it is");
+            return;
+        }
+
+        MeshOptimizer::optimizeVertexCache(indices, vertex_count);
+        MeshOptimizer::optimizeOverdraw(indices, vertices_, overdraw_threshold);
+
+        // every array has to be renumbered along with the positions
+        size_t length = vertex_count;
+        if (!hasBones() && (normals_.empty() || (normals_.size() == length))
+                && sameLength(float_vectors_, length) && sameLength(vec2_vectors_, length)
+                && sameLength(vec3_vectors_, length) && sameLength(vec4_vectors_, length)) {
+            std::vector<unsigned int> remap;
+            MeshOptimizer::optimizeVertexFetch(indices, vertex_count, remap);
+            MeshOptimizer::remapVertices(vertices_, remap);
+            if (!normals_.empty()) {
+                MeshOptimizer::remapVertices(normals_, remap);
+            }
+            remapAll(float_vectors_, remap);
+            remapAll(vec2_vectors_, remap);
+            remapAll(vec3_vectors_, remap);
+            remapAll(vec4_vectors_, remap);
+        }
+        indices_.swap(indices);
+
+        float acmr_after = MeshOptimizer::acmr(indices_, vertex_count);
+        float atvr_after = MeshOptimizer::atvr(indices_, vertex_count);
+        if (report) {
+            report[2] = acmr_after;
+            report[3] = atvr_after;
+        }
+        LOGD("Mesh::optimize : %d triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+                int(indices_.size() / 3), acmr_before, acmr_after, atvr_before, atvr_after);
+        vao_dirty_ = true;
+        dirty();
     }
 
     void Mesh::getAttribNames(std::set<std::string> &attrib_names) {
@@ -401,65 +791,125 @@ namespace gvr {
         }
 
         for (auto it : vec2_vectors_) {
-            attrib_names.insert(it.first);
-            LOGE("vec2 vector %s", (it.first).c_str());
+            attrib_names.insert(VertexAttributes::name(it.first));
+            LOGE("vec2 vector %s", VertexAttributes::name(it.first).c_str());
         }
         for (auto it : vec3_vectors_) {
-            attrib_names.insert(it.first);
+            attrib_names.insert(VertexAttributes::name(it.first));
         }
         for (auto it : vec4_vectors_) {
-            attrib_names.insert(it.first);
+            attrib_names.insert(VertexAttributes::name(it.first));
         }
         for (auto it : float_vectors_) {
-            attrib_names.insert(it.first);
+            attrib_names.insert(VertexAttributes::name(it.first));
         }
 
     }
 
-    void Mesh::generateBoneArrayBuffers(GLuint programId) {
-        if (!bone_data_dirty_) {
-            return;
-        }
-
-        // delete
-        if (boneVboID_ != 0) {
-            GL(glDeleteBuffers(1, &boneVboID_));
-            boneVboID_ = 0;
+    /*
+     * Bone indices and weights in a byte each, the weights normalized.
+     * Rounding is put on the largest weight so they still add up to one.
+     * Fails if a bone index does not fit.
+     */
+    static bool packBoneData(const std::vector<VertexBoneData::BoneData>& bones,
+            std::vector<GLubyte>& packed) {
+        packed.resize(bones.size() * 2 * BONES_PER_VERTEX);
+        for (size_t v = 0; v < bones.size(); ++v) {
+            GLubyte* ids = &packed[v * 2 * BONES_PER_VERTEX];
+            GLubyte* weights = ids + BONES_PER_VERTEX;
+            int sum = 0;
+            int largest = 0;
+
+            for (int k = 0; k < BONES_PER_VERTEX; ++k) {
+                if (bones[v].ids[k] > 255) {
+                    return false;
+                }
+                ids[k] = bones[v].ids[k];
+                weights[k] = glm::packUnorm1x8(bones[v].weights[k]);
+                sum += weights[k];
+                if (weights[k] > weights[largest]) {
+                    largest = k;
+                }
+            }
+            if ((sum != 255) && (std::abs(sum - 255) <= BONES_PER_VERTEX)) {
+                weights[largest] += 255 - sum;
+            }
         }
+        return true;
+    }
 
+    /*
+     * The bone data goes into a buffer of its own, made once and pointed
+     * to by the VAO of every layout drawn with bones.
+     */
+    void Mesh::generateBoneArrayBuffers(GLuint programId) {
         int nVertices = vertices().size();
         if (!vertexBoneData_.getNumBones() || !nVertices) {
             LOGV("no bones or vertices");
             return;
         }
 
-        auto it = program_ids_.find(programId);
-        if (it == program_ids_.end()) {
+        GLuint vaoID = getVAOId(programId);
+        if (vaoID == 0) {
             LOGV("Invalid program Id for bones");
             return;
         }
-        GLVaoVboId id = it->second;
-        glBindVertexArray(id.vaoID);
-
-        // BoneID
-        GLuint boneVboID;
-        glGenBuffers(1, &boneVboID);
-        glBindBuffer(GL_ARRAY_BUFFER, boneVboID);
-        glBufferData(GL_ARRAY_BUFFER,
-                     sizeof(vertexBoneData_.boneData[0]) * vertexBoneData_.boneData.size(),
-                     &vertexBoneData_.boneData[0], GL_STATIC_DRAW
-        );
-        glEnableVertexAttribArray(getBoneIndicesLoc());
-        glVertexAttribIPointer(getBoneIndicesLoc(), 4, GL_INT, sizeof(VertexBoneData::BoneData),
-                               (const GLvoid *) 0);
-
-        // BoneWeight
-        glEnableVertexAttribArray(getBoneWeightsLoc());
-        glVertexAttribPointer(getBoneWeightsLoc(), 4, GL_FLOAT, GL_FALSE,
-                              sizeof(VertexBoneData::BoneData),
-                              (const GLvoid *) (sizeof(VertexBoneData::BoneData::ids)));
-
-        boneVboID_ = boneVboID;
+        if (bone_data_dirty_) {
+            if (boneVboID_ != 0) {
+                GL(glDeleteBuffers(1, &boneVboID_));
+                boneVboID_ = 0;
+            }
+            for (auto it = layout_vaos_.begin(); it != layout_vaos_.end(); ++it) {
+                it->second.has_bones = false;
+            }
+            // BoneID
+            GLuint boneVboID;
+            std::vector<GLubyte> packed;
+            glGenBuffers(1, &boneVboID);
+            glBindBuffer(GL_ARRAY_BUFFER, boneVboID);
+            bones_packed_ = (vertex_format_ & PACK_BONE_WEIGHTS)
+                    && packBoneData(vertexBoneData_.boneData, packed);
+            if (bones_packed_) {
+                glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+            } else {
+                glBufferData(GL_ARRAY_BUFFER,
+                             sizeof(vertexBoneData_.boneData[0]) * vertexBoneData_.boneData.size(),
+                             &vertexBoneData_.boneData[0], GL_STATIC_DRAW
+                );
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            boneVboID_ = boneVboID;
+            bone_data_dirty_ = false;
+        }
+
+        LayoutVao& vao = layout_vaos_[program_layouts_[programId]];
+        if (vao.has_bones) {
+            return;
+        }
+        glBindVertexArray(vaoID);
+        glBindBuffer(GL_ARRAY_BUFFER, boneVboID_);
+        if (bones_packed_) {
+            glEnableVertexAttribArray(getBoneIndicesLoc());
+            glVertexAttribIPointer(getBoneIndicesLoc(), BONES_PER_VERTEX, GL_UNSIGNED_BYTE,
+                                   2 * BONES_PER_VERTEX, (const GLvoid *) 0);
+
+            // BoneWeight
+            glEnableVertexAttribArray(getBoneWeightsLoc());
+            glVertexAttribPointer(getBoneWeightsLoc(), BONES_PER_VERTEX, GL_UNSIGNED_BYTE,
+                                  GL_TRUE, 2 * BONES_PER_VERTEX,
+                                  (const GLvoid *) BONES_PER_VERTEX);
+        } else {
+            glEnableVertexAttribArray(getBoneIndicesLoc());
+            glVertexAttribIPointer(getBoneIndicesLoc(), 4, GL_INT, sizeof(VertexBoneData::BoneData),
+                                   (const GLvoid *) 0);
+
+            // BoneWeight
+            glEnableVertexAttribArray(getBoneWeightsLoc());
+            glVertexAttribPointer(getBoneWeightsLoc(), 4, GL_FLOAT, GL_FALSE,
+                                  sizeof(VertexBoneData::BoneData),
+                                  (const GLvoid *) (sizeof(VertexBoneData::BoneData::ids)));
+        }
+        vao.has_bones = true;
 
         glBindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
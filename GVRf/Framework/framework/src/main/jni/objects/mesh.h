@@ -38,23 +38,45 @@
 #include "objects/material.h"
 #include "objects/bounding_volume.h"
 #include "objects/vertex_bone_data.h"
+#include "objects/vertex_attributes.h"
 
 namespace gvr {
 class Mesh: public HybridObject {
 public:
+    /*
+     * Attributes which may be uploaded in less than 32 bit floats; see
+     * setVertexFormat().
+     */
+    enum VertexFormat {
+        PACK_POSITIONS = 1,     // half floats
+        PACK_NORMALS = 2,       // a_normal, a_tangent, a_bitangent as 10 bit snorm
+        PACK_TEXCOORDS = 4,     // a_texcoord* as half floats
+        PACK_BONE_WEIGHTS = 8,  // bone indices and weights in bytes
+        PACK_ALL = 15
+    };
+
     Mesh() :
             vertices_(),
             normals_(),
-            indices_(),
             float_vectors_(),
             vec2_vectors_(),
             vec3_vectors_(),
             vec4_vectors_(),
-            have_bounding_volume_(false),
+            indices_(),
+            index_type_(GL_UNSIGNED_SHORT),
+            vboID_(0),
+            iboID_(0),
+            vertex_stride_(0),
+            vertex_format_(0),
             vao_dirty_(true),
-            boneVboID_(0),
+            dirty_vertices_(),
+            dirty_indices_(),
+            upload_bytes_(0),
+            have_bounding_volume_(false),
             vertexBoneData_(this),
-            bone_data_dirty_(true)
+            boneVboID_(0),
+            bone_data_dirty_(true),
+            bones_packed_(false)
     {
     }
 
@@ -70,38 +92,32 @@ public:
         vertices.swap(vertices_);
         std::vector<glm::vec3> normals;
         normals.swap(normals_);
-        std::vector<unsigned short> indices;
+        std::vector<unsigned int> indices;
         indices.swap(indices_);
 
         deleteVaos();
     }
 
     //would be nice to remove this; one of the backends uses it for something unique.
-    void deleteVaoForProgram(int programId)
-    {
-        auto it = program_ids_.find(programId);
-        if (it != program_ids_.end())
-        {
-            GLVaoVboId ids = it->second;
-            GL(glDeleteVertexArrays(1, &ids.vaoID));
-            GL(glDeleteBuffers(1, &ids.static_vboID));
-            GL(glDeleteBuffers(1, &ids.triangle_vboID));
-            program_ids_.erase(it);
-        }
-    }
+    void deleteVaoForProgram(int programId);
 
     /**
      * Must be called on the rendering thread
      */
     void deleteVaos() {
-        for (auto it : program_ids_ )
+        for (auto it : layout_vaos_)
         {
-            GLVaoVboId ids = it.second;
-            GL(glDeleteVertexArrays(1, &ids.vaoID));
-            GL(glDeleteBuffers(1, &ids.static_vboID));
-            GL(glDeleteBuffers(1, &ids.triangle_vboID));
+            if (it.second.vaoID != 0) {
+                GL(glDeleteVertexArrays(1, &it.second.vaoID));
+            }
+        }
+        layout_vaos_.clear();
+        program_layouts_.clear();
+        if (vboID_ != 0) {
+            GL(glDeleteBuffers(1, &vboID_));
+            GL(glDeleteBuffers(1, &iboID_));
+            vboID_ = iboID_ = 0;
         }
-        program_ids_.clear();
         have_bounding_volume_ = false;
         vao_dirty_ = true;
         bone_data_dirty_ = true;
@@ -143,56 +159,98 @@ public:
         dirty();
     }
 
-    const std::vector<unsigned short>& triangles() const {
+    const std::vector<unsigned int>& triangles() const {
         return indices_;
     }
 
     void set_triangles(const std::vector<unsigned short>& triangles) {
-        indices_ = triangles;
-        vao_dirty_ = true;
-        dirty();
+        set_indices(triangles);
     }
 
-    void set_triangles(std::vector<unsigned short>&& triangles) {
-        indices_ = std::move(triangles);
-        vao_dirty_ = true;
-        dirty();
+    void set_triangles(std::vector<unsigned int>&& triangles) {
+        set_indices(std::move(triangles));
     }
 
-    const std::vector<unsigned short>& indices() const {
+    /*
+     * Indices are kept 32 bit. The index buffer is narrowed to 16 bit
+     * when every vertex can be addressed that way; indexType() tells
+     * which one the last upload used.
+     */
+    const std::vector<unsigned int>& indices() const {
         return indices_;
     }
 
     void set_indices(const std::vector<unsigned short>& indices) {
+        indices_.assign(indices.begin(), indices.end());
+        vao_dirty_ = true;
+        dirty();
+    }
+
+    void set_indices(const std::vector<unsigned int>& indices) {
         indices_ = indices;
         vao_dirty_ = true;
         dirty();
     }
 
-    void set_indices(std::vector<unsigned short>&& indices) {
+    void set_indices(std::vector<unsigned int>&& indices) {
         indices_ = std::move(indices);
         vao_dirty_ = true;
         dirty();
     }
 
+    GLenum indexType() const {
+        return index_type_;
+    }
+
+    /*
+     * Choose which attributes are packed when uploaded; a combination of
+     * VertexFormat bits. The arrays kept here stay floats. An attribute
+     * is only packed if all its values survive within the precision the
+     * packed type promises, otherwise it is uploaded as floats.
+     */
+    void setVertexFormat(int format) {
+        vertex_format_ = format;
+        vao_dirty_ = true;
+        bone_data_dirty_ = true;
+    }
+
+    int vertexFormat() const {
+        return vertex_format_;
+    }
+
+    /*
+     * Bytes of one vertex in the buffer last uploaded, bones apart.
+     */
+    int vertexStride() const {
+        return vertex_stride_;
+    }
+
+    /*
+     * Attribute arrays are kept by the id VertexAttributes gives their
+     * name; the string accessors below look it up.
+     */
     bool hasAttribute(std::string key) const {
-        if (vec3_vectors_.find(key) != vec3_vectors_.end()) {
+        int id = VertexAttributes::find(key);
+        if (id < 0) {
+            return false;
+        }
+        if (vec3_vectors_.find(id) != vec3_vectors_.end()) {
             return true;
         }
-        if (vec2_vectors_.find(key) != vec2_vectors_.end()) {
+        if (vec2_vectors_.find(id) != vec2_vectors_.end()) {
             return true;
         }
-        if (vec4_vectors_.find(key) != vec4_vectors_.end()) {
+        if (vec4_vectors_.find(id) != vec4_vectors_.end()) {
             return true;
         }
-        if (float_vectors_.find(key) != float_vectors_.end()) {
+        if (float_vectors_.find(id) != float_vectors_.end()) {
             return true;
         }
         return false;
     }
 
     const std::vector<float>& getFloatVector(std::string key) const {
-        auto it = float_vectors_.find(key);
+        auto it = float_vectors_.find(VertexAttributes::find(key));
         if (it != float_vectors_.end()) {
             return it->second;
         } else {
@@ -203,12 +261,12 @@ public:
     }
 
     void setFloatVector(std::string key, const std::vector<float>& vector) {
-        float_vectors_[key] = vector;
+        float_vectors_[VertexAttributes::intern(key)] = vector;
         vao_dirty_ = true;
     }
 
     const std::vector<glm::vec2>& getVec2Vector(std::string key) const {
-        auto it = vec2_vectors_.find(key);
+        auto it = vec2_vectors_.find(VertexAttributes::find(key));
         if (it != vec2_vectors_.end()) {
             return it->second;
         } else {
@@ -218,7 +276,7 @@ public:
     }
 
     bool getVec(std::string key, std::vector<glm::vec2>** const ptr)  {
-        auto it = vec2_vectors_.find(key);
+        auto it = vec2_vectors_.find(VertexAttributes::find(key));
         if (it != vec2_vectors_.end()) {
             *ptr = &(it->second);
             return true;
@@ -229,7 +287,7 @@ public:
     }
 
     void setVec2Vector(std::string key, const std::vector<glm::vec2>& vector) {
-        vec2_vectors_[key] = vector;
+        vec2_vectors_[VertexAttributes::intern(key)] = vector;
         if(strstr((key.c_str()),"a_texcoord")) {
             dirty();
         }
@@ -237,7 +295,7 @@ public:
     }
 
     const std::vector<glm::vec3>& getVec3Vector(std::string key) const {
-        auto it = vec3_vectors_.find(key);
+        auto it = vec3_vectors_.find(VertexAttributes::find(key));
         if (it != vec3_vectors_.end()) {
             return it->second;
         } else {
@@ -247,12 +305,12 @@ public:
     }
 
     void setVec3Vector(std::string key, const std::vector<glm::vec3>& vector) {
-        vec3_vectors_[key] = vector;
+        vec3_vectors_[VertexAttributes::intern(key)] = vector;
         vao_dirty_ = true;
     }
 
     const std::vector<glm::vec4>& getVec4Vector(std::string key) const {
-        auto it = vec4_vectors_.find(key);
+        auto it = vec4_vectors_.find(VertexAttributes::find(key));
         if (it != vec4_vectors_.end()) {
             return it->second;
         } else {
@@ -262,10 +320,43 @@ public:
     }
 
     void setVec4Vector(std::string key, const std::vector<glm::vec4>& vector) {
-        vec4_vectors_[key] = vector;
+        vec4_vectors_[VertexAttributes::intern(key)] = vector;
         vao_dirty_ = true;
     }
 
+    /*
+     * Overwrite part of the data in place. Unlike the setters these keep
+     * the VAOs; the next getVAOId() writes only the changed ranges into
+     * the existing buffers with glBufferSubData. Values that no longer fit
+     * the packed type of their attribute make it upload everything again.
+     * The ranges have to lie inside the current arrays.
+     */
+    void updateVertices(int first, const glm::vec3* vertices, int count);
+    void updateNormals(int first, const glm::vec3* normals, int count);
+    void updateVec2Vector(std::string key, int first, const glm::vec2* data, int count);
+    void updateFloatVector(std::string key, int first, const float* data, int count);
+    void updateIndices(int first, const unsigned int* indices, int count);
+
+    /*
+     * Bytes written to the vertex and index buffers since the last call,
+     * which resets it.
+     */
+    int takeUploadBytes() {
+        int bytes = upload_bytes_;
+        upload_bytes_ = 0;
+        return bytes;
+    }
+
+    /*
+     * Reorder the triangles for the post transform cache and for less
+     * overdraw, then renumber the vertices in the order they are used;
+     * see MeshOptimizer. What is drawn does not change. Vertices are not
+     * renumbered for skinned meshes or if the arrays differ in length.
+     * overdraw_threshold is how much worse the cache may get for less
+     * overdraw. report, if not null, gets ACMR and ATVR before and after.
+     */
+    void optimize(float overdraw_threshold, float* report);
+
     Mesh* createBoundingBox();
     void getTransformedBoundingBoxInfo(glm::mat4 *M,
             float *transformed_bounding_box); //Get Bounding box info transformed by matrix
@@ -287,25 +378,25 @@ public:
     }
 
     void setVertexAttribLocF(GLuint location, std::string key) {
-        attribute_float_keys_[location] = key;
+        attribute_locations_[location] = VertexAttributes::intern(key);
         vao_dirty_ = true;
         LOGD("SHADER: setVertexAttrib %s\n", key.c_str());
     }
 
     void setVertexAttribLocV2(GLuint location, std::string key) {
-        attribute_vec2_keys_[location] = key;
+        attribute_locations_[location] = VertexAttributes::intern(key);
         vao_dirty_ = true;
         LOGD("SHADER: setVertexAttrib %s\n", key.c_str());
     }
 
     void setVertexAttribLocV3(GLuint location, std::string key) {
-        attribute_vec3_keys_[location] = key;
+        attribute_locations_[location] = VertexAttributes::intern(key);
         vao_dirty_ = true;
         LOGD("SHADER: setVertexAttrib %s\n", key.c_str());
     }
 
     void setVertexAttribLocV4(GLuint location, std::string key) {
-        attribute_vec4_keys_[location] = key;
+        attribute_locations_[location] = VertexAttributes::intern(key);
         vao_dirty_ = true;
         LOGD("SHADER: setVertexAttrib %s\n", key.c_str());
     }
@@ -355,43 +446,76 @@ private:
     std::vector<glm::vec3> vertices_;
     std::vector<glm::vec3> normals_;
 
-    std::map<std::string, std::vector<float>> float_vectors_;
-    std::map<std::string, std::vector<glm::vec2>> vec2_vectors_;
-    std::map<std::string, std::vector<glm::vec3>> vec3_vectors_;
-    std::map<std::string, std::vector<glm::vec4>> vec4_vectors_;
-    std::vector<unsigned short> indices_;
-
-    // add location slot map
-    std::map<int, std::string> attribute_float_keys_;
-    std::map<int, std::string> attribute_vec2_keys_;
-    std::map<int, std::string> attribute_vec3_keys_;
-    std::map<int, std::string> attribute_vec4_keys_;
-
-    // add vertex array object and VBO
-
-    struct GLVaoVboId {
+    // by attribute id
+    std::map<int, std::vector<float>> float_vectors_;
+    std::map<int, std::vector<glm::vec2>> vec2_vectors_;
+    std::map<int, std::vector<glm::vec3>> vec3_vectors_;
+    std::map<int, std::vector<glm::vec4>> vec4_vectors_;
+    std::vector<unsigned int> indices_;
+    GLenum index_type_;
+
+    // add location slot map: attribute id by location
+    std::map<int, int> attribute_locations_;
+
+    /*
+     * Every attribute of the mesh is interleaved into one vertex buffer,
+     * in attribute id order, next to one index buffer. Programs only
+     * differ in where they read the attributes from, so there is one
+     * vertex array object per layout (see VertexAttributes) and programs
+     * with the same layout share it.
+     */
+    struct LayoutVao {
         GLuint vaoID;
-        GLuint static_vboID;
-        GLuint triangle_vboID;
+        bool has_bones;
+        std::vector<int> bindings;  // location, attribute id pairs
     };
-
-    std::map<GLuint, GLVaoVboId> program_ids_;
+    std::map<unsigned int, LayoutVao> layout_vaos_;
+    std::map<GLuint, unsigned int> program_layouts_;
+    GLuint vboID_;
+    GLuint iboID_;
 
     struct GLAttributeMapping {
-        GLuint          index;
-        GLuint          size;
+        int             id;
+        GLuint          size;       // floats per vertex in data
+        GLint           components; // as given to glVertexAttribPointer
         GLenum          type;
-        GLuint          offset;
-        const void*     data;
+        GLboolean       normalized;
+        GLuint          offset;     // in bytes
+        GLuint          bytes;
+        int             length;
+        const float*    data;
+        float           bound;      // precision a GL_HALF_FLOAT attribute was checked for
     };
     std::vector<GLAttributeMapping> attrMapping;
-
-    void createAttributeMapping(int programId, int& totalStride, int& attrLength);
-    void createBuffer(std::vector<GLfloat>& buffer, int attrLength);
+    struct DirtyRange {
+        int first;
+        int end;       // one past the last
+    };
+    int vertex_stride_;             // in bytes
+    int vertex_format_;
+
+    void createAttributeMapping(int& attrLength);
+    void chooseAttributeType(GLAttributeMapping& attr);
+    float positionBound();
+    void checkPacking(int id, const float* data, int count);
+    void createBuffer(std::vector<GLubyte>& buffer, int first, int count);
+    unsigned int layoutOf(GLuint programId);
+    void setupVao(LayoutVao& vao);
+    static void markDirty(std::vector<DirtyRange>& ranges, int first, int count);
+    void uploadDirtyRanges();
+    GLenum chooseIndexType() const;
+    int indexSize() const {
+        return (index_type_ == GL_UNSIGNED_INT) ? sizeof(GLuint) : sizeof(GLushort);
+    }
 
     // triangle information
     GLuint numTriangles_;
     bool vao_dirty_;
+    // disjoint ranges of vertices and indices changed in place since the
+    // last upload
+    std::vector<DirtyRange> dirty_vertices_;
+    std::vector<DirtyRange> dirty_indices_;
+    int upload_bytes_;
     bool have_bounding_volume_;
     BoundingVolume bounding_volume;
 
@@ -402,6 +526,7 @@ private:
 
     GLuint boneVboID_;
     bool bone_data_dirty_;
+    bool bones_packed_;
     static std::vector<std::string> dynamicAttribute_Names_;
 
     std::unordered_set<std::shared_ptr<bool>> dirty_flags_;
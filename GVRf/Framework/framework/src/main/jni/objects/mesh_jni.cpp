@@ -59,6 +59,12 @@ extern "C" {
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeMesh_setIndices(JNIEnv * env,
             jobject obj, jlong jmesh, jcharArray indices);
+    JNIEXPORT jintArray JNICALL
+    Java_org_gearvrf_NativeMesh_getIntIndices(JNIEnv * env,
+            jobject obj, jlong jmesh);
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeMesh_setIntIndices(JNIEnv * env,
+            jobject obj, jlong jmesh, jintArray indices);
 
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeMesh_setFloatVector(JNIEnv * env,
@@ -100,6 +106,18 @@ extern "C" {
     Java_org_gearvrf_NativeMesh_getAttribNames(JNIEnv * env,
             jobject obj, jlong jmesh);
 
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeMesh_setVertexFormat(JNIEnv * env,
+            jobject obj, jlong jmesh, jint format);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_getVertexFormat(JNIEnv * env,
+            jobject obj, jlong jmesh);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeMesh_optimize(JNIEnv * env,
+            jobject obj, jlong jmesh, jfloat overdraw_threshold, jfloatArray jreport);
+
 };
 
 JNIEXPORT jobjectArray JNICALL
@@ -197,56 +215,75 @@ Java_org_gearvrf_NativeMesh_getTexCoords(JNIEnv * env,
     return NULL;
 }
 
+/*
+ * Java chars are 16 bit; indices of meshes with more vertices have to go
+ * through getIntIndices() and setIntIndices().
+ */
+static jcharArray getCharIndices(JNIEnv * env, const std::vector<unsigned int>& indices) {
+    std::vector<jchar> narrow(indices.begin(), indices.end());
+    jcharArray jindices = env->NewCharArray(narrow.size());
+    env->SetCharArrayRegion(jindices, 0, narrow.size(), narrow.data());
+    return jindices;
+}
+
+static std::vector<unsigned short> toNativeIndices(JNIEnv * env, jcharArray indices) {
+    jchar* jindices_pointer = env->GetCharArrayElements(indices, 0);
+    int indices_length = env->GetArrayLength(indices);
+    std::vector<unsigned short> native_indices(jindices_pointer,
+            jindices_pointer + indices_length);
+    env->ReleaseCharArrayElements(indices, jindices_pointer, JNI_ABORT);
+    return native_indices;
+}
+
 JNIEXPORT jcharArray JNICALL
 Java_org_gearvrf_NativeMesh_getTriangles(JNIEnv * env,
         jobject obj, jlong jmesh) {
     Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
-    const std::vector<unsigned short>& triangles = mesh->triangles();
-    jcharArray jtriangles = env->NewCharArray(triangles.size());
-    env->SetCharArrayRegion(jtriangles, 0, triangles.size(), triangles.data());
-    return jtriangles;
+    return getCharIndices(env, mesh->triangles());
 }
 
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeMesh_setTriangles(JNIEnv * env,
         jobject obj, jlong jmesh, jcharArray triangles) {
     Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
-    jchar* jtriangles_pointer = env->GetCharArrayElements(triangles, 0);
-    unsigned short* triangles_pointer =
-            static_cast<unsigned short*>(jtriangles_pointer);
-    int triangles_length = env->GetArrayLength(triangles);
-    std::vector<unsigned short> native_triangles;
-    for (int i = 0; i < triangles_length; ++i) {
-        native_triangles.push_back(triangles_pointer[i]);
-    }
-    mesh->set_triangles(native_triangles);
-    env->ReleaseCharArrayElements(triangles, jtriangles_pointer, 0);
+    mesh->set_triangles(toNativeIndices(env, triangles));
 }
 
 JNIEXPORT jcharArray JNICALL
 Java_org_gearvrf_NativeMesh_getIndices(JNIEnv * env,
         jobject obj, jlong jmesh) {
     Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
-    const std::vector<unsigned short>& indices = mesh->indices();
-    jcharArray jindices = env->NewCharArray(indices.size());
-    env->SetCharArrayRegion(jindices, 0, indices.size(), indices.data());
-    return jindices;
+    return getCharIndices(env, mesh->indices());
 }
 
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeMesh_setIndices(JNIEnv * env,
         jobject obj, jlong jmesh, jcharArray indices) {
     Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
-    jchar* jindices_pointer = env->GetCharArrayElements(indices, 0);
-    unsigned short* indices_pointer =
-            static_cast<unsigned short*>(jindices_pointer);
+    mesh->set_indices(toNativeIndices(env, indices));
+}
+
+JNIEXPORT jintArray JNICALL
+Java_org_gearvrf_NativeMesh_getIntIndices(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    const std::vector<unsigned int>& indices = mesh->indices();
+    jintArray jindices = env->NewIntArray(indices.size());
+    env->SetIntArrayRegion(jindices, 0, indices.size(),
+            reinterpret_cast<const jint*>(indices.data()));
+    return jindices;
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setIntIndices(JNIEnv * env,
+        jobject obj, jlong jmesh, jintArray indices) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    jint* jindices_pointer = env->GetIntArrayElements(indices, 0);
     int indices_length = env->GetArrayLength(indices);
-    std::vector<unsigned short> native_indices;
-    for (int i = 0; i < indices_length; ++i) {
-        native_indices.push_back(indices_pointer[i]);
-    }
-    mesh->set_indices(native_indices);
-    env->ReleaseCharArrayElements(indices, jindices_pointer, 0);
+    std::vector<unsigned int> native_indices(jindices_pointer,
+            jindices_pointer + indices_length);
+    mesh->set_indices(std::move(native_indices));
+    env->ReleaseIntArrayElements(indices, jindices_pointer, JNI_ABORT);
 }
 
 JNIEXPORT jfloatArray JNICALL
@@ -429,4 +466,28 @@ Java_org_gearvrf_NativeMesh_getSphereBound(JNIEnv * env,
     sphere[3] = bvol.radius();
     env->SetFloatArrayRegion(jsphere, 0, 4, sphere);
 }
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setVertexFormat(JNIEnv * env,
+        jobject obj, jlong jmesh, jint format) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->setVertexFormat(format);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeMesh_getVertexFormat(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    return mesh->vertexFormat();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_optimize(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloat overdraw_threshold, jfloatArray jreport) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    float report[4];
+
+    mesh->optimize(overdraw_threshold, report);
+    env->SetFloatArrayRegion(jreport, 0, 4, report);
+}
 }
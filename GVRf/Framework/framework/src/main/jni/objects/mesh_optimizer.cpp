@@ -0,0 +1,315 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Reordering of triangles and vertices for faster drawing.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "mesh_optimizer.h"
+
+namespace gvr {
+
+/*
+ * Misses of a FIFO cache: a vertex is still cached if fewer than
+ * cache_size vertices went in after it.
+ */
+static int cacheMisses(const std::vector<unsigned int>& indices, int vertex_count,
+        int cache_size) {
+    std::vector<unsigned int> timestamps(vertex_count, 0);
+    unsigned int time = cache_size + 1;
+    int misses = 0;
+
+    for (auto it = indices.begin(); it != indices.end(); ++it) {
+        if (time - timestamps[*it] > static_cast<unsigned int>(cache_size)) {
+            timestamps[*it] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+float MeshOptimizer::acmr(const std::vector<unsigned int>& indices, int vertex_count,
+        int cache_size) {
+    int triangles = indices.size() / 3;
+    if (triangles == 0) {
+        return 0.0f;
+    }
+    return float(cacheMisses(indices, vertex_count, cache_size)) / triangles;
+}
+
+float MeshOptimizer::atvr(const std::vector<unsigned int>& indices, int vertex_count,
+        int cache_size) {
+    if (vertex_count == 0) {
+        return 0.0f;
+    }
+    return float(cacheMisses(indices, vertex_count, cache_size)) / vertex_count;
+}
+
+/*
+ * Scores of Forsyth's algorithm. The cache modelled is LRU and larger
+ * than the hardware one; the last triangle's vertices score the same so
+ * that strips are not preferred, and vertices with few triangles left
+ * are boosted so they are finished off.
+ */
+static const int SCORE_CACHE_SIZE = 32;
+static const int SCORE_VALENCE_SIZE = 32;
+
+struct ForsythScores {
+    float cache[SCORE_CACHE_SIZE];
+    float valence[SCORE_VALENCE_SIZE];
+
+    ForsythScores() {
+        const float cache_decay_power = 1.5f;
+        const float last_triangle_score = 0.75f;
+        const float valence_boost_scale = 2.0f;
+        const float valence_boost_power = 0.5f;
+
+        for (int i = 0; i < SCORE_CACHE_SIZE; ++i) {
+            if (i < 3) {
+                cache[i] = last_triangle_score;
+            } else {
+                float scaler = 1.0f / (SCORE_CACHE_SIZE - 3);
+                cache[i] = std::pow(1.0f - (i - 3) * scaler, cache_decay_power);
+            }
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i < SCORE_VALENCE_SIZE; ++i) {
+            valence[i] = valence_boost_scale * std::pow(float(i), -valence_boost_power);
+        }
+    }
+
+    float vertex(int cache_position, int live_triangles) const {
+        if (live_triangles == 0) {
+            return -1.0f;
+        }
+        float score = (cache_position >= 0) ? cache[cache_position] : 0.0f;
+        return score + valence[std::min(live_triangles, SCORE_VALENCE_SIZE - 1)];
+    }
+};
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, int vertex_count) {
+    static const ForsythScores scores;
+    int triangle_count = indices.size() / 3;
+
+    if (triangle_count < 2) {
+        return;
+    }
+
+    // triangles of every vertex; the first live[v] are not emitted yet
+    std::vector<int> live(vertex_count, 0);
+    std::vector<int> first(vertex_count + 1, 0);
+    std::vector<int> adjacency(triangle_count * 3);
+
+    for (auto it = indices.begin(); it != indices.end(); ++it) {
+        ++live[*it];
+    }
+    for (int v = 0; v < vertex_count; ++v) {
+        first[v + 1] = first[v] + live[v];
+    }
+    std::vector<int> filled(first.begin(), first.end() - 1);
+    for (int t = 0; t < triangle_count * 3; ++t) {
+        adjacency[filled[indices[t]]++] = t / 3;
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    std::vector<float> triangle_score(triangle_count, 0.0f);
+    std::vector<char> emitted(triangle_count, 0);
+
+    for (int v = 0; v < vertex_count; ++v) {
+        vertex_score[v] = scores.vertex(-1, live[v]);
+    }
+    int best = 0;
+    for (int t = 0; t < triangle_count; ++t) {
+        triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]]
+                + vertex_score[indices[t * 3 + 2]];
+        if (triangle_score[t] > triangle_score[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    unsigned int cache[SCORE_CACHE_SIZE + 3];
+    unsigned int next_cache[SCORE_CACHE_SIZE + 3];
+    int cache_count = 0;
+    int cursor = 0;
+
+    while (output.size() < indices.size()) {
+        if (best < 0) {
+            // dead end, carry on with the first triangle left
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+            best = cursor;
+        }
+        const unsigned int* tri = &indices[best * 3];
+        emitted[best] = 1;
+        output.insert(output.end(), tri, tri + 3);
+
+        // the triangle is no longer live on its vertices
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = tri[k];
+            int* begin = &adjacency[first[v]];
+            int* end = begin + live[v];
+            *std::find(begin, end, best) = *(end - 1);
+            --live[v];
+        }
+
+        // its vertices go to the front of the cache
+        int next_count = 0;
+        for (int k = 0; k < 3; ++k) {
+            next_cache[next_count++] = tri[k];
+        }
+        for (int i = 0; i < cache_count; ++i) {
+            unsigned int v = cache[i];
+            if ((v != tri[0]) && (v != tri[1]) && (v != tri[2])) {
+                next_cache[next_count++] = v;
+            }
+        }
+        std::copy(next_cache, next_cache + next_count, cache);
+        cache_count = std::min(next_count, SCORE_CACHE_SIZE);
+
+        // rescore what is cached now and what just fell out
+        for (int i = 0; i < next_count; ++i) {
+            unsigned int v = next_cache[i];
+            cache_position[v] = (i < SCORE_CACHE_SIZE) ? i : -1;
+            vertex_score[v] = scores.vertex(cache_position[v], live[v]);
+        }
+        best = -1;
+        float best_score = -1.0f;
+        for (int i = 0; i < next_count; ++i) {
+            unsigned int v = next_cache[i];
+            for (int j = first[v]; j < first[v] + live[v]; ++j) {
+                int t = adjacency[j];
+                triangle_score[t] = vertex_score[indices[t * 3]]
+                        + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+    }
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices,
+        const std::vector<glm::vec3>& positions, float threshold) {
+    int triangle_count = indices.size() / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+
+    // a cluster starts wherever all three vertices of a triangle miss
+    std::vector<int> clusters;
+    std::vector<unsigned int> timestamps(positions.size(), 0);
+    unsigned int time = CACHE_SIZE + 1;
+    for (int t = 0; t < triangle_count; ++t) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = indices[t * 3 + k];
+            if (time - timestamps[v] > CACHE_SIZE) {
+                timestamps[v] = time++;
+                ++misses;
+            }
+        }
+        if ((t == 0) || (misses == 3)) {
+            clusters.push_back(t);
+        }
+    }
+    int cluster_count = clusters.size();
+    if (cluster_count < 2) {
+        return;
+    }
+    clusters.push_back(triangle_count);
+
+    // area weighted centre and normal of every cluster and of the mesh
+    std::vector<glm::vec3> centroids(cluster_count);
+    std::vector<glm::vec3> normals(cluster_count);
+    glm::vec3 mesh_centroid(0.0f);
+    float mesh_area = 0.0f;
+
+    for (int c = 0; c < cluster_count; ++c) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+
+        for (int t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+            const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        mesh_centroid += centroid;
+        mesh_area += area;
+        centroids[c] = (area > 0.0f) ? centroid / area : centroid;
+        normals[c] = normal;
+    }
+    if (mesh_area > 0.0f) {
+        mesh_centroid /= mesh_area;
+    }
+
+    std::vector<float> keys(cluster_count);
+    std::vector<int> order(cluster_count);
+    for (int c = 0; c < cluster_count; ++c) {
+        float length = glm::length(normals[c]);
+        keys[c] = (length > 0.0f)
+                ? glm::dot(centroids[c] - mesh_centroid, normals[c] / length) : 0.0f;
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(),
+            [&keys](int a, int b) { return keys[a] > keys[b]; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (auto it = order.begin(); it != order.end(); ++it) {
+        output.insert(output.end(), indices.begin() + clusters[*it] * 3,
+                indices.begin() + clusters[*it + 1] * 3);
+    }
+    int vertex_count = positions.size();
+    if (acmr(output, vertex_count) <= threshold * acmr(indices, vertex_count)) {
+        indices.swap(output);
+    }
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<unsigned int>& indices, int vertex_count,
+        std::vector<unsigned int>& remap) {
+    const unsigned int unused = ~0u;
+    unsigned int next = 0;
+
+    remap.assign(vertex_count, unused);
+    for (auto it = indices.begin(); it != indices.end(); ++it) {
+        if (remap[*it] == unused) {
+            remap[*it] = next++;
+        }
+        *it = remap[*it];
+    }
+    for (int v = 0; v < vertex_count; ++v) {
+        if (remap[v] == unused) {
+            remap[v] = next++;
+        }
+    }
+}
+
+}
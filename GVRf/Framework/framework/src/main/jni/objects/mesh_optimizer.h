@@ -0,0 +1,96 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Reordering of triangles and vertices for faster drawing.
+ ***************************************************************************/
+
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+
+/*
+ * Reorders the triangle list of a mesh without changing what is drawn:
+ * every triangle keeps its vertices and winding, only the order of the
+ * triangles and the numbering of the vertices change.
+ *
+ * ACMR is the average number of vertices the post transform cache
+ * misses per triangle, 3 at worst and 0.5 at best on large meshes.
+ * ATVR is the number of vertices transformed per vertex of the mesh,
+ * 1 at best.
+ */
+class MeshOptimizer {
+public:
+    // a FIFO cache of this many vertices is what ACMR is measured with
+    static const int CACHE_SIZE = 16;
+
+    /*
+     * ACMR of drawing indices with a FIFO cache of cache_size.
+     */
+    static float acmr(const std::vector<unsigned int>& indices, int vertex_count,
+            int cache_size = CACHE_SIZE);
+
+    /*
+     * ATVR of drawing indices with a FIFO cache of cache_size.
+     */
+    static float atvr(const std::vector<unsigned int>& indices, int vertex_count,
+            int cache_size = CACHE_SIZE);
+
+    /*
+     * Order the triangles so neighbouring ones reuse vertices still in
+     * the cache, after Forsyth's linear speed vertex cache optimisation.
+     */
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, int vertex_count);
+
+    /*
+     * Split triangles ordered for the cache into clusters where the
+     * cache starts over, and draw the clusters facing outwards furthest
+     * from the centre first so they hide the others. The new order is
+     * kept only if its ACMR stays within threshold times the old one.
+     */
+    static void optimizeOverdraw(std::vector<unsigned int>& indices,
+            const std::vector<glm::vec3>& positions, float threshold);
+
+    /*
+     * Number the vertices in the order the triangles first use them;
+     * unused vertices go last. Fills remap with the new index of every
+     * old vertex and rewrites indices.
+     */
+    static void optimizeVertexFetch(std::vector<unsigned int>& indices, int vertex_count,
+            std::vector<unsigned int>& remap);
+
+    /*
+     * Move the elements of data to where remap says.
+     */
+    template <class T>
+    static void remapVertices(std::vector<T>& data, const std::vector<unsigned int>& remap) {
+        std::vector<T> moved(data.size());
+        for (size_t i = 0; i < data.size(); ++i) {
+            moved[remap[i]] = data[i];
+        }
+        data.swap(moved);
+    }
+
+private:
+    MeshOptimizer();
+};
+
+}
+#endif
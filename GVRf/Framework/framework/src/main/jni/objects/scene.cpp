@@ -31,6 +31,14 @@ Scene::Scene() :
         frustum_flag_(false),
         dirtyFlag_(0),
         occlusion_flag_(false),
+        flat_culling_flag_(false),
+        stereo_culling_flag_(true),
+        cpu_occlusion_flag_(false),
+        small_feature_pixels_(0.0f),
+        cull_viewport_height_(0),
+        instancing_flag_(false),
+        null_backend_flag_(false),
+        pipelined_prep_flag_(false),
         pick_visible_(true),
         is_shadowmap_invalid(true) {
     if (main_scene() == NULL) {
@@ -78,11 +86,17 @@ void Scene::pick(SceneObject* sceneobj) {
     if (pick_visible_) {
          Collider* collider = reinterpret_cast<Collider*>(sceneobj->getComponent(Collider::getComponentType()));
         if (collider) {
-            visibleColliders.push_back(collider);
+            pendingColliders.push_back(collider);
         }
      }
 }
 
+void Scene::publishVisibleColliders() {
+    collider_mutex_.lock();
+    visibleColliders.swap(pendingColliders);
+    collider_mutex_.unlock();
+}
+
 void Scene::addCollider(Collider* collider) {
     auto it = std::find(allColliders.begin(), allColliders.end(), collider);
     if (it == allColliders.end()) {
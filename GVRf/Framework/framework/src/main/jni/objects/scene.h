@@ -28,6 +28,7 @@
 #include "objects/hybrid_object.h"
 #include "components/camera_rig.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/flat_scene_graph.h"
 #include "objects/light.h"
 
 namespace gvr {
@@ -60,6 +61,90 @@ public:
     void set_occlusion_culling( bool occlusion_flag){ occlusion_flag_ = occlusion_flag; }
     bool get_occlusion_culling(){ return occlusion_flag_; }
 
+    /*
+     * If set to true the renderer culls against a flattened copy
+     * of the scene graph instead of recursing through the scene objects.
+     */
+    void set_flat_culling( bool flat_flag){ flat_culling_flag_ = flat_flag; }
+    bool get_flat_culling(){ return flat_culling_flag_; }
+
+    /*
+     * If set to true sibling leaves are culled several at a time with
+     * NEON or SSE; otherwise every box goes through the scalar test.
+     */
+    /*
+     * Number of threads used for culling, including the calling one.
+     * Only used with flat culling; 1 culls on the render thread alone.
+     */
+    void set_cull_threads( int thread_count){ flat_scene_graph_.set_cull_threads(thread_count); }
+    int get_cull_threads(){ return flat_scene_graph_.get_cull_threads(); }
+
+    void set_simd_culling( bool simd_flag){ flat_scene_graph_.set_simd_culling(simd_flag); }
+    bool get_simd_culling(){ return flat_scene_graph_.get_simd_culling(); }
+
+    /*
+     * If set to true culling for the main camera rig's center camera
+     * uses one frustum enclosing both eyes, so the render list built
+     * once per frame is valid for the left and the right eye.
+     */
+    void set_stereo_culling( bool stereo_flag){ stereo_culling_flag_ = stereo_flag; }
+    bool get_stereo_culling(){ return stereo_culling_flag_; }
+
+    /*
+     * If set to true objects hidden behind render data marked as
+     * occluders are culled on the CPU after frustum culling.
+     */
+    void set_cpu_occlusion_culling( bool cpu_occlusion_flag){ cpu_occlusion_flag_ = cpu_occlusion_flag; }
+    bool get_cpu_occlusion_culling(){ return cpu_occlusion_flag_; }
+
+    /*
+     * Objects whose bounding sphere covers fewer pixel rows than this
+     * are culled along with their children. 0 turns it off.
+     */
+    void set_small_feature_culling( float min_pixels){ small_feature_pixels_ = min_pixels; }
+    float get_small_feature_culling(){ return small_feature_pixels_; }
+
+    /*
+     * Height in pixels of the eye buffers the scene is culled for,
+     * which sizes on screen are measured against.
+     */
+    void set_cull_viewport_height( int height){ cull_viewport_height_ = height; }
+    int get_cull_viewport_height(){ return cull_viewport_height_; }
+
+    /*
+     * If set to true render data sharing a mesh, passes and render state
+     * are drawn instanced instead of being merged into batches, if their
+     * shaders read a_instance_matrix. The others are still batched.
+     */
+    void set_instancing( bool instancing_flag){ instancing_flag_ = instancing_flag; }
+    bool get_instancing(){ return instancing_flag_; }
+
+    /*
+     * If set to true recorded render commands are replayed into a backend
+     * that makes no GL calls, so nothing is drawn. For timing the
+     * recording on its own.
+     */
+    void set_null_backend( bool null_backend_flag){ null_backend_flag_ = null_backend_flag; }
+    bool get_null_backend(){ return null_backend_flag_; }
+
+    /*
+     * If set to true the next frame is culled and sorted on a thread of
+     * its own while the GL thread submits the current one, so what gets
+     * drawn is one frame behind the scene hierarchy.
+     */
+    void set_pipelined_prep( bool pipelined_prep_flag){ pipelined_prep_flag_ = pipelined_prep_flag; }
+    bool get_pipelined_prep(){ return pipelined_prep_flag_; }
+
+    /*
+     * Vertex and index budget of one batch when meshes are merged on
+     * the CPU.
+     */
+    void set_batch_budget( int max_vertices, int max_indices){
+        Renderer::getInstance()->setBatchBudget(max_vertices, max_indices);
+    }
+
+    FlatSceneGraph& getFlatSceneGraph() { return flat_scene_graph_; }
+
     /*
      * Adds a new light to the scene.
      * Return true if light was added, false if already there or too many lights.
@@ -77,11 +162,119 @@ public:
             return gRenderer->getNumberDrawCalls();
         }
     }
+    int getNumberRenderCommands() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getNumberRenderCommands();
+        }
+        return 0;
+    }
+    long long getCommandRecordTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getCommandRecordTime();
+        }
+        return 0;
+    }
+    long long getCommandReplayTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getCommandReplayTime();
+        }
+        return 0;
+    }
+    int getShadowCasters() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getShadowCasters();
+        }
+        return 0;
+    }
+    int getShadowMapsUpdated() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getShadowMapsUpdated();
+        }
+        return 0;
+    }
+    int getShadowMapsSkipped() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getShadowMapsSkipped();
+        }
+        return 0;
+    }
+    long long getFramePrepSnapshotTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getFramePrepSnapshotTime();
+        }
+        return 0;
+    }
+    long long getFramePrepWaitTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getFramePrepWaitTime();
+        }
+        return 0;
+    }
     int getNumberTriangles() {
         if(nullptr!= gRenderer) {
             return gRenderer->getNumberTriangles();
         }
     }
+    long long getCullTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getCullTime();
+        }
+        return 0;
+    }
+    long long getSortTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getSortTime();
+        }
+        return 0;
+    }
+    int getCullAllocations() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getCullAllocations();
+        }
+        return -1;
+    }
+    int getOcclusionQueries() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getOcclusionQueries();
+        }
+        return 0;
+    }
+    int getOcclusionStalls() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getOcclusionStalls();
+        }
+        return 0;
+    }
+    float getOcclusionLatency() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getOcclusionLatency();
+        }
+        return 0;
+    }
+    int getCpuOccluded() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getCpuOccluded();
+        }
+        return 0;
+    }
+    long long getCpuOcclusionTime() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getCpuOcclusionTime();
+        }
+        return 0;
+    }
+    int getNumberGLCallsAvoided() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getNumberGLCallsAvoided();
+        }
+        return 0;
+    }
+    int getBatchUploadBytes() {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getBatchUploadBytes();
+        }
+        return 0;
+    }
 
     void exportToFile(std::string filepath);
 
@@ -127,26 +320,35 @@ public:
     void removeCollider(Collider* collider);
 
     /*
-     * Clear the visible collider list.
+     * Start a new visible collider list.
      * This list is constructed every frame during culling
      * to contain only the pickable objects that are visible.
-     * This function does not lock the collider list!
+     * It is built aside and only replaces the list seen by
+     * lockColliders in publishVisibleColliders.
      */
-    void clearVisibleColliders() { visibleColliders.clear(); }
+    void clearVisibleColliders() { pendingColliders.clear(); }
 
     /*
      * Called during culling to add a scene object's
      * collider to the visible collider list.
+     * Does not lock the collider list.
      */
     void pick(SceneObject* sceneobj);
 
+    /*
+     * Make the visible colliders gathered by pick since the
+     * last clearVisibleColliders the current visible list.
+     * Takes the collider lock once.
+     */
+    void publishVisibleColliders();
+
     /*
      * Get the current collider list and lock it.
      * If set_pick_visible is set the visible collider list
      * is returned. Otherwise the list of all colliders is returned.
      * You should call unlockColliders after you are done with the list.
      */
-    const std::vector<Component*> lockColliders() {
+    const std::vector<Component*>& lockColliders() {
         collider_mutex_.lock();
         return pick_visible_ ? visibleColliders : allColliders;
     }
@@ -180,12 +382,22 @@ private:
     int dirtyFlag_;
     bool frustum_flag_;
     bool occlusion_flag_;
+    bool flat_culling_flag_;
+    bool stereo_culling_flag_;
+    bool cpu_occlusion_flag_;
+    float small_feature_pixels_;
+    int cull_viewport_height_;
+    bool instancing_flag_;
+    bool null_backend_flag_;
+    bool pipelined_prep_flag_;
     bool pick_visible_;
     std::mutex collider_mutex_;
     std::vector<Light*> lightList;
     std::vector<Component*> allColliders;
     std::vector<Component*> visibleColliders;
+    std::vector<Component*> pendingColliders;
     bool is_shadowmap_invalid;
+    FlatSceneGraph flat_scene_graph_;
 };
 
 }
@@ -51,6 +51,46 @@ extern "C" {
     Java_org_gearvrf_NativeScene_setOcclusionQuery(JNIEnv * env,
             jobject obj, jlong jscene, jboolean flag);
 
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setFlatCulling(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setSimdCulling(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setCullThreads(JNIEnv * env,
+            jobject obj, jlong jscene, jint count);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setStereoCulling(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setCpuOcclusionCulling(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setSmallFeatureCulling(JNIEnv * env,
+            jobject obj, jlong jscene, jfloat min_pixels);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setInstancing(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setNullBackend(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setPipelinedFramePrep(JNIEnv * env,
+            jobject obj, jlong jscene, jboolean flag);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setBatchBudget(JNIEnv * env,
+            jobject obj, jlong jscene, jint max_vertices, jint max_indices);
+
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeScene_resetStats(JNIEnv * env,
             jobject obj, jlong jscene);
@@ -59,6 +99,38 @@ extern "C" {
     Java_org_gearvrf_NativeScene_getNumberDrawCalls(JNIEnv * env,
             jobject obj, jlong jscene);
 
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getNumberRenderCommands(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getCommandRecordTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getCommandReplayTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getShadowCasters(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getShadowMapsUpdated(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getShadowMapsSkipped(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getFramePrepSnapshotTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getFramePrepWaitTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeScene_exportToFile(JNIEnv * env,
             jobject obj, jlong jscene, jstring file_path);
@@ -67,6 +139,46 @@ extern "C" {
     Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
             jobject obj, jlong jscene);
 
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getCullTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getSortTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getCullAllocations(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getOcclusionQueries(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getOcclusionStalls(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jfloat JNICALL
+    Java_org_gearvrf_NativeScene_getOcclusionLatency(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getCpuOccluded(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeScene_getCpuOcclusionTime(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getNumberGLCallsAvoided(JNIEnv * env,
+            jobject obj, jlong jscene);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getBatchUploadBytes(JNIEnv * env,
+            jobject obj, jlong jscene);
+
     JNIEXPORT jboolean JNICALL
     Java_org_gearvrf_NativeScene_addLight(
             JNIEnv * env, jobject obj, jlong jscene, jlong light);
@@ -157,6 +269,76 @@ Java_org_gearvrf_NativeScene_setOcclusionQuery(JNIEnv * env,
     scene->set_occlusion_culling(static_cast<bool>(flag));
 }
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setFlatCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_flat_culling(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setSimdCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_simd_culling(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setCullThreads(JNIEnv * env,
+        jobject obj, jlong jscene, jint count) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_cull_threads(count);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setStereoCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_stereo_culling(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setCpuOcclusionCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_cpu_occlusion_culling(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setSmallFeatureCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jfloat min_pixels) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_small_feature_culling(min_pixels);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setInstancing(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_instancing(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setNullBackend(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_null_backend(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setPipelinedFramePrep(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_pipelined_prep(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setBatchBudget(JNIEnv * env,
+        jobject obj, jlong jscene, jint max_vertices, jint max_indices) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_batch_budget(max_vertices, max_indices);
+}
+
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_resetStats(JNIEnv * env,
         jobject obj, jlong jscene) {
@@ -172,6 +354,62 @@ Java_org_gearvrf_NativeScene_getNumberDrawCalls(JNIEnv * env,
     return scene->getNumberDrawCalls();
 }
 
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getNumberRenderCommands(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getNumberRenderCommands();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getCommandRecordTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getCommandRecordTime();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getCommandReplayTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getCommandReplayTime();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getShadowCasters(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getShadowCasters();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getShadowMapsUpdated(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getShadowMapsUpdated();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getShadowMapsSkipped(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getShadowMapsSkipped();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getFramePrepSnapshotTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getFramePrepSnapshotTime();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getFramePrepWaitTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getFramePrepWaitTime();
+}
+
 
 JNIEXPORT int JNICALL
 Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
@@ -180,6 +418,76 @@ Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
     return scene->getNumberTriangles();
 }
 
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getCullTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getCullTime();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getSortTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getSortTime();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getCullAllocations(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getCullAllocations();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getOcclusionQueries(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getOcclusionQueries();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getOcclusionStalls(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getOcclusionStalls();
+}
+
+JNIEXPORT jfloat JNICALL
+Java_org_gearvrf_NativeScene_getOcclusionLatency(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getOcclusionLatency();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getCpuOccluded(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getCpuOccluded();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeScene_getCpuOcclusionTime(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getCpuOcclusionTime();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getNumberGLCallsAvoided(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getNumberGLCallsAvoided();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getBatchUploadBytes(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getBatchUploadBytes();
+}
+
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_exportToFile(JNIEnv * env,
         jobject obj, jlong jscene, jstring filepath) {
@@ -28,18 +28,15 @@
 
 namespace gvr {
 
-SceneObject::SceneObject() :
-        HybridObject(), name_(""), children_(), visible_(true), transform_dirty_(false), in_frustum_(
-                false),  enabled_(true),query_currently_issued_(false), vis_count_(0),
-                cull_status_(false), bounding_volume_dirty_(true) {
+std::atomic<unsigned int> SceneObject::hierarchy_version_(0);
 
-    // Occlusion query setup
-    queries_ = new GLuint[1];
-    glGenQueries(1, queries_);
+SceneObject::SceneObject() :
+        HybridObject(), name_(""), children_(), cull_status_(false), transform_dirty_(false),
+                bounding_volume_dirty_(true), vis_count_(0), visible_(true), enabled_(true),
+                in_frustum_(false) {
 }
 
 SceneObject::~SceneObject() {
-    delete queries_;
 }
 
 bool SceneObject::attachComponent(Component* component) {
@@ -116,6 +113,7 @@ void SceneObject::addChildObject(SceneObject* self, SceneObject* child) {
         children_.push_back(child);
     }
     child->parent_ = self;
+    ++hierarchy_version_;
     Transform* const t = child->transform();
     if (nullptr != t) {
         t->invalidate(false);
@@ -130,6 +128,7 @@ void SceneObject::removeChildObject(SceneObject* child) {
             children_.erase(std::remove(children_.begin(), children_.end(), child), children_.end());
         }
         child->parent_ = NULL;
+        ++hierarchy_version_;
     }
 
     Transform* const t = child->transform();
@@ -146,6 +145,7 @@ void SceneObject::clear() {
         child->parent_ = NULL;
     }
     children_.clear();
+    ++hierarchy_version_;
 }
 
 int SceneObject::getChildrenCount() const {
@@ -350,8 +350,8 @@ BoundingVolume& SceneObject::getBoundingVolume() {
         }
     }
     // 2. Aggregate with all its children's bounding volumes
-    std::vector<SceneObject*> childrenCopy = children();
-    for (auto it = childrenCopy.begin(); it != childrenCopy.end(); ++it) {
+    std::lock_guard < std::mutex > lock(children_mutex_);
+    for (auto it = children_.begin(); it != children_.end(); ++it) {
         BoundingVolume child_bounding_volume = (*it)->getBoundingVolume();
         if (child_bounding_volume.radius() > 0) {
             transformed_bounding_volume_.expand(child_bounding_volume);
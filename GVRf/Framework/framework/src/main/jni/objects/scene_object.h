@@ -21,6 +21,7 @@
 #define SCENE_OBJECT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <mutex>
 
 #include "objects/hybrid_object.h"
@@ -70,14 +71,6 @@ public:
         return visible_;
     }
 
-    void set_query_issued(bool issued = true) {
-        query_currently_issued_ = issued;
-    }
-
-    bool is_query_issued() {
-        return query_currently_issued_;
-    }
-
     bool attachComponent(Component* component);
     bool detachComponent(Component* component);
     Component* detachComponent(long long type);
@@ -129,15 +122,25 @@ public:
         return std::vector<SceneObject*>(children_);
     }
 
+    /*
+     * Get the children without copying them and lock them against being
+     * added or removed. Call unlockChildren when done with the list.
+     */
+    const std::vector<SceneObject*>& lockChildren() {
+        children_mutex_.lock();
+        return children_;
+    }
+
+    void unlockChildren() {
+        children_mutex_.unlock();
+    }
+
     void addChildObject(SceneObject* self, SceneObject* child);
     void removeChildObject(SceneObject* child);
     void getDescendants(std::vector<SceneObject*>& descendants);
     void clear();
     int getChildrenCount() const;
     SceneObject* getChildByIndex(int index);
-    GLuint *get_occlusion_array() {
-        return queries_;
-    }
     bool isColliding(SceneObject* scene_object);
     bool intersectsBoundingVolume(float rox, float roy, float roz, float rdx,
             float rdy, float rdz);
@@ -146,6 +149,31 @@ public:
     void dirtyHierarchicalBoundingVolume();
     BoundingVolume& getBoundingVolume();
 
+    /*
+     * Bounding volume of this object's own mesh in world space.
+     * Only valid after getBoundingVolume() has been called.
+     */
+    const BoundingVolume& getMeshBoundingVolume() const {
+        return mesh_bounding_volume;
+    }
+
+    /*
+     * Incremented whenever a child is added to or removed from
+     * any scene object so cached copies of the hierarchy know
+     * when to rebuild.
+     */
+    static unsigned int hierarchyVersion() {
+        return hierarchy_version_;
+    }
+
+    /*
+     * Make cached copies of the hierarchy rebuild, for changes they
+     * depend on other than children being added or removed.
+     */
+    static void invalidateHierarchy() {
+        ++hierarchy_version_;
+    }
+
     int frustumCull(glm::vec3 camera_position, const float frustum[6][4], int& planeMask);
 
 private:
@@ -159,15 +187,13 @@ private:
     bool bounding_volume_dirty_;
     BoundingVolume mesh_bounding_volume;
 
-    //Flags to check for visibility of a node and
-    //whether there are any pending occlusion queries on it
+    //Flags to check for visibility of a node
     const int check_frames_ = 12;
     int vis_count_;
     bool visible_;
     bool enabled_;
     bool in_frustum_;
-    bool query_currently_issued_;
-    GLuint *queries_ = nullptr;
+    static std::atomic<unsigned int> hierarchy_version_;
 
     SceneObject(const SceneObject& scene_object);
     SceneObject(SceneObject&& scene_object);
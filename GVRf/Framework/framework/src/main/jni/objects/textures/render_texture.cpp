@@ -614,12 +614,21 @@ bool RenderTextureArray::bindFrameBuffer(int layerIndex) {
         glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width(), height(), mNumLayers, 0, GL_RGBA,
                      GL_UNSIGNED_BYTE, NULL);
         glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        // one depth buffer for all layers, so casters hide each other
+        delete renderTexture_gl_render_buffer_;
+        renderTexture_gl_render_buffer_ = new GLRenderBuffer();
+        glBindRenderbuffer(GL_RENDERBUFFER, renderTexture_gl_render_buffer_->id());
+        glRenderbufferStorage(GL_RENDERBUFFER, DEPTH_FORMAT, width(), height());
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
         setReady(fbid > 0);
         checkGLError("create RenderTextureArray");
     }
     bind();
     glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
                               fbid, 0, layerIndex);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                              renderTexture_gl_render_buffer_->id());
     checkGLError("RenderTextureArray::bindFrameBuffer");
     int fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (fboStatus != GL_FRAMEBUFFER_COMPLETE) {
@@ -131,6 +131,11 @@ protected:
 class RenderTextureArray : public RenderTexture
 {
 public:
+    /*
+     * Format of the depth buffer the layers are rendered with.
+     */
+    static const GLenum DEPTH_FORMAT = GL_DEPTH_COMPONENT16;
+
     RenderTextureArray(int width, int height, int numLayers);
     bool bindFrameBuffer(int layerIndex);
     bool bindTexture(int gl_location, int texIndex);
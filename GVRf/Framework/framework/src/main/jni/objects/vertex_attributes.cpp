@@ -0,0 +1,71 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Interned names and layouts of vertex attributes.
+ ***************************************************************************/
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "vertex_attributes.h"
+
+namespace gvr {
+
+// meshes are filled from Java threads and drawn on the GL thread
+static std::mutex attributes_lock;
+static std::unordered_map<std::string, int> attribute_ids = {
+    { "a_position", VertexAttributes::POSITION },
+    { "a_normal", VertexAttributes::NORMAL }
+};
+static std::vector<std::string> attribute_names = { "a_position", "a_normal" };
+static std::map<std::vector<int>, unsigned int> layout_ids;
+
+int VertexAttributes::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(attributes_lock);
+    auto it = attribute_ids.find(name);
+    if (it != attribute_ids.end()) {
+        return it->second;
+    }
+    int id = attribute_names.size();
+    attribute_ids[name] = id;
+    attribute_names.push_back(name);
+    return id;
+}
+
+int VertexAttributes::find(const std::string& name) {
+    std::lock_guard<std::mutex> lock(attributes_lock);
+    auto it = attribute_ids.find(name);
+    return (it != attribute_ids.end()) ? it->second : -1;
+}
+
+std::string VertexAttributes::name(int id) {
+    std::lock_guard<std::mutex> lock(attributes_lock);
+    return attribute_names[id];
+}
+
+unsigned int VertexAttributes::internLayout(const std::vector<int>& bindings) {
+    std::lock_guard<std::mutex> lock(attributes_lock);
+    auto it = layout_ids.find(bindings);
+    if (it != layout_ids.end()) {
+        return it->second;
+    }
+    unsigned int id = layout_ids.size() + 1;
+    layout_ids[bindings] = id;
+    return id;
+}
+
+}
@@ -0,0 +1,70 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Interned names and layouts of vertex attributes.
+ ***************************************************************************/
+
+#ifndef VERTEX_ATTRIBUTES_H_
+#define VERTEX_ATTRIBUTES_H_
+
+#include <string>
+#include <vector>
+
+namespace gvr {
+
+/*
+ * Attribute names are interned to small integers once, so meshes keep
+ * their arrays by index and order them the same way in every buffer.
+ * Position and normal, which every mesh keeps apart, always come first.
+ *
+ * Layouts are what a program reads from a vertex buffer: the pairs of
+ * attribute location and attribute id. Programs with the same layout
+ * can draw a mesh through the same vertex array object.
+ */
+class VertexAttributes {
+public:
+    enum {
+        POSITION = 0,
+        NORMAL = 1
+    };
+
+    /*
+     * Id of name, registering it if it is new.
+     */
+    static int intern(const std::string& name);
+
+    /*
+     * Id of name, or -1 if no mesh or shader ever had it.
+     */
+    static int find(const std::string& name);
+
+    /*
+     * Name registered for id.
+     */
+    static std::string name(int id);
+
+    /*
+     * Id shared by all programs with exactly these location and
+     * attribute id pairs, which have to be sorted by location.
+     */
+    static unsigned int internLayout(const std::vector<int>& bindings);
+
+private:
+    VertexAttributes();
+};
+
+}
+#endif
@@ -19,6 +19,7 @@
 
 #include "assimp_shader.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 #include "util/gvr_log.h"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -43,7 +44,9 @@ static const char NO_SPECULAR_TEXTURE[] = "#undef AS_SPECULAR_TEXTURE\n";
 
 static const char VERTEX_SHADER[] =
                 "in vec3 a_position;\n"
-                "uniform mat4 u_mvp;\n"
+                "layout (std140) uniform Transform_ubo {\n"
+                "    mat4 u_mvp;\n"
+                "};\n"
                 "\n"
                 "#ifdef AS_DIFFUSE_TEXTURE\n"
                 "in vec2 a_texcoord;\n"
@@ -107,79 +110,84 @@ static const char FRAGMENT_SHADER[] =
                 "}\n";
 
 AssimpShader::AssimpShader() :
-         u_mvp_(0), u_diffuse_color_(0), u_ambient_color_(
-                0), u_texture_(0), u_color_(0), u_opacity_(
-                0), program_list_(0) {
+        program_list_(0) {
+    matrix_usage_ = USE_MVP;
     program_list_ = new GLProgram*[AS_TOTAL_GL_PROGRAM_COUNT];
+    for (int i = 0; i < AS_TOTAL_GL_PROGRAM_COUNT; i++) {
+        program_list_[i] = nullptr;
+    }
+}
 
+/*
+ * Build the program for one combination of features.
+ */
+GLProgram* AssimpShader::buildProgram(int i) {
     const char* vertex_shader_strings[AS_TOTAL_SHADER_STRINGS_COUNT];
     GLint vertex_shader_string_lengths[AS_TOTAL_SHADER_STRINGS_COUNT];
     const char* fragment_shader_strings[AS_TOTAL_SHADER_STRINGS_COUNT];
     GLint fragment_shader_string_lengths[AS_TOTAL_SHADER_STRINGS_COUNT];
 
-    for (int i = 0; i < AS_TOTAL_GL_PROGRAM_COUNT; i++) {
-        int counter = 0;
-
-        vertex_shader_strings[counter] =  GLSL_VERSION;
-        vertex_shader_string_lengths[counter] = (GLint) strlen(GLSL_VERSION);
-        fragment_shader_strings[counter] = GLSL_VERSION;
-        fragment_shader_string_lengths[counter] = (GLint) strlen(GLSL_VERSION);
-        counter++;
-
-        // TODO: remove duplicate code
-        if (ISSET(i, AS_DIFFUSE_TEXTURE)) {
-            vertex_shader_strings[counter] =  DIFFUSE_TEXTURE;
-            vertex_shader_string_lengths[counter] = (GLint) strlen(DIFFUSE_TEXTURE);
-            fragment_shader_strings[counter] = DIFFUSE_TEXTURE;
-            fragment_shader_string_lengths[counter] = (GLint) strlen(DIFFUSE_TEXTURE);
-            counter++;
-        } else {
-            vertex_shader_strings[counter] =  NO_DIFFUSE_TEXTURE;
-            vertex_shader_string_lengths[counter] = (GLint) strlen(NO_DIFFUSE_TEXTURE);
-            fragment_shader_strings[counter] = NO_DIFFUSE_TEXTURE;
-            fragment_shader_string_lengths[counter] = (GLint) strlen(NO_DIFFUSE_TEXTURE);
-            counter++;
-        }
+    int counter = 0;
 
-        if (ISSET(i, AS_SPECULAR_TEXTURE)) {
-            vertex_shader_strings[counter] =  SPECULAR_TEXTURE;
-            vertex_shader_string_lengths[counter] = (GLint) strlen(SPECULAR_TEXTURE);
-            fragment_shader_strings[counter] = SPECULAR_TEXTURE;
-            fragment_shader_string_lengths[counter] = (GLint) strlen(SPECULAR_TEXTURE);
-            counter++;
-        } else {
-            vertex_shader_strings[counter] =  NO_SPECULAR_TEXTURE;
-            vertex_shader_string_lengths[counter] = (GLint) strlen(NO_SPECULAR_TEXTURE);
-            fragment_shader_strings[counter] = NO_SPECULAR_TEXTURE;
-            fragment_shader_string_lengths[counter] = (GLint) strlen(NO_SPECULAR_TEXTURE);
-            counter++;
-        }
+    vertex_shader_strings[counter] =  GLSL_VERSION;
+    vertex_shader_string_lengths[counter] = (GLint) strlen(GLSL_VERSION);
+    fragment_shader_strings[counter] = GLSL_VERSION;
+    fragment_shader_string_lengths[counter] = (GLint) strlen(GLSL_VERSION);
+    counter++;
 
-        if (ISSET(i, AS_SKINNING)) {
-            vertex_shader_strings[counter] =  SKINNING;
-            vertex_shader_string_lengths[counter] = (GLint) strlen(SKINNING);
-            fragment_shader_strings[counter] = SKINNING;
-            fragment_shader_string_lengths[counter] = (GLint) strlen(SKINNING);
-            counter++;
-        } else {
-            vertex_shader_strings[counter] =  NO_SKINNING;
-            vertex_shader_string_lengths[counter] = (GLint) strlen(NO_SKINNING);
-            fragment_shader_strings[counter] = NO_SKINNING;
-            fragment_shader_string_lengths[counter] = (GLint) strlen(NO_SKINNING);
-            counter++;
-        }
+    // TODO: remove duplicate code
+    if (ISSET(i, AS_DIFFUSE_TEXTURE)) {
+        vertex_shader_strings[counter] =  DIFFUSE_TEXTURE;
+        vertex_shader_string_lengths[counter] = (GLint) strlen(DIFFUSE_TEXTURE);
+        fragment_shader_strings[counter] = DIFFUSE_TEXTURE;
+        fragment_shader_string_lengths[counter] = (GLint) strlen(DIFFUSE_TEXTURE);
+        counter++;
+    } else {
+        vertex_shader_strings[counter] =  NO_DIFFUSE_TEXTURE;
+        vertex_shader_string_lengths[counter] = (GLint) strlen(NO_DIFFUSE_TEXTURE);
+        fragment_shader_strings[counter] = NO_DIFFUSE_TEXTURE;
+        fragment_shader_string_lengths[counter] = (GLint) strlen(NO_DIFFUSE_TEXTURE);
+        counter++;
+    }
 
-        /* Shader should be added in the last */
-        vertex_shader_strings[counter] = VERTEX_SHADER;
-        vertex_shader_string_lengths[counter] = (GLint) strlen(VERTEX_SHADER);
-        fragment_shader_strings[counter] = FRAGMENT_SHADER;
-        fragment_shader_string_lengths[counter] = (GLint) strlen(FRAGMENT_SHADER);
+    if (ISSET(i, AS_SPECULAR_TEXTURE)) {
+        vertex_shader_strings[counter] =  SPECULAR_TEXTURE;
+        vertex_shader_string_lengths[counter] = (GLint) strlen(SPECULAR_TEXTURE);
+        fragment_shader_strings[counter] = SPECULAR_TEXTURE;
+        fragment_shader_string_lengths[counter] = (GLint) strlen(SPECULAR_TEXTURE);
+        counter++;
+    } else {
+        vertex_shader_strings[counter] =  NO_SPECULAR_TEXTURE;
+        vertex_shader_string_lengths[counter] = (GLint) strlen(NO_SPECULAR_TEXTURE);
+        fragment_shader_strings[counter] = NO_SPECULAR_TEXTURE;
+        fragment_shader_string_lengths[counter] = (GLint) strlen(NO_SPECULAR_TEXTURE);
         counter++;
+    }
 
-        program_list_[i] = new GLProgram(vertex_shader_strings,
-                    vertex_shader_string_lengths, fragment_shader_strings,
-                    fragment_shader_string_lengths, counter);
+    if (ISSET(i, AS_SKINNING)) {
+        vertex_shader_strings[counter] =  SKINNING;
+        vertex_shader_string_lengths[counter] = (GLint) strlen(SKINNING);
+        fragment_shader_strings[counter] = SKINNING;
+        fragment_shader_string_lengths[counter] = (GLint) strlen(SKINNING);
+        counter++;
+    } else {
+        vertex_shader_strings[counter] =  NO_SKINNING;
+        vertex_shader_string_lengths[counter] = (GLint) strlen(NO_SKINNING);
+        fragment_shader_strings[counter] = NO_SKINNING;
+        fragment_shader_string_lengths[counter] = (GLint) strlen(NO_SKINNING);
+        counter++;
     }
+
+    /* Shader should be added in the last */
+    vertex_shader_strings[counter] = VERTEX_SHADER;
+    vertex_shader_string_lengths[counter] = (GLint) strlen(VERTEX_SHADER);
+    fragment_shader_strings[counter] = FRAGMENT_SHADER;
+    fragment_shader_string_lengths[counter] = (GLint) strlen(FRAGMENT_SHADER);
+    counter++;
+
+    return new GLProgram(vertex_shader_strings,
+                vertex_shader_string_lengths, fragment_shader_strings,
+                fragment_shader_string_lengths, counter);
 }
 
 AssimpShader::~AssimpShader() {
@@ -191,11 +199,44 @@ AssimpShader::~AssimpShader() {
     }
 }
 
-void AssimpShader::render(RenderState* rstate,
-        RenderData* render_data, Material* material) {
+void AssimpShader::build(RenderState* rstate, RenderData* render_data,
+        Material* material) {
+    int feature_set = material->get_shader_feature_set() & (AS_TOTAL_GL_PROGRAM_COUNT - 1);
+    if (program_list_[feature_set] != nullptr) {
+        return;
+    }
+    GLProgram* program = buildProgram(feature_set);
+    GLuint id = program->id();
+    Locations& locations = locations_[feature_set];
+
+    if (!locations.transform_block.init(id)) {
+        LOGE("AssimpShader: Transform_ubo not found");
+    }
+    locations.u_texture = glGetUniformLocation(id, "u_texture");
+    locations.u_diffuse_color = glGetUniformLocation(id, "u_diffuse_color");
+    locations.u_ambient_color = glGetUniformLocation(id, "u_ambient_color");
+    locations.u_color = glGetUniformLocation(id, "u_color");
+    locations.u_opacity = glGetUniformLocation(id, "u_opacity");
+    locations.a_bone_indices = glGetAttribLocation(id, "a_bone_indices");
+    locations.a_bone_weights = glGetAttribLocation(id, "a_bone_weights");
+    locations.u_bone_matrices = glGetUniformLocation(id, "u_bone_matrix[0]");
+    if (ISSET(feature_set, AS_SKINNING) && (locations.u_bone_matrices == -1)) {
+        LOGD("Warning! Unable to get the location of uniform u_bone_matrix[0]\n");
+    }
+    program_list_[feature_set] = program;
+}
+
+bool AssimpShader::record(RenderState* rstate, RenderData* render_data,
+        Material* material, RenderCommandList& commands) {
     Texture* texture;
     int feature_set = material->get_shader_feature_set();
 
+    /* Based on feature set get the shader program, feature set cannot exceed program count */
+    int variant = feature_set & (AS_TOTAL_GL_PROGRAM_COUNT - 1);
+    if (program_list_[variant] == nullptr) {
+        return false;
+    }
+
     /* Get the texture only diffuse texture is set */
     if (ISSET(feature_set, AS_DIFFUSE_TEXTURE)) {
         texture = material->getTexture("main_texture");
@@ -206,60 +247,46 @@ void AssimpShader::render(RenderState* rstate,
         }
     }
 
-    /* Based on feature set get the shader program, feature set cannot exceed program count */
-    program_ = program_list_[feature_set & (AS_TOTAL_GL_PROGRAM_COUNT - 1)];
-
-    u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
-    u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
-    u_diffuse_color_ = glGetUniformLocation(program_->id(), "u_diffuse_color");
-    u_ambient_color_ = glGetUniformLocation(program_->id(), "u_ambient_color");
-    u_color_ = glGetUniformLocation(program_->id(), "u_color");
-    u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
+    program_ = program_list_[variant];
+    const Locations& locations = locations_[variant];
 
     /* Get common attributes and uniforms from material */
     glm::vec3 color = material->getVec3("color");
     float opacity = material->getFloat("opacity");
 
-    glUseProgram(program_->id());
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
+    commands.bindProgram(program_->id());
+    locations.transform_block.record(commands, rstate->uniforms, false);
 
     if (ISSET(feature_set, AS_DIFFUSE_TEXTURE)) {
-        glActiveTexture (GL_TEXTURE0);
-        glBindTexture(texture->getTarget(), texture->getId());
-        glUniform1i(u_texture_, 0);
+        commands.bindTexture(0, texture->getTarget(), texture->getId());
+        commands.uniform1i(locations.u_texture, 0);
     } else {
         glm::vec4 diffuse_color = material->getVec4("diffuse_color");
         glm::vec4 ambient_color = material->getVec4("ambient_color");
-        glUniform4f(u_diffuse_color_, diffuse_color.r, diffuse_color.g,
+        commands.uniform4f(locations.u_diffuse_color, diffuse_color.r, diffuse_color.g,
                 diffuse_color.b, diffuse_color.a);
-        glUniform4f(u_ambient_color_, ambient_color.r, ambient_color.g,
+        commands.uniform4f(locations.u_ambient_color, ambient_color.r, ambient_color.g,
                 ambient_color.b, ambient_color.a);
     }
 
-    /* Set up bones if AS_SKINNING is set */
-    if (ISSET(feature_set, AS_SKINNING)) {
-        a_bone_indices_ = glGetAttribLocation(program_->id(), "a_bone_indices");
-        a_bone_weights_ = glGetAttribLocation(program_->id(), "a_bone_weights");
-        u_bone_matrices_ = glGetUniformLocation(program_->id(), "u_bone_matrix[0]");
-        if (u_bone_matrices_ == -1) {
-            LOGD("Warning! Unable to get the location of uniform u_bone_matrix[0]\n");
-        }
+    /* Set up bones if AS_SKINNING is set, the backend uploads them before drawing */
+    skinned_ = ISSET(feature_set, AS_SKINNING);
+    if (skinned_) {
         Mesh* mesh = render_data->mesh();
-        mesh->setBoneLoc(a_bone_indices_, a_bone_weights_);
-        mesh->generateBoneArrayBuffers(program_->id());
+        mesh->setBoneLoc(locations.a_bone_indices, locations.a_bone_weights);
 
         glm::mat4 finalTransform;
         int nBones = MIN(mesh->getVertexBoneData().getNumBones(), MAX_BONES);
         for (int i = 0; i < nBones; ++i) {
             finalTransform = mesh->getVertexBoneData().getFinalBoneTransform(i);
-            glUniformMatrix4fv(u_bone_matrices_ + i, 1, GL_FALSE, glm::value_ptr(finalTransform));
+            commands.uniformMatrix4fv(locations.u_bone_matrices + i, 1,
+                    glm::value_ptr(finalTransform));
         }
     }
 
-    glUniform3f(u_color_, color.r, color.g, color.b);
-    glUniform1f(u_opacity_, opacity);
-    checkGLError("AssimpShader::render");
+    commands.uniform3f(locations.u_color, color.r, color.g, color.b);
+    commands.uniform1f(locations.u_opacity, opacity);
+    return true;
 }
 
 }
-;
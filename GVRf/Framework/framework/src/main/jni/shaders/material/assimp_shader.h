@@ -21,6 +21,7 @@
 #define ASSIMP_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 #define SETBIT(num, i)                   num = (num | (1 << i))
 #define ISSET(num, i)                    ((num & (1 << i)) != 0)
@@ -51,8 +52,9 @@ public:
     AssimpShader();
     virtual ~AssimpShader();
 
-    virtual void render(RenderState* rstate,  RenderData* render_data,
-            Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     AssimpShader(const AssimpShader& assimp_shader);
@@ -61,19 +63,27 @@ private:
     AssimpShader& operator=(AssimpShader&& assimp_shader);
 
 private:
-    GLProgram** program_list_;
+    /*
+     * Uniform and attribute locations of one program variant.
+     */
+    struct Locations {
+        GLTransformBlock transform_block;
+        GLint u_texture;
+        GLint u_diffuse_color;
+        GLint u_ambient_color;
+        GLint u_color;
+        GLint u_opacity;
+
+        // Bones
+        GLint a_bone_indices;
+        GLint a_bone_weights;
+        GLint u_bone_matrices;
+    };
 
-    GLuint u_mvp_;
-    GLuint u_texture_;
-    GLuint u_diffuse_color_;
-    GLuint u_ambient_color_;
-    GLuint u_color_;
-    GLuint u_opacity_;
-
-    // Bones
-    GLuint a_bone_indices_;
-    GLuint a_bone_weights_;
-    GLuint u_bone_matrices_;
+    GLProgram* buildProgram(int feature_set);
+
+    GLProgram** program_list_;
+    Locations locations_[AS_TOTAL_GL_PROGRAM_COUNT];
 };
 
 }
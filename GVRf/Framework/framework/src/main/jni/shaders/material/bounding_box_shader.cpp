@@ -20,8 +20,6 @@
 #include "bounding_box_shader.h"
 
 #include "gl/gl_program.h"
-#include "objects/material.h"
-#include "util/gvr_log.h"
 
 namespace gvr {
 static const char VERTEX_SHADER[] = //
@@ -39,21 +37,15 @@ static const char FRAGMENT_SHADER[] = //
                 "}\n";
 
 BoundingBoxShader::BoundingBoxShader() :
-        program_(0), u_mvp_(0) {
+        program_(0), u_mvp_(0), a_position_(0) {
     program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
     u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
+    a_position_ = glGetAttribLocation(program_->id(), "a_position");
 }
 
 BoundingBoxShader::~BoundingBoxShader() {
     delete program_;
 }
 
-void BoundingBoxShader::render(const glm::mat4& mvp_matrix,
-        RenderData* render_data, Material* material) {
-    glUseProgram(program_->id());
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
-    checkGLError("BoundingBoxShader::render");
-}
-
 }
 ;
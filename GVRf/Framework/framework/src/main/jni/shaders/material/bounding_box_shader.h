@@ -26,19 +26,30 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "gl/gl_program.h"
 #include "objects/hybrid_object.h"
 
 namespace gvr {
 class GLProgram;
-class RenderData;
-class Material;
 
 class BoundingBoxShader: public HybridObject {
 public:
     BoundingBoxShader();
     virtual ~BoundingBoxShader();
 
-    void render(const glm::mat4& mvp_matrix, RenderData* render_data, Material* material);
+    /*
+     * The caller binds the program, sets u_mvp and draws its own boxes,
+     * so many boxes share one program bind.
+     */
+    GLuint programId() const {
+        return program_->id();
+    }
+    GLuint mvpLocation() const {
+        return u_mvp_;
+    }
+    GLuint positionLocation() const {
+        return a_position_;
+    }
 
 private:
     BoundingBoxShader(const BoundingBoxShader& bounding_box_shader);
@@ -49,6 +60,7 @@ private:
 private:
     GLProgram* program_;
     GLuint u_mvp_;
+    GLuint a_position_;
 };
 
 }
@@ -21,6 +21,7 @@
 #include "objects/material.h"
 #include "util/gvr_log.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 
 // OpenGL Cube map texture uses coordinate system different to other OpenGL functions:
 // Positive x pointing right, positive y pointing up, positive z pointing inward.
@@ -59,13 +60,16 @@
 
 namespace gvr {
 static const char VERTEX_SHADER[] =
-        "attribute vec3 a_position;\n"
-        "attribute vec3 a_normal;\n"
-        "uniform mat4 u_mv;\n"
-        "uniform mat4 u_mv_it;\n"
-        "uniform mat4 u_mvp;\n"
-        "varying vec3 v_viewspace_position;\n"
-        "varying vec3 v_viewspace_normal;\n"
+        "#version 300 es\n"
+        "in vec3 a_position;\n"
+        "in vec3 a_normal;\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_mv;\n"
+        "    mat4 u_mv_it;\n"
+        "    mat4 u_mvp;\n"
+        "};\n"
+        "out vec3 v_viewspace_position;\n"
+        "out vec3 v_viewspace_normal;\n"
         "void main() {\n"
         "  vec4 pos = vec4(a_position, 1.0);\n"
         "  vec4 viewspace_position = u_mv * pos;\n"
@@ -74,41 +78,56 @@ static const char VERTEX_SHADER[] =
         "  gl_Position = u_mvp * pos;\n"
         "}\n";
 
-static const char FRAGMENT_SHADER[] =
-        "precision highp float;\n"
+static const char FRAGMENT_SHADER_HEADER[] =
+        "#version 300 es\n"
+        "precision highp float;\n";
+
+static const char FRAGMENT_SHADER_BODY[] =
         "uniform samplerCube u_texture;\n"
         "uniform vec3 u_color;\n"
         "uniform float u_opacity;\n"
-        "uniform mat4 u_view_i;\n"
-        "varying vec3 v_viewspace_position;\n"
-        "varying vec3 v_viewspace_normal;\n"
+        "in vec3 v_viewspace_position;\n"
+        "in vec3 v_viewspace_normal;\n"
+        "out vec4 fragColor;\n"
         "void main()\n"
         "{\n"
         "  vec3 v_reflected_position = reflect(v_viewspace_position, normalize(v_viewspace_normal));\n"
-        "  vec3 v_tex_coord = (u_view_i * vec4(v_reflected_position, 1.0)).xyz;\n"
+        "  vec3 v_tex_coord = (u_view_inv * vec4(v_reflected_position, 1.0)).xyz;\n"
         "  v_tex_coord.z = -v_tex_coord.z;\n"
-        "  vec4 color = textureCube(u_texture, v_tex_coord.xyz);\n"
-        "  gl_FragColor = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
+        "  vec4 color = texture(u_texture, v_tex_coord.xyz);\n"
+        "  fragColor = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
         "}\n";
 
 CubemapReflectionShader::CubemapReflectionShader() :
-        u_mv_(0), u_mv_it_(0), u_mvp_(
-                0), u_view_i_(0), u_texture_(0), u_color_(0), u_opacity_(0) {
-    program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
-    u_mv_ = glGetUniformLocation(program_->id(), "u_mv");
-    u_mv_it_ = glGetUniformLocation(program_->id(), "u_mv_it");
-    u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
-    u_view_i_ = glGetUniformLocation(program_->id(), "u_view_i");
-    u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
-    u_color_ = glGetUniformLocation(program_->id(), "u_color");
-    u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
+        u_texture_(0), u_color_(0), u_opacity_(0) {
+    matrix_usage_ = USE_MV | USE_MV_IT | USE_MVP;
 }
 
 CubemapReflectionShader::~CubemapReflectionShader() {
     delete program_;
 }
 
-void CubemapReflectionShader::render(RenderState* rstate, RenderData* render_data, Material* material) {
+void CubemapReflectionShader::build(RenderState* rstate, RenderData* render_data,
+        Material* material) {
+    if (program_ != nullptr) {
+        return;
+    }
+    std::string fragment_shader = std::string(FRAGMENT_SHADER_HEADER)
+            + VIEW_UBO_GLSL + FRAGMENT_SHADER_BODY;
+    program_ = new GLProgram(VERTEX_SHADER, fragment_shader.c_str());
+    if (!transform_block_.init(program_->id())) {
+        LOGE("CubemapReflectionShader: Transform_ubo not found");
+    }
+    u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
+    u_color_ = glGetUniformLocation(program_->id(), "u_color");
+    u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
+}
+
+bool CubemapReflectionShader::record(RenderState* rstate, RenderData* render_data,
+        Material* material, RenderCommandList& commands) {
+    if (program_ == nullptr) {
+        return false;
+    }
     Texture* texture = material->getTexture("main_texture");
     glm::vec3 color = material->getVec3("color");
     float opacity = material->getFloat("opacity");
@@ -119,18 +138,13 @@ void CubemapReflectionShader::render(RenderState* rstate, RenderData* render_dat
         throw error;
     }
 
-    glUseProgram(program_->id());
-    glUniformMatrix4fv(u_mv_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mv));
-    glUniformMatrix4fv(u_mv_it_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mv_it));
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
-    glUniformMatrix4fv(u_view_i_, 1, GL_FALSE,
-            glm::value_ptr(rstate->uniforms.u_view_inv));
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
-    glUniform1i(u_texture_, 0);
-    glUniform3f(u_color_, color.r, color.g, color.b);
-    glUniform1f(u_opacity_, opacity);
-    checkGLError("CubemapReflectionShader::render");
+    commands.bindProgram(program_->id());
+    transform_block_.record(commands, rstate->uniforms, false);
+    commands.bindTexture(0, texture->getTarget(), texture->getId());
+    commands.uniform1i(u_texture_, 0);
+    commands.uniform3f(u_color_, color.r, color.g, color.b);
+    commands.uniform1f(u_opacity_, opacity);
+    return true;
 }
 
 }
@@ -22,6 +22,7 @@
 #define CUBEMAP_REFLECTION_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 namespace gvr {
 
@@ -30,7 +31,9 @@ public:
     CubemapReflectionShader();
     virtual ~CubemapReflectionShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     CubemapReflectionShader(const CubemapReflectionShader& cubemap_shader);
@@ -39,10 +42,7 @@ private:
     CubemapReflectionShader& operator=(CubemapReflectionShader&& cubemap_shader);
 
 private:
-    GLuint u_mv_;
-    GLuint u_mv_it_;
-    GLuint u_mvp_;
-    GLuint u_view_i_;
+    GLTransformBlock transform_block_;
     GLuint u_texture_;
     GLuint u_color_;
     GLuint u_opacity_;
@@ -21,6 +21,7 @@
 #include "objects/material.h"
 #include "util/gvr_log.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 
 // OpenGL Cube map texture uses coordinate system different to other OpenGL functions:
 // Positive x pointing right, positive y pointing up, positive z pointing inward.
@@ -63,13 +64,17 @@ const std::string VERTEX_SHADER =
         "#ifdef HAS_MULTIVIEW\n"
         "#extension GL_OVR_multiview2 : enable\n"
         "layout(num_views = 2) in;\n"
-        "uniform mat4 u_mvp_[2];\n"
-        "#else\n"
-        "uniform mat4 u_mvp;\n"
         "#endif\n"
 
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_model;\n"
+        "#ifdef HAS_MULTIVIEW\n"
+        "    mat4 u_mvp_[2];\n"
+        "#else\n"
+        "    mat4 u_mvp;\n"
+        "#endif\n"
+        "};\n"
         "in vec3 a_position;\n"
-        "uniform mat4 u_model;\n"
         "out vec3 v_tex_coord;\n"
 
         "void main() {\n"
@@ -115,12 +120,8 @@ void CubemapShader::programInit(RenderState* rstate){
     fragmentShaderSource = "#version 300 es\n" + fragmentShaderSource;
 
     program_ = new GLProgram(vertexShaderSource.c_str(), fragmentShaderSource.c_str());
-    u_model_ = glGetUniformLocation(program_->id(), "u_model");
-
-    if(rstate->is_multiview) {
-        u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp_[0]");
-    } else {
-        u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
+    if (!transform_block_.init(program_->id())) {
+        LOGE("CubemapShader: Transform_ubo not found");
     }
 
     u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
@@ -129,17 +130,24 @@ void CubemapShader::programInit(RenderState* rstate){
 }
 
 CubemapShader::CubemapShader() {
+    matrix_usage_ = USE_MODEL | USE_MVP;
 }
 
 CubemapShader::~CubemapShader() {
     delete program_;
 }
 
-void CubemapShader::render(RenderState* rstate, RenderData*, Material* material) {
-
-    if(program_ == nullptr) {
+void CubemapShader::build(RenderState* rstate, RenderData*, Material* material) {
+    if (program_ == nullptr) {
         programInit(rstate);
     }
+}
+
+bool CubemapShader::record(RenderState* rstate, RenderData*, Material* material,
+        RenderCommandList& commands) {
+    if (program_ == nullptr) {
+        return false;
+    }
 
     Texture* texture = material->getTexture("main_texture");
     glm::vec3 color = material->getVec3("color");
@@ -149,20 +157,14 @@ void CubemapShader::render(RenderState* rstate, RenderData*, Material* material)
         std::string error = "CubemapShader::render : texture with wrong target";
         throw error;
     }
-    GL(glUseProgram(program_->id()));
-    GL(glUniformMatrix4fv(u_model_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_model)));
-
-    if(rstate->is_multiview) {
-        GL(glUniformMatrix4fv(u_mvp_, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp_[0])));
-    } else {
-        GL(glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp)));
-    }
-
-    GL(glActiveTexture (GL_TEXTURE0));
-    GL(glBindTexture(texture->getTarget(), texture->getId()));
-    GL(glUniform1i(u_texture_, 0));
-    GL(glUniform3f(u_color_, color.r, color.g, color.b));
-    GL(glUniform1f(u_opacity_, opacity));
+    commands.bindProgram(program_->id());
+    transform_block_.record(commands, rstate->uniforms, rstate->is_multiview);
+
+    commands.bindTexture(0, texture->getTarget(), texture->getId());
+    commands.uniform1i(u_texture_, 0);
+    commands.uniform3f(u_color_, color.r, color.g, color.b);
+    commands.uniform1f(u_opacity_, opacity);
+    return true;
 }
 
 }
@@ -21,6 +21,7 @@
 #define CUBEMAP_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 namespace gvr {
 
@@ -30,7 +31,9 @@ public:
     CubemapShader();
     virtual ~CubemapShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     void programInit(RenderState* rstate);
@@ -40,8 +43,7 @@ private:
     CubemapShader& operator=(CubemapShader&& cubemap_shader);
 
 private:
-    GLuint u_model_;
-    GLuint u_mvp_;
+    GLTransformBlock transform_block_;
     GLuint u_texture_;
     GLuint u_color_;
     GLuint u_opacity_;
@@ -19,16 +19,23 @@
 
 #include "custom_shader.h"
 #include "objects/scene.h"
+#include "shaders/shader_manager.h"
 #include "util/gvr_log.h"
+#include "engine/renderer/render_commands.h"
 
 #include <sys/time.h>
 #include "objects/components/shadow_map.h"
 
 namespace gvr {
 CustomShader::CustomShader(const std::string& vertex_shader, const std::string& fragment_shader)
-    : vertexShader_(vertex_shader), fragmentShader_(fragment_shader) {
+    : light_block_(-1), u_shadow_maps_(-1),
+      a_bone_indices_(-1), a_bone_weights_(-1), u_bone_matrices_(-1),
+      vertexShader_(vertex_shader), fragmentShader_(fragment_shader) {
 }
-void CustomShader::initializeOnDemand(RenderState* rstate) {
+/*
+ * Build the program and look up the locations recording needs.
+ */
+void CustomShader::build(RenderState* rstate, RenderData* render_data, Material* material) {
     if (nullptr == program_)
     {
         if(rstate->is_multiview && !(strstr(vertexShader_.c_str(),"gl_ViewID_OVR")
@@ -37,7 +44,15 @@ void CustomShader::initializeOnDemand(RenderState* rstate) {
             LOGE("Your shaders are not multiview");
             std::terminate();
         }
-        program_ = new GLProgram(vertexShader_.c_str(), fragmentShader_.c_str());
+        if (pending_ != nullptr) {
+            pending_->wait();
+            program_ = pending_->take();
+            pending_.reset();
+        }
+        // built here if it was not queued or the compile thread failed
+        if (nullptr == program_) {
+            program_ = new GLProgram(vertexShader_.c_str(), fragmentShader_.c_str());
+        }
         if(rstate->is_multiview && !rstate->shadow_map){
             u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp_[0]");
             u_view_ = glGetUniformLocation(program_->id(), "u_view_[0]");
@@ -52,6 +67,30 @@ void CustomShader::initializeOnDemand(RenderState* rstate) {
         }
         u_right_ = glGetUniformLocation(program_->id(), "u_right");
         u_model_ = glGetUniformLocation(program_->id(), "u_model");
+        instance_matrix_location_ = glGetAttribLocation(program_->id(), "a_instance_matrix");
+        u_shadow_maps_ = glGetUniformLocation(program_->id(), "u_shadow_maps");
+        a_bone_indices_ = glGetAttribLocation(program_->id(), "a_bone_indices");
+        a_bone_weights_ = glGetAttribLocation(program_->id(), "a_bone_weights");
+        u_bone_matrices_ = glGetUniformLocation(program_->id(), "u_bone_matrix[0]");
+
+        // lights declared in Lights_ubo are uploaded once for all programs
+        light_block_ = rstate->light_blocks->init(program_->id());
+
+        // matrices declared in Transform_ubo have no location
+        transform_block_.init(program_->id());
+        matrix_usage_ = 0;
+        if (u_model_ != -1 || transform_block_.has(GLTransformBlock::MODEL)) {
+            matrix_usage_ |= USE_MODEL;
+        }
+        if (u_mv_ != -1 || transform_block_.has(GLTransformBlock::MV)) {
+            matrix_usage_ |= USE_MV;
+        }
+        if (u_mv_it_ != -1 || transform_block_.has(GLTransformBlock::MV_IT)) {
+            matrix_usage_ |= USE_MV_IT;
+        }
+        if (u_mvp_ != -1 || transform_block_.has(GLTransformBlock::MVP)) {
+            matrix_usage_ |= USE_MVP;
+        }
         vertexShader_.clear();
         fragmentShader_.clear();
         LOGE("Custom shader added program %d", program_->id());
@@ -81,6 +120,8 @@ void CustomShader::initializeOnDemand(RenderState* rstate) {
         }
         checkGLError("CustomShader::initialize uniforms");
         uniformVariablesDirty_ = false;
+        bindingPlans_.clear();
+        boundVersion_ = 0;
     }
 
     if (attributeVariablesDirty_) {
@@ -95,6 +136,47 @@ void CustomShader::initializeOnDemand(RenderState* rstate) {
         checkGLError("CustomShader::initialize attributes");
         attributeVariablesDirty_ = false;
     }
+
+    // lights declared outside Lights_ubo are set one uniform at a time
+    if (light_block_ < 0) {
+        const std::vector<Light*>& lightlist = rstate->scene->getLightList();
+        for (auto it = lightlist.begin(); it != lightlist.end(); ++it) {
+            if (*it != nullptr) {
+                (*it)->findUniforms(program_->id());
+            }
+        }
+    }
+}
+
+bool CustomShader::texturesReady(Material* material) {
+    std::lock_guard<std::mutex> lock(textureVariablesLock_);
+    for (auto it = textureVariables_.begin(); it != textureVariables_.end(); ++it) {
+        Texture* texture = material->getTextureNoError(it->key);
+        if ((texture == NULL) || !texture->isReady()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CustomShader::prepare(ShaderManager* shader_manager) {
+    if (nullptr != program_) {
+        return true;
+    }
+    if (nullptr == pending_) {
+        GLProgramCompiler& compiler = shader_manager->compiler();
+        if (!compiler.async()) {
+            return true;
+        }
+        pending_ = compiler.submit(vertexShader_, fragmentShader_);
+    }
+    return pending_->done();
+}
+
+void CustomShader::prewarm(GLProgramCompiler& compiler) {
+    if ((nullptr == program_) && (nullptr == pending_)) {
+        pending_ = compiler.submit(vertexShader_, fragmentShader_);
+    }
 }
 
 CustomShader::~CustomShader() {
@@ -111,13 +193,12 @@ void CustomShader::addTextureKey(const std::string& variable_name, const std::st
         return glGetUniformLocation(programId, variable_name.c_str());
     };
 
-    d.variableType.f_bind = [key] (int& textureIndex, const Material& material, GLuint location) {
-        glActiveTexture(GL_TEXTURE0 + textureIndex);
+    d.variableType.f_bind = [key] (int& textureIndex, const Material& material, GLuint location,
+            RenderCommandList& commands) {
         Texture* texture = material.getTextureNoError(key);
         if (nullptr != texture) {
-            glBindTexture(texture->getTarget(), texture->getId());
-            glUniform1i(location, textureIndex++);
-            checkGLError("CustomShader::addTextureKey");
+            commands.bindTexture(textureIndex, texture->getTarget(), texture->getId());
+            commands.uniform1i(location, textureIndex++);
         }
     };
 
@@ -179,14 +260,15 @@ void CustomShader::addAttributeVec4Key(const std::string& variable_name,
     addAttributeKey(variable_name, key, f);
 }
 void CustomShader::addUniformKey(const std::string& variable_name,
-        const std::string& key, UniformVariableBind f) {
+        const std::string& key, int size) {
     LOGV("CustomShader::uniform:add variable: %s key: %s", variable_name.c_str(), key.c_str());
     Descriptor<UniformVariable> d(variable_name, key);
 
     d.variableType.f_getLocation = [variable_name] (GLuint programId) {
         return glGetUniformLocation(programId, variable_name.c_str());
     };
-    d.variableType.f_bind = f;
+    d.variableType.param = MaterialParams::intern(key);
+    d.variableType.size = size;
 
     std::lock_guard <std::mutex> lock(uniformVariablesLock_);
     uniformVariables_.insert(d);
@@ -196,142 +278,149 @@ void CustomShader::addUniformKey(const std::string& variable_name,
 
 void CustomShader::addUniformFloatKey(const std::string& variable_name,
         const std::string& key) {
-    UniformVariableBind f =
-            [key] (Material& material, GLuint location) {
-                glUniform1f(location, material.getFloat(key));
-            };
-    addUniformKey(variable_name, key, f);
+    addUniformKey(variable_name, key, 1);
 }
 
 
 void CustomShader::addUniformVec2Key(const std::string& variable_name,
         const std::string& key) {
-    UniformVariableBind f =
-            [key] (Material& material, GLuint location) {
-                glm::vec2 v = material.getVec2(key);
-                glUniform2f(location, v.x, v.y);
-            };
-    addUniformKey(variable_name, key, f);
+    addUniformKey(variable_name, key, 2);
 }
 
 
 void CustomShader::addUniformVec3Key(const std::string& variable_name,
         const std::string& key) {
-    UniformVariableBind f =
-            [key] (Material& material, GLuint location) {
-                glm::vec3 v = material.getVec3(key);
-                glUniform3f(location, v.x, v.y, v.z);
-            };
-    addUniformKey(variable_name, key, f);
+    addUniformKey(variable_name, key, 3);
 }
 
 
 void CustomShader::addUniformVec4Key(const std::string& variable_name,
         const std::string& key) {
-    UniformVariableBind f =
-            [key] (Material& material, GLuint location) {
-                glm::vec4 v = material.getVec4(key);
-                glUniform4f(location, v.x, v.y, v.z, v.w);
-            };
-    addUniformKey(variable_name, key, f);
+    addUniformKey(variable_name, key, 4);
 }
 
+
 void CustomShader::addUniformMat4Key(const std::string& variable_name,
         const std::string& key) {
-    UniformVariableBind f =
-            [key] (Material& material, GLuint location) {
-                glm::mat4 m = material.getMat4(key);
-                glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(m));
-            };
-    addUniformKey(variable_name, key, f);
+    addUniformKey(variable_name, key, 16);
 }
 
+/*
+ * Where the uniforms of materials with this layout are found. Built
+ * once per layout; uniforms the material does not have are left out.
+ */
+const std::vector<CustomShader::UniformBinding>& CustomShader::bindingPlan(
+        const Material& material) {
+    auto it = bindingPlans_.find(material.layout());
+    if (it != bindingPlans_.end()) {
+        return it->second;
+    }
 
-void CustomShader::render(RenderState* rstate, RenderData* render_data, Material* material) {
-	//LOGE(" start of render %s", render_data->owner_object()->name().c_str());
-	initializeOnDemand(rstate);
-    checkGLError("CustomShader::initialize");
-    {
-        std::lock_guard<std::mutex> lock(textureVariablesLock_);
-        for (auto it = textureVariables_.begin(); it != textureVariables_.end(); ++it) {
-            Texture* texture = material->getTextureNoError(it->key);
-            if ((texture == NULL) || !texture->isReady()) {
-                return;
+    std::vector<UniformBinding>& plan = bindingPlans_[material.layout()];
+    std::lock_guard<std::mutex> lock(uniformVariablesLock_);
+    for (auto it = uniformVariables_.begin(); it != uniformVariables_.end(); ++it) {
+        const float* values = material.findParam(it->variableType.param, it->variableType.size);
+        if ((it->location != -1) && (values != nullptr)) {
+            UniformBinding binding = { it->location, static_cast<int>(values - material.params()),
+                    it->variableType.size };
+            plan.push_back(binding);
+        }
+    }
+    return plan;
+}
+
+
+bool CustomShader::record(RenderState* rstate, RenderData* render_data, Material* material,
+        RenderCommandList& commands) {
+    if ((nullptr == program_) || textureVariablesDirty_ || uniformVariablesDirty_
+            || attributeVariablesDirty_) {
+        return false;
+    }
+    /*
+     * Lights set one uniform at a time need their locations in this
+     * program
+     */
+    const std::vector<Light*>& lightlist = rstate->scene->getLightList();
+    if (light_block_ < 0) {
+        for (auto it = lightlist.begin(); it != lightlist.end(); ++it) {
+            if ((*it != NULL) && !(*it)->hasUniforms(program_->id())) {
+                return false;
+            }
+        }
+    }
+    commands.bindProgram(program_->id());
+    if (light_block_ < 0) {
+        for (auto it = lightlist.begin(); it != lightlist.end(); ++it) {
+            if (*it != NULL) {
+                (*it)->record(program_->id(), commands);
             }
-            checkGLError("CustomShader::render textureReady");
         }
     }
-   // LOGE("rendering %s with program %d", render_data->owner_object()->name().c_str(), program_->id());
 
     Mesh* mesh = render_data->mesh();
-    glUseProgram(program_->id());
     /*
-     * Update the bone matrices
+     * Update the bone matrices, the backend uploads the bone data
      */
-    int a_bone_indices = glGetAttribLocation(program_->id(), "a_bone_indices");
-    int a_bone_weights = glGetAttribLocation(program_->id(), "a_bone_weights");
-    int u_bone_matrices = glGetUniformLocation(program_->id(), "u_bone_matrix[0]");
-    if ((a_bone_indices >= 0) ||
-        (a_bone_weights >= 0) ||
-        (u_bone_matrices >= 0)) {
+    skinned_ = (a_bone_indices_ >= 0) || (a_bone_weights_ >= 0) || (u_bone_matrices_ >= 0);
+    if (skinned_) {
         glm::mat4 finalTransform;
-        mesh->setBoneLoc(a_bone_indices, a_bone_weights);
-        mesh->generateBoneArrayBuffers(program_->id());
+        mesh->setBoneLoc(a_bone_indices_, a_bone_weights_);
         int nBones = mesh->getVertexBoneData().getNumBones();
         if (nBones > MAX_BONES)
             nBones = MAX_BONES;
-        for (int i = 0; i < nBones; ++i) {
+        for (int i = 0; (u_bone_matrices_ >= 0) && (i < nBones); ++i) {
             finalTransform = mesh->getVertexBoneData().getFinalBoneTransform(i);
-            glUniformMatrix4fv(u_bone_matrices + i, 1, GL_FALSE, glm::value_ptr(finalTransform));
+            commands.uniformMatrix4fv(u_bone_matrices_ + i, 1, glm::value_ptr(finalTransform));
         }
-        checkGLError("CustomShader::render bones");
     }
     /*
-     * Update values of uniform variables
+     * Update values of uniform variables, unless the program still has
+     * them from the last draw with this material
      */
-    {
-        std::lock_guard<std::mutex> lock(uniformVariablesLock_);
-        for (auto it = uniformVariables_.begin(); it != uniformVariables_.end(); ++it) {
-            auto d = *it;
-            try {
-                d.variableType.f_bind(*material, d.location);
-                checkGLError("CustomShader::render bindUniform");
-            } catch(const std::string& exc) {
-                //the keys defined for this shader might not have been used by the material yet
+    if ((material->version() != boundVersion_) || (RenderCommandList::epoch() != boundEpoch_)) {
+        const std::vector<UniformBinding>& plan = bindingPlan(*material);
+        const float* params = material->params();
+        for (auto it = plan.begin(); it != plan.end(); ++it) {
+            const float* values = params + it->offset;
+            switch (it->size) {
+            case 1:
+                commands.uniform(it->location, RenderCommand::FLOAT, 1, values);
+                break;
+            case 2:
+                commands.uniform(it->location, RenderCommand::VEC2, 1, values);
+                break;
+            case 3:
+                commands.uniform(it->location, RenderCommand::VEC3, 1, values);
+                break;
+            case 4:
+                commands.uniform(it->location, RenderCommand::VEC4, 1, values);
+                break;
+            case 16:
+                commands.uniformMatrix4fv(it->location, 1, values);
+                break;
             }
         }
+        boundVersion_ = material->version();
+        boundEpoch_ = RenderCommandList::epoch();
     }
 
-    if (u_model_ != -1){
-    	glUniformMatrix4fv(u_model_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_model));
-    }
-    if (u_mvp_ != -1) {
-        if(rstate->is_multiview && !rstate->shadow_map)
-            glUniformMatrix4fv(u_mvp_, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp_[0]));
-        else
-            glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
+    bool multiview = rstate->is_multiview && !rstate->shadow_map;
+    if (transform_block_.valid()) {
+        transform_block_.record(commands, rstate->uniforms, multiview);
     }
-    if (u_view_ != -1) {
-        if(rstate->is_multiview  && !rstate->shadow_map)
-            glUniformMatrix4fv(u_view_, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_view_[0]));
-        else
-            glUniformMatrix4fv(u_view_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_view));
-    }
-    if (u_mv_ != -1) {
-       if(rstate->is_multiview  && !rstate->shadow_map)
-           glUniformMatrix4fv(u_mv_, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mv_[0]));
-       else
-          glUniformMatrix4fv(u_mv_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mv));
-    }
-    if (u_mv_it_ != -1) {
-        if(rstate->is_multiview  && !rstate->shadow_map)
-            glUniformMatrix4fv(u_mv_it_, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mv_it_[0]));
-        else
-            glUniformMatrix4fv(u_mv_it_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mv_it));
-    }
-    if (u_right_ != 0) {
-        glUniform1i(u_right_, rstate->uniforms.u_right ? 1 : 0);
+    commands.uniformMatrix4fv(u_model_, 1, glm::value_ptr(rstate->uniforms.u_model));
+    if (multiview) {
+        commands.uniformMatrix4fv(u_mvp_, 2, glm::value_ptr(rstate->uniforms.u_mvp_[0]));
+        commands.uniformMatrix4fv(u_view_, 2, glm::value_ptr(rstate->uniforms.u_view_[0]));
+        commands.uniformMatrix4fv(u_mv_, 2, glm::value_ptr(rstate->uniforms.u_mv_[0]));
+        commands.uniformMatrix4fv(u_mv_it_, 2, glm::value_ptr(rstate->uniforms.u_mv_it_[0]));
+    } else {
+        commands.uniformMatrix4fv(u_mvp_, 1, glm::value_ptr(rstate->uniforms.u_mvp));
+        commands.uniformMatrix4fv(u_view_, 1, glm::value_ptr(rstate->uniforms.u_view));
+        commands.uniformMatrix4fv(u_mv_, 1, glm::value_ptr(rstate->uniforms.u_mv));
+        commands.uniformMatrix4fv(u_mv_it_, 1, glm::value_ptr(rstate->uniforms.u_mv_it));
     }
+    commands.uniform1i(u_right_, rstate->uniforms.u_right ? 1 : 0);
     /*
      * Bind textures
      */
@@ -340,16 +429,18 @@ void CustomShader::render(RenderState* rstate, RenderData* render_data, Material
         std::lock_guard<std::mutex> lock(textureVariablesLock_);
         for (auto it = textureVariables_.begin(); it != textureVariables_.end(); ++it) {
             auto d = *it;
-            d.variableType.f_bind(texture_index, *material, d.location);
+            d.variableType.f_bind(texture_index, *material, d.location, commands);
             texture_index++;
-            checkGLError("CustomShader::render bindTexture");
         }
     }
     /*
-     * Update the uniforms for the lights
+     * Lights declared in Lights_ubo and the shadow maps
      */
-    const std::vector<Light*>& lightlist = rstate->scene->getLightList();
     ShadowMap* shadowMap = nullptr;
+    if (light_block_ >= 0)
+    {
+        commands.bindLightBlock(light_block_);
+    }
     for (auto it = lightlist.begin();
          it != lightlist.end();
          ++it)
@@ -357,7 +448,6 @@ void CustomShader::render(RenderState* rstate, RenderData* render_data, Material
         Light* light = (*it);
          if (light != NULL)
          {
-            light->render(program_->id(), texture_index);
             ShadowMap* sm = light->getShadowMap();
             if (sm != nullptr)
             {
@@ -365,14 +455,10 @@ void CustomShader::render(RenderState* rstate, RenderData* render_data, Material
             }
          }
     }
-    if (shadowMap)
+    if (shadowMap && (u_shadow_maps_ >= 0))
     {
-        int loc = glGetUniformLocation(program_->id(), "u_shadow_maps");
-        if (loc >= 0)
-        {
-            shadowMap->bindTexture(loc, texture_index);
-        }
+        shadowMap->recordTexture(u_shadow_maps_, texture_index, commands);
     }
-    checkGLError("CustomShader::render");
+    return true;
 }
 } /* namespace gvr */
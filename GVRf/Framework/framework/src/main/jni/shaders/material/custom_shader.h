@@ -25,9 +25,13 @@
 #include <set>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <mutex>
 #include <vector>
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
+#include "engine/renderer/gl_light_blocks.h"
+#include "gl/gl_program_compiler.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
@@ -41,7 +45,6 @@ namespace gvr {
 struct ShaderUniformsPerObject;
 
 typedef std::function<void(Mesh&, GLuint)> AttributeVariableBind;
-typedef std::function<void(Material&, GLuint)> UniformVariableBind;
 
 class CustomShader: public ShaderBase {
 public:
@@ -60,7 +63,20 @@ public:
     void addUniformVec3Key(const std::string& variable_name, const std::string& key);
     void addUniformVec4Key(const std::string& variable_name, const std::string& key);
     void addUniformMat4Key(const std::string& variable_name, const std::string& key);
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool prepare(ShaderManager* shader_manager);
+    virtual bool texturesReady(Material* material);
+    // known once the program is built
+    virtual bool supportsInstancing() const {
+        return instance_matrix_location_ >= 0;
+    }
+    /*
+     * Start building the program now, on the compile thread if it is
+     * asynchronous or right away if not.
+     */
+    void prewarm(GLProgramCompiler& compiler);
     static int getGLTexture(int n);
     GLuint getProgramId();
 private:
@@ -70,9 +86,7 @@ private:
     CustomShader& operator=(CustomShader&& custom_shader);
 
     void addAttributeKey(const std::string& variable_name, const std::string& key, AttributeVariableBind f);
-    void addUniformKey(const std::string& variable_name, const std::string& key, UniformVariableBind f);
-
-    void initializeOnDemand(RenderState* rstate);
+    void addUniformKey(const std::string& variable_name, const std::string& key, int size);
 
     template <class T> struct Descriptor {
         Descriptor(const std::string& v, const std::string& k) : variable(v), key(k) {
@@ -94,7 +108,7 @@ private:
 
     struct TextureVariable {
         std::function<int(GLuint)> f_getLocation;
-        std::function<void(int&, const Material&, GLuint)> f_bind;
+        std::function<void(int&, const Material&, GLuint, RenderCommandList&)> f_bind;
     };
 
     struct AttributeVariable {
@@ -104,9 +118,22 @@ private:
 
     struct UniformVariable {
         std::function<int(GLuint)> f_getLocation;
-        UniformVariableBind f_bind;
+        int param;  // interned material parameter
+        int size;   // in floats
+    };
+
+    /*
+     * One uniform of the binding plan of a material layout: where its
+     * value is in the material's parameter block.
+     */
+    struct UniformBinding {
+        GLint location;
+        int offset;
+        int size;
     };
 
+    const std::vector<UniformBinding>& bindingPlan(const Material& material);
+
 private:
     GLuint u_mvp_;
     GLuint u_mv_;
@@ -114,6 +141,13 @@ private:
     GLuint u_mv_it_;
     GLuint u_right_;
     GLuint u_model_;
+    GLTransformBlock transform_block_;
+    std::shared_ptr<GLProgramCompiler::Job> pending_;   // program being built
+    int light_block_;       // layout of Lights_ubo, -1 if not declared
+    GLint u_shadow_maps_;
+    GLint a_bone_indices_;
+    GLint a_bone_weights_;
+    GLint u_bone_matrices_;
     bool textureVariablesDirty_ = false;
     std::mutex textureVariablesLock_;
     std::set<Descriptor<TextureVariable>, DescriptorComparator<TextureVariable>> textureVariables_;
@@ -125,6 +159,9 @@ private:
     bool uniformVariablesDirty_ = false;
     std::mutex uniformVariablesLock_;
     std::set<Descriptor<UniformVariable>, DescriptorComparator<UniformVariable>> uniformVariables_;
+    std::unordered_map<unsigned int, std::vector<UniformBinding>> bindingPlans_;   // by material layout
+    unsigned int boundVersion_ = 0;     // of the material whose uniforms the program has
+    unsigned int boundEpoch_ = 0;       // RenderCommandList::epoch() they were recorded in
 
     std::string vertexShader_;
     std::string fragmentShader_;
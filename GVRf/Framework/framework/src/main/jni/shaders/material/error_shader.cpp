@@ -21,41 +21,64 @@
 #include "objects/material.h"
 #include "util/gvr_log.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 
 namespace gvr {
-static const char VERTEX_SHADER[] = "attribute vec4 a_position;\n"
-        "uniform mat4 u_mvp;\n"
+static const char VERTEX_SHADER[] =
+        "#version 300 es\n"
+        "in vec4 a_position;\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_mvp;\n"
+        "};\n"
         "void main() {\n"
         "  gl_Position = u_mvp * a_position;\n"
         "}\n";
 
-static const char FRAGMENT_SHADER[] = "precision highp float;\n"
+static const char FRAGMENT_SHADER[] =
+        "#version 300 es\n"
+        "precision highp float;\n"
         "uniform vec4 u_color;\n"
+        "out vec4 fragColor;\n"
         "void main()\n"
         "{\n"
-        "  gl_FragColor = u_color;\n"
+        "  fragColor = u_color;\n"
         "}\n";
 
-ErrorShader::ErrorShader() {
-    program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
-    u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
-    u_color_ = glGetUniformLocation(program_->id(), "u_color");
+ErrorShader::ErrorShader() :
+        u_color_(0) {
+    matrix_usage_ = USE_MVP;
 }
 
 ErrorShader::~ErrorShader() {
     delete program_;
 }
 
-void ErrorShader::render(RenderState* rstate, RenderData* render_data, Material* mtl_unused) {
+void ErrorShader::build(RenderState* rstate, RenderData* render_data,
+        Material* material) {
+    if (program_ != nullptr) {
+        return;
+    }
+    program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+    if (!transform_block_.init(program_->id())) {
+        LOGE("ErrorShader: Transform_ubo not found");
+    }
+    u_color_ = glGetUniformLocation(program_->id(), "u_color");
+}
+
+bool ErrorShader::record(RenderState* rstate, RenderData* render_data, Material* mtl_unused,
+        RenderCommandList& commands) {
+    if (program_ == nullptr) {
+        return false;
+    }
     float r = 0.0f;
     float g = 1.0f;
     float b = 0.0f;
     float a = 1.0f;
 
-    glUseProgram(program_->id());
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
-    glUniform4f(u_color_, r, g, b, a);
-    checkGLError("ErrorShader::render");
+    commands.bindProgram(program_->id());
+    transform_block_.record(commands, rstate->uniforms, false);
+    commands.uniform4f(u_color_, r, g, b, a);
+    return true;
 }
 
 }
@@ -22,6 +22,7 @@
 #define SOLID_COLOR_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 namespace gvr {
 class Color;
@@ -33,7 +34,9 @@ public:
     ErrorShader();
     virtual ~ErrorShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     ErrorShader(const ErrorShader& error_shader);
@@ -42,8 +45,7 @@ private:
     ErrorShader& operator=(ErrorShader&& error_shader);
 
 private:
-    GLProgram* program_;
-    GLuint u_mvp_;
+    GLTransformBlock transform_block_;
     GLuint u_color_;
 };
 
@@ -9,6 +9,8 @@
 #include "objects/components/texture_capturer.h"
 #include "objects/textures/external_renderer_texture.h"
 #include "util/gvr_log.h"
+#include "engine/renderer/gl_state_cache.h"
+#include "engine/renderer/render_commands.h"
 
 static GVRF_ExternalRenderer externalRenderer = NULL;
 
@@ -18,7 +20,22 @@ void GVRF_installExternalRenderer(GVRF_ExternalRenderer fct) {
 
 namespace gvr {
 
-void ExternalRendererShader::render(RenderState* rstate, RenderData* render_data, Material* mtl_unused) {
+void ExternalRendererShader::build(RenderState* rstate, RenderData* render_data,
+        Material* material) {
+}
+
+/*
+ * The external renderer draws with GL calls of its own, so all there is
+ * to record is handing it the render data.
+ */
+bool ExternalRendererShader::record(RenderState* rstate, RenderData* render_data,
+        Material* mtl_unused, RenderCommandList& commands) {
+    commands.external(render_data, rstate->uniforms.u_mvp);
+    return true;
+}
+
+void ExternalRendererShader::drawExternal(RenderState* rstate, RenderData* render_data,
+        const glm::mat4& mvp) {
     if (externalRenderer == NULL) {
         LOGE("External renderer not installed");
         return;
@@ -72,7 +89,7 @@ void ExternalRendererShader::render(RenderState* rstate, RenderData* render_data
         // Original rendering
         externalRenderer(reinterpret_cast<ExternalRendererTexture*>(texture)->getData(),
                          scratchBuffer, 6,
-                         glm::value_ptr(rstate->uniforms.u_mvp), 16,
+                         glm::value_ptr(mvp), 16,
                          glm::value_ptr(*mesh->getVec2Vector("a_texcoord").data()), mesh->getVec2Vector("a_texcoord").size() * 2,
                          material->getFloat("opacity"));
     } else {
@@ -84,10 +101,10 @@ void ExternalRendererShader::render(RenderState* rstate, RenderData* render_data
             float halfWidth = fabs(vertices[0][0]);
             float halfHeight = fabs(vertices[0][1]);
 
-            glm::mat4 mvp = capturer->getMvpMatrix(halfWidth, halfHeight);
+            glm::mat4 capture_mvp = capturer->getMvpMatrix(halfWidth, halfHeight);
             externalRenderer(reinterpret_cast<ExternalRendererTexture*>(texture)->getData(),
                     scratchBuffer, 6,
-                    glm::value_ptr(mvp), 16,
+                    glm::value_ptr(capture_mvp), 16,
                     glm::value_ptr(*mesh->getVec2Vector("a_texcoord").data()), mesh->getVec2Vector("a_texcoord").size() * 2,
                     1.0);
         }
@@ -102,7 +119,10 @@ void ExternalRendererShader::render(RenderState* rstate, RenderData* render_data
         capturer->callback(TCCB_NEW_CAPTURE, 0);
     }
 
-    checkGLError("ExternalRendererShader::render");
+    // the external renderer and the capture change GL state behind our back
+    rstate->gl_state->invalidate();
+
+    checkGLError("ExternalRendererShader::drawExternal");
 }
 
 }
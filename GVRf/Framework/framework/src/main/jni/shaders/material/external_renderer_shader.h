@@ -18,8 +18,18 @@ namespace gvr {
 
 class ExternalRendererShader : public ShaderBase {
 public:
-    ExternalRendererShader() {}
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    ExternalRendererShader() {
+        matrix_usage_ = USE_MVP;
+    }
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
+
+    /*
+     * Replay of the EXTERNAL command: call the external renderer for
+     * render_data. GL thread.
+     */
+    void drawExternal(RenderState* rstate, RenderData* render_data, const glm::mat4& mvp);
 
 private:
     ExternalRendererShader(
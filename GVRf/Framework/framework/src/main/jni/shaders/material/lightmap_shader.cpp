@@ -21,40 +21,62 @@
 #include "objects/material.h"
 #include "util/gvr_log.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 
 namespace gvr {
-static const char VERTEX_SHADER[] = "attribute vec4 a_position;\n"
-        "attribute vec3 a_normal;\n"
-        "attribute vec2 a_texcoord;\n"
-        "uniform mat4 u_mvp;\n"
-        "varying vec2 coord;\n"
+static const char VERTEX_SHADER[] =
+        "#version 300 es\n"
+        "in vec4 a_position;\n"
+        "in vec3 a_normal;\n"
+        "in vec2 a_texcoord;\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_mvp;\n"
+        "};\n"
+        "out vec2 coord;\n"
         "void main() {\n"
         " vec4 pos = u_mvp * a_position;\n"
         " coord = a_texcoord;\n"
         " gl_Position = pos;\n"
         "}";
 
-static const char FRAGMENT_SHADER[] = "precision mediump float;\n"
-        "varying vec2  coord;\n"
+static const char FRAGMENT_SHADER[] =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "in vec2  coord;\n"
         "uniform sampler2D u_main_texture;\n"
         "uniform sampler2D u_lightmap_texture;\n"
         "uniform vec2  u_lightmap_offset;\n"
         "uniform vec2  u_lightmap_scale;\n"
+        "out vec4 fragColor;\n"
         "void main() {\n"
         " vec4 color;\n"
         " vec4 lightmap_color;\n"
         " vec2 lightmap_coord = (coord * u_lightmap_scale) + u_lightmap_offset;\n"
         // Beast exports the texture with vertical flip
-        " lightmap_color = texture2D(u_lightmap_texture, vec2(lightmap_coord.x, 1.0 - lightmap_coord.y));\n"
-        " color = texture2D(u_main_texture, coord);\n"
-        " gl_FragColor = color * lightmap_color;\n"
+        " lightmap_color = texture(u_lightmap_texture, vec2(lightmap_coord.x, 1.0 - lightmap_coord.y));\n"
+        " color = texture(u_main_texture, coord);\n"
+        " fragColor = color * lightmap_color;\n"
         "}";
 
 LightMapShader::LightMapShader() :
-        u_mvp_(0), u_texture_(0), u_lightmap_texture_(0),
+        u_texture_(0), u_lightmap_texture_(0),
         u_lightmap_offset_(0), u_lightmap_scale_(0) {
+    matrix_usage_ = USE_MVP;
+}
+
+LightMapShader::~LightMapShader() {
+    delete program_;
+}
+
+void LightMapShader::build(RenderState* rstate, RenderData* render_data,
+        Material* material) {
+    if (program_ != nullptr) {
+        return;
+    }
     program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
-    u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
+    if (!transform_block_.init(program_->id())) {
+        LOGE("LightMapShader: Transform_ubo not found");
+    }
     u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
 
     u_lightmap_texture_ = glGetUniformLocation(program_->id(), "u_lightmap_texture");
@@ -62,33 +84,29 @@ LightMapShader::LightMapShader() :
     u_lightmap_scale_ = glGetUniformLocation(program_->id(), "u_lightmap_scale");
 }
 
-LightMapShader::~LightMapShader() {
-    delete program_;
-}
-
-void LightMapShader::render(RenderState* rstate,
-        RenderData* render_data, Material* material) {
-
+bool LightMapShader::record(RenderState* rstate, RenderData* render_data,
+        Material* material, RenderCommandList& commands) {
+    if (program_ == nullptr) {
+        return false;
+    }
     Texture* texture = material->getTexture("main_texture");
     Texture* lightmap_texture = material->getTexture("lightmap_texture");
     glm::vec2 lightmap_offset = material->getVec2("lightmap_offset");
     glm::vec2 lightmap_scale = material->getVec2("lightmap_scale");
 
-    glUseProgram(program_->id());
+    commands.bindProgram(program_->id());
 
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
+    transform_block_.record(commands, rstate->uniforms, false);
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
-    glUniform1i(u_texture_, 0);
+    commands.bindTexture(0, texture->getTarget(), texture->getId());
+    commands.uniform1i(u_texture_, 0);
 
-    glActiveTexture (GL_TEXTURE1);
-    glBindTexture(lightmap_texture->getTarget(), lightmap_texture->getId());
-    glUniform1i(u_lightmap_texture_, 1);
+    commands.bindTexture(1, lightmap_texture->getTarget(), lightmap_texture->getId());
+    commands.uniform1i(u_lightmap_texture_, 1);
 
-    glUniform2f(u_lightmap_offset_, lightmap_offset.x, lightmap_offset.y);
-    glUniform2f(u_lightmap_scale_, lightmap_scale.x, lightmap_scale.y);
-    checkGLError("LightMapShader::render");
+    commands.uniform2f(u_lightmap_offset_, lightmap_offset.x, lightmap_offset.y);
+    commands.uniform2f(u_lightmap_scale_, lightmap_scale.x, lightmap_scale.y);
+    return true;
 }
 
 };
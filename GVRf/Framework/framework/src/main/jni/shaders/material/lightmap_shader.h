@@ -21,6 +21,7 @@
 #define LIGHTMAP_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 namespace gvr {
 
@@ -29,7 +30,9 @@ public:
     LightMapShader();
     virtual ~LightMapShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     LightMapShader(const LightMapShader& lightmap_shader);
@@ -38,7 +41,7 @@ private:
     LightMapShader& operator=(LightMapShader&& lightmap_shader);
 
 private:
-    GLuint u_mvp_;
+    GLTransformBlock transform_block_;
     GLuint u_texture_;
     GLuint u_lightmap_texture_;
     GLuint u_lightmap_offset_;
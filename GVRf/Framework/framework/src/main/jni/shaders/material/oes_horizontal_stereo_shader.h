@@ -22,6 +22,7 @@
 #define OES_HORIZONTAL_STEREO_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 #include "objects/eye_type.h"
 
 
@@ -36,7 +37,9 @@ public:
     OESHorizontalStereoShader();
     virtual ~OESHorizontalStereoShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     OESHorizontalStereoShader(
@@ -49,7 +52,7 @@ private:
             OESHorizontalStereoShader&& oes_horizontal_stereo_shader);
 
 private:
-    GLuint u_mvp_;
+    GLTransformBlock transform_block_;
     GLuint u_texture_;
     GLuint u_color_;
     GLuint u_opacity_;
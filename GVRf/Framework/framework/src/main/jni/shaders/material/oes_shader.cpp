@@ -25,13 +25,16 @@
 #include "objects/components/render_data.h"
 #include "util/gvr_gl.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 
 namespace gvr {
 static const char VERTEX_SHADER[] =
         "#version 300 es\n"
         "in vec4 a_position;\n"
         "in vec2 a_texcoord;\n"
-        "uniform mat4 u_mvp;\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_mvp;\n"
+        "};\n"
         "out vec2 v_texcoord;\n"
         "void main() {\n"
         "  v_texcoord = a_texcoord.xy;\n"
@@ -42,7 +45,9 @@ static const char VERTEX_SHADER_MULTIVIEW[] =
         "#version 300 es\n"
         "#extension GL_OVR_multiview2 : enable\n"
         "layout(num_views = 2) in;\n"
-        "uniform mat4 u_mvp_[2];\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_mvp_[2];\n"
+        "};\n"
         "in vec3 a_position;\n"
         "in vec2 a_texcoord;\n"
         "out vec2 v_texcoord;\n"
@@ -69,10 +74,11 @@ static const char FRAGMENT_SHADER[] =
 
 
 OESShader::OESShader() :
-        u_mvp_(0),
         u_texture_(0),
         u_color_(0),
-        u_opacity_(0) {}
+        u_opacity_(0) {
+    matrix_usage_ = USE_MVP;
+}
 
 void OESShader::programInit(RenderState* rstate) {
     if (rstate->is_multiview) {
@@ -82,11 +88,12 @@ void OESShader::programInit(RenderState* rstate) {
         }
 
         program_ = new GLProgram(VERTEX_SHADER_MULTIVIEW,FRAGMENT_SHADER);
-        u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp_[0]");
     } else {
         LOGE("not a multiview");
         program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
-        u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
+    }
+    if (!transform_block_.init(program_->id())) {
+        LOGE("OESShader: Transform_ubo not found");
     }
 
     u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
@@ -98,9 +105,17 @@ OESShader::~OESShader() {
     delete program_;
 }
 
-void OESShader::render(RenderState* rstate, RenderData* render_data, Material* material) {
-    if(program_ == nullptr)
+void OESShader::build(RenderState* rstate, RenderData* render_data, Material* material) {
+    if (program_ == nullptr) {
         programInit(rstate);
+    }
+}
+
+bool OESShader::record(RenderState* rstate, RenderData* render_data, Material* material,
+        RenderCommandList& commands) {
+    if (program_ == nullptr) {
+        return false;
+    }
 
     Texture* texture = material->getTexture("main_texture");
     glm::vec3 color = material->getVec3("color");
@@ -111,19 +126,14 @@ void OESShader::render(RenderState* rstate, RenderData* render_data, Material* m
         throw error;
     }
 
-    glUseProgram(program_->id());
-    if (rstate->is_multiview) {
-        glUniformMatrix4fv(u_mvp_, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp_[0]));
-    } else {
-        glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
-    }
+    commands.bindProgram(program_->id());
+    transform_block_.record(commands, rstate->uniforms, rstate->is_multiview);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
-    glUniform1i(u_texture_, 0);
-    glUniform3f(u_color_, color.r, color.g, color.b);
-    glUniform1f(u_opacity_, opacity);
-    checkGLError("OESShader::render");
+    commands.bindTexture(0, texture->getTarget(), texture->getId());
+    commands.uniform1i(u_texture_, 0);
+    commands.uniform3f(u_color_, color.r, color.g, color.b);
+    commands.uniform1f(u_opacity_, opacity);
+    return true;
 }
 
 }
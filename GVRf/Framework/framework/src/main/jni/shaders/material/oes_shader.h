@@ -22,6 +22,7 @@
 #define OES_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 namespace gvr {
 class RenderData;
@@ -32,7 +33,9 @@ class OESShader: public ShaderBase {
 public:
     OESShader();
     virtual ~OESShader();
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 private:
     OESShader(const OESShader& oes_shader) = delete;
     OESShader(OESShader&& oes_shader) = delete;
@@ -42,7 +45,7 @@ private:
     void programInit(RenderState*);
 
 private:
-    GLint u_mvp_;
+    GLTransformBlock transform_block_;
     GLint u_texture_;
     GLint u_color_;
     GLint u_opacity_;
@@ -22,6 +22,7 @@
 #define OES_VERTICAL_STEREO_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 #include "objects/eye_type.h"
 
 
@@ -32,7 +33,9 @@ public:
     OESVerticalStereoShader();
     virtual ~OESVerticalStereoShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     OESVerticalStereoShader(
@@ -45,7 +48,7 @@ private:
             OESVerticalStereoShader&& oes_vertical_stereo_shader);
 
 private:
-    GLint u_mvp_;
+    GLTransformBlock transform_block_;
     GLint u_texture_;
     GLint u_color_;
     GLint u_opacity_;
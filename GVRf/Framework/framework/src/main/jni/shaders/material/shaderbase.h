@@ -33,12 +33,79 @@ struct RenderState;
 class RenderData;
 class Material;
 class GLProgram;
+class ShaderManager;
+class RenderCommandList;
 
 class ShaderBase: public HybridObject {
 public:
-    ShaderBase() : program_(nullptr) {
+    /*
+     * Per object matrices of ShaderUniformsPerObject. The renderer only
+     * computes the ones the shader says it reads.
+     */
+    enum MatrixUsage {
+        USE_MODEL = 1, USE_MV = 2, USE_MV_IT = 4, USE_MVP = 8,
+        USE_ALL = USE_MODEL | USE_MV | USE_MV_IT | USE_MVP
     };
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material)=0;
+
+    ShaderBase() : program_(nullptr), matrix_usage_(USE_ALL),
+            instance_matrix_location_(-1), skinned_(false) {
+    };
+    /*
+     * Record the program, uniforms and textures for drawing render_data
+     * with material, from the matrices in rstate->uniforms. Makes no GL
+     * calls. Returns false, recording nothing, if build() has to run for
+     * this draw first. Throws a std::string if the material does not fit
+     * the shader.
+     */
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands) = 0;
+    /*
+     * GL thread, between recordings: build what record() found missing
+     * for this draw, like the program and its uniform locations.
+     */
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material) = 0;
+    /*
+     * Whether the program can be drawn with now. A shader whose program
+     * is built in the background starts building it and returns false
+     * until it is done.
+     */
+    virtual bool prepare(ShaderManager* shader_manager) {
+        return true;
+    }
+    /*
+     * Whether the textures material draws with are ready. Render data
+     * whose textures are not are skipped.
+     */
+    virtual bool texturesReady(Material* material) {
+        return true;
+    }
+    int matrixUsage() const {
+        return matrix_usage_;
+    }
+    /*
+     * Location of the a_instance_matrix attribute in the program the last
+     * record() call used, or -1 if it takes its model matrix from u_model.
+     * Programs with the attribute are drawn instanced, with the model
+     * matrices recorded for the draw.
+     */
+    GLint instanceMatrixLocation() const {
+        return instance_matrix_location_;
+    }
+    /*
+     * Whether render data drawn with this shader can be drawn instanced,
+     * by a program with an active a_instance_matrix attribute. The others
+     * are left to the CPU batches.
+     */
+    virtual bool supportsInstancing() const {
+        return false;
+    }
+    /*
+     * Whether the program the last record() call used reads the bone
+     * attributes, which the backend uploads before drawing.
+     */
+    bool skinned() const {
+        return skinned_;
+    }
     GLuint getProgramId()
     {
         if (program_)
@@ -53,6 +120,9 @@ public:
 
 protected:
     GLProgram* program_;
+    int matrix_usage_;
+    GLint instance_matrix_location_;
+    bool skinned_;
 };
 
 }
@@ -21,6 +21,7 @@
 #include "objects/material.h"
 #include "objects/light.h"
 #include "util/gvr_log.h"
+#include "engine/renderer/render_commands.h"
 
 #define LIGHT           1
 #define NO_LIGHT        2
@@ -28,6 +29,8 @@
 #define NO_MULTIVIEW    8
 #define BATCHING        16
 #define NO_BATCHING     32
+#define INSTANCING      64
+#define NO_INSTANCING   128
 
 namespace gvr {
 static const char USE_MULTIVIEW[] = "#define MULTIVIEW\n";
@@ -37,25 +40,26 @@ static const char USE_LIGHT[] = "#define USE_LIGHT\n";
 static const char NOT_USE_LIGHT[] = "#undef USE_LIGHT\n";
 static const char USE_BATCHING[] = "#define USE_BATCHING\n";
 static const char NOT_USE_BATCHING[] ="#undef USE_BATCHING\n";
+static const char USE_INSTANCING[] = "#define USE_INSTANCING\n";
+static const char NOT_USE_INSTANCING[] = "#undef USE_INSTANCING\n";
 
-static const char VERTEX_SHADER[] =
+// extensions go first, View_ubo is declared between the two parts
+static const char VERTEX_SHADER_EXTENSIONS[] =
         "#ifdef MULTIVIEW\n"
         "#extension GL_OVR_multiview2 : enable\n"
         "layout(num_views = 2) in;\n"
-        "#endif\n"
+        "#endif\n";
 
-        "uniform mat4 u_proj;\n"
+static const char VERTEX_SHADER[] =
         "in vec3 a_position;\n"
         "in vec2 a_texcoord;\n"
 
-        "#ifdef MULTIVIEW\n"
-        "uniform mat4 u_view_[2];\n"
-        "#else\n"
-        "uniform mat4 u_view;\n"
-        "#endif\n"
-
-        "#ifndef USE_BATCHING\n"
-        "uniform mat4 u_model;\n"
+        "#if defined(USE_INSTANCING)\n"
+        "in mat4 a_instance_matrix;\n"
+        "#elif !defined(USE_BATCHING)\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_model;\n"
+        "};\n"
         "#endif\n"
 
         "out vec2 v_tex_coord;\n"
@@ -80,6 +84,8 @@ static const char VERTEX_SHADER[] =
             "#ifdef USE_BATCHING\n"
             "int index =int(a_matrix_index);\n"
             "mat4 model_matrix = mat4(u_matrices[index*4],u_matrices[index*4+1],u_matrices[index*4+2],u_matrices[index*4+3]);\n"
+            "#elif defined(USE_INSTANCING)\n"
+            "mat4 model_matrix = a_instance_matrix;\n"
             "#else\n"
             "mat4 model_matrix = u_model;\n"
             "#endif\n"
@@ -157,7 +163,9 @@ static const char FRAGMENT_SHADER[] =
         "  out_color = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
         "}\n";
 
-TextureShader::TextureShader() {}
+TextureShader::TextureShader() {
+    matrix_usage_ = USE_MODEL;
+}
 
 TextureShader::~TextureShader() {
     for(auto it= program_object_map_.begin();it!=program_object_map_.end();it++){
@@ -171,7 +179,6 @@ void TextureShader::initUniforms(int feature_set, GLuint program_id,uniforms& lo
     locations.u_texture = glGetUniformLocation(program_id, "u_texture");
     locations.u_color = glGetUniformLocation(program_id, "u_color");
     locations.u_opacity = glGetUniformLocation(program_id, "u_opacity");
-    locations.u_proj = glGetUniformLocation(program_id, "u_proj");
 
     if(feature_set & LIGHT){
         locations.u_light_pos = glGetUniformLocation(program_id, "u_light_pos");
@@ -190,175 +197,185 @@ void TextureShader::initUniforms(int feature_set, GLuint program_id,uniforms& lo
         locations.u_light_specular_intensity_ = glGetUniformLocation(program_id,
                 "lightSpecularIntensity");
     }
-    if(feature_set & MULTIVIEW)
-        locations.u_view = glGetUniformLocation(program_id, "u_view_[0]");
+    // u_view and u_proj come from View_ubo, u_model from Transform_ubo
+    locations.transform_block.init(program_id);
+    if(feature_set & BATCHING)
+        locations.u_matrices = glGetUniformLocation(program_id, "u_matrices[0]");
     else
-        locations.u_view = glGetUniformLocation(program_id, "u_view");
+        locations.u_matrices = -1;
 
-    if(feature_set & BATCHING)
-        locations.u_model = glGetUniformLocation(program_id, "u_matrices[0]");
+    if(feature_set & INSTANCING)
+        locations.a_instance_matrix = glGetAttribLocation(program_id, "a_instance_matrix");
     else
-        locations.u_model = glGetUniformLocation(program_id, "u_model");
+        locations.a_instance_matrix = -1;
 }
 
-void TextureShader::programInit(RenderState* rstate, RenderData* render_data, Material* material,
-        const std::vector<glm::mat4>& model_matrix,int drawcount, bool batching){
-
-    if(!material->isMainTextureReady())
-        return;
-
-    Texture* texture = material->getTexture("main_texture");
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
-    glm::vec4 material_ambient_color = material->getVec4("ambient_color");
-    glm::vec4 material_diffuse_color = material->getVec4("diffuse_color");
-    glm::vec4 material_specular_color = material->getVec4("specular_color");
-    float material_specular_exponent = material->getFloat("specular_exponent");
-    GLenum target = texture->getTarget();
-    if (target != GL_TEXTURE_2D) {
-        std::string error = "TextureShader::render : texture with wrong target.";
-        throw error;
-    }
-
+/*
+ * Program variant for drawing render_data in the current pass.
+ */
+int TextureShader::featureSet(RenderState* rstate, RenderData* render_data, bool batching) {
     bool use_light = false;
-    Light* light;
     if (render_data->light_enabled()) {
-        light = render_data->light();
+        Light* light = render_data->light();
         if (light->enabled()) {
             use_light = true;
         }
     }
 
-    bool batching_enabled = batching;
+    bool instancing_enabled = !batching && rstate->instance_count > 0;
     int feature_set =0;
     feature_set |= (use_light) ? LIGHT : NO_LIGHT;
     feature_set |= (rstate->is_multiview) ? MULTIVIEW : NO_MULTIVIEW;
-    feature_set |= (batching_enabled) ? BATCHING : NO_BATCHING;
+    feature_set |= (batching) ? BATCHING : NO_BATCHING;
+    feature_set |= (instancing_enabled) ? INSTANCING : NO_INSTANCING;
+    return feature_set;
+}
 
-    bool properties [] = {use_light, rstate->is_multiview, batching_enabled};
-    const char* feature_strings[2][3]={{NOT_USE_LIGHT, NOT_USE_MULTIVIEW, NOT_USE_BATCHING},
-            {USE_LIGHT, USE_MULTIVIEW, USE_BATCHING}};
+void TextureShader::buildVariant(int feature_set) {
+    if (program_object_map_.find(feature_set) != program_object_map_.end()) {
+        return;
+    }
+    bool properties [] = {(feature_set & LIGHT) != 0, (feature_set & MULTIVIEW) != 0,
+            (feature_set & BATCHING) != 0, (feature_set & INSTANCING) != 0};
+    const char* feature_strings[2][4]={{NOT_USE_LIGHT, NOT_USE_MULTIVIEW, NOT_USE_BATCHING, NOT_USE_INSTANCING},
+            {USE_LIGHT, USE_MULTIVIEW, USE_BATCHING, USE_INSTANCING}};
+
+    const char* vertex_shader_strings[8];
+    GLint vertex_shader_string_lengths[8];
+    vertex_shader_strings[0]=version;
+    vertex_shader_strings[5]=VERTEX_SHADER_EXTENSIONS;
+    vertex_shader_strings[6]=VIEW_UBO_GLSL;
+    vertex_shader_strings[7]=VERTEX_SHADER;
+    vertex_shader_string_lengths[0]= (GLint) strlen(version);
+    for (int i = 5; i < 8; ++i) {
+        vertex_shader_string_lengths[i] = (GLint) strlen(vertex_shader_strings[i]);
+    }
 
-    int feature_string_lengths[2][3]={{strlen(NOT_USE_LIGHT), strlen(NOT_USE_MULTIVIEW), strlen(NOT_USE_BATCHING)},
-            {strlen(USE_LIGHT),strlen(USE_MULTIVIEW), strlen(USE_BATCHING)}};
+    // the fragment shader reads no matrices
+    const char* frag_shader_strings[8];
+    GLint frag_shader_string_lengths[8];
+    frag_shader_strings[0]=version;
+    frag_shader_strings[5]="";
+    frag_shader_strings[6]="";
+    frag_shader_strings[7]=FRAGMENT_SHADER;
+    frag_shader_string_lengths [0] = vertex_shader_string_lengths[0];
+    frag_shader_string_lengths [5] = 0;
+    frag_shader_string_lengths [6] = 0;
+    frag_shader_string_lengths [7] = (GLint) strlen(FRAGMENT_SHADER);
+
+    int index = 1;
+    for(int i=0;i<4; i++){
+        vertex_shader_strings[index]= feature_strings[properties[i]][i];
+        vertex_shader_string_lengths [index]= (GLint) strlen(vertex_shader_strings[index]);
+        frag_shader_strings[index]=vertex_shader_strings[index];
+        frag_shader_string_lengths[index] = vertex_shader_string_lengths [index];
+        index++;
+    }
+    GLProgram* prgram = new GLProgram(vertex_shader_strings,
+            vertex_shader_string_lengths, frag_shader_strings,
+            frag_shader_string_lengths, 8);
+    program_object_map_[feature_set] = prgram;
 
+    if(feature_set & MULTIVIEW)
+        LOGE("Rendering with multiview");
     uniforms uniform_locations;
-    GLProgram* prgram = nullptr;
-    if(program_object_map_.find(feature_set)==program_object_map_.end()){
-
-        const char* vertex_shader_strings[5];
-        GLint vertex_shader_string_lengths[5];
-        vertex_shader_strings[0]=version;
-        vertex_shader_strings[4]=VERTEX_SHADER;
-        vertex_shader_string_lengths[0]= (GLint) strlen(version);
-        vertex_shader_string_lengths[4]= (GLint) strlen(VERTEX_SHADER);
-
-        const char* frag_shader_strings[5];
-        GLint frag_shader_string_lengths[5];
-        frag_shader_strings[0]=version;
-        frag_shader_strings[4]=FRAGMENT_SHADER;
-        frag_shader_string_lengths [0] = vertex_shader_string_lengths[0];
-        frag_shader_string_lengths [4] = (GLint) strlen(FRAGMENT_SHADER);
-
-        int index = 1;
-        for(int i=0;i<3; i++){
-            vertex_shader_strings[index]= feature_strings[properties[i]][i];
-            vertex_shader_string_lengths [index]= feature_string_lengths[properties[i]][i];
-            frag_shader_strings[index]=vertex_shader_strings[index];
-            frag_shader_string_lengths[index] = vertex_shader_string_lengths [index];
-            index++;
-        }
-        prgram = new GLProgram(vertex_shader_strings,
-                vertex_shader_string_lengths, frag_shader_strings,
-                frag_shader_string_lengths, 5);
-        program_object_map_[feature_set] = prgram;
-
-        if(rstate->is_multiview)
-            LOGE("Rendering with multiview");
-        initUniforms(feature_set, prgram->id(), uniform_locations);
-        uniform_loc[feature_set] = uniform_locations;
-    }
-    else {
-        prgram = program_object_map_[feature_set];
-        uniform_locations = uniform_loc[feature_set];
-    }
+    initUniforms(feature_set, prgram->id(), uniform_locations);
+    uniform_loc[feature_set] = uniform_locations;
+}
 
-    program_ = prgram;
-    GLuint programId = prgram->id();
-    //render_data->mesh()->generateVAO(programId);
-    GL(glUseProgram(programId));
-    GL(glActiveTexture (GL_TEXTURE0));
-    GL(glBindTexture(texture->getTarget(), texture->getId()));
+void TextureShader::build(RenderState* rstate, RenderData* render_data, Material* material) {
+    buildVariant(featureSet(rstate, render_data, false));
+}
+
+void TextureShader::buildBatch(RenderState* rstate, RenderData* render_data) {
+    buildVariant(featureSet(rstate, render_data, true));
+}
 
-    glUniform1i(uniform_locations.u_texture, 0);
-    glUniform3f(uniform_locations.u_color, color.r, color.g, color.b);
-    glUniform1f(uniform_locations.u_opacity, opacity);
+bool TextureShader::recordVariant(RenderState* rstate, RenderData* render_data,
+        Material* material, const std::vector<glm::mat4>* model_matrix,
+        RenderCommandList& commands) {
+    bool batching = (model_matrix != nullptr);
+    int feature_set = featureSet(rstate, render_data, batching);
+    auto program = program_object_map_.find(feature_set);
+    if (program == program_object_map_.end()) {
+        return false;
+    }
 
-    if(!batching_enabled)
-        glUniformMatrix4fv(uniform_locations.u_model, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_model));
+    Texture* texture = material->getTexture("main_texture");
+    glm::vec3 color = material->getVec3("color");
+    float opacity = material->getFloat("opacity");
+    GLenum target = texture->getTarget();
+    if (target != GL_TEXTURE_2D) {
+        std::string error = "TextureShader::render : texture with wrong target.";
+        throw error;
+    }
 
-    glUniformMatrix4fv(uniform_locations.u_proj, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_proj));
-    if (use_light) {
+    const uniforms& uniform_locations = uniform_loc[feature_set];
+    program_ = program->second;
+    instance_matrix_location_ = uniform_locations.a_instance_matrix;
+    commands.bindProgram(program_->id());
+    commands.bindTexture(0, texture->getTarget(), texture->getId());
+
+    commands.uniform1i(uniform_locations.u_texture, 0);
+    commands.uniform3f(uniform_locations.u_color, color.r, color.g, color.b);
+    commands.uniform1f(uniform_locations.u_opacity, opacity);
+
+    // only the variants without batching or instancing declare Transform_ubo
+    uniform_locations.transform_block.record(commands, rstate->uniforms, false);
+
+    if (feature_set & LIGHT) {
+        Light* light = render_data->light();
+        glm::vec4 material_ambient_color = material->getVec4("ambient_color");
+        glm::vec4 material_diffuse_color = material->getVec4("diffuse_color");
+        glm::vec4 material_specular_color = material->getVec4("specular_color");
+        float material_specular_exponent = material->getFloat("specular_exponent");
         glm::vec3 light_position = light->getVec3("world_position");
         glm::vec4 light_ambient_intensity = light->getVec4("ambient_intensity");
         glm::vec4 light_diffuse_intensity = light->getVec4("diffuse_intensity");
         glm::vec4 light_specular_intensity = light->getVec4(
                 "specular_intensity");
 
-        glUniform3f(uniform_locations.u_light_pos, light_position.x, light_position.y,
+        commands.uniform3f(uniform_locations.u_light_pos, light_position.x, light_position.y,
                 light_position.z);
 
-        glUniform4f(uniform_locations.u_material_ambient_color_, material_ambient_color.r,
+        commands.uniform4f(uniform_locations.u_material_ambient_color_, material_ambient_color.r,
                 material_ambient_color.g, material_ambient_color.b,
                 material_ambient_color.a);
-        glUniform4f(uniform_locations.u_material_diffuse_color_, material_diffuse_color.r,
+        commands.uniform4f(uniform_locations.u_material_diffuse_color_, material_diffuse_color.r,
                 material_diffuse_color.g, material_diffuse_color.b,
                 material_diffuse_color.a);
-        glUniform4f(uniform_locations.u_material_specular_color_, material_specular_color.r,
+        commands.uniform4f(uniform_locations.u_material_specular_color_, material_specular_color.r,
                 material_specular_color.g, material_specular_color.b,
                 material_specular_color.a);
-        glUniform1f(uniform_locations.u_material_specular_exponent_, material_specular_exponent);
-        glUniform4f(uniform_locations.u_light_ambient_intensity_, light_ambient_intensity.r,
+        commands.uniform1f(uniform_locations.u_material_specular_exponent_, material_specular_exponent);
+        commands.uniform4f(uniform_locations.u_light_ambient_intensity_, light_ambient_intensity.r,
                 light_ambient_intensity.g, light_ambient_intensity.b,
                 light_ambient_intensity.a);
-        glUniform4f(uniform_locations.u_light_diffuse_intensity_, light_diffuse_intensity.r,
+        commands.uniform4f(uniform_locations.u_light_diffuse_intensity_, light_diffuse_intensity.r,
                 light_diffuse_intensity.g, light_diffuse_intensity.b,
                 light_diffuse_intensity.a);
-        glUniform4f(uniform_locations.u_light_specular_intensity_, light_specular_intensity.r,
+        commands.uniform4f(uniform_locations.u_light_specular_intensity_, light_specular_intensity.r,
                 light_specular_intensity.g, light_specular_intensity.b,
                 light_specular_intensity.a);
 
     }
 
-    if(rstate->is_multiview)
-        glUniformMatrix4fv(uniform_locations.u_view, 2, GL_FALSE, glm::value_ptr(rstate->uniforms.u_view_[0]));
-    else
-        glUniformMatrix4fv(uniform_locations.u_view, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_view));
-
-
-    if(batching){
-        glUniform4fv(uniform_locations.u_model, drawcount*4, &model_matrix[0][0][0]);
-        glBindVertexArray(render_data->mesh()->getVAOId(programId));
+    if (batching) {
+        commands.uniform4fv(uniform_locations.u_matrices, model_matrix->size() * 4,
+                &(*model_matrix)[0][0][0]);
     }
-
-
+    return true;
 }
-void TextureShader::render(RenderState* rstate,
-        RenderData* render_data, Material* material) {
 
-   std::vector<glm::mat4> model_matrix;
-   model_matrix.push_back(rstate->uniforms.u_model);
-   programInit(rstate,render_data,material,model_matrix,1,false);
-    checkGLError("TextureShader::render");
+bool TextureShader::record(RenderState* rstate, RenderData* render_data,
+        Material* material, RenderCommandList& commands) {
+    return recordVariant(rstate, render_data, material, nullptr, commands);
 }
-void TextureShader::render_batch(const std::vector<glm::mat4>& model_matrix,
-        RenderData* render_data,  RenderState& rstate, unsigned int indexCount, int drawcount)
-{
-    uniforms uniform_locations;
-    programInit(&rstate,render_data,rstate.material_override,model_matrix,drawcount,true);
-    GL(glDrawElements(render_data->draw_mode(), indexCount, GL_UNSIGNED_SHORT, 0));
-    GL(glBindVertexArray(0));
-    checkGLError(" TextureShader::render_batch");
+
+bool TextureShader::recordBatch(RenderState* rstate, RenderData* render_data,
+        Material* material, const std::vector<glm::mat4>& model_matrix,
+        RenderCommandList& commands) {
+    return recordVariant(rstate, render_data, material, &model_matrix, commands);
 }
 }
 ;
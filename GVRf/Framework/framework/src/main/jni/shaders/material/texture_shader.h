@@ -21,6 +21,7 @@
 #define TEXTURE_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 #include <vector>
 #include <unordered_map>
 namespace gvr {
@@ -31,9 +32,21 @@ public:
     TextureShader();
     virtual ~TextureShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
-    void render_batch(const std::vector<glm::mat4>& model_matrix,
-              RenderData* render_data,  RenderState& rstate, unsigned int, int);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
+    // the instancing variant reads its model matrix from a_instance_matrix
+    virtual bool supportsInstancing() const {
+        return true;
+    }
+
+    /*
+     * Record drawing the merged meshes of a batch, with the model matrices
+     * of its meshes. Returns false if buildBatch() has to run first.
+     */
+    bool recordBatch(RenderState* rstate, RenderData* render_data, Material* material,
+            const std::vector<glm::mat4>& model_matrix, RenderCommandList& commands);
+    void buildBatch(RenderState* rstate, RenderData* render_data);
 
 private:
     TextureShader(const TextureShader& texture_shader);
@@ -45,12 +58,11 @@ private:
 
     std::unordered_map<int, GLProgram*>program_object_map_;
     struct uniforms{
-        GLuint u_model;
+        GLTransformBlock transform_block;
+        GLint u_matrices;
         GLuint u_texture;
         GLuint u_color;
         GLuint u_opacity;
-        GLuint u_view;
-        GLuint u_proj;
         GLuint u_light_pos;
         GLuint u_material_ambient_color_;
         GLuint u_material_diffuse_color_;
@@ -59,14 +71,19 @@ private:
         GLuint u_light_ambient_intensity_;
         GLuint u_light_diffuse_intensity_;
         GLuint u_light_specular_intensity_;
+        GLint a_instance_matrix;
     };
     std::unordered_map<int,uniforms> uniform_loc;
 
 
 public:
     void initUniforms(int, GLuint ,uniforms& );
-    void programInit(RenderState* rstate, RenderData* rdata, Material* material, const std::vector<glm::mat4>& model_matrix
-            ,int drawcount, bool batching);
+
+private:
+    int featureSet(RenderState* rstate, RenderData* render_data, bool batching);
+    void buildVariant(int feature_set);
+    bool recordVariant(RenderState* rstate, RenderData* render_data, Material* material,
+            const std::vector<glm::mat4>* model_matrix, RenderCommandList& commands);
 };
 
 }
@@ -17,12 +17,17 @@
 #include "objects/material.h"
 #include "util/gvr_log.h"
 #include "engine/renderer/renderer.h"
+#include "engine/renderer/render_commands.h"
 
 namespace gvr {
-static const char VERTEX_SHADER[] = "attribute vec3 a_position;\n"
-        "attribute vec2 a_texcoord;\n"
-        "uniform mat4 u_mvp;\n"
-        "varying vec2 v_tex_coord;\n"
+static const char VERTEX_SHADER[] =
+        "#version 300 es\n"
+        "in vec3 a_position;\n"
+        "in vec2 a_texcoord;\n"
+        "layout (std140) uniform Transform_ubo {\n"
+        "    mat4 u_mvp;\n"
+        "};\n"
+        "out vec2 v_tex_coord;\n"
         "void main() {\n"
         "  v_tex_coord.x = a_texcoord.x;\n"
         "  v_tex_coord.y = 1.0 - a_texcoord.y;\n"
@@ -30,24 +35,22 @@ static const char VERTEX_SHADER[] = "attribute vec3 a_position;\n"
         "}\n";
 
 static const char FRAGMENT_SHADER[] =
+        "#version 300 es\n"
         "precision highp float;\n"
                 "uniform sampler2D u_texture;\n"
                 "uniform vec3 u_color;\n"
                 "uniform float u_opacity;\n"
-                "varying vec2 v_tex_coord;\n"
+                "in vec2 v_tex_coord;\n"
+                "out vec4 fragColor;\n"
                 "void main()\n"
                 "{\n"
-                "  vec4 color = texture2D(u_texture, v_tex_coord);"
-                "  gl_FragColor = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
+                "  vec4 color = texture(u_texture, v_tex_coord);"
+                "  fragColor = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
                 "}\n";
 
 UnlitFboShader::UnlitFboShader() :
-         u_mvp_(0), u_texture_(0), u_color_(0), u_opacity_(0) {
-    program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
-    u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
-    u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
-    u_color_ = glGetUniformLocation(program_->id(), "u_color");
-    u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
+         u_texture_(0), u_color_(0), u_opacity_(0) {
+    matrix_usage_ = USE_MVP;
 }
 
 UnlitFboShader::~UnlitFboShader() {
@@ -61,8 +64,25 @@ void UnlitFboShader::recycle() {
     program_ = 0;
 }
 
-void UnlitFboShader::render(RenderState* rstate,
-        RenderData* render_data, Material* material) {
+void UnlitFboShader::build(RenderState* rstate, RenderData* render_data,
+        Material* material) {
+    if (program_ != 0) {
+        return;
+    }
+    program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+    if (!transform_block_.init(program_->id())) {
+        LOGE("UnlitFboShader: Transform_ubo not found");
+    }
+    u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
+    u_color_ = glGetUniformLocation(program_->id(), "u_color");
+    u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
+}
+
+bool UnlitFboShader::record(RenderState* rstate, RenderData* render_data,
+        Material* material, RenderCommandList& commands) {
+    if (program_ == 0) {
+        return false;
+    }
     Texture* texture = material->getTexture("main_texture");
     glm::vec3 color = material->getVec3("color");
     float opacity = material->getFloat("opacity");
@@ -72,16 +92,13 @@ void UnlitFboShader::render(RenderState* rstate,
         throw error;
     }
 
-    glUseProgram(program_->id());
-
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(rstate->uniforms.u_mvp));
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
-    glUniform1i(u_texture_, 0);
-    glUniform3f(u_color_, color.r, color.g, color.b);
-    glUniform1f(u_opacity_, opacity);
-    checkGLError("UnlitFboShader::render");
+    commands.bindProgram(program_->id());
+    transform_block_.record(commands, rstate->uniforms, false);
+    commands.bindTexture(0, texture->getTarget(), texture->getId());
+    commands.uniform1i(u_texture_, 0);
+    commands.uniform3f(u_color_, color.r, color.g, color.b);
+    commands.uniform1f(u_opacity_, opacity);
+    return true;
 }
 
 }
-;
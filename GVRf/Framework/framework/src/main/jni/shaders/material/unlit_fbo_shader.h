@@ -17,6 +17,7 @@
 #define UNLIT_FBO_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 
 namespace gvr {
 class GLProgram;
@@ -28,7 +29,9 @@ public:
     UnlitFboShader();
     virtual ~UnlitFboShader();
     void recycle();
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     UnlitFboShader(const UnlitFboShader& fbo_shader);
@@ -37,7 +40,7 @@ private:
     UnlitFboShader& operator=(UnlitFboShader&& fbo_shader);
 
 private:
-    GLuint u_mvp_;
+    GLTransformBlock transform_block_;
     GLuint u_texture_;
     GLuint u_color_;
     GLuint u_opacity_;
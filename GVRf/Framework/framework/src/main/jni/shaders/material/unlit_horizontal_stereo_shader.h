@@ -22,6 +22,7 @@
 #define UNLIT_HORIZONTAL_STEREO_SHADER_H_
 
 #include "shaderbase.h"
+#include "engine/renderer/gl_uniform_ring.h"
 #include "objects/eye_type.h"
 
 namespace gvr {
@@ -32,7 +33,9 @@ public:
     UnlitHorizontalStereoShader();
     virtual ~UnlitHorizontalStereoShader();
 
-    virtual void render(RenderState* rstate, RenderData* render_data, Material* material);
+    virtual bool record(RenderState* rstate, RenderData* render_data, Material* material,
+            RenderCommandList& commands);
+    virtual void build(RenderState* rstate, RenderData* render_data, Material* material);
 
 private:
     UnlitHorizontalStereoShader(
@@ -44,7 +47,7 @@ private:
             UnlitHorizontalStereoShader&& unlit_shader);
 
 private:
-    GLuint u_mvp_;
+    GLTransformBlock transform_block_;
     GLuint u_texture_;
     GLuint u_color_;
     GLuint u_opacity_;
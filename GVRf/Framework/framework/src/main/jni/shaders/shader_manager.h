@@ -37,6 +37,7 @@
 
 #include "shaders/material/unlit_fbo_shader.h"
 #include "shaders/material/lightmap_shader.h"
+#include "gl/gl_program_compiler.h"
 
 #include "util/gvr_log.h"
 
@@ -171,6 +172,76 @@ public:
         }
     }
 
+    /*
+     * Shader for a Material::ShaderType or a custom shader id. Builtin
+     * shaders are built on first use.
+     */
+    ShaderBase* getShader(int shader_type) {
+        //TODO: Improve this logic to avoid a big "switch case"
+        switch (shader_type) {
+        case Material::ShaderType::UNLIT_HORIZONTAL_STEREO_SHADER:
+            return getUnlitHorizontalStereoShader();
+        case Material::ShaderType::UNLIT_VERTICAL_STEREO_SHADER:
+            return getUnlitVerticalStereoShader();
+        case Material::ShaderType::OES_SHADER:
+            return getOESShader();
+        case Material::ShaderType::OES_HORIZONTAL_STEREO_SHADER:
+            return getOESHorizontalStereoShader();
+        case Material::ShaderType::OES_VERTICAL_STEREO_SHADER:
+            return getOESVerticalStereoShader();
+        case Material::ShaderType::CUBEMAP_SHADER:
+            return getCubemapShader();
+        case Material::ShaderType::CUBEMAP_REFLECTION_SHADER:
+            return getCubemapReflectionShader();
+        case Material::ShaderType::TEXTURE_SHADER:
+            return getTextureShader();
+        case Material::ShaderType::EXTERNAL_RENDERER_SHADER:
+            return getExternalRendererShader();
+        case Material::ShaderType::ASSIMP_SHADER:
+            return getAssimpShader();
+        case Material::ShaderType::LIGHTMAP_SHADER:
+            return getLightMapShader();
+        case Material::ShaderType::UNLIT_FBO_SHADER:
+            return getUnlitFboShader();
+        default:
+            return getCustomShader(shader_type);
+        }
+    }
+
+    /*
+     * GL thread: build the programs of these shaders now rather than at
+     * their first draw. Custom shaders are queued on the compile thread
+     * if compiling asynchronously.
+     */
+    void prewarm(const int* shader_types, int count) {
+        for (int i = 0; i < count; ++i) {
+            if (shader_types[i] == Material::ShaderType::BEING_GENERATED) {
+                continue;
+            }
+            try {
+                if (shader_types[i] >= INITIAL_CUSTOM_SHADER_INDEX) {
+                    getCustomShader(shader_types[i])->prewarm(compiler_);
+                } else {
+                    getShader(shader_types[i]);
+                }
+            } catch (const std::string& error) {
+                LOGE("ShaderManager::prewarm() %d: %s", shader_types[i], error.c_str());
+            }
+        }
+    }
+
+    /*
+     * Compiles custom shaders on a thread of their own when async is
+     * set. Until their program is ready they are not drawn, like
+     * materials whose shader is still being generated.
+     */
+    GLProgramCompiler& compiler() {
+        return compiler_;
+    }
+    void set_async_compile(bool async) {
+        compiler_.setAsync(async);
+    }
+
 private:
     ShaderManager(const ShaderManager& shader_manager);
     ShaderManager(ShaderManager&& shader_manager);
@@ -198,6 +269,7 @@ private:
 
     ErrorShader* error_shader_;
     int latest_custom_shader_id_;
+    GLProgramCompiler compiler_;
     std::map<int, CustomShader*> custom_shaders_;
 };
 
@@ -18,6 +18,7 @@
  ***************************************************************************/
 
 #include "shader_manager.h"
+#include "gl/gl_program_cache.h"
 
 #include "util/gvr_jni.h"
 
@@ -33,6 +34,30 @@ Java_org_gearvrf_NativeShaderManager_addCustomShader(
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeShaderManager_getCustomShader(
         JNIEnv * env, jobject obj, jlong jshader_manager, jint id);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeShaderManager_setAsyncCompile(
+        JNIEnv * env, jobject obj, jlong jshader_manager, jboolean async);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeShaderManager_prewarm(
+        JNIEnv * env, jobject obj, jlong jshader_manager, jintArray jshader_types);
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeShaderManager_getPendingPrograms(
+        JNIEnv * env, jobject obj, jlong jshader_manager);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeShaderManager_setProgramCacheDirectory(
+        JNIEnv * env, jobject obj, jstring directory);
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeShaderManager_getCompiledPrograms(
+        JNIEnv * env, jobject obj);
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeShaderManager_getCachedPrograms(
+        JNIEnv * env, jobject obj);
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeShaderManager_getProgramCompileTime(
+        JNIEnv * env, jobject obj);
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeShaderManager_getProgramLoadTime(
+        JNIEnv * env, jobject obj);
 }
 
 JNIEXPORT jlong JNICALL
@@ -71,4 +96,66 @@ Java_org_gearvrf_NativeShaderManager_getCustomShader(
 }
 }
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeShaderManager_setAsyncCompile(
+    JNIEnv * env, jobject obj, jlong jshader_manager, jboolean async) {
+    ShaderManager* shader_manager =
+    reinterpret_cast<ShaderManager*>(jshader_manager);
+    shader_manager->set_async_compile(async);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeShaderManager_prewarm(
+    JNIEnv * env, jobject obj, jlong jshader_manager, jintArray jshader_types) {
+    ShaderManager* shader_manager =
+    reinterpret_cast<ShaderManager*>(jshader_manager);
+    jint* shader_types = env->GetIntArrayElements(jshader_types, 0);
+    shader_manager->prewarm(shader_types, env->GetArrayLength(jshader_types));
+    env->ReleaseIntArrayElements(jshader_types, shader_types, JNI_ABORT);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeShaderManager_getPendingPrograms(
+    JNIEnv * env, jobject obj, jlong jshader_manager) {
+    ShaderManager* shader_manager =
+    reinterpret_cast<ShaderManager*>(jshader_manager);
+    return shader_manager->compiler().pending();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeShaderManager_setProgramCacheDirectory(
+    JNIEnv * env, jobject obj, jstring directory) {
+    if (directory == nullptr) {
+        GLProgramCache::setDirectory("");
+        return;
+    }
+    const char* directory_str = env->GetStringUTFChars(directory, 0);
+    GLProgramCache::setDirectory(directory_str);
+    env->ReleaseStringUTFChars(directory, directory_str);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeShaderManager_getCompiledPrograms(
+    JNIEnv * env, jobject obj) {
+    return GLProgramCache::compiledPrograms();
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeShaderManager_getCachedPrograms(
+    JNIEnv * env, jobject obj) {
+    return GLProgramCache::cachedPrograms();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeShaderManager_getProgramCompileTime(
+    JNIEnv * env, jobject obj) {
+    return GLProgramCache::compileTime();
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeShaderManager_getProgramLoadTime(
+    JNIEnv * env, jobject obj) {
+    return GLProgramCache::loadTime();
+}
+
 }
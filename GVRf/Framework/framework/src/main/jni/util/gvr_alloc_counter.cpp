@@ -0,0 +1,94 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Counts heap allocations made through operator new.
+ ***************************************************************************/
+
+#include "gvr_alloc_counter.h"
+
+#ifdef GVR_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> allocation_count(0);
+
+static void* countedAlloc(std::size_t size) {
+    ++allocation_count;
+    return malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size) {
+    void* p = countedAlloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = countedAlloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+
+namespace gvr {
+
+long long getAllocationCount() {
+    return allocation_count;
+}
+
+}
+
+#else
+
+namespace gvr {
+
+long long getAllocationCount() {
+    return -1;
+}
+
+}
+
+#endif
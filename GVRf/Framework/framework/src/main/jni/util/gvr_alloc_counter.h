@@ -0,0 +1,38 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Counts heap allocations made through operator new.
+ ***************************************************************************/
+
+#ifndef GVR_ALLOC_COUNTER_H_
+#define GVR_ALLOC_COUNTER_H_
+
+namespace gvr {
+
+/*
+ * Number of calls to operator new made by the process so far, on any
+ * thread. Counting is only compiled in when GVR_COUNT_ALLOCATIONS is
+ * defined (see Android.mk); without it this returns -1.
+ *
+ * Take the difference of two calls to see how many allocations a piece
+ * of code made, e.g. to check that steady state culling makes none.
+ */
+long long getAllocationCount();
+
+}
+
+#endif
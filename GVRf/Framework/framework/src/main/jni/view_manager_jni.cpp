@@ -17,6 +17,7 @@
 
 #include "engine/renderer/renderer.h"
 #include "objects/textures/render_texture.h"
+#include "objects/scene.h"
 //#include "objects/components/camera.h"
 
 namespace gvr {
@@ -26,14 +27,22 @@ class Scene;
 
 extern "C" {
     void Java_org_gearvrf_GVRViewManager_cull(JNIEnv *jni, jclass clazz,
-                                              jlong jscene, jlong jcamera, jlong jshader_manager) {
+                                              jlong jscene, jlong jcamera, jlong jshader_manager,
+                                              jint viewport_height) {
         Scene *scene = reinterpret_cast<Scene *>(jscene);
         Camera *camera = reinterpret_cast<Camera *>(jcamera);
         ShaderManager *shader_manager = reinterpret_cast<ShaderManager *>(jshader_manager);
+        scene->set_cull_viewport_height(viewport_height);
         gRenderer = Renderer::getInstance();
         gRenderer->cull(scene, camera, shader_manager);
     }
 
+    void Java_org_gearvrf_GVRViewManager_finishFramePrep(JNIEnv *jni, jclass clazz) {
+        if (nullptr != gRenderer) {
+            gRenderer->finishFramePrep();
+        }
+    }
+
 
     void Java_org_gearvrf_GVRViewManager_makeShadowMaps(JNIEnv *jni, jclass clazz,
                                                         jlong jscene, jlong jshader_manager,
@@ -0,0 +1,148 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Bytes a batch uploads per frame when a tenth of its members are toggled
+ * every frame, against uploading the whole merged mesh again.
+ ***************************************************************************/
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+#include "engine/renderer/batch.h"
+
+using namespace gvr;
+
+namespace {
+
+// any program will do, there is no GL context to look it up in
+const int PROGRAM = 1;
+
+/*
+ * A box with its own vertices per face, the way textured meshes come in.
+ */
+void makeBox(Mesh& mesh) {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texcoords;
+    std::vector<unsigned int> indices;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int side = -1; side <= 1; side += 2) {
+            int first = vertices.size();
+            glm::vec3 normal(0.0f);
+            normal[axis] = side;
+            for (int corner = 0; corner < 4; ++corner) {
+                glm::vec3 v(normal * 0.5f);
+                v[(axis + 1) % 3] = (corner & 1) ? 0.5f : -0.5f;
+                v[(axis + 2) % 3] = (corner & 2) ? 0.5f : -0.5f;
+                vertices.push_back(v);
+                normals.push_back(normal);
+                texcoords.push_back(glm::vec2((corner & 1) ? 1.0f : 0.0f,
+                        (corner & 2) ? 1.0f : 0.0f));
+            }
+            unsigned int quad[] = { 0, 1, 2, 1, 3, 2 };
+            for (int i = 0; i < 6; ++i) {
+                indices.push_back(first + quad[i]);
+            }
+        }
+    }
+    mesh.set_vertices(vertices);
+    mesh.set_normals(normals);
+    mesh.setVec2Vector("a_texcoord", texcoords);
+    mesh.set_indices(indices);
+}
+
+}
+
+int main() {
+    const int MEMBERS = 60;         // what u_matrices holds
+    const int TOGGLED = MEMBERS / 10;
+    const int FRAMES = 200;
+    test::Random random(3);
+    Material material(Material::TEXTURE_SHADER);
+    RenderPass pass;
+    Mesh box;
+    test::TestScene scene;
+
+    makeBox(box);
+    pass.set_material(&material);
+    std::vector<RenderData*> members;
+    for (int i = 0; i < MEMBERS; ++i) {
+        SceneObject* object = scene.addGroup(scene.root(),
+                glm::vec3((i % 8) * 2.0f, (i / 8) * 2.0f, 0.0f));
+        std::unique_ptr<RenderData> render_data(new RenderData());
+        render_data->set_mesh(&box);
+        render_data->add_pass(&pass);
+        render_data->set_batching(true);
+        object->attachComponent(render_data.get());
+        members.push_back(render_data.release());
+    }
+
+    Batch batch(MEMBERS * box.vertices().size(), MEMBERS * box.indices().size());
+    for (auto it = members.begin(); it != members.end(); ++it) {
+        batch.add(*it);
+        (*it)->setBatch(&batch);
+    }
+    batch.setupMesh(false);
+    Mesh* merged = batch.get_renderdata()->mesh();
+    merged->getVAOId(PROGRAM);
+    int full = batch.takeUploadBytes();
+
+    // every frame the members hidden last frame come back, as the batch
+    // manager adds them, and as many others are hidden
+    std::vector<RenderData*> hidden;
+    long long total = 0;
+    int worst = 0;
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        for (auto it = hidden.begin(); it != hidden.end(); ++it) {
+            (*it)->owner_object()->set_enable(true);
+            (*it)->set_batching(true);
+            batch.add(*it);
+            (*it)->setBatch(&batch);
+        }
+        hidden.clear();
+        while (hidden.size() < TOGGLED) {
+            RenderData* render_data = members[random.below(MEMBERS)];
+            if (render_data->owner_object()->enabled()) {
+                render_data->owner_object()->set_enable(false);
+                hidden.push_back(render_data);
+            }
+        }
+        batch.setupMesh(false);
+        merged = batch.get_renderdata()->mesh();
+        merged->getVAOId(PROGRAM);
+        int bytes = batch.takeUploadBytes();
+        total += bytes;
+        worst = std::max(worst, bytes);
+    }
+
+    printf("%d members of %d vertices, %d toggled per frame, %d frames\n", MEMBERS,
+            (int) box.vertices().size(), TOGGLED, FRAMES);
+    printf("  whole mesh   %7d bytes\n", full);
+    printf("  per frame    %7lld bytes average, %d worst, %.1f%% of the whole mesh\n",
+            total / FRAMES, worst, 100.0 * total / FRAMES / full);
+
+    for (auto it = members.begin(); it != members.end(); ++it) {
+        delete *it;
+    }
+    return 0;
+}
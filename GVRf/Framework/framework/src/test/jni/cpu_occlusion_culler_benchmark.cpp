@@ -0,0 +1,76 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * CPU occlusion culling of a city seen from street level: the buildings
+ * are occluders, the props on the sidewalks are tested against them.
+ ***************************************************************************/
+
+#include <cstdio>
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "engine/renderer/cpu_occlusion_culler.h"
+
+using namespace gvr;
+
+int main() {
+    const int BLOCKS = 20;          // per side
+    const float BLOCK = 40.0f;      // building footprint plus the street
+    const float STREET = 12.0f;
+    const int PROPS = 16;           // per block
+    const int RUNS = 20;
+    test::Random random(7);
+    test::TestScene scene;
+
+    for (int bx = 0; bx < BLOCKS; ++bx) {
+        for (int bz = 0; bz < BLOCKS; ++bz) {
+            glm::vec3 center((bx - BLOCKS / 2) * BLOCK + BLOCK / 2, 0.0f,
+                    -bz * BLOCK - BLOCK / 2);
+            float height = random.range(20.0f, 80.0f);
+            float side = BLOCK - STREET;
+            scene.addBox(scene.root(), center + glm::vec3(0.0f, height / 2, 0.0f),
+                    glm::vec3(side, height, side), true);
+            for (int i = 0; i < PROPS; ++i) {
+                float along = random.range(-side / 2, side / 2);
+                float x = (i & 1) ? along : ((i & 2) ? side / 2 + 2.0f : -side / 2 - 2.0f);
+                float z = (i & 1) ? ((i & 2) ? side / 2 + 2.0f : -side / 2 - 2.0f) : along;
+                scene.addBox(scene.root(), center + glm::vec3(x, 1.0f, z), glm::vec3(2.0f));
+            }
+        }
+    }
+    // eye height in the middle of a street, looking down it
+    glm::mat4 vp = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f)
+            * glm::lookAt(glm::vec3(0.0f, 1.7f, 0.0f), glm::vec3(0.0f, 1.7f, -1.0f),
+                    glm::vec3(0.0f, 1.0f, 0.0f));
+    std::vector<SceneObject*> objects = scene.objects();
+    for (auto it = objects.begin(); it != objects.end(); ++it) {
+        (*it)->getBoundingVolume();
+    }
+
+    CpuOcclusionCuller culler;
+    int culled = 0;
+    double time = test::bestOf(RUNS, [&]() {
+        culled = culler.cull(vp, objects);
+    });
+
+    printf("%d buildings, %d props, best of %d runs\n", BLOCKS * BLOCKS,
+            BLOCKS * BLOCKS * PROPS, RUNS);
+    printf("  cull %9.1f us, %d props occluded (%.0f%%)\n", time, culled,
+            100.0f * culled / (BLOCKS * BLOCKS * PROPS));
+    return 0;
+}
@@ -0,0 +1,119 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * What the CPU occlusion culler hides behind a wall, and what it keeps.
+ ***************************************************************************/
+
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "engine/renderer/cpu_occlusion_culler.h"
+
+using namespace gvr;
+
+namespace {
+
+// looking down -z from the origin, twice as wide as high
+glm::mat4 viewProjection() {
+    return glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f)
+            * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                    glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/*
+ * Culling runs after the frustum cull has computed the bounding volumes
+ * and cleared the cull status of everything it kept.
+ */
+std::vector<SceneObject*> frustumCulled(test::TestScene& scene) {
+    std::vector<SceneObject*> objects = scene.objects();
+    for (auto it = objects.begin(); it != objects.end(); ++it) {
+        (*it)->getBoundingVolume();
+        (*it)->setCullStatus(false);
+    }
+    return objects;
+}
+
+void testWall() {
+    test::TestScene scene;
+    // hides |x|, |y| < 8 at a distance of 20
+    SceneObject* wall = scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -5.0f),
+            glm::vec3(4.0f, 4.0f, 0.2f), true);
+    SceneObject* hidden = scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -20.0f),
+            glm::vec3(1.0f));
+    SceneObject* beside = scene.addBox(scene.root(), glm::vec3(12.0f, 0.0f, -20.0f),
+            glm::vec3(1.0f));
+    SceneObject* edge = scene.addBox(scene.root(), glm::vec3(8.0f, 0.0f, -20.0f),
+            glm::vec3(2.0f));
+    SceneObject* in_front = scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -3.0f),
+            glm::vec3(1.0f));
+    SceneObject* near_plane = scene.addBox(scene.root(), glm::vec3(0.0f),
+            glm::vec3(1.0f));
+    std::vector<SceneObject*> objects = frustumCulled(scene);
+    CpuOcclusionCuller culler;
+
+    CHECK_EQ(1, culler.cull(viewProjection(), objects));
+    CHECK(hidden->isCulled());
+    CHECK(!wall->isCulled());
+    CHECK(!beside->isCulled());
+    CHECK(!edge->isCulled());
+    CHECK(!in_front->isCulled());
+    CHECK(!near_plane->isCulled());
+    // hidden objects stay in the list to be picked
+    CHECK_EQ(scene.objects().size(), objects.size());
+}
+
+void testNoOccluders() {
+    test::TestScene scene;
+    SceneObject* box = scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -20.0f),
+            glm::vec3(1.0f));
+    scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(4.0f, 4.0f, 0.2f));
+    std::vector<SceneObject*> objects = frustumCulled(scene);
+    CpuOcclusionCuller culler;
+
+    CHECK_EQ(0, culler.cull(viewProjection(), objects));
+    CHECK(!box->isCulled());
+}
+
+/*
+ * A wall that moved away no longer hides anything; the depth buffer of
+ * the last view must not linger.
+ */
+void testNewView() {
+    test::TestScene scene;
+    SceneObject* wall = scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -5.0f),
+            glm::vec3(4.0f, 4.0f, 0.2f), true);
+    SceneObject* box = scene.addBox(scene.root(), glm::vec3(0.0f, 0.0f, -20.0f),
+            glm::vec3(1.0f));
+    CpuOcclusionCuller culler;
+
+    std::vector<SceneObject*> objects = frustumCulled(scene);
+    CHECK_EQ(1, culler.cull(viewProjection(), objects));
+    wall->transform()->set_position(glm::vec3(30.0f, 0.0f, -5.0f));
+    objects = frustumCulled(scene);
+    CHECK_EQ(0, culler.cull(viewProjection(), objects));
+    CHECK(!box->isCulled());
+}
+
+}
+
+int main() {
+    testWall();
+    testNoOccluders();
+    testNewView();
+    return test::result();
+}
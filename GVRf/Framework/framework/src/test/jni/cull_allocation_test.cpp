@@ -0,0 +1,105 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Once the renderer's vectors have grown to fit the scene, culling and
+ * sorting a frame makes no heap allocations.
+ ***************************************************************************/
+
+#include <cstdio>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+#include "objects/scene.h"
+#include "objects/components/perspective_camera.h"
+#include "engine/renderer/renderer.h"
+#include "util/gvr_alloc_counter.h"
+
+using namespace gvr;
+
+namespace {
+
+const int FRAMES = 16;          // one sweep of the camera
+
+/*
+ * Cull and sort a sweep of the camera across the scene, checking the
+ * allocations of every frame when steady is set.
+ */
+void sweep(Renderer* renderer, Scene* scene, PerspectiveCamera& camera, bool steady) {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        camera.owner_object()->transform()->set_position(
+                glm::vec3(frame * 4.0f - 32.0f, 2.0f, 10.0f));
+        renderer->cull(scene, &camera, nullptr);
+        if (steady) {
+            CHECK_EQ(0, renderer->getCullAllocations());
+        }
+    }
+}
+
+}
+
+int main() {
+    if (getAllocationCount() < 0) {
+        fprintf(stderr, "built without GVR_COUNT_ALLOCATIONS\n");
+        return 1;
+    }
+    Material near_material(Material::TEXTURE_SHADER);
+    Material far_material(Material::TEXTURE_SHADER);
+    RenderPass near_pass;
+    RenderPass far_pass;
+    test::TestScene test_scene;
+
+    // rows of boxes in groups, two materials so the sort has work
+    near_pass.set_material(&near_material);
+    far_pass.set_material(&far_material);
+    for (int g = 0; g < 16; ++g) {
+        SceneObject* group = test_scene.addGroup(test_scene.root(),
+                glm::vec3(g * 8.0f - 64.0f, 0.0f, 0.0f));
+        for (int i = 0; i < 16; ++i) {
+            SceneObject* box = test_scene.addBox(group,
+                    glm::vec3((i % 4) * 2.0f, 0.0f, (i / 4) * -2.0f), glm::vec3(1.0f));
+            box->render_data()->add_pass((i & 1) ? &near_pass : &far_pass);
+        }
+    }
+    SceneObject* camera_object = test_scene.addGroup(test_scene.root(), glm::vec3(0.0f));
+    PerspectiveCamera camera;
+    camera_object->attachComponent(&camera);
+
+    Scene* scene = new Scene();
+    scene->addSceneObject(test_scene.root());
+    scene->set_frustum_culling(true);
+    scene->resetStats();
+    Renderer* renderer = Renderer::getInstance();
+
+    // the first frame grows the vectors and caches, which the counter sees
+    scene->set_flat_culling(true);
+    renderer->cull(scene, &camera, nullptr);
+    CHECK(renderer->getCullAllocations() > 0);
+    sweep(renderer, scene, camera, false);
+    sweep(renderer, scene, camera, true);
+
+    scene->set_flat_culling(false);
+    sweep(renderer, scene, camera, false);
+    sweep(renderer, scene, camera, true);
+
+    camera_object->detachComponent(&camera);
+    scene->removeSceneObject(test_scene.root());
+    delete scene;
+    return test::result();
+}
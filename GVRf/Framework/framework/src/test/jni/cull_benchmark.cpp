@@ -0,0 +1,130 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Frustum culling of a deep scene graph, walking the tree recursively
+ * against the flattened scene graph, through Renderer::cullFromCamera.
+ ***************************************************************************/
+
+#include <cstdio>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+#include "objects/scene.h"
+#include "objects/components/perspective_camera.h"
+#include "engine/renderer/renderer.h"
+#include "engine/renderer/flat_scene_graph.h"
+
+using namespace gvr;
+
+int main() {
+    const int DISTRICTS = 32;       // groups under the root
+    const int BLOCKS = 16;          // groups per district
+    const int BOXES = 16;           // boxes per block
+    const float SPACING = 4.0f;
+    const int RUNS = 20;
+    test::Random random(11);
+    Material material(Material::TEXTURE_SHADER);
+    RenderPass pass;
+    test::TestScene test_scene;
+
+    // districts on a ring around the camera, so about a sixth of them
+    // are in view and whole subtrees can be rejected at once
+    for (int d = 0; d < DISTRICTS; ++d) {
+        float angle = 6.2831853f * d / DISTRICTS;
+        glm::vec3 center(sinf(angle) * 200.0f, 0.0f, -cosf(angle) * 200.0f);
+        SceneObject* district = test_scene.addGroup(test_scene.root(), center);
+        for (int b = 0; b < BLOCKS; ++b) {
+            SceneObject* block = test_scene.addGroup(district,
+                    glm::vec3((b % 4 - 1.5f) * 8 * SPACING, 0.0f, (b / 4 - 1.5f) * 8 * SPACING));
+            for (int i = 0; i < BOXES; ++i) {
+                test_scene.addBox(block,
+                        glm::vec3((i % 4) * SPACING, random.range(0.0f, 20.0f),
+                                (i / 4) * SPACING),
+                        glm::vec3(random.range(0.5f, 3.0f)));
+            }
+        }
+    }
+
+    // the renderer only culls objects that can be drawn
+    pass.set_material(&material);
+    std::vector<SceneObject*> objects = test_scene.objects();
+    for (auto it = objects.begin(); it != objects.end(); ++it) {
+        if ((*it)->render_data() != nullptr) {
+            (*it)->render_data()->add_pass(&pass);
+        }
+    }
+
+    Scene* scene = new Scene();
+    scene->addSceneObject(test_scene.root());
+    scene->set_frustum_culling(true);
+    PerspectiveCamera camera;
+    Renderer* renderer = Renderer::getInstance();
+    FlatSceneGraph& flat_graph = scene->getFlatSceneGraph();
+
+    // the flat graph refreshes every node each frame, the recursive walk
+    // only visits what it does not reject, so both a partial view and an
+    // overview are timed
+    struct View {
+        const char* name;
+        glm::vec3 eye;
+        glm::vec3 center;
+    };
+    const View views[] = {
+        { "street", glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(0.0f, 5.0f, -1.0f) },
+        { "overview", glm::vec3(0.0f, 600.0f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f) }
+    };
+
+    printf("%d boxes in %d groups, best of %d runs\n", DISTRICTS * BLOCKS * BOXES,
+            DISTRICTS * (BLOCKS + 1), RUNS);
+    for (const View& view : views) {
+        camera.setViewMatrix(glm::lookAt(view.eye, view.center, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        scene->set_flat_culling(false);
+        renderer->cullFromCamera(scene, &camera, nullptr);
+        double recursive = test::bestOf(RUNS, [&]() {
+            renderer->cullFromCamera(scene, &camera, nullptr);
+        });
+        scene->set_flat_culling(true);
+        renderer->cullFromCamera(scene, &camera, nullptr);
+        double flat = test::bestOf(RUNS, [&]() {
+            renderer->cullFromCamera(scene, &camera, nullptr);
+        });
+        int visible = renderer->getRenderDataVector().size();
+
+        // the two halves of a flat cull on their own
+        float frustum[6][4];
+        std::vector<SceneObject*> scene_objects;
+        test::frustumOf(camera.getProjectionMatrix() * camera.getViewMatrix(), frustum);
+        double sync = test::bestOf(RUNS, [&]() {
+            flat_graph.sync(scene->getRoot());
+        });
+        double cull = test::bestOf(RUNS, [&]() {
+            scene_objects.clear();
+            flat_graph.cull(view.eye, frustum, scene_objects, true);
+        });
+
+        printf("%s view, %d boxes visible\n", view.name, visible);
+        printf("  recursive %9.1f us\n", recursive);
+        printf("  flat      %9.1f us  %.2fx (sync %.1f us, cull %.1f us)\n", flat,
+                recursive / flat, sync, cull);
+    }
+    scene->removeSceneObject(test_scene.root());
+    delete scene;
+    return 0;
+}
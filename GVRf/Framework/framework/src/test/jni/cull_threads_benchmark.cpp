@@ -0,0 +1,94 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Scaling of the flat scene graph cull with the number of cull threads.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+#include "engine/renderer/flat_scene_graph.h"
+
+using namespace gvr;
+
+int main() {
+    const int GRID = 48;            // blocks per side
+    const int BOXES = 16;           // boxes per block
+    const float BLOCK = 20.0f;
+    const int RUNS = 20;
+    test::Random random(5);
+    Material material(Material::TEXTURE_SHADER);
+    RenderPass pass;
+    test::TestScene scene;
+
+    for (int bx = 0; bx < GRID; ++bx) {
+        for (int bz = 0; bz < GRID; ++bz) {
+            SceneObject* block = scene.addGroup(scene.root(),
+                    glm::vec3((bx - GRID / 2) * BLOCK, 0.0f, (bz - GRID / 2) * BLOCK));
+            for (int i = 0; i < BOXES; ++i) {
+                scene.addBox(block,
+                        glm::vec3(random.range(0.0f, BLOCK), random.range(0.0f, 10.0f),
+                                random.range(0.0f, BLOCK)),
+                        glm::vec3(random.range(0.5f, 3.0f)));
+            }
+        }
+    }
+    // the cull only accepts objects that can be drawn
+    pass.set_material(&material);
+    std::vector<SceneObject*> objects = scene.objects();
+    for (auto it = objects.begin(); it != objects.end(); ++it) {
+        if ((*it)->render_data() != nullptr) {
+            (*it)->render_data()->add_pass(&pass);
+        }
+    }
+
+    // looking down at the middle of the grid, so most blocks straddle
+    // or are inside the frustum and every thread has work
+    glm::vec3 eye(0.0f, 300.0f, 200.0f);
+    glm::mat4 vp = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 2000.0f)
+            * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    float frustum[6][4];
+    test::frustumOf(vp, frustum);
+
+    FlatSceneGraph graph;
+    std::vector<SceneObject*> visible;
+    int max_threads = std::max(4, (int) std::thread::hardware_concurrency());
+    double serial = 0;
+
+    printf("%d boxes in %d blocks, %d hardware threads, best of %d runs\n",
+            GRID * GRID * BOXES, GRID * GRID, std::thread::hardware_concurrency(), RUNS);
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        graph.set_cull_threads(threads);
+        graph.sync(scene.root());
+        double time = test::bestOf(RUNS, [&]() {
+            visible.clear();
+            graph.sync(scene.root());
+            graph.cull(eye, frustum, visible, true);
+        });
+        if (threads == 1) {
+            serial = time;
+        }
+        printf("  %2d threads %9.1f us  %.2fx, %d visible\n", threads, time,
+                serial / time, (int) visible.size());
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The prep thread culls from a snapshot and leaves the scene alone until
+ * the GL thread swaps its results in.
+ ***************************************************************************/
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+#include "objects/scene.h"
+#include "engine/renderer/flat_scene_graph.h"
+#include "engine/renderer/frame_prep.h"
+
+using namespace gvr;
+
+namespace {
+
+void setCullStatus(const std::vector<SceneObject*>& objects, bool cull) {
+    for (auto it = objects.begin(); it != objects.end(); ++it) {
+        (*it)->setCullStatus(cull);
+    }
+}
+
+std::vector<bool> cullStatus(const std::vector<SceneObject*>& objects) {
+    std::vector<bool> status;
+    for (auto it = objects.begin(); it != objects.end(); ++it) {
+        status.push_back((*it)->isCulled());
+    }
+    return status;
+}
+
+}
+
+int main() {
+    Material material(Material::TEXTURE_SHADER);
+    RenderPass pass;
+    test::TestScene test_scene;
+
+    // a row of boxes, the camera only sees the middle of it
+    pass.set_material(&material);
+    for (int g = 0; g < 8; ++g) {
+        SceneObject* group = test_scene.addGroup(test_scene.root(),
+                glm::vec3(g * 16.0f - 64.0f, 0.0f, 0.0f));
+        for (int i = 0; i < 4; ++i) {
+            SceneObject* box = test_scene.addBox(group, glm::vec3(i * 2.0f, 0.0f, 0.0f),
+                    glm::vec3(1.0f));
+            box->render_data()->add_pass(&pass);
+        }
+    }
+    Scene* scene = new Scene();
+    scene->addSceneObject(test_scene.root());
+    std::vector<SceneObject*> objects = test_scene.objects();
+
+    glm::vec3 camera_position(0.0f, 0.0f, 20.0f);
+    glm::mat4 vp = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f)
+            * glm::lookAt(camera_position, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    float frustum[6][4];
+    test::frustumOf(vp, frustum);
+
+    // what a cull on the GL thread does to the scene
+    FlatSceneGraph reference;
+    std::vector<SceneObject*> expected;
+    setCullStatus(objects, false);
+    reference.sync(scene->getRoot());
+    reference.cull(camera_position, frustum, expected, true);
+    std::vector<bool> expected_status = cullStatus(objects);
+    CHECK(expected.size() > 0);
+    CHECK(expected.size() < objects.size());
+
+    // nothing changes until swap()
+    FramePrep prep;
+    std::vector<SceneObject*> scene_objects;
+    std::vector<RenderData*> render_data;
+    setCullStatus(objects, false);
+    prep.begin(scene, camera_position, frustum, true, ScreenSpaceCull());
+    prep.finish();
+    CHECK(prep.ready());
+    CHECK(cullStatus(objects) == std::vector<bool>(objects.size(), false));
+    prep.swap(scene_objects, render_data);
+    CHECK(scene_objects == expected);
+    CHECK(cullStatus(objects) == expected_status);
+    CHECK(render_data.size() > 0);
+
+    // another cull, like the one for a shadow map, culls what the camera
+    // sees; reapply() brings the camera's status back
+    setCullStatus(expected, true);
+    prep.reapply();
+    CHECK(cullStatus(objects) == expected_status);
+
+    // moving an object after begin() does not reach the prepared frame
+    SceneObject* visible = expected.back();
+    glm::vec3 position = visible->transform()->position();
+    prep.begin(scene, camera_position, frustum, true, ScreenSpaceCull());
+    visible->transform()->set_position(glm::vec3(0.0f, 500.0f, 0.0f));
+    prep.finish();
+    prep.swap(scene_objects, render_data);
+    CHECK(scene_objects == expected);
+    visible->transform()->set_position(position);
+
+    // results of a hierarchy that changed are not applied again
+    setCullStatus(objects, true);
+    test_scene.addGroup(test_scene.root(), glm::vec3(0.0f));
+    prep.reapply();
+    CHECK(cullStatus(objects) == std::vector<bool>(objects.size(), true));
+
+    scene->removeSceneObject(test_scene.root());
+    delete scene;
+    return test::result();
+}
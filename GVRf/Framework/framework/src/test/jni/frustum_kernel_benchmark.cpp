@@ -0,0 +1,121 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Scalar against vector frustum kernel on 16k boxes in a few layouts.
+ ***************************************************************************/
+
+#include <cstdio>
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "engine/renderer/frustum_kernel.h"
+
+using namespace gvr;
+
+namespace {
+
+const int COUNT = 16384;
+const int RUNS = 50;
+
+struct Boxes {
+    std::vector<float> xmin, ymin, zmin, xmax, ymax, zmax;
+    std::vector<int> masks;
+    std::vector<unsigned char> results;
+
+    void add(const glm::vec3& center, const glm::vec3& half, int mask) {
+        xmin.push_back(center.x - half.x);
+        ymin.push_back(center.y - half.y);
+        zmin.push_back(center.z - half.z);
+        xmax.push_back(center.x + half.x);
+        ymax.push_back(center.y + half.y);
+        zmax.push_back(center.z + half.z);
+        masks.push_back(mask);
+        results.push_back(0);
+    }
+};
+
+/*
+ * Time count boxes through the kernel, starting from their masks each run.
+ */
+double timeKernel(const float frustum[6][4], Boxes& boxes, bool use_simd) {
+    std::vector<int> initial(boxes.masks);
+    return test::bestOf(RUNS, [&]() {
+        boxes.masks = initial;
+        checkAABBsVsFrustum(frustum, boxes.results.size(), &boxes.xmin[0], &boxes.ymin[0],
+                &boxes.zmin[0], &boxes.xmax[0], &boxes.ymax[0], &boxes.zmax[0],
+                &boxes.masks[0], &boxes.results[0], use_simd);
+    });
+}
+
+void run(const char* name, const float frustum[6][4], Boxes& boxes) {
+    double scalar = timeKernel(frustum, boxes, false);
+    double simd = timeKernel(frustum, boxes, true);
+    int counts[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < boxes.results.size(); ++i) {
+        ++counts[boxes.results[i]];
+    }
+    printf("  %-22s scalar %8.1f us  simd %8.1f us  (%.2fx)  out/cross/in %d/%d/%d\n",
+            name, scalar, simd, scalar / simd, counts[FRUSTUM_OUTSIDE],
+            counts[FRUSTUM_INTERSECT], counts[FRUSTUM_INSIDE]);
+}
+
+}
+
+int main() {
+    float frustum[6][4];
+    glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    test::frustumOf(proj, frustum);
+    test::Random random(42);
+
+    printf("%d boxes, best of %d runs, %s\n", COUNT, RUNS,
+            frustumKernelHasSimd() ? "vector kernel" : "no vector kernel on this target");
+    {
+        Boxes boxes;
+        for (int i = 0; i < COUNT; ++i) {
+            boxes.add(glm::vec3(random.range(-100.0f, 100.0f), random.range(-100.0f, 100.0f),
+                    random.range(-150.0f, 50.0f)), glm::vec3(random.range(0.5f, 5.0f)), 0);
+        }
+        run("random", frustum, boxes);
+    }
+    {
+        Boxes boxes;
+        for (int i = 0; i < COUNT; ++i) {
+            boxes.add(glm::vec3(random.range(-5.0f, 5.0f), random.range(-5.0f, 5.0f),
+                    random.range(-90.0f, -20.0f)), glm::vec3(0.5f), 0);
+        }
+        run("all inside", frustum, boxes);
+    }
+    {
+        Boxes boxes;
+        for (int i = 0; i < COUNT; ++i) {
+            boxes.add(glm::vec3(random.range(-50.0f, 50.0f), random.range(-50.0f, 50.0f),
+                    random.range(5.0f, 50.0f)), glm::vec3(0.5f), 0);
+        }
+        run("all behind", frustum, boxes);
+    }
+    {
+        // siblings under a parent that is inside of the side planes already
+        Boxes boxes;
+        for (int i = 0; i < COUNT; ++i) {
+            boxes.add(glm::vec3(random.range(-5.0f, 5.0f), random.range(-5.0f, 5.0f),
+                    random.range(-150.0f, -20.0f)), glm::vec3(0.5f), 0x0F);
+        }
+        run("masked siblings", frustum, boxes);
+    }
+    return 0;
+}
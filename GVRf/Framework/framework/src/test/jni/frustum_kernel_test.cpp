@@ -0,0 +1,234 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The vector frustum kernel gives the same results and plane masks as the
+ * scalar test, box for box.
+ ***************************************************************************/
+
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "test_util.h"
+#include "test_scene.h"
+#include "engine/renderer/frustum_kernel.h"
+
+using namespace gvr;
+
+namespace {
+
+const int ALL_PLANES = (1 << 6) - 1;
+
+/*
+ * Boxes as the kernel takes them, one array per corner coordinate.
+ */
+struct Boxes {
+    std::vector<float> xmin, ymin, zmin, xmax, ymax, zmax;
+    std::vector<int> masks;
+
+    void add(const glm::vec3& center, const glm::vec3& half, int mask = 0) {
+        xmin.push_back(center.x - half.x);
+        ymin.push_back(center.y - half.y);
+        zmin.push_back(center.z - half.z);
+        xmax.push_back(center.x + half.x);
+        ymax.push_back(center.y + half.y);
+        zmax.push_back(center.z + half.z);
+        masks.push_back(mask);
+    }
+
+    int size() const {
+        return xmin.size();
+    }
+};
+
+struct Frustum {
+    float planes[6][4];
+
+    Frustum() {
+        glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                glm::vec3(0.0f, 1.0f, 0.0f));
+        test::frustumOf(proj * view, planes);
+    }
+};
+
+/*
+ * Run the kernel over the first count boxes with and without SIMD and
+ * compare both with the scalar test of every box.
+ */
+void checkSame(const Frustum& frustum, const Boxes& boxes, int count) {
+    std::vector<int> scalar_masks(boxes.masks.begin(), boxes.masks.begin() + count);
+    std::vector<int> simd_masks(scalar_masks);
+    std::vector<int> plain_masks(scalar_masks);
+    std::vector<unsigned char> simd_results(count + 1, 0xFF);
+    std::vector<unsigned char> plain_results(count + 1, 0xFF);
+
+    checkAABBsVsFrustum(frustum.planes, count, &boxes.xmin[0], &boxes.ymin[0],
+            &boxes.zmin[0], &boxes.xmax[0], &boxes.ymax[0], &boxes.zmax[0],
+            &simd_masks[0], &simd_results[0], true);
+    checkAABBsVsFrustum(frustum.planes, count, &boxes.xmin[0], &boxes.ymin[0],
+            &boxes.zmin[0], &boxes.xmax[0], &boxes.ymax[0], &boxes.zmax[0],
+            &plain_masks[0], &plain_results[0], false);
+
+    for (int i = 0; i < count; ++i) {
+        int result = checkAABBVsFrustum(frustum.planes, boxes.xmin[i], boxes.ymin[i],
+                boxes.zmin[i], boxes.xmax[i], boxes.ymax[i], boxes.zmax[i],
+                scalar_masks[i]);
+        CHECK_EQ(result, simd_results[i]);
+        CHECK_EQ(result, plain_results[i]);
+        CHECK_EQ(scalar_masks[i], simd_masks[i]);
+        CHECK_EQ(scalar_masks[i], plain_masks[i]);
+    }
+    // nothing past the last box is written
+    CHECK_EQ(0xFF, simd_results[count]);
+    CHECK_EQ(0xFF, plain_results[count]);
+}
+
+/*
+ * Boxes all around the camera, some inside, some crossing planes and
+ * some outside.
+ */
+void addRandomBoxes(Boxes& boxes, int count, test::Random& random) {
+    for (int i = 0; i < count; ++i) {
+        glm::vec3 center(random.range(-60.0f, 60.0f), random.range(-60.0f, 60.0f),
+                random.range(-120.0f, 20.0f));
+        glm::vec3 half(random.range(0.1f, 8.0f), random.range(0.1f, 8.0f),
+                random.range(0.1f, 8.0f));
+        boxes.add(center, half);
+    }
+}
+
+/*
+ * Every count from empty up to a few groups, so each number of boxes
+ * left over for the scalar tail is covered.
+ */
+void testLaneTails() {
+    Frustum frustum;
+    test::Random random(3);
+    Boxes boxes;
+    addRandomBoxes(boxes, 4 * FRUSTUM_KERNEL_WIDTH + 1, random);
+
+    for (int count = 0; count <= boxes.size() - 1; ++count) {
+        checkSame(frustum, boxes, count);
+    }
+}
+
+void testRandomBoxes() {
+    Frustum frustum;
+    test::Random random(11);
+    Boxes boxes;
+    addRandomBoxes(boxes, 4099, random);
+    checkSame(frustum, boxes, boxes.size());
+
+    // the boxes cover every outcome
+    int seen[3] = { 0, 0, 0 };
+    for (int i = 0; i < boxes.size(); ++i) {
+        int mask = 0;
+        ++seen[checkAABBVsFrustum(frustum.planes, boxes.xmin[i], boxes.ymin[i],
+                boxes.zmin[i], boxes.xmax[i], boxes.ymax[i], boxes.zmax[i], mask)];
+    }
+    CHECK(seen[FRUSTUM_OUTSIDE] > 0);
+    CHECK(seen[FRUSTUM_INTERSECT] > 0);
+    CHECK(seen[FRUSTUM_INSIDE] > 0);
+}
+
+/*
+ * Children come in with the mask their parent left, and planes in it are
+ * not tested again. Lanes of a group may have different masks.
+ */
+void testPlaneMasks() {
+    Frustum frustum;
+    test::Random random(5);
+    Boxes boxes;
+
+    for (int group = 0; group < 64; ++group) {
+        Boxes parent;
+        glm::vec3 center(random.range(-30.0f, 30.0f), random.range(-30.0f, 30.0f),
+                random.range(-90.0f, -5.0f));
+        parent.add(center, glm::vec3(4.0f));
+        int mask = 0;
+        checkAABBVsFrustum(frustum.planes, parent.xmin[0], parent.ymin[0], parent.zmin[0],
+                parent.xmax[0], parent.ymax[0], parent.zmax[0], mask);
+
+        for (int child = 0; child < FRUSTUM_KERNEL_WIDTH; ++child) {
+            glm::vec3 offset(random.range(-3.0f, 3.0f), random.range(-3.0f, 3.0f),
+                    random.range(-3.0f, 3.0f));
+            // every other group gives its lanes different masks
+            int lane_mask = (group & 1) ? (mask & random.below(ALL_PLANES + 1)) : mask;
+            boxes.add(center + offset, glm::vec3(1.0f), lane_mask);
+        }
+    }
+    checkSame(frustum, boxes, boxes.size());
+
+    // a box known to be inside of every plane is inside without a test
+    Boxes inside;
+    for (int i = 0; i < FRUSTUM_KERNEL_WIDTH; ++i) {
+        inside.add(glm::vec3(0.0f, 0.0f, 500.0f), glm::vec3(1.0f), ALL_PLANES);
+    }
+    std::vector<unsigned char> results(FRUSTUM_KERNEL_WIDTH);
+    checkAABBsVsFrustum(frustum.planes, inside.size(), &inside.xmin[0], &inside.ymin[0],
+            &inside.zmin[0], &inside.xmax[0], &inside.ymax[0], &inside.zmax[0],
+            &inside.masks[0], &results[0], true);
+    for (int i = 0; i < FRUSTUM_KERNEL_WIDTH; ++i) {
+        CHECK_EQ(FRUSTUM_INSIDE, results[i]);
+        CHECK_EQ(ALL_PLANES, inside.masks[i]);
+    }
+}
+
+/*
+ * Groups that are outside as a whole, outside of the same plane or of
+ * different ones, stop early and still match the scalar test.
+ */
+void testAllOutside() {
+    Frustum frustum;
+    Boxes boxes;
+
+    // behind the camera
+    for (int i = 0; i < FRUSTUM_KERNEL_WIDTH; ++i) {
+        boxes.add(glm::vec3(i, 0.0f, 10.0f + i), glm::vec3(0.5f));
+    }
+    // left, right, above and below
+    boxes.add(glm::vec3(-50.0f, 0.0f, -10.0f), glm::vec3(1.0f));
+    boxes.add(glm::vec3(50.0f, 0.0f, -10.0f), glm::vec3(1.0f));
+    boxes.add(glm::vec3(0.0f, 50.0f, -10.0f), glm::vec3(1.0f));
+    boxes.add(glm::vec3(0.0f, -50.0f, -10.0f), glm::vec3(1.0f));
+    // beyond the far plane, inside of the side planes first
+    for (int i = 0; i < FRUSTUM_KERNEL_WIDTH; ++i) {
+        boxes.add(glm::vec3(0.0f, 0.0f, -200.0f - i), glm::vec3(1.0f));
+    }
+    checkSame(frustum, boxes, boxes.size());
+
+    std::vector<unsigned char> results(boxes.size());
+    std::vector<int> masks(boxes.masks);
+    checkAABBsVsFrustum(frustum.planes, boxes.size(), &boxes.xmin[0], &boxes.ymin[0],
+            &boxes.zmin[0], &boxes.xmax[0], &boxes.ymax[0], &boxes.zmax[0],
+            &masks[0], &results[0], true);
+    for (int i = 0; i < boxes.size(); ++i) {
+        CHECK_EQ(FRUSTUM_OUTSIDE, results[i]);
+    }
+}
+
+}
+
+int main() {
+    if (!frustumKernelHasSimd()) {
+        fprintf(stderr, "no vector kernel on this target, testing the scalar one only\n");
+    }
+    testLaneTails();
+    testRandomBoxes();
+    testPlaneMasks();
+    testAllOutside();
+    return test::result();
+}
@@ -0,0 +1,140 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * ACMR, ATVR and run time of the mesh optimizer on shuffled meshes.
+ ***************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "test_util.h"
+#include "objects/mesh_optimizer.h"
+
+using namespace gvr;
+
+namespace {
+
+typedef std::vector<unsigned int> Indices;
+
+void shuffleTriangles(Indices& indices, test::Random& random) {
+    int count = indices.size() / 3;
+    for (int i = count - 1; i > 0; --i) {
+        int j = random.below(i + 1);
+        for (int k = 0; k < 3; ++k) {
+            std::swap(indices[i * 3 + k], indices[j * 3 + k]);
+        }
+    }
+}
+
+void makeGrid(int size, Indices& indices, std::vector<glm::vec3>& positions) {
+    int row = size + 1;
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            positions.push_back(glm::vec3(x, y, 0.0f));
+        }
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            unsigned int corner = y * row + x;
+            unsigned int quad[] = { corner, corner + 1, corner + row,
+                    corner + 1, corner + row + 1, corner + row };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+void makeSphere(int rings, int segments, Indices& indices, std::vector<glm::vec3>& positions) {
+    for (int r = 0; r <= rings; ++r) {
+        float theta = M_PI * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float phi = 2.0f * M_PI * s / segments;
+            positions.push_back(glm::vec3(sinf(theta) * cosf(phi), cosf(theta),
+                    sinf(theta) * sinf(phi)));
+        }
+    }
+    int row = segments + 1;
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            unsigned int corner = r * row + s;
+            unsigned int quad[] = { corner, corner + row, corner + 1,
+                    corner + 1, corner + row, corner + row + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+void report(const char* stage, const Indices& indices, int vertex_count, double us) {
+    printf("  %-14s ACMR %.3f  ATVR %.3f", stage,
+            MeshOptimizer::acmr(indices, vertex_count),
+            MeshOptimizer::atvr(indices, vertex_count));
+    if (us > 0.0) {
+        printf("  %10.1f us", us);
+    }
+    printf("\n");
+}
+
+void run(const char* name, const Indices& shuffled, const std::vector<glm::vec3>& positions) {
+    const int RUNS = 5;
+    int vertex_count = positions.size();
+    Indices indices;
+    Indices remap;
+
+    printf("%s: %d triangles, %d vertices, best of %d runs\n", name,
+            static_cast<int>(shuffled.size() / 3), vertex_count, RUNS);
+    report("shuffled", shuffled, vertex_count, 0.0);
+
+    double cache = test::bestOf(RUNS, [&]() {
+        indices = shuffled;
+        MeshOptimizer::optimizeVertexCache(indices, vertex_count);
+    });
+    report("vertex cache", indices, vertex_count, cache);
+
+    Indices cached = indices;
+    double overdraw = test::bestOf(RUNS, [&]() {
+        indices = cached;
+        MeshOptimizer::optimizeOverdraw(indices, positions, 1.05f);
+    });
+    report("overdraw", indices, vertex_count, overdraw);
+
+    Indices ordered = indices;
+    double fetch = test::bestOf(RUNS, [&]() {
+        indices = ordered;
+        MeshOptimizer::optimizeVertexFetch(indices, vertex_count, remap);
+    });
+    report("vertex fetch", indices, vertex_count, fetch);
+}
+
+}
+
+int main() {
+    test::Random random(42);
+    {
+        Indices indices;
+        std::vector<glm::vec3> positions;
+        makeGrid(256, indices, positions);
+        shuffleTriangles(indices, random);
+        run("grid", indices, positions);
+    }
+    {
+        Indices indices;
+        std::vector<glm::vec3> positions;
+        makeSphere(128, 256, indices, positions);
+        shuffleTriangles(indices, random);
+        run("sphere", indices, positions);
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The mesh optimizer reorders triangles and vertices without changing
+ * what is drawn, and draws them with fewer cache misses.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <vector>
+
+#include "test_util.h"
+#include "objects/mesh_optimizer.h"
+
+using namespace gvr;
+
+namespace {
+
+typedef std::vector<unsigned int> Indices;
+
+/*
+ * A grid of size x size quads in the z = 0 plane, its triangles in a
+ * random order and starting at a random corner.
+ */
+void makeShuffledGrid(int size, Indices& indices, std::vector<glm::vec3>& positions) {
+    test::Random random(7);
+    int row = size + 1;
+
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            positions.push_back(glm::vec3(x, y, 0.0f));
+        }
+    }
+    std::vector<glm::uvec3> triangles;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            unsigned int corner = y * row + x;
+            triangles.push_back(glm::uvec3(corner, corner + 1, corner + row));
+            triangles.push_back(glm::uvec3(corner + 1, corner + row + 1, corner + row));
+        }
+    }
+    for (int i = triangles.size() - 1; i > 0; --i) {
+        std::swap(triangles[i], triangles[random.below(i + 1)]);
+    }
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        int first = random.below(3);
+        for (int k = 0; k < 3; ++k) {
+            indices.push_back(triangles[i][(first + k) % 3]);
+        }
+    }
+}
+
+/*
+ * The triangles of indices, each starting at its lowest vertex so the
+ * winding is kept, sorted.
+ */
+std::vector<glm::uvec3> triangleSet(const Indices& indices) {
+    std::vector<glm::uvec3> triangles;
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if ((b < a) && (b < c)) {
+            triangles.push_back(glm::uvec3(b, c, a));
+        } else if ((c < a) && (c < b)) {
+            triangles.push_back(glm::uvec3(c, a, b));
+        } else {
+            triangles.push_back(glm::uvec3(a, b, c));
+        }
+    }
+    std::sort(triangles.begin(), triangles.end(),
+            [](const glm::uvec3& l, const glm::uvec3& r) {
+                return (l.x != r.x) ? (l.x < r.x) : (l.y != r.y) ? (l.y < r.y) : (l.z < r.z);
+            });
+    return triangles;
+}
+
+void testVertexCache() {
+    Indices indices;
+    std::vector<glm::vec3> positions;
+    makeShuffledGrid(32, indices, positions);
+    int vertex_count = positions.size();
+    Indices original = indices;
+
+    MeshOptimizer::optimizeVertexCache(indices, vertex_count);
+    CHECK(triangleSet(original) == triangleSet(indices));
+
+    float acmr_before = MeshOptimizer::acmr(original, vertex_count);
+    float acmr_after = MeshOptimizer::acmr(indices, vertex_count);
+    float atvr_before = MeshOptimizer::atvr(original, vertex_count);
+    float atvr_after = MeshOptimizer::atvr(indices, vertex_count);
+    CHECK(acmr_after < acmr_before);
+    CHECK(atvr_after < atvr_before);
+    // a regular grid gets close to the 0.5 vertices per triangle it needs
+    CHECK(acmr_after < 0.8f);
+    CHECK(atvr_after >= 1.0f);
+}
+
+void testOverdraw() {
+    Indices indices;
+    std::vector<glm::vec3> positions;
+    makeShuffledGrid(32, indices, positions);
+    int vertex_count = positions.size();
+    Indices original = indices;
+
+    MeshOptimizer::optimizeVertexCache(indices, vertex_count);
+    float acmr_cache = MeshOptimizer::acmr(indices, vertex_count);
+    MeshOptimizer::optimizeOverdraw(indices, positions, 1.05f);
+    CHECK(triangleSet(original) == triangleSet(indices));
+    CHECK(MeshOptimizer::acmr(indices, vertex_count) <= acmr_cache * 1.05f);
+}
+
+void testVertexFetch() {
+    Indices indices;
+    std::vector<glm::vec3> positions;
+    makeShuffledGrid(16, indices, positions);
+    int vertex_count = positions.size();
+    MeshOptimizer::optimizeVertexCache(indices, vertex_count);
+    Indices original = indices;
+    std::vector<glm::vec3> moved = positions;
+    Indices remap;
+
+    MeshOptimizer::optimizeVertexFetch(indices, vertex_count, remap);
+    MeshOptimizer::remapVertices(moved, remap);
+
+    // same triangles in the same order, at the same positions
+    CHECK_EQ(original.size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        CHECK_EQ(remap[original[i]], indices[i]);
+        CHECK(moved[indices[i]] == positions[original[i]]);
+    }
+    // vertices are numbered in the order they are first used
+    unsigned int next = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        CHECK(indices[i] <= next);
+        if (indices[i] == next) {
+            ++next;
+        }
+    }
+    CHECK_EQ(static_cast<unsigned int>(vertex_count), next);
+    CHECK_EQ(MeshOptimizer::acmr(original, vertex_count),
+            MeshOptimizer::acmr(indices, vertex_count));
+}
+
+/*
+ * ACMR against a FIFO cache worked out by hand.
+ */
+void testMetrics() {
+    // two triangles sharing an edge miss 4 vertices
+    Indices quad = { 0, 1, 2, 2, 1, 3 };
+    CHECK_EQ(2.0f, MeshOptimizer::acmr(quad, 4));
+    CHECK_EQ(1.0f, MeshOptimizer::atvr(quad, 4));
+
+    // a cache of 3 has lost vertex 0 when the last triangle needs it
+    Indices fan = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    CHECK_EQ(3.0f, MeshOptimizer::acmr(fan, 6, 3));
+    CHECK_EQ(2.0f, MeshOptimizer::acmr(fan, 6, 6));
+}
+
+}
+
+int main() {
+    testMetrics();
+    testVertexCache();
+    testOverdraw();
+    testVertexFetch();
+    return test::result();
+}
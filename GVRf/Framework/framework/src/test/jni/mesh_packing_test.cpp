@@ -0,0 +1,203 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Attributes are packed only while their values fit, also after they are
+ * updated in place. Only what was updated in place is uploaded.
+ ***************************************************************************/
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "test_util.h"
+#include "objects/mesh.h"
+
+using namespace gvr;
+
+namespace {
+
+// any program will do, there is no GL context to look it up in
+const int PROGRAM = 1;
+
+const int FLOAT_POSITION = 3 * sizeof(float);
+const int HALF_POSITION = 8;    // three halves, padded to 4 bytes
+const int FLOAT_NORMAL = 3 * sizeof(float);
+const int PACKED_NORMAL = 4;
+const int FLOAT_TEXCOORD = 2 * sizeof(float);
+const int HALF_TEXCOORD = 4;
+
+/*
+ * A quad of size 2 with normals and texture coordinates that all pack.
+ */
+void makeQuad(Mesh& mesh) {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texcoords;
+
+    for (int i = 0; i < 4; ++i) {
+        float x = (i & 1) ? 1.0f : -1.0f;
+        float y = (i & 2) ? 1.0f : -1.0f;
+        vertices.push_back(glm::vec3(x, y, 0.0f));
+        normals.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+        texcoords.push_back(glm::vec2(0.5f * x + 0.5f, 0.5f * y + 0.5f));
+    }
+    mesh.set_vertices(vertices);
+    mesh.set_normals(normals);
+    mesh.setVec2Vector("a_texcoord", texcoords);
+    std::vector<unsigned int> indices = { 0, 1, 2, 1, 3, 2 };
+    mesh.set_indices(indices);
+    mesh.setVertexFormat(Mesh::PACK_ALL);
+    mesh.getVAOId(PROGRAM);
+    mesh.takeUploadBytes();
+}
+
+void testPackedLayout() {
+    Mesh mesh;
+    makeQuad(mesh);
+    CHECK_EQ(HALF_POSITION + PACKED_NORMAL + HALF_TEXCOORD, mesh.vertexStride());
+}
+
+/*
+ * Values within range are written in place, one vertex worth of bytes.
+ */
+void testFittingUpdate() {
+    Mesh mesh;
+    makeQuad(mesh);
+    int stride = mesh.vertexStride();
+
+    glm::vec3 normal(0.0f, 1.0f, 0.0f);
+    mesh.updateNormals(2, &normal, 1);
+    glm::vec3 vertex(0.5f, -0.25f, 0.125f);
+    mesh.updateVertices(1, &vertex, 1);
+    glm::vec2 texcoord(0.75f, 0.25f);
+    mesh.updateVec2Vector("a_texcoord", 3, &texcoord, 1);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(stride, mesh.vertexStride());
+    CHECK_EQ(3 * stride, mesh.takeUploadBytes());
+}
+
+/*
+ * Updates apart from each other upload on their own, not what lies
+ * between them.
+ */
+void testSeparateRanges() {
+    Mesh mesh;
+    makeQuad(mesh);
+    int stride = mesh.vertexStride();
+
+    glm::vec3 normal(0.0f, 1.0f, 0.0f);
+    mesh.updateNormals(0, &normal, 1);
+    mesh.updateNormals(3, &normal, 1);
+    unsigned int index = 0;
+    mesh.updateIndices(0, &index, 1);
+    mesh.updateIndices(5, &index, 1);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(2 * stride + 2 * (int) sizeof(unsigned short), mesh.takeUploadBytes());
+
+    // neighbours merge into one range
+    glm::vec3 normals[] = { normal, normal };
+    mesh.updateNormals(1, &normal, 1);
+    mesh.updateNormals(2, &normal, 1);
+    mesh.updateNormals(1, normals, 2);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(2 * stride, mesh.takeUploadBytes());
+}
+
+/*
+ * Only [-1, 1] fits the 2_10_10_10 normals.
+ */
+void testNormalOutOfRange() {
+    Mesh mesh;
+    makeQuad(mesh);
+
+    glm::vec3 normal(0.0f, 1.5f, 0.0f);
+    mesh.updateNormals(0, &normal, 1);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(HALF_POSITION + FLOAT_NORMAL + HALF_TEXCOORD, mesh.vertexStride());
+}
+
+/*
+ * Past the largest half float positions go back to floats, values a half
+ * holds exactly stay packed.
+ */
+void testPositionOutOfRange() {
+    Mesh mesh;
+    makeQuad(mesh);
+
+    glm::vec3 vertex(70000.0f, 0.0f, 0.0f);
+    mesh.updateVertices(0, &vertex, 1);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(FLOAT_POSITION + PACKED_NORMAL + HALF_TEXCOORD, mesh.vertexStride());
+
+    // a half float step at 1 is 1/1024, exact, so that stays packed
+    Mesh precise;
+    makeQuad(precise);
+    vertex = glm::vec3(1.0f + 1.0f / 1024.0f, 0.0f, 0.0f);
+    precise.updateVertices(0, &vertex, 1);
+    precise.getVAOId(PROGRAM);
+    CHECK_EQ(HALF_POSITION + PACKED_NORMAL + HALF_TEXCOORD, precise.vertexStride());
+}
+
+/*
+ * The precision half float positions were checked for shrinks with the
+ * mesh, values that fitted before may not any more.
+ */
+void testPositionShrinks() {
+    Mesh mesh;
+    std::vector<glm::vec3> vertices;
+    vertices.push_back(glm::vec3(0.0f));
+    vertices.push_back(glm::vec3(1000.0f, 0.0f, 0.0f));
+    vertices.push_back(glm::vec3(1000.0f, 1000.0f, 0.0f));
+    vertices.push_back(glm::vec3(300.125f, 0.0f, 0.0f));
+    mesh.set_vertices(vertices);
+    std::vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+    mesh.set_indices(indices);
+    mesh.setVertexFormat(Mesh::PACK_ALL);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(HALF_POSITION, mesh.vertexStride());
+
+    // 300.125 is off by 0.125 as a half, fine for a 1400 unit mesh but not
+    // once it is 300 units across
+    glm::vec3 smaller[] = { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 300.0f, 0.0f) };
+    mesh.updateVertices(1, smaller, 2);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(FLOAT_POSITION, mesh.vertexStride());
+}
+
+/*
+ * Texture coordinates are kept within 1/1024.
+ */
+void testTexcoordOutOfRange() {
+    Mesh mesh;
+    makeQuad(mesh);
+
+    glm::vec2 texcoord(5000.3f, 0.0f);
+    mesh.updateVec2Vector("a_texcoord", 0, &texcoord, 1);
+    mesh.getVAOId(PROGRAM);
+    CHECK_EQ(HALF_POSITION + PACKED_NORMAL + FLOAT_TEXCOORD, mesh.vertexStride());
+}
+
+}
+
+int main() {
+    testPackedLayout();
+    testFittingUpdate();
+    testSeparateRanges();
+    testNormalOutOfRange();
+    testPositionOutOfRange();
+    testPositionShrinks();
+    testTexcoordOutOfRange();
+    return test::result();
+}
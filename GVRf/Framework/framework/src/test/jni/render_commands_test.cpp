@@ -0,0 +1,158 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Recorded commands have to carry their values, so replaying them needs
+ * nothing but the list.
+ ***************************************************************************/
+
+#include <cstring>
+
+#include "test_util.h"
+#include "engine/renderer/render_commands.h"
+#include "engine/renderer/renderer.h"
+#include "objects/components/render_data.h"
+#include "shaders/material/error_shader.h"
+
+using namespace gvr;
+
+namespace {
+
+void testValuesAreCopied() {
+    RenderCommandList commands;
+    float color[] = { 1.0f, 2.0f, 3.0f, 4.0f };
+    glm::mat4 matrix(5.0f);
+
+    commands.bindProgram(7);
+    commands.uniform4fv(3, 1, color);
+    commands.uniformMatrix4fv(4, 1, &matrix[0][0]);
+    commands.uniform1i(5, 9);
+    color[0] = 0.0f;
+    matrix[0][0] = 0.0f;
+
+    CHECK_EQ(4, commands.size());
+    CHECK(commands[0].type == RenderCommand::BIND_PROGRAM);
+    CHECK_EQ(7u, commands[0].program);
+
+    const RenderCommand::UniformArgs& vec4 = commands[1].uniform;
+    CHECK_EQ(RenderCommand::VEC4, vec4.type);
+    CHECK_EQ(3, vec4.location);
+    CHECK_EQ(1.0f, commands.floats(vec4.first)[0]);
+    CHECK_EQ(4.0f, commands.floats(vec4.first)[3]);
+
+    const RenderCommand::UniformArgs& mat4 = commands[2].uniform;
+    CHECK_EQ(RenderCommand::MAT4, mat4.type);
+    CHECK_EQ(5.0f, commands.floats(mat4.first)[0]);
+
+    const RenderCommand::UniformArgs& ivalue = commands[3].uniform;
+    CHECK_EQ(RenderCommand::INT, ivalue.type);
+    CHECK_EQ(9, commands.ints(ivalue.first)[0]);
+}
+
+void testMissingLocationsAreSkipped() {
+    RenderCommandList commands;
+
+    commands.uniform1i(-1, 1);
+    commands.uniform1f(-1, 1.0f);
+    commands.uniform4f(-1, 1.0f, 2.0f, 3.0f, 4.0f);
+    CHECK_EQ(0, commands.size());
+}
+
+void testStatesAndBlocks() {
+    RenderCommandList commands;
+    RenderData first;
+    RenderData second;
+
+    second.set_alpha_blend(!first.alpha_blend());
+    commands.setState(first.render_state(), RenderData::CullBack, false);
+    commands.setState(first.render_state(), RenderData::CullNone, false);
+    commands.setState(second.render_state(), RenderData::CullBack, true);
+    CHECK_EQ(0, commands[0].state.block);
+    CHECK_EQ(0, commands[1].state.block);
+    CHECK_EQ(1, commands[2].state.block);
+    CHECK(commands.state(1) == second.render_state());
+    CHECK(commands[2].state.stencil_only);
+
+    int value = 42;
+    char* block = commands.uniformBlock(2, 64);
+    memcpy(block, &value, sizeof(value));
+    const RenderCommand::BlockArgs& args = commands[3].block;
+    CHECK_EQ(2, args.binding);
+    CHECK_EQ(64, args.size);
+    CHECK_EQ(0, memcmp(commands.blockData(args.first), &value, sizeof(value)));
+    CHECK_EQ(0, commands.blockData(args.first)[63]);
+}
+
+void testNullBackend() {
+    RenderCommandList commands;
+    NullCommandBackend backend;
+    RenderState rstate;
+    glm::mat4 matrices[3];
+
+    commands.bindProgram(1);
+    commands.uniform4f(0, 1.0f, 2.0f, 3.0f, 4.0f);
+    commands.uniformBlock(1, 32);
+    int first = commands.addMatrices(matrices, 3);
+    commands.draw(nullptr, GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, first, 3, 4, false);
+    commands.draw(nullptr, GL_TRIANGLES, 36, 0, -1, 0, -1, false);
+
+    unsigned int epoch = RenderCommandList::epoch();
+    backend.replay(rstate, commands);
+    CHECK_EQ(1, backend.count(RenderCommand::BIND_PROGRAM));
+    CHECK_EQ(1, backend.count(RenderCommand::UNIFORM));
+    CHECK_EQ(2, backend.count(RenderCommand::DRAW));
+    CHECK_EQ(static_cast<int>(4 * sizeof(float) + 32), backend.uniformBytes());
+    // nothing reached a GPU, so nothing counts as set any more
+    CHECK(RenderCommandList::epoch() != epoch);
+
+    backend.reset();
+    CHECK_EQ(0, backend.count(RenderCommand::DRAW));
+    CHECK_EQ(0, backend.uniformBytes());
+}
+
+void testDiscardInvalidates() {
+    RenderCommandList commands;
+    unsigned int epoch = RenderCommandList::epoch();
+
+    commands.bindProgram(1);
+    commands.discard();
+    CHECK_EQ(0, commands.size());
+    CHECK(RenderCommandList::epoch() != epoch);
+}
+
+/*
+ * Shaders do not create programs while recording, they ask to be built.
+ */
+void testRecordWithoutProgram() {
+    ErrorShader shader;
+    RenderCommandList commands;
+    RenderState rstate;
+    RenderData render_data;
+
+    CHECK(!shader.record(&rstate, &render_data, nullptr, commands));
+    CHECK_EQ(0, commands.size());
+}
+
+}
+
+int main() {
+    testValuesAreCopied();
+    testMissingLocationsAreSkipped();
+    testStatesAndBlocks();
+    testNullBackend();
+    testDiscardInvalidates();
+    testRecordWithoutProgram();
+    return test::result();
+}
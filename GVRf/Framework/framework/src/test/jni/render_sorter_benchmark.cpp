@@ -0,0 +1,85 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Radix sort against the comparator sort on 10k render data.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "test_util.h"
+#include "engine/renderer/render_sorter.h"
+#include "objects/components/render_data.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+
+using namespace gvr;
+
+int main() {
+    const int COUNT = 10000;
+    const int MATERIALS = 64;
+    const int RUNS = 20;
+    test::Random random(42);
+    std::vector<std::unique_ptr<Material>> materials;
+    std::vector<std::unique_ptr<RenderPass>> passes;
+    std::vector<std::unique_ptr<RenderData>> render_data;
+    std::vector<RenderData*> list;
+
+    for (int i = 0; i < MATERIALS; ++i) {
+        materials.push_back(std::unique_ptr<Material>(new Material(
+                Material::UNLIT_HORIZONTAL_STEREO_SHADER)));
+    }
+    for (int i = 0; i < COUNT; ++i) {
+        RenderPass* pass = new RenderPass();
+        pass->set_material(materials[random.below(MATERIALS)].get());
+        pass->set_cull_face(random.below(3));
+        passes.push_back(std::unique_ptr<RenderPass>(pass));
+
+        RenderData* rdata = new RenderData();
+        rdata->add_pass(pass);
+        rdata->set_rendering_order(random.below(10) ? RenderData::Geometry
+                : RenderData::Transparent);
+        rdata->set_depth_test(random.below(4) != 0);
+        float distance = random.range(1.0f, 1000.0f);
+        rdata->setCameraDistanceLambda([distance]() { return distance; });
+        render_data.push_back(std::unique_ptr<RenderData>(rdata));
+        list.push_back(rdata);
+    }
+    // evaluate the distance lambdas and state hashes once up front, both
+    // sorts then read cached values
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        (*it)->camera_distance();
+        (*it)->getHashCode();
+    }
+
+    std::vector<RenderData*> work;
+    double comparator = test::bestOf(RUNS, [&]() {
+        work = list;
+        std::sort(work.begin(), work.end(), compareRenderDataByOrderShaderDistance);
+    });
+    RenderSorter sorter;
+    double radix = test::bestOf(RUNS, [&]() {
+        work = list;
+        sorter.sort(work);
+    });
+
+    printf("%d render data, best of %d runs\n", COUNT, RUNS);
+    printf("  std::sort    %9.1f us\n", comparator);
+    printf("  RenderSorter %9.1f us  (%.2fx)\n", radix, comparator / radix);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The radix sorter has to put render data in the order the comparator does.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "test_util.h"
+#include "engine/renderer/render_sorter.h"
+#include "objects/components/render_data.h"
+#include "objects/material.h"
+#include "objects/render_pass.h"
+
+using namespace gvr;
+
+namespace {
+
+/*
+ * Render data with the keys the sort looks at drawn from small sets, so
+ * every criterion has ties the next one has to break.
+ */
+class Scene {
+public:
+    Scene(int count, bool transparent, uint32_t seed) {
+        test::Random random(seed);
+        const int cull_faces[] = {
+            RenderData::CullBack, RenderData::CullFront, RenderData::CullNone
+        };
+        const Material::ShaderType shaders[] = {
+            Material::UNLIT_HORIZONTAL_STEREO_SHADER, Material::UNLIT_VERTICAL_STEREO_SHADER
+        };
+
+        for (int i = 0; i < 6; ++i) {
+            materials_.push_back(std::unique_ptr<Material>(new Material(shaders[i % 2])));
+        }
+        for (int i = 0; i < count; ++i) {
+            RenderPass* pass = new RenderPass();
+            pass->set_material(materials_[random.below(materials_.size())].get());
+            pass->set_cull_face(cull_faces[random.below(3)]);
+            passes_.push_back(std::unique_ptr<RenderPass>(pass));
+
+            RenderData* rdata = new RenderData();
+            rdata->add_pass(pass);
+            rdata->set_rendering_order((transparent && random.below(2))
+                    ? RenderData::Transparent : RenderData::Geometry);
+            rdata->set_alpha_blend(random.below(2) != 0);
+            rdata->set_depth_test(random.below(2) != 0);
+
+            // distinct whole numbers survive the quantization in the key
+            float distance = static_cast<float>(1 + i);
+            rdata->setCameraDistanceLambda([distance]() { return distance; });
+            render_data_.push_back(std::unique_ptr<RenderData>(rdata));
+        }
+        for (size_t i = render_data_.size(); i > 1; --i) {
+            std::swap(render_data_[i - 1], render_data_[random.below(i)]);
+        }
+    }
+
+    std::vector<RenderData*> list() const {
+        std::vector<RenderData*> list;
+        for (auto it = render_data_.begin(); it != render_data_.end(); ++it) {
+            list.push_back(it->get());
+        }
+        return list;
+    }
+
+private:
+    std::vector<std::unique_ptr<Material>> materials_;
+    std::vector<std::unique_ptr<RenderPass>> passes_;
+    std::vector<std::unique_ptr<RenderData>> render_data_;
+};
+
+void checkSameOrder(int count, bool transparent, uint32_t seed) {
+    Scene scene(count, transparent, seed);
+    std::vector<RenderData*> expected = scene.list();
+    std::vector<RenderData*> actual = expected;
+    RenderSorter sorter;
+
+    std::stable_sort(expected.begin(), expected.end(), compareRenderDataByOrderShaderDistance);
+    CHECK(sorter.sort(actual));
+    CHECK(expected == actual);
+}
+
+/*
+ * CullNone is 2, which used to spill out of a one bit field into the
+ * material rank: same material, different cull face must still sort by
+ * cull face first.
+ */
+void testCullNoneStaysInItsField() {
+    Material material(Material::UNLIT_HORIZONTAL_STEREO_SHADER);
+    RenderPass none_pass;
+    RenderPass back_pass;
+    RenderData none;
+    RenderData back;
+
+    none_pass.set_material(&material);
+    none_pass.set_cull_face(RenderData::CullNone);
+    back_pass.set_material(&material);
+    back_pass.set_cull_face(RenderData::CullBack);
+    none.add_pass(&none_pass);
+    back.add_pass(&back_pass);
+    none.setCameraDistanceLambda([]() { return 1.0f; });
+    back.setCameraDistanceLambda([]() { return 2.0f; });
+
+    std::vector<RenderData*> list;
+    list.push_back(&none);
+    list.push_back(&back);
+    RenderSorter sorter;
+    CHECK(sorter.sort(list));
+    CHECK(list[0] == &back);
+    CHECK(list[1] == &none);
+}
+
+}
+
+int main() {
+    testCullNoneStaysInItsField();
+    checkSameOrder(2, false, 1);
+    checkSameOrder(100, false, 2);
+    checkSameOrder(1000, false, 3);
+    checkSameOrder(1000, true, 4);
+    checkSameOrder(10000, true, 5);
+    return test::result();
+}
@@ -0,0 +1,30 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Host stand-in for the NDK header of the same name.
+ ***************************************************************************/
+
+#pragma once
+#include <jni.h>
+struct AAssetManager; struct AAsset; 
+static inline AAssetManager* AAssetManager_fromJava(JNIEnv*, jobject) { return 0; }
+static inline AAsset* AAssetManager_open(AAssetManager*, const char*, int) { return 0; }
+static inline long AAsset_getLength(AAsset*) { return 0; }
+static inline const void* AAsset_getBuffer(AAsset*) { return 0; }
+static inline int AAsset_read(AAsset*, void*, long) { return 0; }
+static inline void AAsset_close(AAsset*) {}
+#define AASSET_MODE_BUFFER 3
+#define AASSET_MODE_STREAMING 2
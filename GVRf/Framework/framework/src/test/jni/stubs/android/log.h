@@ -0,0 +1,39 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Host stand-in for the NDK's logging. Messages go to stderr.
+ ***************************************************************************/
+
+#pragma once
+#include <stdarg.h>
+#include <stdio.h>
+
+enum {
+    ANDROID_LOG_VERBOSE = 2, ANDROID_LOG_DEBUG, ANDROID_LOG_INFO, ANDROID_LOG_WARN, ANDROID_LOG_ERROR
+};
+
+static inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    if (prio < ANDROID_LOG_WARN) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", tag);
+    int n = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return n;
+}
@@ -0,0 +1,27 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Included ahead of every engine source on the host. The NDK's STL pulls
+ * these in through other headers; libstdc++ does not.
+ ***************************************************************************/
+
+#pragma once
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <string>
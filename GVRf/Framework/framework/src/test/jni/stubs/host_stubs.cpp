@@ -0,0 +1,36 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Host stand-ins for what the engine calls out to but the host build
+ * leaves out: the assimp exporter and the Java side of the JNI callbacks.
+ ***************************************************************************/
+
+#include "jni.h"
+#include "engine/exporter/exporter.h"
+
+namespace gvr {
+
+extern "C" {
+void Java_org_gearvrf_NativeTextureCapturer_callbackFromNative(
+        JNIEnv *env, jobject obj, jint index, char *info) {
+}
+}
+
+int Exporter::writeToFile(Scene *scene, const std::string filename) {
+    return -1;
+}
+
+}
@@ -0,0 +1,133 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Host stand-in for the NDK's jni.h. Only what the engine sources need to
+ * compile; every call is a no-op, the tests never go through JNI.
+ ***************************************************************************/
+
+#pragma once
+#include <stdint.h>
+#include <stdarg.h>
+typedef int32_t jint; typedef int64_t jlong; typedef uint8_t jboolean; typedef int8_t jbyte; typedef uint16_t jchar; typedef int16_t jshort; typedef float jfloat; typedef double jdouble; typedef jint jsize;
+class _jobject {}; typedef _jobject* jobject; typedef jobject jclass; typedef jobject jstring; typedef jobject jarray; typedef jobject jobjectArray; typedef jobject jfloatArray; typedef jobject jintArray; typedef jobject jcharArray; typedef jobject jbyteArray; typedef jobject jshortArray; typedef jobject jthrowable; typedef jobject jweak; typedef jobject jlongArray; typedef jobject jbooleanArray;
+struct _jmethodID; typedef _jmethodID* jmethodID; struct _jfieldID; typedef _jfieldID* jfieldID;
+#define JNIEXPORT
+#define JNICALL
+#define JNI_TRUE 1
+#define JNI_FALSE 0
+#define JNI_OK 0
+#define JNI_VERSION_1_6 0x10006
+#define JNI_ABORT 2
+struct JNIEnv {
+  template<class... A> jsize GetStringLength(A...) { return 0; }
+  template<class... A> const jchar* GetStringChars(A...) { return 0; }
+  template<class... A> void ReleaseStringChars(A...) {}
+  template<class... A> jobject NewWeakGlobalRef(A...) { return 0; }
+  template<class... A> jobject NewLocalRef(A...) { return 0; }
+  template<class... A> jobject CallStaticObjectMethod(A...) { return 0; }
+  template<class... A> jobject GetObjectClass(A...) { return 0; }
+  template<class... A> jobject GetObjectField(A...) { return 0; }
+  template<class... A> jobject NewDirectByteBuffer(A...) { return 0; }
+  template<class... A> jobject GetStaticObjectField(A...) { return 0; }
+  template<class... A> jobject AllocObject(A...) { return 0; }
+  template<class... A> jobject NewByteArray(A...) { return 0; }
+  template<class... A> jobject NewLongArray(A...) { return 0; }
+  template<class... A> jobject GetStaticFieldID(A...) { return 0; }
+  template<class... A> jobject PopLocalFrame(A...) { return 0; }
+  template<class... A> jobject ExceptionOccurred(A...) { return 0; }
+  template<class... A> void DeleteWeakGlobalRef(A...) {}
+  template<class... A> void SetByteArrayRegion(A...) {}
+  template<class... A> void SetLongArrayRegion(A...) {}
+  template<class... A> void ExceptionClear(A...) {}
+  template<class... A> void ExceptionDescribe(A...) {}
+  template<class... A> void SetIntField(A...) {}
+  template<class... A> void SetLongField(A...) {}
+  template<class... A> void SetFloatField(A...) {}
+  template<class... A> void SetObjectField(A...) {}
+  template<class... A> void ReleaseLongArrayElements(A...) {}
+  template<class... A> void ReleasePrimitiveArrayCritical(A...) {}
+  template<class... A> void ReleaseBooleanArrayElements(A...) {}
+  template<class... A> void GetByteArrayRegion(A...) {}
+  template<class... A> void GetShortArrayRegion(A...) {}
+  template<class... A> void GetLongArrayRegion(A...) {}
+  template<class... A> void SetBooleanArrayRegion(A...) {}
+  template<class... A> jlong* GetLongArrayElements(A...) { return 0; }
+  template<class... A> void* GetPrimitiveArrayCritical(A...) { return 0; }
+  template<class... A> jint PushLocalFrame(A...) { return 0; }
+  template<class... A> jint EnsureLocalCapacity(A...) { return 0; }
+  template<class... A> jint CallStaticIntMethod(A...) { return 0; }
+  template<class... A> jint Throw(A...) { return 0; }
+  template<class... A> jint MonitorEnter(A...) { return 0; }
+  template<class... A> jint MonitorExit(A...) { return 0; }
+  template<class... A> jint GetStaticIntField(A...) { return 0; }
+  template<class... A> jfloat CallFloatMethod(A...) { return 0; }
+  template<class... A> jfloat GetFloatField(A...) { return 0; }
+  template<class... A> jboolean IsInstanceOf(A...) { return 0; }
+  template<class... A> jboolean IsSameObject(A...) { return 0; }
+  template<class... A> jboolean CallStaticBooleanMethod(A...) { return 0; }
+  template<class... A> jboolean GetBooleanField(A...) { return 0; }
+  template<class... A> jboolean* GetBooleanArrayElements(A...) { return 0; }
+  template<class... A> jclass FindClass(A...) { return 0; }
+  template<class... A> jmethodID GetMethodID(A...) { return 0; }
+  template<class... A> jmethodID GetStaticMethodID(A...) { return 0; }
+  template<class... A> jfieldID GetFieldID(A...) { return 0; }
+  template<class... A> void CallVoidMethod(A...) {}
+  template<class... A> void CallStaticVoidMethod(A...) {}
+  template<class... A> jobject CallObjectMethod(A...) { return 0; }
+  template<class... A> jint CallIntMethod(A...) { return 0; }
+  template<class... A> jboolean CallBooleanMethod(A...) { return 0; }
+  template<class... A> jlong CallLongMethod(A...) { return 0; }
+  template<class... A> jobject NewObject(A...) { return 0; }
+  template<class... A> const char* GetStringUTFChars(A...) { return 0; }
+  template<class... A> void ReleaseStringUTFChars(A...) {}
+  template<class... A> jstring NewStringUTF(A...) { return 0; }
+  template<class... A> jsize GetArrayLength(A...) { return 0; }
+  template<class... A> jfloat* GetFloatArrayElements(A...) { return 0; }
+  template<class... A> void ReleaseFloatArrayElements(A...) {}
+  template<class... A> jint* GetIntArrayElements(A...) { return 0; }
+  template<class... A> void ReleaseIntArrayElements(A...) {}
+  template<class... A> jchar* GetCharArrayElements(A...) { return 0; }
+  template<class... A> void ReleaseCharArrayElements(A...) {}
+  template<class... A> jshort* GetShortArrayElements(A...) { return 0; }
+  template<class... A> void ReleaseShortArrayElements(A...) {}
+  template<class... A> jbyte* GetByteArrayElements(A...) { return 0; }
+  template<class... A> void ReleaseByteArrayElements(A...) {}
+  template<class... A> jobject NewFloatArray(A...) { return 0; }
+  template<class... A> jobject NewIntArray(A...) { return 0; }
+  template<class... A> jobject NewCharArray(A...) { return 0; }
+  template<class... A> jobject NewShortArray(A...) { return 0; }
+  template<class... A> void SetFloatArrayRegion(A...) {}
+  template<class... A> void SetIntArrayRegion(A...) {}
+  template<class... A> void SetCharArrayRegion(A...) {}
+  template<class... A> void SetShortArrayRegion(A...) {}
+  template<class... A> void GetFloatArrayRegion(A...) {}
+  template<class... A> void GetIntArrayRegion(A...) {}
+  template<class... A> void GetCharArrayRegion(A...) {}
+  template<class... A> jobject GetObjectArrayElement(A...) { return 0; }
+  template<class... A> void DeleteLocalRef(A...) {}
+  template<class... A> jobject NewGlobalRef(A...) { return 0; }
+  template<class... A> void DeleteGlobalRef(A...) {}
+  template<class... A> void* GetDirectBufferAddress(A...) { return 0; }
+  template<class... A> jlong GetDirectBufferCapacity(A...) { return 0; }
+  template<class... A> jint ThrowNew(A...) { return 0; }
+  template<class... A> jboolean ExceptionCheck(A...) { return 0; }
+  template<class... A> jint GetJavaVM(A...) { return 0; }
+  template<class... A> jobject NewObjectArray(A...) { return 0; }
+  template<class... A> void SetObjectArrayElement(A...) {}
+  template<class... A> jlong GetLongField(A...) { return 0; }
+  template<class... A> jint GetIntField(A...) { return 0; }
+};
+struct JavaVM { template<class... A> jint AttachCurrentThread(A...) { return 0; } template<class... A> jint DetachCurrentThread(A...) { return 0; } template<class... A> jint GetEnv(A...) { return 0; } };
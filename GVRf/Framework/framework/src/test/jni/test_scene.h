@@ -0,0 +1,145 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Scene graphs of boxes for the culling tests and benchmarks.
+ ***************************************************************************/
+
+#ifndef TEST_SCENE_H_
+#define TEST_SCENE_H_
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "objects/mesh.h"
+#include "objects/scene_object.h"
+#include "objects/components/render_data.h"
+#include "objects/components/transform.h"
+
+namespace gvr {
+namespace test {
+
+/*
+ * The normalized planes of the view frustum of vp, in the order and form
+ * Renderer::build_frustum gives them.
+ */
+static inline void frustumOf(const glm::mat4& vp, float frustum[6][4]) {
+    // right, left, bottom, top, far, near
+    static const int rows[6] = { 0, 0, 1, 1, 2, 2 };
+    static const float signs[6] = { -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f };
+
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            frustum[p][c] = vp[c][3] + signs[p] * vp[c][rows[p]];
+        }
+        float length = sqrtf(frustum[p][0] * frustum[p][0] + frustum[p][1] * frustum[p][1]
+                + frustum[p][2] * frustum[p][2]);
+        for (int c = 0; c < 4; ++c) {
+            frustum[p][c] /= length;
+        }
+    }
+}
+
+/*
+ * Owns the objects, components and the unit box mesh they share; scene
+ * objects do not delete what is attached to them.
+ */
+class TestScene {
+public:
+    TestScene() : root_(new SceneObject()) {
+        const float h = 0.5f;
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec2> texcoords;
+        for (int corner = 0; corner < 8; ++corner) {
+            vertices.push_back(glm::vec3((corner & 1) ? h : -h, (corner & 2) ? h : -h,
+                    (corner & 4) ? h : -h));
+            // batching copies them
+            texcoords.push_back(glm::vec2((corner & 1) ? 1.0f : 0.0f, (corner & 2) ? 1.0f : 0.0f));
+        }
+        static const unsigned short faces[] = {
+            0, 2, 1, 1, 2, 3,   4, 5, 6, 5, 7, 6,   0, 1, 4, 1, 5, 4,
+            2, 6, 3, 3, 6, 7,   0, 4, 2, 2, 4, 6,   1, 3, 5, 3, 7, 5
+        };
+        box_.set_vertices(vertices);
+        box_.setVec2Vector("a_texcoord", texcoords);
+        box_.set_triangles(std::vector<unsigned short>(faces, faces + 36));
+        root_->attachComponent(newTransform());
+    }
+
+    SceneObject* root() {
+        return root_.get();
+    }
+
+    /*
+     * Add an object with a transform and no render data under parent.
+     */
+    SceneObject* addGroup(SceneObject* parent, const glm::vec3& position) {
+        SceneObject* object = new SceneObject();
+        objects_.push_back(std::unique_ptr<SceneObject>(object));
+        Transform* transform = newTransform();
+        object->attachComponent(transform);
+        transform->set_position(position);
+        parent->addChildObject(parent, object);
+        return object;
+    }
+
+    /*
+     * Add a box of the given size under parent.
+     */
+    SceneObject* addBox(SceneObject* parent, const glm::vec3& position,
+            const glm::vec3& size, bool occluder = false) {
+        SceneObject* object = addGroup(parent, position);
+        object->transform()->set_scale(size);
+        RenderData* render_data = new RenderData();
+        render_data_.push_back(std::unique_ptr<RenderData>(render_data));
+        render_data->set_mesh(&box_);
+        render_data->set_occluder(occluder);
+        object->attachComponent(render_data);
+        return object;
+    }
+
+    /*
+     * Every object under the root, parents first.
+     */
+    std::vector<SceneObject*> objects() const {
+        std::vector<SceneObject*> objects;
+        for (auto it = objects_.begin(); it != objects_.end(); ++it) {
+            objects.push_back(it->get());
+        }
+        return objects;
+    }
+
+private:
+    TestScene(const TestScene&);
+    TestScene& operator=(const TestScene&);
+
+    Transform* newTransform() {
+        Transform* transform = new Transform();
+        transforms_.push_back(std::unique_ptr<Transform>(transform));
+        return transform;
+    }
+
+    Mesh box_;
+    std::unique_ptr<SceneObject> root_;
+    std::vector<std::unique_ptr<SceneObject>> objects_;
+    std::vector<std::unique_ptr<Transform>> transforms_;
+    std::vector<std::unique_ptr<RenderData>> render_data_;
+};
+
+}
+}
+#endif
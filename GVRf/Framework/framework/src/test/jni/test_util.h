@@ -0,0 +1,113 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Checks and timing shared by the host tests and benchmarks.
+ ***************************************************************************/
+
+#ifndef TEST_UTIL_H_
+#define TEST_UTIL_H_
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+namespace gvr {
+namespace test {
+
+static int failures = 0;
+
+/*
+ * Record a failure and keep going, so one run reports every broken check.
+ */
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++gvr::test::failures; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(expected, actual) \
+    do { \
+        if (!((expected) == (actual))) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed\n", __FILE__, __LINE__, \
+                    #expected, #actual); \
+            ++gvr::test::failures; \
+        } \
+    } while (0)
+
+/*
+ * Exit status for main().
+ */
+static inline int result() {
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Small deterministic generator so runs are reproducible everywhere.
+ */
+class Random {
+public:
+    explicit Random(uint32_t seed) : state_(seed ? seed : 1) {
+    }
+
+    uint32_t next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    // uniform in [0, n)
+    int below(int n) {
+        return static_cast<int>(next() % static_cast<uint32_t>(n));
+    }
+
+    // uniform in [lo, hi)
+    float range(float lo, float hi) {
+        return lo + (hi - lo) * ((next() & 0xFFFFFF) / 16777216.0f);
+    }
+
+private:
+    uint32_t state_;
+};
+
+/*
+ * Best time of a few runs of func, in microseconds.
+ */
+template<class F>
+double bestOf(int runs, F func) {
+    double best = 1e30;
+
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        std::chrono::duration<double, std::micro> elapsed =
+                std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+}
+}
+#endif